@@ -0,0 +1,269 @@
+/*
+	calctables: compute the constant floating point tables of the decoder
+
+	copyright 2016 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+
+	This is a standalone program for the build host, run via "make tables"
+	in src/libmpg123 to regenerate the headers that get included when
+	PRECALC_TABLES is defined in a floating point build:
+
+		calctables l12 > l12_float_tables.h
+		calctables l3  > l3_float_tables.h
+		calctables dct > dct_float_tables.h
+
+	The computations are the same as the runtime ones in layer2.c, layer3.c and
+	tabinit.c. Values are printed as exact double constants, so the compiler
+	rounding them to real (float or double) gives the very numbers the runtime
+	code would produce with DOUBLE_TO_REAL(). Tables that are used to fill
+	per-decoder tables (gainpow2, layer12_table) stay double for that.
+	Do not build it with -ffast-math, that sacrifices some libm accuracy.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+# define M_PI       3.14159265358979323846
+#endif
+#ifndef M_SQRT2
+#	define M_SQRT2	1.41421356237309504880
+#endif
+
+static const char *header_text =
+	"	generated by calctables.c, do not edit, run \"make tables\" instead\n"
+	"\n"
+	"	copyright 1995-2016 by the mpg123 project - free software under the terms of the LGPL 2.1\n"
+	"	see COPYING and AUTHORS files in distribution or http://mpg123.org\n";
+
+static void print_values(const double *val, size_t count, const char *indent)
+{
+	size_t i;
+	for(i=0; i<count; ++i)
+	{
+		if(i % 4 == 0) printf("%s", indent);
+		printf("%.17g", val[i]);
+		if(i+1 < count) printf(",");
+		printf((i % 4 == 3 || i+1 == count) ? "\n" : " ");
+	}
+}
+
+static void print_table(const char *decl, const double *val, size_t count)
+{
+	printf("\n%s =\n{\n", decl);
+	print_values(val, count, "\t");
+	printf("};\n");
+}
+
+static void print_table2(const char *decl, const double *val, size_t rows, size_t cols)
+{
+	size_t r;
+	printf("\n%s =\n{\n", decl);
+	for(r=0; r<rows; ++r)
+	{
+		printf("\t{\n");
+		print_values(val+r*cols, cols, "\t\t");
+		printf("\t}%s\n", r+1 < rows ? "," : "");
+	}
+	printf("};\n");
+}
+
+static void print_value(const char *decl, double val)
+{
+	printf("\n%s = %.17g;\n", decl, val);
+}
+
+static void begin(const char *name, const char *title, const char *guard)
+{
+	printf("/*\n\t%s: %s\n\n%s*/\n\n", name, title, header_text);
+	printf("#ifndef %s\n#define %s\n", guard, guard);
+}
+
+static void end(void)
+{
+	printf("\n#endif\n");
+}
+
+/* Layer I and II dequantization factors, see init_layer12_table(). */
+static void layer12(void)
+{
+	static const double mulmul[27] =
+	{
+		0.0 , -2.0/3.0 , 2.0/3.0 ,
+		2.0/7.0 , 2.0/15.0 , 2.0/31.0, 2.0/63.0 , 2.0/127.0 , 2.0/255.0 ,
+		2.0/511.0 , 2.0/1023.0 , 2.0/2047.0 , 2.0/4095.0 , 2.0/8191.0 ,
+		2.0/16383.0 , 2.0/32767.0 , 2.0/65535.0 ,
+		-4.0/5.0 , -2.0/5.0 , 2.0/5.0, 4.0/5.0 ,
+		-8.0/9.0 , -4.0/9.0 , -2.0/9.0 , 2.0/9.0 , 4.0/9.0 , 8.0/9.0
+	};
+	double table[27][63];
+	int i,j,m;
+
+	for(m=0; m<27; ++m)
+	for(j=3,i=0;i<63;i++,j--)
+	table[m][i] = mulmul[m] * pow(2.0,(double) j / 3.0);
+
+	begin( "l12_float_tables.h", "Layer 1 and 2 constant tables for floating point decoders"
+	,	"MPG123_L12_FLOAT_TABLES_H" );
+	print_table2("static const double layer12_table[27][63]", table[0], 27, 63);
+	end();
+}
+
+/* The Layer III tables, see init_layer3() and init_layer3_gainpow2(). */
+static void layer3(void)
+{
+	double ispow[8207];
+	double aa_cs[8], aa_ca[8];
+	double win[4][36], win1[4][36];
+	double COS9[9], tfcos36[9], tfcos12[3];
+	double cos9[3], cos18[3];
+	double tan1_1[16], tan2_1[16], tan1_2[16], tan2_2[16];
+	double pow1_1[2][16], pow2_1[2][16], pow1_2[2][16], pow2_2[2][16];
+	double gainpow2[256+118+4];
+	int i,j;
+
+	for(i=0;i<8207;i++)
+	ispow[i] = pow((double)i,(double)4.0/3.0);
+
+	for(i=0;i<8;i++)
+	{
+		const double Ci[8] = {-0.6,-0.535,-0.33,-0.185,-0.095,-0.041,-0.0142,-0.0037};
+		double sq = sqrt(1.0+Ci[i]*Ci[i]);
+		aa_cs[i] = 1.0/sq;
+		aa_ca[i] = Ci[i]/sq;
+	}
+
+	memset(win, 0, sizeof(win));
+	for(i=0;i<18;i++)
+	{
+		win[0][i]    = win[1][i]    =
+			0.5*sin(M_PI/72.0 * (double)(2*(i+0) +1)) / cos(M_PI * (double)(2*(i+0) +19) / 72.0);
+		win[0][i+18] = win[3][i+18] =
+			0.5*sin(M_PI/72.0 * (double)(2*(i+18)+1)) / cos(M_PI * (double)(2*(i+18)+19) / 72.0);
+	}
+	for(i=0;i<6;i++)
+	{
+		win[1][i+18] = 0.5 / cos ( M_PI * (double) (2*(i+18)+19) / 72.0 );
+		win[3][i+12] = 0.5 / cos ( M_PI * (double) (2*(i+12)+19) / 72.0 );
+		win[1][i+24] = 0.5 * sin( M_PI / 24.0 * (double) (2*i+13) ) / cos ( M_PI * (double) (2*(i+24)+19) / 72.0 );
+		win[1][i+30] = win[3][i] = 0.0;
+		win[3][i+6 ] = 0.5 * sin( M_PI / 24.0 * (double) (2*i+1 ) ) / cos ( M_PI * (double) (2*(i+6 )+19) / 72.0 );
+	}
+	for(i=0;i<12;i++)
+	win[2][i] = 0.5 * sin( M_PI / 24.0 * (double) (2*i+1) ) / cos ( M_PI * (double) (2*i+7) / 24.0 );
+
+	memset(win1, 0, sizeof(win1));
+	for(j=0;j<4;j++)
+	{
+		const int len[4] = { 36,36,12,36 };
+		for(i=0;i<len[j];i+=2) win1[j][i] = + win[j][i];
+
+		for(i=1;i<len[j];i+=2) win1[j][i] = - win[j][i];
+	}
+
+	for(i=0;i<9;i++)
+	COS9[i] = cos( M_PI / 18.0 * (double) i);
+
+	for(i=0;i<9;i++)
+	tfcos36[i] = 0.5 / cos ( M_PI * (double) (i*2+1) / 36.0 );
+
+	for(i=0;i<3;i++)
+	tfcos12[i] = 0.5 / cos ( M_PI * (double) (i*2+1) / 12.0 );
+
+	cos9[0]  = cos(1.0*M_PI/9.0);
+	cos9[1]  = cos(5.0*M_PI/9.0);
+	cos9[2]  = cos(7.0*M_PI/9.0);
+	cos18[0] = cos(1.0*M_PI/18.0);
+	cos18[1] = cos(11.0*M_PI/18.0);
+	cos18[2] = cos(13.0*M_PI/18.0);
+
+	for(i=0;i<16;i++)
+	{
+		double t = tan( (double) i * M_PI / 12.0 );
+		tan1_1[i] = t / (1.0+t);
+		tan2_1[i] = 1.0 / (1.0 + t);
+		tan1_2[i] = M_SQRT2 * t / (1.0+t);
+		tan2_2[i] = M_SQRT2 / (1.0 + t);
+
+		for(j=0;j<2;j++)
+		{
+			double base = pow(2.0,-0.25*(j+1.0));
+			double p1=1.0,p2=1.0;
+			if(i > 0)
+			{
+				if( i & 1 ) p1 = pow(base,(i+1.0)*0.5);
+				else p2 = pow(base,i*0.5);
+			}
+			pow1_1[j][i] = p1;
+			pow2_1[j][i] = p2;
+			pow1_2[j][i] = M_SQRT2 * p1;
+			pow2_2[j][i] = M_SQRT2 * p2;
+		}
+	}
+
+	for(i=-256;i<118+4;i++)
+	gainpow2[i+256] = pow((double)2.0,-0.25 * (double) (i+210));
+
+	begin( "l3_float_tables.h", "Layer 3 constant tables for floating point decoders"
+	,	"MPG123_L3_FLOAT_TABLES_H" );
+	print_table("static const real ispow[8207]", ispow, 8207);
+	print_table("static const real aa_cs[8]", aa_cs, 8);
+	print_table("static const real aa_ca[8]", aa_ca, 8);
+	printf("\n/* The dct36 variants want non-const pointers. */");
+	print_table2("static ALIGNED(16) real win[4][36]", win[0], 4, 36);
+	print_table2("static ALIGNED(16) real win1[4][36]", win1[0], 4, 36);
+	print_table("const real COS9[9]", COS9, 9);
+	print_value("static const real COS6_1", cos( M_PI / 6.0 * (double) 1));
+	print_value("static const real COS6_2", cos( M_PI / 6.0 * (double) 2));
+	print_table("const real tfcos36[9]", tfcos36, 9);
+	print_table("static const real tfcos12[3]", tfcos12, 3);
+	print_table("static const real cos9[3]", cos9, 3);
+	print_table("static const real cos18[3]", cos18, 3);
+	print_table("static const real tan1_1[16]", tan1_1, 16);
+	print_table("static const real tan2_1[16]", tan2_1, 16);
+	print_table("static const real tan1_2[16]", tan1_2, 16);
+	print_table("static const real tan2_2[16]", tan2_2, 16);
+	print_table2("static const real pow1_1[2][16]", pow1_1[0], 2, 16);
+	print_table2("static const real pow2_1[2][16]", pow2_1[0], 2, 16);
+	print_table2("static const real pow1_2[2][16]", pow1_2[0], 2, 16);
+	print_table2("static const real pow2_2[2][16]", pow2_2[0], 2, 16);
+	print_table("static const double gainpow2[256+118+4]", gainpow2, 256+118+4);
+	end();
+}
+
+/* The cosine tables for dct64, see prepare_decode_tables(). */
+static void dct(void)
+{
+	double costab[16];
+	int i,k,kr,divv;
+	char decl[64];
+
+	begin( "dct_float_tables.h", "cosine tables of dct64 for floating point decoders"
+	,	"MPG123_DCT_FLOAT_TABLES_H" );
+	for(i=0;i<5;i++)
+	{
+		kr=0x10>>i; divv=0x40>>i;
+		for(k=0;k<kr;k++)
+		costab[k] = 1.0 / (2.0 * cos(M_PI * ((double) k * 2.0 + 1.0) / (double) divv));
+		sprintf(decl, "static ALIGNED(16) real cos%i[%i]", divv, kr);
+		print_table(decl, costab, kr);
+	}
+	end();
+}
+
+int main(int argc, char **argv)
+{
+	if(argc == 2 && !strcmp(argv[1], "l12"))
+		layer12();
+	else if(argc == 2 && !strcmp(argv[1], "l3"))
+		layer3();
+	else if(argc == 2 && !strcmp(argv[1], "dct"))
+		dct();
+	else
+	{
+		fprintf(stderr, "usage: %s l12|l3|dct > header\n", argv[0]);
+		return 1;
+	}
+	return 0;
+}
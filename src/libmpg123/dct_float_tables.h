@@ -0,0 +1,42 @@
+/*
+	dct_float_tables.h: cosine tables of dct64 for floating point decoders
+
+	generated by calctables.c, do not edit, run "make tables" instead
+
+	copyright 1995-2016 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+*/
+
+#ifndef MPG123_DCT_FLOAT_TABLES_H
+#define MPG123_DCT_FLOAT_TABLES_H
+
+static ALIGNED(16) real cos64[16] =
+{
+	0.50060299823519627, 0.50547095989754365, 0.51544730992262455, 0.53104259108978413,
+	0.55310389603444454, 0.58293496820613389, 0.62250412303566482, 0.67480834145500568,
+	0.74453627100229858, 0.83934964541552681, 0.97256823786196078, 1.1694399334328847,
+	1.4841646163141662, 2.0577810099534108, 3.407608418468719, 10.190008123548033
+};
+
+static ALIGNED(16) real cos32[8] =
+{
+	0.50241928618815568, 0.52249861493968885, 0.56694403481635769, 0.64682178335999008,
+	0.7881546234512502, 1.0606776859903471, 1.7224470982383342, 5.1011486186891553
+};
+
+static ALIGNED(16) real cos16[4] =
+{
+	0.50979557910415918, 0.60134488693504529, 0.89997622313641557, 2.5629154477415055
+};
+
+static ALIGNED(16) real cos8[2] =
+{
+	0.54119610014619701, 1.3065629648763764
+};
+
+static ALIGNED(16) real cos4[1] =
+{
+	0.70710678118654746
+};
+
+#endif
@@ -31,6 +31,10 @@
 #define NTOM_MAX_FREQ 96000 /* maximum frequency to upsample to / downsample from */
 #define NTOM_MUL (32768)
 void ntom_set_ntom(mpg123_handle *fr, off_t num);
+/* Windowed-sinc resampling needs floating point samples from the native rate synth. */
+#if !defined(NO_REAL) && !defined(REAL_IS_FIXED)
+#define RESAMPLER
+#endif
 #endif
 
 /* Let's collect all possible synth functions here, for an overview.
@@ -55,6 +59,8 @@ int synth_1to1_x86_64     (real*, int, mpg123_handle*, int);
 int synth_1to1_stereo_x86_64(real*, real*, mpg123_handle*);
 int synth_1to1_avx        (real*, int, mpg123_handle*, int);
 int synth_1to1_stereo_avx (real*, real*, mpg123_handle*);
+int synth_1to1_avx512        (real*, int, mpg123_handle*, int);
+int synth_1to1_stereo_avx512 (real*, real*, mpg123_handle*);
 int synth_1to1_arm        (real*, int, mpg123_handle*, int);
 int synth_1to1_neon       (real*, int, mpg123_handle*, int);
 int synth_1to1_stereo_neon(real*, real*, mpg123_handle*);
@@ -87,6 +93,13 @@ int synth_ntom (real *,int, mpg123_handle*, int);
 int synth_ntom_mono (real *, mpg123_handle *);
 int synth_ntom_m2s (real *, mpg123_handle *);
 #endif
+#ifdef RESAMPLER
+/* Native rate synth and windowed-sinc resampling to the NtoM rate. */
+int synth_resample            (real*, int, mpg123_handle*, int);
+int synth_resample_stereo     (real*, real*, mpg123_handle*);
+int synth_resample_mono       (real*, mpg123_handle*);
+int synth_resample_m2s(real*, mpg123_handle*);
+#endif
 #endif
 
 #ifndef NO_8BIT
@@ -102,6 +115,7 @@ int synth_1to1_8bit_m2s(real*, mpg123_handle*);
 #ifndef NO_16BIT
 int synth_1to1_8bit_wrap_mono       (real*, mpg123_handle*);
 int synth_1to1_8bit_wrap_m2s(real*, mpg123_handle*);
+int synth_1to1_8bit_wrap_stereo(real*, real*, mpg123_handle*);
 #endif
 #ifndef NO_DOWNSAMPLE
 int synth_2to1_8bit            (real*, int, mpg123_handle*, int);
@@ -118,6 +132,12 @@ int synth_ntom_8bit            (real*, int, mpg123_handle*, int);
 int synth_ntom_8bit_mono       (real*, mpg123_handle*);
 int synth_ntom_8bit_m2s(real*, mpg123_handle*);
 #endif
+#ifdef RESAMPLER
+int synth_resample_8bit            (real*, int, mpg123_handle*, int);
+int synth_resample_8bit_stereo     (real*, real*, mpg123_handle*);
+int synth_resample_8bit_mono       (real*, mpg123_handle*);
+int synth_resample_8bit_m2s(real*, mpg123_handle*);
+#endif
 #endif
 
 #ifndef REAL_IS_FIXED
@@ -132,6 +152,10 @@ int synth_1to1_real_x86_64     (real*, int, mpg123_handle*, int);
 int synth_1to1_real_stereo_x86_64(real*, real*, mpg123_handle*);
 int synth_1to1_real_avx        (real*, int, mpg123_handle*, int);
 int synth_1to1_real_stereo_avx (real*, real*, mpg123_handle*);
+int synth_1to1_real_avx512        (real*, int, mpg123_handle*, int);
+int synth_1to1_real_stereo_avx512 (real*, real*, mpg123_handle*);
+int synth_1to1_real_stereo_planar_avx512(real*, real*, mpg123_handle*);
+int synth_1to1_real_m2s_planar_avx512(real*, mpg123_handle*);
 int synth_1to1_real_altivec    (real*, int, mpg123_handle*, int);
 int synth_1to1_real_stereo_altivec(real*, real*, mpg123_handle*);
 int synth_1to1_real_neon       (real*, int, mpg123_handle*, int);
@@ -140,6 +164,9 @@ int synth_1to1_real_neon64     (real*, int, mpg123_handle*, int);
 int synth_1to1_real_stereo_neon64(real*, real*, mpg123_handle*);
 int synth_1to1_real_mono       (real*, mpg123_handle*);
 int synth_1to1_real_m2s(real*, mpg123_handle*);
+int synth_1to1_real_planar       (real*, int, mpg123_handle*, int);
+int synth_1to1_real_stereo_planar(real*, real*, mpg123_handle*);
+int synth_1to1_real_m2s_planar   (real*, mpg123_handle*);
 #ifndef NO_DOWNSAMPLE
 int synth_2to1_real            (real*, int, mpg123_handle*, int);
 int synth_2to1_real_i386       (real*, int, mpg123_handle*, int);
@@ -155,6 +182,12 @@ int synth_ntom_real            (real*, int, mpg123_handle*, int);
 int synth_ntom_real_mono       (real*, mpg123_handle*);
 int synth_ntom_real_m2s(real*, mpg123_handle*);
 #endif
+#ifdef RESAMPLER
+int synth_resample_real            (real*, int, mpg123_handle*, int);
+int synth_resample_real_stereo     (real*, real*, mpg123_handle*);
+int synth_resample_real_mono       (real*, mpg123_handle*);
+int synth_resample_real_m2s(real*, mpg123_handle*);
+#endif
 #endif
 
 #ifndef NO_32BIT
@@ -167,6 +200,8 @@ int synth_1to1_s32_x86_64     (real*, int, mpg123_handle*, int);
 int synth_1to1_s32_stereo_x86_64(real*, real*, mpg123_handle*);
 int synth_1to1_s32_avx        (real*, int, mpg123_handle*, int);
 int synth_1to1_s32_stereo_avx (real*, real*, mpg123_handle*);
+int synth_1to1_s32_avx512        (real*, int, mpg123_handle*, int);
+int synth_1to1_s32_stereo_avx512 (real*, real*, mpg123_handle*);
 int synth_1to1_s32_altivec    (real*, int, mpg123_handle*, int);
 int synth_1to1_s32_stereo_altivec(real*, real*, mpg123_handle*);
 int synth_1to1_s32_neon       (real*, int, mpg123_handle*, int);
@@ -190,6 +225,12 @@ int synth_ntom_s32            (real*, int, mpg123_handle*, int);
 int synth_ntom_s32_mono       (real*, mpg123_handle*);
 int synth_ntom_s32_m2s(real*, mpg123_handle*);
 #endif
+#ifdef RESAMPLER
+int synth_resample_s32            (real*, int, mpg123_handle*, int);
+int synth_resample_s32_stereo     (real*, real*, mpg123_handle*);
+int synth_resample_s32_mono       (real*, mpg123_handle*);
+int synth_resample_s32_m2s(real*, mpg123_handle*);
+#endif
 #endif
 
 #endif /* FIXED */
@@ -213,9 +254,42 @@ void dct36_avx     (real *,real *,real *,real *,real *);
 void dct36_neon    (real *,real *,real *,real *,real *);
 void dct36_neon64  (real *,real *,real *,real *,real *);
 
+/* The stages around it, in generic C and SSE for x86-64 (used by the AVX decoders, too). */
+void dct12             (real *,real *,real *,real *,real *);
+void dct12_x86_64      (real *,real *,real *,real *,real *);
+void antialias         (real *xr1, int sblim);
+void antialias_x86_64  (real *xr1, int sblim);
+void stereo_ms         (real *in0, real *in1, int count);
+void stereo_ms_x86_64  (real *in0, real *in1, int count);
+void hybrid_tail       (real *rawout1, real *rawout2, real *ts, int count);
+void hybrid_tail_x86_64(real *rawout1, real *rawout2, real *ts, int count);
+
+/* Layer I and II dequantization, also with SSE for x86-64. */
+void dequant12         (real *out, const int *q, const real *cm, int rows);
+void dequant12_x86_64  (real *out, const int *q, const real *cm, int rows);
+#ifndef NO_LAYER12
+/* The mean of both channels in left, for MPG123_MONO_MIX. */
+void mix12(real *left, const real *right, int rows);
+/* Synthesis of count blocks of SBLIMIT subband samples that follow each other in memory.
+   Without right channel, it is fr->synth_mono on the left one. */
+int synth_blocks(mpg123_handle *fr, real *left, real *right, int count);
+#endif
+
 /* Tools for NtoM resampling synth, defined in ntom.c . */
 int synth_ntom_set_step(mpg123_handle *fr); /* prepare ntom decoding */
 unsigned long ntom_val(mpg123_handle *fr, off_t frame); /* compute ntom_val for frame offset */
+#ifdef RESAMPLER
+/* The windowed-sinc resampler, also in ntom.c, over the same NtoM sample stepping. */
+int resample_setup(mpg123_handle *fr); /* prepare filter for the NtoM step, or disable it */
+void resample_reset(mpg123_handle *fr); /* clear the sample history */
+void resample_flush(mpg123_handle *fr); /* output the delayed end of a gapless track after its last frame */
+int resample_synth(mpg123_handle *fr, real *bandPtr, int channel); /* native samples into the history */
+int resample_synth_stereo(mpg123_handle *fr, real *bandPtr_l, real *bandPtr_r);
+int resample_block(mpg123_handle *fr, int channel, real *out, unsigned long *ntom);
+real resample_fir       (const real *x, const real *coef, int taps, real frac);
+real resample_fir_x86_64(const real *x, const real *coef, int taps, real frac);
+real resample_fir_avx   (const real *x, const real *coef, int taps, real frac);
+#endif
 /* Frame and sample offsets. */
 #ifndef NO_NTOM
 /*
@@ -272,12 +346,18 @@ int make_conv16to8_table(mpg123_handle *fr);
 
 #ifndef NO_LAYER3
 int do_layer3(mpg123_handle *fr);
+int III_frame_stats(mpg123_handle *fr, struct mpg123_frame_stats *st);
+#ifdef USE_THREADS
+void layer3_pipe_exit(mpg123_handle *fr);
+#endif
 #endif
 #ifndef NO_LAYER2
 int do_layer2(mpg123_handle *fr);
+int II_frame_stats(mpg123_handle *fr, struct mpg123_frame_stats *st);
 #endif
 #ifndef NO_LAYER1
 int do_layer1(mpg123_handle *fr);
+int I_frame_stats(mpg123_handle *fr, struct mpg123_frame_stats *st);
 #endif
 /* There's an 3DNow counterpart in asm. */
 void do_equalizer(real *bandPtr,int channel, real equalizer[2][32]);
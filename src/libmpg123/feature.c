@@ -101,6 +101,13 @@ int mpg123_feature(const enum mpg123_feature_set key)
 		return 0;
 #endif
 
+		case MPG123_FEATURE_THREADS:
+#ifdef USE_THREADS
+		return 1;
+#else
+		return 0;
+#endif
+
 		default: return 0;
 	}
 }
@@ -494,61 +494,63 @@ off_t outblock_bytes(mpg123_handle *fr, off_t s)
 	return s * encsize * fr->af.channels;
 }
 
-#ifndef NO_32BIT
-/* Remove every fourth byte, facilitating conversion from 32 bit to 24 bit integers.
-   This has to be aware of endianness, of course. */
-static void chop_fourth_byte(struct outbuffer *buf)
-{
-	unsigned char *wpos = buf->data;
-	unsigned char *rpos = buf->data;
-#ifdef WORDS_BIGENDIAN
-	while((size_t) (rpos - buf->data + 4) <= buf->fill)
-	{
-		/* Really stupid: Copy, increment. Byte per byte. */
-		*wpos = *rpos;
-		wpos++; rpos++;
-		*wpos = *rpos;
-		wpos++; rpos++;
-		*wpos = *rpos;
-		wpos++; rpos++;
-		rpos++; /* Skip the lowest byte (last). */
-	}
-#else
-	while((size_t) (rpos - buf->data + 4) <= buf->fill)
-	{
-		/* Really stupid: Copy, increment. Byte per byte. */
-		rpos++; /* Skip the lowest byte (first). */
-		*wpos = *rpos;
-		wpos++; rpos++;
-		*wpos = *rpos;
-		wpos++; rpos++;
-		*wpos = *rpos;
-		wpos++; rpos++;
-	}
-#endif
-	buf->fill = wpos-buf->data;
-}
+/*
+	The conversions are plain loops over the samples that the compiler can
+	vectorize. Flipping the sign bit is the same as adding the offset for
+	unsigned output, modulo the type size.
+*/
 
+#ifndef NO_32BIT
 static void conv_s32_to_u32(struct outbuffer *buf)
 {
 	size_t i;
-	int32_t  *ssamples = (int32_t*)  buf->data;
-	uint32_t *usamples = (uint32_t*) buf->data;
+	uint32_t *samples = (uint32_t*) buf->data;
 	size_t count = buf->fill/sizeof(int32_t);
 
 	for(i=0; i<count; ++i)
+		samples[i] ^= (uint32_t)0x80000000UL;
+}
+
+/* Remove every fourth byte, facilitating conversion from 32 bit to 24 bit integers,
+   flipping the sign bit on the way for unsigned output, in one pass.
+   This has to be aware of endianness, of course. */
+static void conv_s32_to_24(struct outbuffer *buf, int to_unsigned)
+{
+	uint32_t flip = to_unsigned ? (uint32_t)0x80000000UL : 0;
+	size_t count = buf->fill/sizeof(int32_t);
+	size_t i = 0;
+#ifndef WORDS_BIGENDIAN
+	/* Four samples to three words. Reading is always ahead of writing. */
+	uint32_t *in  = (uint32_t*) buf->data;
+	uint32_t *out = (uint32_t*) buf->data;
+	for(; i+4<=count; i+=4, in+=4, out+=3)
 	{
-		/* Different strategy since we don't have a larger type at hand.
-			 Also watch out for silly +-1 fun because integer constants are signed in C90! */
-		if(ssamples[i] >= 0)
-		usamples[i] = (uint32_t)ssamples[i] + 2147483647+1;
-		/* The smallest value goes zero. */
-		else if(ssamples[i] == ((int32_t)-2147483647-1))
-		usamples[i] = 0;
-		/* Now -value is in the positive range of signed int ... so it's a possible value at all. */
-		else
-		usamples[i] = (uint32_t)2147483647+1 - (uint32_t)(-ssamples[i]);
+		uint32_t a = (in[0]^flip)>>8;
+		uint32_t b = (in[1]^flip)>>8;
+		uint32_t c = (in[2]^flip)>>8;
+		uint32_t d = (in[3]^flip)>>8;
+		out[0] = a | b<<24;
+		out[1] = b>>8 | c<<16;
+		out[2] = c>>16 | d<<8;
+	}
+#endif
+	for(; i<count; ++i)
+	{
+		uint32_t v = ((uint32_t*)buf->data)[i] ^ flip;
+		unsigned char *wpos = buf->data+3*i;
+#ifdef WORDS_BIGENDIAN
+		/* Skip the lowest byte (last). */
+		wpos[0] = (unsigned char)(v>>24);
+		wpos[1] = (unsigned char)(v>>16);
+		wpos[2] = (unsigned char)(v>>8);
+#else
+		/* Skip the lowest byte (first). */
+		wpos[0] = (unsigned char)(v>>8);
+		wpos[1] = (unsigned char)(v>>16);
+		wpos[2] = (unsigned char)(v>>24);
+#endif
 	}
+	buf->fill = 3*count;
 }
 
 #endif
@@ -565,15 +567,11 @@ static const char *bufsizeerr = "Fatal: Buffer too small for postprocessing!";
 static void conv_s16_to_u16(struct outbuffer *buf)
 {
 	size_t i;
-	int16_t  *ssamples = (int16_t*) buf->data;
-	uint16_t *usamples = (uint16_t*)buf->data;
+	uint16_t *samples = (uint16_t*)buf->data;
 	size_t count = buf->fill/sizeof(int16_t);
 
 	for(i=0; i<count; ++i)
-	{
-		long tmp = (long)ssamples[i]+32768;
-		usamples[i] = (uint16_t)tmp;
-	}
+		samples[i] ^= 0x8000;
 }
 
 #ifndef NO_REAL
@@ -629,6 +627,48 @@ static void conv_s16_to_s32(struct outbuffer *buf)
 #endif
 #endif
 
+/*
+	Interleaved stereo to planar (MPG123_PLANAR) for the setups without a
+	planar synth. The left samples move to the front in place, the right ones
+	go through the scratch buffer and are appended after them.
+*/
+#define PLANAR_SPLIT(type) \
+{ \
+	type *in = (type*)fr->buffer.data; \
+	type *right = (type*)fr->planebuf; \
+	for(i=0; i<count; ++i) \
+	{ \
+		right[i] = in[2*i+1]; \
+		in[i] = in[2*i]; \
+	} \
+}
+
+static void conv_planar(mpg123_handle *fr)
+{
+	size_t i;
+	size_t size  = fr->af.encsize;
+	size_t count = fr->buffer.fill/(2*size);
+
+	if(fr->planebuf_size < count*size)
+	{
+		error1("%s", bufsizeerr);
+		return;
+	}
+	switch(size)
+	{
+		case 1: PLANAR_SPLIT(unsigned char) break;
+		case 2: PLANAR_SPLIT(int16_t) break;
+		case 4: PLANAR_SPLIT(int32_t) break;
+		case 8: PLANAR_SPLIT(double) break;
+		default:
+			for(i=0; i<count; ++i)
+			{
+				memcpy(fr->planebuf+i*size, fr->buffer.data+(2*i+1)*size, size);
+				memmove(fr->buffer.data+i*size, fr->buffer.data+2*i*size, size);
+			}
+	}
+	memcpy(fr->buffer.data+count*size, fr->planebuf, count*size);
+}
 
 void postprocess_buffer(mpg123_handle *fr)
 {
@@ -648,11 +688,10 @@ void postprocess_buffer(mpg123_handle *fr)
 			conv_s32_to_u32(&fr->buffer);
 		break;
 		case MPG123_ENC_UNSIGNED_24:
-			conv_s32_to_u32(&fr->buffer);
-			chop_fourth_byte(&fr->buffer);
+			conv_s32_to_24(&fr->buffer, TRUE);
 		break;
 		case MPG123_ENC_SIGNED_24:
-			chop_fourth_byte(&fr->buffer);
+			conv_s32_to_24(&fr->buffer, FALSE);
 		break;
 		}
 	break;
@@ -679,16 +718,16 @@ void postprocess_buffer(mpg123_handle *fr)
 		break;
 		case MPG123_ENC_UNSIGNED_24:
 			conv_s16_to_s32(&fr->buffer);
-			conv_s32_to_u32(&fr->buffer);
-			chop_fourth_byte(&fr->buffer);
+			conv_s32_to_24(&fr->buffer, TRUE);
 		break;
 		case MPG123_ENC_SIGNED_24:
 			conv_s16_to_s32(&fr->buffer);
-			chop_fourth_byte(&fr->buffer);
+			conv_s32_to_24(&fr->buffer, FALSE);
 		break;
 #endif
 		}
 	break;
 #endif
 	}
+	if(fr->planar && !fr->planar_synth) conv_planar(fr);
 }
@@ -43,6 +43,7 @@ static void frame_default_pars(mpg123_pars *mp)
 	mp->flags |= MPG123_AUTO_RESAMPLE;
 #ifndef NO_NTOM
 	mp->force_rate = 0;
+	mp->resample = MPG123_RESAMPLE_NTOM;
 #endif
 	mp->down_sample = 0;
 	mp->rva = 0;
@@ -58,6 +59,10 @@ static void frame_default_pars(mpg123_pars *mp)
 	mp->index_size = INDEX_SIZE;
 #endif
 	mp->preframes = 4; /* That's good  for layer 3 ISO compliance bitstream. */
+	mp->scan_threads = 1;
+	mp->readahead = 0;
+	mp->feed_wait = 0;
+	mp->bandwidth = 0;
 	mpg123_fmt_all(mp);
 	/* Default of keeping some 4K buffers at hand, should cover the "usual" use case (using 16K pipe buffers as role model). */
 #ifndef NO_FEEDER
@@ -80,15 +85,57 @@ void frame_init_par(mpg123_handle *fr, mpg123_pars *mp)
 	fr->buffer.size = 0;
 	fr->rawbuffs = NULL;
 	fr->rawbuffss = 0;
-	fr->rawdecwin = NULL;
-	fr->rawdecwins = 0;
+	fr->planar = fr->planar_synth = 0;
+	fr->planebuf = NULL;
+	fr->planebuf_size = 0;
+	fr->tap = NULL;
+	fr->tap_handle = NULL;
+	fr->tap_kinds = 0;
+	fr->tapbuf = NULL;
+	fr->loudness = NULL;
+#ifdef RESAMPLER
+	fr->rs_taps = 0;
+	fr->rs_tail = 0;
+	fr->rs_buffer = NULL;
+	fr->rs_buffer_size = 0;
+#endif
+	fr->decwin_table = NULL;
+	fr->layer_table = NULL;
+	fr->decwin = NULL;
+#ifdef OPT_MMXORSSE
+	fr->decwin_mmx = NULL;
+	fr->decwins = NULL;
+#endif
+	fr->gainpow2 = NULL;
+	fr->muls = NULL;
+	fr->longLimit = NULL;
+	fr->shortLimit = NULL;
+	fr->bsspace = NULL;
+	fr->bsbuf = fr->bsbufold = NULL;
+	fr->bsinplace = 0;
 #ifndef NO_8BIT
 	fr->conv16to8_buf = NULL;
 #endif
 #ifdef OPT_DITHER
 	fr->dithernoise = NULL;
 #endif
-	fr->layerscratch = NULL;
+	fr->layerscratch[0] = fr->layerscratch[1] = fr->layerscratch[2] = NULL;
+#ifndef NO_LAYER1
+	fr->layer1.fraction = NULL;
+	fr->layer1.samples = NULL;
+#endif
+#ifndef NO_LAYER2
+	fr->layer2.fraction = NULL;
+	fr->layer2.samples = NULL;
+#endif
+#ifndef NO_LAYER3
+	fr->layer3.hybrid_in = NULL;
+	fr->layer3.hybrid_out = NULL;
+	fr->layer3.hybrid_block = NULL;
+#ifdef USE_THREADS
+	fr->layer3.pipe = NULL;
+#endif
+#endif
 	fr->xing_toc = NULL;
 	fr->cpu_opts.type = defdec();
 	fr->cpu_opts.class = decclass(fr->cpu_opts.type);
@@ -112,6 +159,10 @@ void frame_init_par(mpg123_handle *fr, mpg123_pars *mp)
 	fr->rdat.r_read_handle = NULL;
 	fr->rdat.r_lseek_handle = NULL;
 	fr->rdat.cleanup_handle = NULL;
+	fr->rdat.filename = NULL;
+	fr->rdat.ahead = NULL;
+	fr->rdat.memdata = NULL;
+	fr->rdat.memsize = 0;
 	fr->wrapperdata = NULL;
 	fr->wrapperclean = NULL;
 	fr->decoder_change = 1;
@@ -131,6 +182,8 @@ void frame_init_par(mpg123_handle *fr, mpg123_pars *mp)
 #ifdef FRAME_INDEX
 	fi_init(&fr->index);
 	frame_index_setup(fr); /* Apply the size setting. */
+	fr->index_cache_dir = NULL;
+	fr->cached = NULL;
 #endif
 }
 
@@ -210,6 +263,62 @@ int frame_outbuffer(mpg123_handle *fr)
 	return MPG123_OK;
 }
 
+/* Room for the right channel while moving the left one to the front, see conv_planar(). */
+int frame_planebuf(mpg123_handle *fr)
+{
+	size_t size = fr->outblock/2;
+	if(fr->planebuf != NULL && fr->planebuf_size >= size) return 0;
+
+	if(fr->planebuf != NULL) free(fr->planebuf);
+	fr->planebuf_size = 0;
+	fr->planebuf = malloc(size);
+	if(fr->planebuf == NULL) return -1;
+
+	fr->planebuf_size = size;
+	return 0;
+}
+
+int attribute_align_arg mpg123_tap(mpg123_handle *mh, int kinds, void (*tap)(void *handle, const struct mpg123_tap_data *data), void *handle)
+{
+	if(mh == NULL) return MPG123_BAD_HANDLE;
+	if(tap == NULL) kinds = 0;
+	if(kinds & ~(MPG123_TAP_SUBBANDS|MPG123_TAP_SPECTRUM))
+	{
+		mh->err = MPG123_BAD_VALUE;
+		return MPG123_ERR;
+	}
+#ifndef REAL_IS_FLOAT
+	/* The most at once: a Layer II frame of subband samples. */
+	if(kinds && mh->tapbuf == NULL && (mh->tapbuf = malloc(3*SCALE_BLOCK*SBLIMIT*sizeof(float))) == NULL)
+	{
+		mh->err = MPG123_OUT_OF_MEM;
+		return MPG123_ERR;
+	}
+#endif
+	mh->tap = tap;
+	mh->tap_handle = handle;
+	mh->tap_kinds = kinds;
+	return MPG123_OK;
+}
+
+/* Hand a block to the tap, unless the frame is only decoded to be discarded. */
+void frame_tap(mpg123_handle *fr, struct mpg123_tap_data *td, const real *data, size_t count)
+{
+	if(fr->num < fr->firstframe) return;
+#ifdef REAL_IS_FLOAT
+	td->data = data;
+#else
+	{
+		size_t i;
+		for(i=0; i<count; ++i)
+		fr->tapbuf[i] = (float)REAL_TO_DOUBLE(data[i]);
+		td->data = fr->tapbuf;
+	}
+#endif
+	td->count = count;
+	fr->tap(fr->tap_handle, td);
+}
+
 int attribute_align_arg mpg123_replace_buffer(mpg123_handle *mh, unsigned char *data, size_t size)
 {
 	debug2("replace buffer with %p size %"SIZE_P, data, (size_p)size);
@@ -233,17 +342,24 @@ int attribute_align_arg mpg123_replace_buffer(mpg123_handle *mh, unsigned char *
 int frame_index_setup(mpg123_handle *fr)
 {
 	int ret = MPG123_ERR;
-	if(fr->p.index_size >= 0)
+	if(fr->p.flags & MPG123_COMPACT_INDEX)
+	{ /* All frames, as long as memory lasts. */
+		ret = fi_compact(&fr->index, 1, 0);
+		debug1("compact index with fill %lu", (unsigned long)fr->index.fill);
+	}
+	else if(fr->p.index_size >= 0)
 	{ /* Simple fixed index. */
 		fr->index.grow_size = 0;
 		debug1("resizing index to %li", fr->p.index_size);
-		ret = fi_resize(&fr->index, (size_t)fr->p.index_size);
+		ret = fi_compact(&fr->index, 0, (size_t)fr->p.index_size);
 		debug2("index resized... %lu at %p", (unsigned long)fr->index.size, (void*)fr->index.data);
 	}
 	else
 	{ /* A growing index. We give it a start, though. */
 		fr->index.grow_size = (size_t)(- fr->p.index_size);
-		if(fr->index.size < fr->index.grow_size)
+		if(fr->index.compact)
+		ret = fi_compact(&fr->index, 0, fr->index.grow_size);
+		else if(fr->index.size < fr->index.grow_size)
 		ret = fi_resize(&fr->index, fr->index.grow_size);
 		else
 		ret = MPG123_OK; /* We have minimal size already... and since growing is OK... */
@@ -324,111 +440,92 @@ int frame_buffers(mpg123_handle *fr)
 		fr->areal_buffs[i][j] = fr->areal_buffs[0][0] + (i*4+j)*0x110;
 	}
 #endif
-	/* now the different decwins... all of the same size, actually */
-	/* The MMX ones want 32byte alignment, which I'll try to ensure manually */
-	{
-		int decwin_size = (512+32)*sizeof(real);
-#ifdef OPT_MMXORSSE
-#ifdef OPT_MULTI
-		if(fr->cpu_opts.class == mmxsse)
-		{
-#endif
-			/* decwin_mmx will share, decwins will be appended ... sizeof(float)==4 */
-			if(decwin_size < (512+32)*4) decwin_size = (512+32)*4;
-
-			/* the second window + alignment zone -- we align for 32 bytes for SSE as
-			   requirement, 64 byte for matching cache line size (that matters!) */
-			decwin_size += (512+32)*4 + 63;
-			/* (512+32)*4/32 == 2176/32 == 68, so one decwin block retains alignment for 32 or 64 bytes */
-#ifdef OPT_MULTI
-		}
-#endif
-#endif
-#if defined(OPT_ALTIVEC) || defined(OPT_ARM) 
-		/* sizeof(real) >= 4 ... yes, it could be 8, for example.
-		   We got it intialized to at least (512+32)*sizeof(real).*/
-		decwin_size += 512*sizeof(real);
-#endif
-		/* Hm, that's basically realloc() ... */
-		if(fr->rawdecwin != NULL && fr->rawdecwins != decwin_size)
-		{
-			free(fr->rawdecwin);
-			fr->rawdecwin = NULL;
-		}
-
-		if(fr->rawdecwin == NULL)
-		fr->rawdecwin = (unsigned char*) malloc(decwin_size);
-
-		if(fr->rawdecwin == NULL) return -1;
+	/* Only reset the buffers we created just now. */
+	frame_decode_buffers_reset(fr);
 
-		fr->rawdecwins = decwin_size;
-		fr->decwin = (real*) fr->rawdecwin;
-#ifdef OPT_MMXORSSE
-#ifdef OPT_MULTI
-		if(fr->cpu_opts.class == mmxsse)
-		{
-#endif
-			/* align decwin, assign that to decwin_mmx, append decwins */
-			/* I need to add to decwin what is missing to the next full 64 byte -- also I want to make gcc -pedantic happy... */
-			fr->decwin = aligned_pointer(fr->rawdecwin,real,64);
-			debug1("aligned decwin: %p", (void*)fr->decwin);
-			fr->decwin_mmx = (float*)fr->decwin;
-			fr->decwins = fr->decwin_mmx+512+32;
-#ifdef OPT_MULTI
-		}
-		else debug("no decwins/decwin_mmx for that class");
-#endif
-#endif
-	}
+	debug1("frame %p buffer done", (void*)fr);
+	return 0;
+}
 
-	/* Layer scratch buffers are of compile-time fixed size, so allocate only once. */
-	if(fr->layerscratch == NULL)
+/* Get aligned part of the memory of given size, allocating it if needed. */
+static real *layer_scratch(mpg123_handle *fr, int lay, size_t size)
+{
+	if(fr->layerscratch[lay-1] == NULL)
 	{
-		/* Allocate specific layer1/2/3 buffers, so that we know they'll work for SSE. */
-		size_t scratchsize = 0;
-		real *scratcher;
-#ifndef NO_LAYER1
-		scratchsize += sizeof(real) * 2 * SBLIMIT;
-#endif
-#ifndef NO_LAYER2
-		scratchsize += sizeof(real) * 2 * 4 * SBLIMIT;
-#endif
-#ifndef NO_LAYER3
-		scratchsize += sizeof(real) * 2 * SBLIMIT * SSLIMIT; /* hybrid_in */
-		scratchsize += sizeof(real) * 2 * SSLIMIT * SBLIMIT; /* hybrid_out */
-#endif
 		/*
-			Now figure out correct alignment:
 			We need 16 byte minimum, smallest unit of the blocks is 2*SBLIMIT*sizeof(real), which is 64*4=256. Let's do 64bytes as heuristic for cache line (as proven useful in buffs above).
 		*/
-		fr->layerscratch = malloc(scratchsize+63);
-		if(fr->layerscratch == NULL) return -1;
+		fr->layerscratch[lay-1] = malloc(size+63);
+		if(fr->layerscratch[lay-1] == NULL) return NULL;
+		memset(fr->layerscratch[lay-1], 0, size+63);
+	}
+	return aligned_pointer(fr->layerscratch[lay-1],real,64);
+}
+
+/*
+	The bitstream buffer and the specific layer1/2/3 buffers (aligned for SSE) are only
+	allocated for the first frame that needs them. A handle that never decodes anything
+	or only ever sees Layer III does not carry the memory for the others around.
+	Those funky pointer casts silence compilers...
+	One might change the code at hand to really just use 1D arrays, but in practice, that would not make a (positive) difference.
+*/
+int frame_layer_buffers(mpg123_handle *fr)
+{
+	real *scratcher;
 
-		/* Get aligned part of the memory, then divide it up. */
-		scratcher = aligned_pointer(fr->layerscratch,real,64);
-		/* Those funky pointer casts silence compilers...
-		   One might change the code at hand to really just use 1D arrays, but in practice, that would not make a (positive) difference. */
+	if(fr->bsspace == NULL)
+	{
+		fr->bsspace = malloc(2*sizeof(*fr->bsspace));
+		if(fr->bsspace == NULL) return -1;
+		memset(fr->bsspace, 0, 2*sizeof(*fr->bsspace));
+		fr->bsbuf = fr->bsspace[1];
+		fr->bsbufold = fr->bsbuf;
+		fr->bsinplace = 0;
+	}
+	switch(fr->lay)
+	{
 #ifndef NO_LAYER1
-		fr->layer1.fraction = (real(*)[SBLIMIT])scratcher;
-		scratcher += 2 * SBLIMIT;
+		case 1:
+			if(fr->layer1.fraction != NULL) break;
+			scratcher = layer_scratch( fr, 1
+			,	sizeof(real) * 2 * SCALE_BLOCK * SBLIMIT
+			+	sizeof(int)  * 2 * SCALE_BLOCK * SBLIMIT );
+			if(scratcher == NULL) return -1;
+			fr->layer1.fraction = (real(*)[SCALE_BLOCK][SBLIMIT])scratcher;
+			scratcher += 2 * SCALE_BLOCK * SBLIMIT;
+			fr->layer1.samples = (int(*)[SCALE_BLOCK][SBLIMIT])scratcher;
+		break;
 #endif
 #ifndef NO_LAYER2
-		fr->layer2.fraction = (real(*)[4][SBLIMIT])scratcher;
-		scratcher += 2 * 4 * SBLIMIT;
+		case 2:
+			if(fr->layer2.fraction != NULL) break;
+			scratcher = layer_scratch( fr, 2
+			,	sizeof(real) * 2 * 3 * SCALE_BLOCK * SBLIMIT
+			+	sizeof(int)  * 2 * 3 * SCALE_BLOCK * SBLIMIT );
+			if(scratcher == NULL) return -1;
+			fr->layer2.fraction = (real(*)[3*SCALE_BLOCK][SBLIMIT])scratcher;
+			scratcher += 2 * 3 * SCALE_BLOCK * SBLIMIT;
+			fr->layer2.samples = (int(*)[3*SCALE_BLOCK][SBLIMIT])scratcher;
+		break;
 #endif
 #ifndef NO_LAYER3
-		fr->layer3.hybrid_in = (real(*)[SBLIMIT][SSLIMIT])scratcher;
-		scratcher += 2 * SBLIMIT * SSLIMIT;
-		fr->layer3.hybrid_out = (real(*)[SSLIMIT][SBLIMIT])scratcher;
-		scratcher += 2 * SSLIMIT * SBLIMIT;
+		case 3:
+			if(fr->layer3.hybrid_in != NULL) break;
+			scratcher = layer_scratch( fr, 3
+			,	sizeof(real) * 2 * SBLIMIT * SSLIMIT /* hybrid_in */
+			+	sizeof(real) * 2 * SSLIMIT * SBLIMIT /* hybrid_out */
+			+	sizeof(real) * 2 * 2 * SBLIMIT * SSLIMIT /* hybrid_block */ );
+			if(scratcher == NULL) return -1;
+			fr->layer3.hybrid_in = (real(*)[SBLIMIT][SSLIMIT])scratcher;
+			scratcher += 2 * SBLIMIT * SSLIMIT;
+			fr->layer3.hybrid_out = (real(*)[SSLIMIT][SBLIMIT])scratcher;
+			scratcher += 2 * SSLIMIT * SBLIMIT;
+			/* That one is decoder state, starting out zeroed. */
+			fr->layer3.hybrid_block = (real(*)[2][SBLIMIT*SSLIMIT])scratcher;
+			fr->hybrid_blc[0] = fr->hybrid_blc[1] = 0;
+		break;
 #endif
-		/* Note: These buffers don't need resetting here. */
 	}
-
-	/* Only reset the buffers we created just now. */
-	frame_decode_buffers_reset(fr);
-
-	debug1("frame %p buffer done", (void*)fr);
 	return 0;
 }
 
@@ -437,14 +534,24 @@ int frame_buffers_reset(mpg123_handle *fr)
 	fr->buffer.fill = 0; /* hm, reset buffer fill... did we do a flush? */
 	fr->bsnum = 0;
 	/* Wondering: could it be actually _wanted_ to retain buffer contents over different files? (special gapless / cut stuff) */
-	fr->bsbuf = fr->bsspace[1];
-	fr->bsbufold = fr->bsbuf;
 	fr->bitreservoir = 0;
 	frame_decode_buffers_reset(fr);
-	memset(fr->bsspace, 0, 2*(MAXFRAMESIZE+512));
+	if(fr->bsspace != NULL)
+	{
+		fr->bsbuf = fr->bsspace[1];
+		memset(fr->bsspace, 0, 2*sizeof(*fr->bsspace));
+	}
+	fr->bsbufold = fr->bsbuf;
+	fr->bsinplace = 0;
 	memset(fr->ssave, 0, 34);
 	fr->hybrid_blc[0] = fr->hybrid_blc[1] = 0;
-	memset(fr->hybrid_block, 0, sizeof(real)*2*2*SBLIMIT*SSLIMIT);
+#ifndef NO_LAYER3
+	if(fr->layer3.hybrid_block != NULL)
+	memset(fr->layer3.hybrid_block, 0, sizeof(real)*2*2*SBLIMIT*SSLIMIT);
+#endif
+#ifdef RESAMPLER
+	resample_reset(fr);
+#endif
 	return 0;
 }
 
@@ -493,6 +600,7 @@ int frame_reset(mpg123_handle* fr)
 #ifdef FRAME_INDEX
 	fi_reset(&fr->index);
 #endif
+	loudness_reset(fr);
 
 	return 0;
 }
@@ -533,6 +641,7 @@ static void frame_fixed_reset(mpg123_handle *fr)
 	fr->fsizeold = 0;
 	fr->firstframe = 0;
 	fr->ignoreframe = fr->firstframe-fr->p.preframes;
+	fr->seekframe = fr->ignoreframe;
 	fr->header_change = 0;
 	fr->lastframe = -1;
 	fr->fresh = 1;
@@ -563,17 +672,31 @@ static void frame_fixed_reset(mpg123_handle *fr)
 
 static void frame_free_buffers(mpg123_handle *fr)
 {
+	int i;
 	if(fr->rawbuffs != NULL) free(fr->rawbuffs);
 	fr->rawbuffs = NULL;
 	fr->rawbuffss = 0;
-	if(fr->rawdecwin != NULL) free(fr->rawdecwin);
-	fr->rawdecwin = NULL;
-	fr->rawdecwins = 0;
+	tabcache_release(fr);
 #ifndef NO_8BIT
 	if(fr->conv16to8_buf != NULL) free(fr->conv16to8_buf);
 	fr->conv16to8_buf = NULL;
 #endif
-	if(fr->layerscratch != NULL) free(fr->layerscratch);
+	if(fr->planebuf != NULL) free(fr->planebuf);
+	fr->planebuf = NULL;
+	fr->planebuf_size = 0;
+#ifdef RESAMPLER
+	if(fr->rs_buffer != NULL) free(fr->rs_buffer);
+	fr->rs_buffer = NULL;
+	fr->rs_buffer_size = 0;
+	fr->rs_taps = 0;
+#endif
+	for(i=0; i<3; ++i)
+	{
+		if(fr->layerscratch[i] != NULL) free(fr->layerscratch[i]);
+		fr->layerscratch[i] = NULL;
+	}
+	if(fr->bsspace != NULL) free(fr->bsspace);
+	fr->bsspace = NULL;
 }
 
 void frame_exit(mpg123_handle *fr)
@@ -584,10 +707,19 @@ void frame_exit(mpg123_handle *fr)
 		free(fr->buffer.rdata);
 	}
 	fr->buffer.rdata = NULL;
+#if !defined(NO_LAYER3) && defined(USE_THREADS)
+	layer3_pipe_exit(fr);
+#endif
 	frame_free_buffers(fr);
 	frame_free_toc(fr);
 #ifdef FRAME_INDEX
 	fi_exit(&fr->index);
+	index_cache_free(fr);
+	if(fr->index_cache_dir != NULL)
+	{
+		free(fr->index_cache_dir);
+		fr->index_cache_dir = NULL;
+	}
 #endif
 #ifdef OPT_DITHER
 	if(fr->dithernoise != NULL)
@@ -596,6 +728,12 @@ void frame_exit(mpg123_handle *fr)
 		fr->dithernoise = NULL;
 	}
 #endif
+	if(fr->tapbuf != NULL)
+	{
+		free(fr->tapbuf);
+		fr->tapbuf = NULL;
+	}
+	loudness_exit(fr);
 	exit_id3(fr);
 	clear_icy(&fr->icy);
 	/* Clean up possible mess from LFS wrapper. */
@@ -704,7 +842,7 @@ off_t frame_index_find(mpg123_handle *fr, off_t want_frame, off_t* get_frame)
 		}
 		/* We have index position, that yields frame and byte offsets. */
 		*get_frame = fi*fr->index.step;
-		gopos = fr->index.data[fi];
+		gopos = fi_get(&fr->index, fi);
 		fr->state_flags |= FRAME_ACCURATE; /* When using the frame index, we are accurate. */
 	}
 	else
@@ -830,6 +968,22 @@ void frame_gapless_realinit(mpg123_handle *fr)
 	if(fr->gapless_frames > 0)
 	fr->fullend_os = frame_ins2outs(fr, fr->gapless_frames*fr->spf);
 	else fr->fullend_os = 0;
+#ifdef RESAMPLER
+	/* The windowed-sinc resampler output lags behind the input.
+	   Shift the window by that, but keep the length of the NtoM one.
+	   An end beyond fullend_os then comes from flushing the filter after
+	   the last frame (resample_flush()). If it is further out than the
+	   shift, the padding was shorter than the decoder delay to begin with. */
+	fr->rs_tail = 0;
+	if(fr->gapless_frames > 0 && fr->down_sample == 3 && fr->rs_taps > 0)
+	{
+		off_t shift = frame_ins2outs(fr, fr->begin_s+fr->rs_taps/2-1) - fr->begin_os;
+		fr->begin_os += shift;
+		fr->end_os   += shift;
+		if(fr->end_os - fr->fullend_os > shift) fr->end_os = fr->fullend_os;
+		else if(fr->end_os > fr->fullend_os) fr->rs_tail = (int)(fr->end_os - fr->fullend_os);
+	}
+#endif
 
 	debug4("frame_gapless_realinit: from %"OFF_P" to %"OFF_P" samples (%"OFF_P", %"OFF_P")", (off_p)fr->begin_os, (off_p)fr->end_os, (off_p)fr->fullend_os, (off_p)fr->gapless_frames);
 }
@@ -868,6 +1022,45 @@ static off_t ignoreframe(mpg123_handle *fr)
 	return fr->firstframe - preshift;
 }
 
+/*
+	Set the frames to start from for firstframe: ignoreframe is the first one
+	to decode, seekframe the first one to read. With the index knowing how far
+	back the Layer III main data reaches, the frames before ignoreframe are
+	only read into the bit reservoir. Decoded ones need to provide the IMDCT
+	overlap and the 16 blocks of synth history, from a granule that had its
+	own overlap already: one frame with two granules, two frames with one
+	granule (MPEG 2/2.5). The preframes still count on top of that, as a
+	damaged frame that fails to decode leaves the state of the ones before it
+	to the next. Without known reach, the preframes are all there is.
+*/
+static void frame_preroll(mpg123_handle *fr)
+{
+	fr->ignoreframe = ignoreframe(fr);
+	fr->seekframe = fr->ignoreframe;
+#if defined(FRAME_INDEX) && !defined(NO_LAYER3)
+	if(fr->lay == 3 && fr->firstframe > 0)
+	{
+		off_t decode = fr->lsf ? 2 : 1;
+		off_t first = fr->firstframe-decode;
+		off_t last;
+		int reach;
+		if(fr->ignoreframe < first) first = fr->ignoreframe;
+		if(first < 0) first = 0;
+		/* Every frame decoded from first on needs its main data, also the
+		   ones after firstframe reaching back past it. */
+		last = first + FI_PAYLOADS - 1;
+		if(fr->track_frames > 0 && last >= fr->track_frames)
+		last = fr->track_frames > first ? fr->track_frames-1 : first;
+		reach = fi_reach(&fr->index, first, last);
+		if(reach >= 0)
+		{
+			fr->ignoreframe = first;
+			fr->seekframe = first-reach;
+		}
+	}
+#endif
+}
+
 /* The frame seek... This is not simply the seek to fe*fr->spf samples in output because we think of _input_ frames here.
    Seek to frame offset 1 may be just seek to 200 samples offset in output since the beginning of first frame is delay/padding.
    Hm, is that right? OK for the padding stuff, but actually, should the decoder delay be better totally hidden or not?
@@ -894,21 +1087,28 @@ void frame_set_frameseek(mpg123_handle *fr, off_t fe)
 		} else {fr->lastframe = -1; fr->lastoff = 0; }
 	} else { fr->firstoff = fr->lastoff = 0; fr->lastframe = -1; }
 #endif
-	fr->ignoreframe = ignoreframe(fr);
+	frame_preroll(fr);
 #ifdef GAPLESS
-	debug5("frame_set_frameseek: begin at %li frames and %li samples, end at %li and %li; ignore from %li",
+	debug6("frame_set_frameseek: begin at %li frames and %li samples, end at %li and %li; ignore from %li, read from %li",
 	       (long) fr->firstframe, (long) fr->firstoff,
-	       (long) fr->lastframe,  (long) fr->lastoff, (long) fr->ignoreframe);
+	       (long) fr->lastframe,  (long) fr->lastoff, (long) fr->ignoreframe, (long) fr->seekframe);
 #else
-	debug3("frame_set_frameseek: begin at %li frames, end at %li; ignore from %li",
-	       (long) fr->firstframe, (long) fr->lastframe, (long) fr->ignoreframe);
+	debug4("frame_set_frameseek: begin at %li frames, end at %li; ignore from %li, read from %li",
+	       (long) fr->firstframe, (long) fr->lastframe, (long) fr->ignoreframe, (long) fr->seekframe);
 #endif
 }
 
 void frame_skip(mpg123_handle *fr)
 {
 #ifndef NO_LAYER3
-	if(fr->lay == 3) set_pointer(fr, 512);
+	if(fr->lay == 3)
+	{
+		set_pointer(fr, 512);
+		/* The main data stays there for the following frames, as after decoding. */
+		fr->bitreservoir += fr->framesize - fr->ssize - (fr->error_protection ? 2 : 0);
+		if(fr->bitreservoir > (unsigned int) (fr->lsf == 0 ? 511 : 255))
+		fr->bitreservoir = (fr->lsf == 0 ? 511 : 255);
+	}
 #endif
 }
 
@@ -921,7 +1121,7 @@ void frame_set_seek(mpg123_handle *fr, off_t sp)
 #ifndef NO_NTOM
 	if(fr->down_sample == 3) ntom_set_ntom(fr, fr->firstframe);
 #endif
-	fr->ignoreframe = ignoreframe(fr);
+	frame_preroll(fr);
 #ifdef GAPLESS /* The sample offset is used for non-gapless mode, too! */
 	fr->firstoff = sp - frame_outs(fr, fr->firstframe);
 	debug5("frame_set_seek: begin at %li frames and %li samples, end at %li and %li; ignore from %li",
@@ -999,7 +1199,11 @@ void do_rva(mpg123_handle *fr)
 		debug3("changing scale value from %f to %f (peak estimated to %f)", fr->lastscale != -1 ? fr->lastscale : fr->p.outscale, newscale, (double) (newscale*peak));
 		fr->lastscale = newscale;
 		/* It may be too early, actually. */
-		if(fr->make_decode_tables != NULL) fr->make_decode_tables(fr); /* the actual work */
+		/* The actual work, or just picking up a table that is there already. */
+		if(fr->make_decode_tables != NULL && tabcache_decwin(fr) != 0)
+		{
+			if(NOQUIET) error("failed to set up decode table for new scale");
+		}
 	}
 }
 
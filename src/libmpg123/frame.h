@@ -28,6 +28,8 @@ int frame_dither_init(mpg123_handle *fr);
 
 /* max = 1728 */
 #define MAXFRAMESIZE 3456
+/* Slack after the bitstream buffers, getbits.h reads whole 64 bit words. */
+#define BSBUF_PAD 8
 
 struct al_table
 {
@@ -63,6 +65,7 @@ struct mpg123_pars_struct
 	long flags; /* combination of above */
 #ifndef NO_NTOM
 	long force_rate;
+	int resample; /* enum mpg123_resample_quality */
 #endif
 	int down_sample;
 	int rva; /* (which) rva to do: 0: nothing, 1: radio/mix/track 2: album/audiophile */
@@ -80,6 +83,10 @@ struct mpg123_pars_struct
 	long resync_limit;
 	long index_size; /* Long, because: negative values have a meaning. */
 	long preframes;
+	long scan_threads;
+	long readahead; /* bytes, 0 for none */
+	long feed_wait; /* milliseconds, <0 for no limit */
+	long bandwidth; /* Hz, 0 for all */
 #ifndef NO_FEEDER
 	long feedpool;
 	long feedbuffer;
@@ -91,6 +98,7 @@ enum frame_state_flags
 	 FRAME_ACCURATE      = 0x1  /**<     0001 Positions are considered accurate. */
 	,FRAME_FRANKENSTEIN  = 0x2  /**<     0010 This stream is concatenated. */
 	,FRAME_FRESH_DECODER = 0x4  /**<     0100 Decoder is fleshly initialized. */
+	,FRAME_SCANNED       = 0x8  /**<     1000 Length and index are exact, from scan or index cache. */
 };
 
 /* There is a lot to condense here... many ints can be merged as flags; though the main space is still consumed by buffers. */
@@ -98,7 +106,6 @@ struct mpg123_handle_struct
 {
 	int fresh; /* to be moved into flags */
 	int new_format;
-	real hybrid_block[2][2][SBLIMIT*SSLIMIT];
 	int hybrid_blc[2];
 	/* the scratch vars for the decoders, sometimes real, sometimes short... sometimes int/long */ 
 	short *short_buffs[2][2];
@@ -113,8 +120,7 @@ struct mpg123_handle_struct
 	int ditherindex;
 	float *dithernoise;
 #endif
-	unsigned char* rawdecwin; /* the block with all decwins */
-	int rawdecwins; /* size of rawdecwin memory */
+	struct tabcache_entry *decwin_table; /* shared memory of all decwins, see tabcache.h */
 	real *decwin; /* _the_ decode table */
 #ifdef OPT_MMXORSSE
 	/* I am not really sure that I need both of them... used in assembler */
@@ -132,20 +138,30 @@ struct mpg123_handle_struct
 	unsigned char *conv16to8_buf;
 	unsigned char *conv16to8;
 #endif
-	/* There's some possible memory saving for stuff that is not _really_ dynamic. */
-
+	/* Tables that are not _really_ dynamic, shared with other handles (tabcache.h). */
+	struct tabcache_entry *layer_table;
 	/* layer3 */
-	int longLimit[9][23];
-	int shortLimit[9][14];
-	real gainpow2[256+118+4]; /* not really dynamic, just different for mmx */
+	int (*longLimit)[23];  /* int longLimit[9][23]; */
+	int (*shortLimit)[14]; /* int shortLimit[9][14]; */
+	real *gainpow2; /* real gainpow2[256+118+4]; not really dynamic, just different for mmx */
 
 	/* layer2 */
-	real muls[27][64];	/* also used by layer 1 */
+	real (*muls)[64]; /* real muls[27][64]; also used by layer 1 */
 
 #ifndef NO_NTOM
 	/* decode_ntom */
 	unsigned long ntom_val[2];
 	unsigned long ntom_step;
+#ifdef RESAMPLER
+	/* Windowed-sinc filter on the native rate samples, used instead of the NtoM synth when rs_taps > 0. */
+	int rs_taps;   /* filter length, multiple of 16 */
+	int rs_phases; /* fractional positions in the table, there is one more row for interpolation */
+	int rs_tail; /* output samples of the gapless track after fullend_os, from flushing the filter */
+	real *rs_coef; /* rows of taps coefficients, each followed by the difference to the next row */
+	real *rs_hist[2]; /* per channel: taps-1 older samples, then the current synth block */
+	void *rs_buffer; /* memory for the above */
+	size_t rs_buffer_size;
+#endif
 #endif
 	/* special i486 fun */
 #ifdef OPT_I486
@@ -164,6 +180,22 @@ struct mpg123_handle_struct
 #if (defined OPT_3DNOW_VINTAGE || defined OPT_3DNOWEXT_VINTAGE || defined OPT_SSE || defined OPT_X86_64 || defined OPT_AVX || defined OPT_NEON || defined OPT_NEON64)
 		void (*the_dct36)(real *,real *,real *,real *,real *);
 #endif
+#if (defined OPT_X86_64 || defined OPT_AVX)
+		void (*the_dct12)(real *,real *,real *,real *,real *);
+		void (*the_antialias)(real *, int);
+		void (*the_stereo_ms)(real *, real *, int);
+		void (*the_hybrid_tail)(real *, real *, real *, int);
+#endif
+#endif
+#ifndef NO_LAYER12
+#if (defined OPT_X86_64 || defined OPT_AVX)
+		void (*the_dequant12)(real *, const int *, const real *, int);
+#endif
+#endif
+#ifdef RESAMPLER
+#if (defined OPT_X86_64 || defined OPT_AVX)
+		real (*the_resample_fir)(const real *, const real *, int, real);
+#endif
 #endif
 
 #endif
@@ -225,7 +257,6 @@ struct mpg123_handle_struct
 	int bitindex;
 	unsigned char *wordpointer;
 	/* temporary storage for getbits stuff */
-	unsigned long ultmp;
 	unsigned char uctmp;
 
 	/* rva data, used in common.c, set in id3.c */
@@ -247,10 +278,11 @@ struct mpg123_handle_struct
 	int fsizeold;
 	int ssize;
 	unsigned int bitreservoir;
-	unsigned char bsspace[2][MAXFRAMESIZE+512]; /* MAXFRAMESIZE */
+	unsigned char (*bsspace)[MAXFRAMESIZE+512+BSBUF_PAD]; /* [2][MAXFRAMESIZE+512+BSBUF_PAD], allocated with the first frame */
 	unsigned char *bsbuf;
 	unsigned char *bsbufold;
 	int bsnum;
+	int bsinplace; /* bsbuf points into the input data, not bsspace */
 	/* That is the header matching the last read frame body. */
 	unsigned long oldhead;
 	/* That is the header that is supposedly the first of the stream. */
@@ -258,6 +290,8 @@ struct mpg123_handle_struct
 	int abr_rate;
 #ifdef FRAME_INDEX
 	struct frame_index index;
+	char *index_cache_dir; /* where to look for and store index cache files, or NULL */
+	struct index_cache *cached; /* loaded index cache, waiting for the first frame to check against */
 #endif
 
 	/* output data */
@@ -265,11 +299,22 @@ struct mpg123_handle_struct
 	struct audioformat af;
 	int own_buffer;
 	size_t outblock; /* number of bytes that this frame produces (upper bound) */
+	int planar;       /* stereo output as all left samples, then all right ones (MPG123_PLANAR) */
+	int planar_synth; /* the synth writes it that way, no rearranging needed */
+	unsigned char *planebuf; /* scratch for rearranging interleaved output */
+	size_t planebuf_size;
+	/* mpg123_tap() */
+	void (*tap)(void *, const struct mpg123_tap_data *);
+	void *tap_handle;
+	int tap_kinds; /* zero without tap */
+	float *tapbuf; /* conversion to float, where real is something else */
+	struct loudness_meter *loudness; /* MPG123_LOUDNESS, allocated with the first output */
 	int to_decode;   /* this frame holds data to be decoded */
 	int to_ignore;   /* the same, somehow */
 	off_t firstframe;  /* start decoding from here */
 	off_t lastframe;   /* last frame to decode (for gapless or num_frames limit) */
 	off_t ignoreframe; /* frames to decode but discard before firstframe */
+	off_t seekframe;   /* frames to read (Layer III bit reservoir) before ignoreframe */
 #ifdef GAPLESS
 	off_t gapless_frames; /* frame count for the gapless part */
 	off_t firstoff; /* number of samples to ignore from firstframe */
@@ -304,19 +349,21 @@ struct mpg123_handle_struct
 	*/
 	/*
 		Those layer-specific structs could actually share memory, as they are not in use simultaneously. One might allocate on decoder switch, too.
-		They all reside in one lump of memory (after each other), allocated to layerscratch.
+		Each layer has its own lump of memory, allocated to layerscratch[lay-1] when a frame of that layer is first seen (frame_layer_buffers()).
 	*/
-	real *layerscratch;
+	real *layerscratch[3];
 #ifndef NO_LAYER1
 	struct
 	{
-		real (*fraction)[SBLIMIT]; /* ALIGNED(16) real fraction[2][SBLIMIT]; */
+		real (*fraction)[SCALE_BLOCK][SBLIMIT]; /* ALIGNED(16) real fraction[2][SCALE_BLOCK][SBLIMIT], the whole frame */
+		int (*samples)[SCALE_BLOCK][SBLIMIT]; /* int samples[2][SCALE_BLOCK][SBLIMIT], before dequantization */
 	} layer1;
 #endif
 #ifndef NO_LAYER2
 	struct
 	{
-		real (*fraction)[4][SBLIMIT]; /* ALIGNED(16) real fraction[2][4][SBLIMIT] */
+		real (*fraction)[3*SCALE_BLOCK][SBLIMIT]; /* ALIGNED(16) real fraction[2][3*SCALE_BLOCK][SBLIMIT], the whole frame */
+		int (*samples)[3*SCALE_BLOCK][SBLIMIT]; /* int samples[2][3*SCALE_BLOCK][SBLIMIT], before dequantization */
 	} layer2;
 #endif
 #ifndef NO_LAYER3
@@ -325,6 +372,10 @@ struct mpg123_handle_struct
 	{
 		real (*hybrid_in)[SBLIMIT][SSLIMIT];  /* ALIGNED(16) real hybridIn[2][SBLIMIT][SSLIMIT]; */
 		real (*hybrid_out)[SSLIMIT][SBLIMIT]; /* ALIGNED(16) real hybridOut[2][SSLIMIT][SBLIMIT]; */
+		real (*hybrid_block)[2][SBLIMIT*SSLIMIT]; /* ALIGNED(16) real hybrid_block[2][2][SBLIMIT*SSLIMIT]; */
+#ifdef USE_THREADS
+		struct layer3_pipe *pipe; /* helper thread for MPG123_PIPELINE, started on demand */
+#endif
 	} layer3;
 #endif
 	/* A place for storing additional data for the large file wrapper.
@@ -342,6 +393,10 @@ int  frame_outbuffer(mpg123_handle *fr);
 int  frame_output_format(mpg123_handle *fr);
 
 int frame_buffers(mpg123_handle *fr); /* various decoder buffers, needed once */
+int frame_planebuf(mpg123_handle *fr); /* scratch for MPG123_PLANAR, half of outblock */
+/* Hand data to the mpg123_tap() function, td filled in but for data and count. */
+void frame_tap(mpg123_handle *fr, struct mpg123_tap_data *td, const real *data, size_t count);
+int frame_layer_buffers(mpg123_handle *fr); /* bitstream and layer buffers, for the current frame's layer */
 int frame_reset(mpg123_handle* fr);   /* reset for next track */
 int frame_buffers_reset(mpg123_handle *fr);
 void frame_exit(mpg123_handle *fr);   /* end, free all buffers */
@@ -353,6 +408,22 @@ int mpg123_print_index(mpg123_handle *fr, FILE* out);
 off_t frame_index_find(mpg123_handle *fr, off_t want_frame, off_t* get_frame);
 /* Apply index_size setting. */
 int frame_index_setup(mpg123_handle *fr);
+#ifdef FRAME_INDEX
+/* Index cache files (indexcache.c).
+   Loading checks the file stamp, the track info is applied with the first frame. */
+int  index_cache_load(mpg123_handle *fr, const char *path);
+int  index_cache_save(mpg123_handle *fr, const char *path);
+int  index_cache_apply(mpg123_handle *fr);
+void index_cache_free(mpg123_handle *fr);
+/* Same with a file in index_cache_dir, silently. */
+void index_cache_lookup(mpg123_handle *fr);
+void index_cache_store(mpg123_handle *fr);
+#endif
+
+/* Loudness measurement of output (loudness.c), interleaved or planar. */
+void loudness_add(mpg123_handle *fr, const unsigned char *buf, size_t bytes, int planar);
+void loudness_reset(mpg123_handle *fr);
+void loudness_exit(mpg123_handle *fr);
 
 void do_volume(mpg123_handle *fr, double factor);
 void do_rva(mpg123_handle *fr);
@@ -77,6 +77,9 @@ static void frame_buffercheck(mpg123_handle *fr)
 		off_t byteoff = (fr->num == fr->lastframe) ? samples_to_bytes(fr, fr->lastoff) : 0;
 		if((off_t)fr->buffer.fill > byteoff)
 		{
+			/* Planar: the right channel moves to the new middle. */
+			if(fr->planar)
+			memmove(fr->buffer.p + byteoff/2, fr->buffer.p + fr->buffer.fill/2, byteoff/2);
 			fr->buffer.fill = byteoff;
 		}
 		if(VERBOSE3) fprintf(stderr, "\nNote: Cut frame %"OFF_P" buffer on end of stream to %"OFF_P" samples, fill now %"SIZE_P" bytes.\n", (off_p)fr->num, (off_p)(fr->num == fr->lastframe ? fr->lastoff : 0), (size_p)fr->buffer.fill);
@@ -92,7 +95,14 @@ static void frame_buffercheck(mpg123_handle *fr)
 			/* buffer.p != buffer.data only for own buffer */
 			debug6("cutting %li samples/%li bytes on begin, own_buffer=%i at %p=%p, buf[1]=%i",
 			        (long)fr->firstoff, (long)byteoff, fr->own_buffer, (void*)fr->buffer.p, (void*)fr->buffer.data, ((short*)fr->buffer.p)[2]);
-			if(fr->own_buffer) fr->buffer.p = fr->buffer.data + byteoff;
+			if(fr->planar)
+			{
+				/* Cut both channels, closing the gap between them. */
+				size_t half = fr->buffer.fill/2;
+				memmove(fr->buffer.data, fr->buffer.data + byteoff/2, half);
+				memmove(fr->buffer.data + half, fr->buffer.data + half + byteoff, half);
+			}
+			else if(fr->own_buffer) fr->buffer.p = fr->buffer.data + byteoff;
 			else memmove(fr->buffer.data, fr->buffer.data + byteoff, fr->buffer.fill);
 			debug3("done cutting, buffer at %p =? %p, buf[1]=%i",
 			        (void*)fr->buffer.p, (void*)fr->buffer.data, ((short*)fr->buffer.p)[2]);
@@ -22,75 +22,65 @@
 #define getbitoffset(fr) ((-fr->bitindex)&0x7)
 #define getbyte(fr)      (*fr->wordpointer++)
 
-/* There is something wrong with that macro... the function below works also for the layer1 test case. */
-#define macro_getbits(fr, nob) ( \
-  fr->ultmp = fr->wordpointer[0],\
-  fr->ultmp <<= 8, \
-  fr->ultmp |= fr->wordpointer[1], \
-  fr->ultmp <<= 8, \
-  fr->ultmp |= fr->wordpointer[2], \
-  fr->ultmp <<= fr->bitindex, \
-  fr->ultmp &= 0xffffff, \
-  fr->bitindex += nob, \
-  fr->ultmp >>= (24-nob), \
-  fr->wordpointer += (fr->bitindex>>3), \
-  fr->bitindex &= 7, \
-  fr->ultmp)
-
-static unsigned int getbits(mpg123_handle *fr, int number_of_bits)
+/*
+	The next 8 bytes of the bit stream as big-endian word, from any alignment.
+	Compilers turn this into a plain load (plus byte swap on little endian).
+	It may read up to 7 bytes past the bits actually used, the bitstream
+	buffers have BSBUF_PAD bytes of slack at the end for that.
+*/
+static inline uint64_t getbits_word(const unsigned char *p)
 {
-  unsigned long rval;
-
-#ifdef DEBUG_GETBITS
-fprintf(stderr,"g%d",number_of_bits);
-#endif
+  return ((uint64_t)p[0]<<56) | ((uint64_t)p[1]<<48)
+  |      ((uint64_t)p[2]<<40) | ((uint64_t)p[3]<<32)
+  |      ((uint64_t)p[4]<<24) | ((uint64_t)p[5]<<16)
+  |      ((uint64_t)p[6]<<8)  |  (uint64_t)p[7];
+}
 
-/*  This is actually slow: if(!number_of_bits)
-    return 0; */
+/*
+	Works for 0 to 32 bits, what the unsigned int return value holds (the word
+	itself would have up to 57); the split shift avoids the undefined shift by
+	64 for 0 bits.
+	This one works on a bit position in local variables, for loops over many fields:
+	there, the compiler would have to reload fr->wordpointer and fr->bitindex after
+	each store of a decoded value that might alias them.
+*/
+static inline unsigned int getbits_at(unsigned char **wordpointer, int *bitindex, int number_of_bits)
+{
+  uint64_t rval;
 
-#if 0
-   check_buffer_range(number_of_bits+fr->bitindex);
-#endif
+  rval = ((getbits_word(*wordpointer) << *bitindex) >> (63-number_of_bits)) >> 1;
 
-  {
-    rval = fr->wordpointer[0];
-    rval <<= 8;
-    rval |= fr->wordpointer[1];
-    rval <<= 8;
-    rval |= fr->wordpointer[2];
+  *bitindex += number_of_bits;
+  *wordpointer += (*bitindex>>3);
+  *bitindex &= 7;
 
-    rval <<= fr->bitindex;
-    rval &= 0xffffff;
+  return (unsigned int)rval;
+}
 
-    fr->bitindex += number_of_bits;
+static inline unsigned int getbits(mpg123_handle *fr, int number_of_bits)
+{
+  unsigned int rval;
 
-    rval >>= (24-number_of_bits);
+#ifdef DEBUG_GETBITS
+fprintf(stderr,"g%d",number_of_bits);
+#endif
 
-    fr->wordpointer += (fr->bitindex>>3);
-    fr->bitindex &= 7;
-  }
+  rval = getbits_at(&fr->wordpointer, &fr->bitindex, number_of_bits);
 
 #ifdef DEBUG_GETBITS
-fprintf(stderr,":%lx\n",rval);
+fprintf(stderr,":%x\n",rval);
 #endif
 
   return rval;
 }
 
+/* A single word load is as cheap as the old two-byte variant. */
+#define getbits_fast(fr, nob) getbits(fr, nob)
 
-#define skipbits(fr, nob) fr->ultmp = ( \
-  fr->ultmp = fr->wordpointer[0], fr->ultmp <<= 8, fr->ultmp |= fr->wordpointer[1], \
-  fr->ultmp <<= 8, fr->ultmp |= fr->wordpointer[2], fr->ultmp <<= fr->bitindex, \
-  fr->ultmp &= 0xffffff, fr->bitindex += nob, \
-  fr->ultmp >>= (24-nob), fr->wordpointer += (fr->bitindex>>3), \
-  fr->bitindex &= 7 )
-
-#define getbits_fast(fr, nob) ( \
-  fr->ultmp = (unsigned char) (fr->wordpointer[0] << fr->bitindex), \
-  fr->ultmp |= ((unsigned long) fr->wordpointer[1]<<fr->bitindex)>>8, \
-  fr->ultmp <<= nob, fr->ultmp >>= 8, \
-  fr->bitindex += nob, fr->wordpointer += (fr->bitindex>>3), \
-  fr->bitindex &= 7, fr->ultmp )
+#define skipbits(fr, nob) ((void)( \
+  fr->bitindex    += nob, \
+  fr->wordpointer += (fr->bitindex>>3), \
+  fr->bitindex    &= 7 ))
 
 #define get1bit(fr) ( \
   fr->uctmp = *fr->wordpointer << fr->bitindex, fr->bitindex++, \
@@ -19,12 +19,15 @@
 #define FLAG2_SSE       0x02000000
 #define FLAG2_SSE2      0x04000000
 #define FLAG2_FPU       0x00000001
+/* standard level 7 flags part 1 (EBX) */
+#define FLAG3_AVX512F   0x00010000
 /* cpuid extended level 1 (AMD) */
 #define XFLAG_MMX      0x00800000
 #define XFLAG_3DNOW    0x80000000
 #define XFLAG_3DNOWEXT 0x40000000
 /* eXtended Control Register 0 */
 #define XCR0FLAG_AVX   0x00000006
+#define XCR0FLAG_AVX512 0x000000e6
 
 
 struct cpuflags
@@ -37,6 +40,7 @@ struct cpuflags
 	unsigned int std2;
 	unsigned int ext;
 	unsigned int xcr0_lo;
+	unsigned int std3;
 #endif
 };
 
@@ -53,6 +57,7 @@ unsigned int getcpuflags(struct cpuflags* cf);
 #define cpu_sse2(s) (FLAG2_SSE2 & s.std2)
 #define cpu_sse3(s) (FLAG_SSE3 & s.std)
 #define cpu_avx(s) ((FLAG_AVX & s.std) == FLAG_AVX && (XCR0FLAG_AVX & s.xcr0_lo) == XCR0FLAG_AVX)
+#define cpu_avx512(s) (cpu_avx(s) && (FLAG3_AVX512F & s.std3) && (XCR0FLAG_AVX512 & s.xcr0_lo) == XCR0FLAG_AVX512)
 #define cpu_fast_sse(s) ((((s.id & 0xf00)>>8) == 6 && FLAG_SSSE3 & s.std) /* for Intel/VIA; family 6 CPUs with SSSE3 */ || \
 						   (((s.id & 0xf00)>>8) == 0xf && (((s.id & 0x0ff00000)>>20) > 0 && ((s.id & 0x0ff00000)>>20) != 5))) /* for AMD; family > 0xF CPUs except Bobcat */
 #define cpu_neon(s) (s.has_neon)
@@ -9,6 +9,9 @@
 #include "index.h"
 #include "debug.h"
 
+/* Reach is noted per block with compact storage. */
+#define FI_SLOT(fi, entry) ((fi)->compact ? (entry)/FI_BLOCK : (entry))
+
 /* The next expected frame offset, one step ahead. */
 static off_t fi_next(struct frame_index *fi)
 {
@@ -28,15 +31,133 @@ static void fi_shrink(struct frame_index *fi)
 		fi->fill /= 2;
 		/* Move the data down. */
 		for(c = 0; c < fi->fill; ++c)
-		fi->data[c] = fi->data[2*c];
+		{
+			fi->data[c] = fi->data[2*c];
+			/* The merged entry covers the frames of both. */
+			fi->reach[c] = fi->reach[2*c] > fi->reach[2*c+1] ? fi->reach[2*c] : fi->reach[2*c+1];
+		}
+		/* A dropped odd entry at the end takes its frames along. */
+		if(fi->reach_end > fi_next(fi)) fi->reach_end = fi_next(fi);
 	}
 
 	fi->next = fi_next(fi);
 }
 
+/* Compact storage: room for one more entry, the blocks growing to double. */
+static int fi_compact_grow(struct frame_index *fi)
+{
+	if(fi->fill == fi->size)
+	{
+		size_t newsize = fi->size ? 2*fi->size : 16*FI_BLOCK;
+		off_t  *anchor;
+		size_t *codepos;
+		unsigned char *reach;
+		if((anchor = safe_realloc(fi->anchor, newsize/FI_BLOCK*sizeof(off_t))) == NULL)
+		return -1;
+		fi->anchor = anchor;
+		if((codepos = safe_realloc(fi->codepos, newsize/FI_BLOCK*sizeof(size_t))) == NULL)
+		return -1;
+		fi->codepos = codepos;
+		if((reach = safe_realloc(fi->reach, newsize/FI_BLOCK)) == NULL)
+		return -1;
+		fi->reach = reach;
+		fi->size = newsize;
+	}
+	/* A code of 64 bits takes 10 bytes at most. */
+	if(fi->code_fill+10 > fi->code_size)
+	{
+		size_t newsize = fi->code_size ? 2*fi->code_size : 32*FI_BLOCK;
+		unsigned char *code = safe_realloc(fi->code, newsize);
+		if(code == NULL) return -1;
+		fi->code = code;
+		fi->code_size = newsize;
+	}
+	return 0;
+}
+
+static int fi_compact_add(struct frame_index *fi, off_t pos)
+{
+	if(fi_compact_grow(fi) != 0)
+	{
+		error("failed to grow compact index!");
+		return -1;
+	}
+	if(fi->fill % FI_BLOCK == 0)
+	{
+		fi->anchor[fi->fill/FI_BLOCK]  = pos;
+		fi->codepos[fi->fill/FI_BLOCK] = fi->code_fill;
+		fi->reach[fi->fill/FI_BLOCK]   = 0;
+		fi->last_dist = 0;
+	}
+	else
+	{
+		off_t dist = pos - fi->last_pos;
+		off_t change = dist - fi->last_dist;
+		/* Zigzag, so that small changes either way make short codes. */
+		off_t val = change < 0 ? 2*(-(change+1))+1 : 2*change;
+		while(val >= 0x80)
+		{
+			fi->code[fi->code_fill++] = (unsigned char)(val & 0x7f) | 0x80;
+			val >>= 7;
+		}
+		fi->code[fi->code_fill++] = (unsigned char)val;
+		fi->last_dist = dist;
+	}
+	fi->last_pos = pos;
+	++fi->fill;
+	return 0;
+}
+
+/* Decode the block of entry i up to it, storing all positions in out if given. */
+static off_t fi_compact_get(struct frame_index *fi, size_t i, off_t *out)
+{
+	const unsigned char *c = fi->code + fi->codepos[i/FI_BLOCK];
+	off_t pos  = fi->anchor[i/FI_BLOCK];
+	off_t dist = 0;
+	size_t n;
+
+	if(out != NULL) *out++ = pos;
+	for(n = i % FI_BLOCK; n; --n)
+	{
+		off_t val = 0;
+		int shift = 0;
+		do
+		{
+			val |= (off_t)(*c & 0x7f) << shift;
+			shift += 7;
+		} while(*c++ & 0x80);
+		dist += (val & 1) ? -(val>>1)-1 : val>>1;
+		pos  += dist;
+		if(out != NULL) *out++ = pos;
+	}
+	return pos;
+}
+
+static void fi_compact_free(struct frame_index *fi)
+{
+	if(fi->anchor  != NULL) free(fi->anchor);
+	if(fi->codepos != NULL) free(fi->codepos);
+	if(fi->code    != NULL) free(fi->code);
+	if(fi->flat    != NULL) free(fi->flat);
+	fi->anchor  = NULL;
+	fi->codepos = NULL;
+	fi->code    = NULL;
+	fi->flat    = NULL;
+	fi->code_fill = fi->code_size = fi->flat_fill = 0;
+}
+
 void fi_init(struct frame_index *fi)
 {
 	fi->data = NULL;
+	fi->compact = 0;
+	fi->anchor  = NULL;
+	fi->codepos = NULL;
+	fi->code    = NULL;
+	fi->flat    = NULL;
+	fi->code_fill = fi->code_size = fi->flat_fill = 0;
+	fi->last_pos = fi->last_dist = 0;
+	fi->reach = NULL;
+	fi->reach_end = 0;
 	fi->step = 1;
 	fi->fill = 0;
 	fi->size = 0;
@@ -48,14 +169,51 @@ void fi_exit(struct frame_index *fi)
 {
 	debug2("fi_exit: %p and %lu", (void*)fi->data, (unsigned long)fi->size);
 	if(fi->size && fi->data != NULL) free(fi->data);
+	if(fi->reach != NULL) free(fi->reach);
+	fi_compact_free(fi);
 
 	fi_init(fi); /* Be prepared for further fun, still. */
 }
 
+/* The memory of an empty index is only allocated with the first entry,
+   handles that never get to see any frame do not need it. */
+static int fi_alloc(struct frame_index *fi)
+{
+	if(fi->data == NULL && fi->size)
+	{
+		fi->data = malloc(fi->size*sizeof(off_t));
+		if(fi->reach != NULL) free(fi->reach);
+		fi->reach = malloc(fi->size);
+		if(fi->data == NULL || fi->reach == NULL)
+		{
+			if(fi->data != NULL) free(fi->data);
+			if(fi->reach != NULL) free(fi->reach);
+			fi->data = NULL;
+			fi->reach = NULL;
+			error("failed to allocate index!");
+			return -1;
+		}
+	}
+	return 0;
+}
+
 int fi_resize(struct frame_index *fi, size_t newsize)
 {
 	off_t *newdata = NULL;
-	if(newsize == fi->size) return 0;
+	unsigned char *newreach = NULL;
+	if(newsize == fi->size || fi->compact) return 0;
+
+	if(fi->fill == 0)
+	{
+		if(fi->data != NULL) free(fi->data);
+		if(fi->reach != NULL) free(fi->reach);
+		fi->data = NULL;
+		fi->reach = NULL;
+		fi->size = newsize;
+		fi->next = fi_next(fi);
+		debug1("new empty index of size %lu", (unsigned long)fi->size);
+		return 0;
+	}
 
 	if(newsize > 0 && newsize < fi->size)
 	{ /* When we reduce buffer size a bit, shrink stuff. */
@@ -63,11 +221,14 @@ int fi_resize(struct frame_index *fi, size_t newsize)
 	}
 
 	newdata = safe_realloc(fi->data, newsize*sizeof(off_t));
-	if(newsize == 0 || newdata != NULL)
+	if(newsize == 0 || newdata != NULL) fi->data = newdata;
+	newreach = safe_realloc(fi->reach, newsize);
+	if(newsize == 0 || newreach != NULL) fi->reach = newreach;
+	if(newsize == 0 || (newdata != NULL && newreach != NULL))
 	{
-		fi->data = newdata;
 		fi->size = newsize;
 		if(fi->fill > fi->size) fi->fill = fi->size;
+		if(fi->reach_end > fi_next(fi)) fi->reach_end = fi_next(fi);
 
 		fi->next = fi_next(fi);
 		debug2("new index of size %lu at %p", (unsigned long)fi->size, (void*)fi->data);
@@ -83,6 +244,12 @@ int fi_resize(struct frame_index *fi, size_t newsize)
 void fi_add(struct frame_index *fi, off_t pos)
 {
 	debug3("wanting to add to fill %lu, step %lu, size %lu", (unsigned long)fi->fill, (unsigned long)fi->step, (unsigned long)fi->size);
+	if(fi->compact)
+	{
+		if(fi_compact_add(fi, pos) == 0) fi->next = fi_next(fi);
+		return;
+	}
+	if(fi_alloc(fi) != 0) return;
 	if(fi->fill == fi->size)
 	{ /* Index is full, we need to shrink... or grow. */
 		/* Store the current frame number to check later if we still want it. */
@@ -99,19 +266,97 @@ void fi_add(struct frame_index *fi, off_t pos)
 	{
 		debug1("adding to index at %p", (void*)(fi->data+fi->fill));
 		fi->data[fi->fill] = pos;
+		fi->reach[fi->fill] = 0;
 		++fi->fill;
 		fi->next = fi_next(fi);
 		debug3("added pos %li to index with fill %lu and step %lu", (long) pos, (unsigned long)fi->fill, (unsigned long)fi->step);
 	}
 }
 
+off_t fi_get(struct frame_index *fi, size_t i)
+{
+	return fi->compact ? fi_compact_get(fi, i, NULL) : fi->data[i];
+}
+
+off_t *fi_positions(struct frame_index *fi)
+{
+	size_t i;
+	if(!fi->compact) return fi->data;
+	if(fi->flat_fill != fi->fill)
+	{
+		off_t *flat = safe_realloc(fi->flat, (fi->fill+1)*sizeof(off_t));
+		if(flat == NULL) return NULL;
+		fi->flat = flat;
+		/* Entries only get appended, a partial block is done again. */
+		for(i = fi->flat_fill - fi->flat_fill % FI_BLOCK; i < fi->fill; i += FI_BLOCK)
+		fi_compact_get(fi, i + FI_BLOCK > fi->fill ? fi->fill-1 : i+FI_BLOCK-1, fi->flat+i);
+		fi->flat_fill = fi->fill;
+	}
+	return fi->flat;
+}
+
+int fi_compact(struct frame_index *fi, int compact, size_t size)
+{
+	struct frame_index other;
+	size_t i;
+
+	if(!compact == !fi->compact) return compact ? 0 : fi_resize(fi, size);
+	/* Build the other kind of index from the entries, keep the old on failure. */
+	fi_init(&other);
+	other.compact = compact ? 1 : 0;
+	other.grow_size = fi->grow_size;
+	other.step = fi->step;
+	if(compact ? fi_compact_grow(&other) : fi_resize(&other, size))
+	goto fi_compact_fail;
+	other.next = fi_next(&other);
+	for(i=0; i<fi->fill; ++i)
+	{
+		size_t fill = other.fill;
+		if(!FI_NEXT(other, (off_t)i*fi->step)) continue;
+		fi_add(&other, fi_get(fi, i));
+		/* A plain index may drop the entry on shrinking, that's fine. */
+		if(other.compact ? other.fill == fill : other.data == NULL)
+		goto fi_compact_fail;
+	}
+	/* The entries of other cover whole entries of fi, or the other way round. */
+	for(i=0; i<fi->fill; ++i)
+	{
+		size_t slot = FI_SLOT(&other, (size_t)((off_t)i*fi->step/other.step));
+		if(slot < (other.compact ? (other.fill+FI_BLOCK-1)/FI_BLOCK : other.fill)
+		  && fi_entry_reach(fi, i) > other.reach[slot])
+		other.reach[slot] = fi_entry_reach(fi, i);
+	}
+	other.reach_end = fi->reach_end > fi_next(&other) ? fi_next(&other) : fi->reach_end;
+	memcpy(other.payload, fi->payload, sizeof(fi->payload));
+	fi_exit(fi);
+	*fi = other;
+	return 0;
+fi_compact_fail:
+	error("failed to convert index!");
+	fi_exit(&other);
+	return -1;
+}
+
 int fi_set(struct frame_index *fi, off_t *offsets, off_t step, size_t fill)
 {
-	if(fi_resize(fi, fill) == -1) return -1;
+	if(fi->compact)
+	{
+		size_t i;
+		fi_reset(fi);
+		fi->step = step;
+		if(offsets != NULL) for(i=0; i<fill; ++i)
+		if(fi_compact_add(fi, offsets[i]) != 0) return -1;
+		fi->next = fi_next(fi);
+		return 0;
+	}
+	if(fi_resize(fi, fill) == -1 || fi_alloc(fi) == -1) return -1;
 	fi->step = step;
+	/* Nothing known about the bit reservoir of these frames. */
+	fi->reach_end = 0;
 	if(offsets != NULL)
 	{
 		memcpy(fi->data, offsets, fill*sizeof(off_t));
+		memset(fi->reach, 0, fill);
 		fi->fill = fill;
 	}
 	else
@@ -130,5 +375,77 @@ void fi_reset(struct frame_index *fi)
 	debug1("reset with size %"SIZE_P, (size_p)fi->size);
 	fi->fill = 0;
 	fi->step = 1;
+	fi->reach_end = 0;
+	fi->code_fill = fi->flat_fill = 0;
 	fi->next = fi_next(fi);
 }
+
+void fi_reservoir(struct frame_index *fi, off_t num, unsigned int main_data_begin, unsigned int payload)
+{
+	size_t entry;
+	unsigned int have = 0;
+	int back = 0;
+
+	/* Frames count only in a row and need an index entry to note things at. */
+	if(num != fi->reach_end || (entry = (size_t)(num/fi->step)) >= fi->fill)
+	return;
+	/* Which of the previous frames are needed for main_data_begin bytes? */
+	while(have < main_data_begin && back < num)
+	{
+		if(back == FI_PAYLOADS)
+		{
+			back = FI_REACH_UNKNOWN;
+			break;
+		}
+		++back;
+		have += fi->payload[(num-back) % FI_PAYLOADS];
+	}
+	entry = FI_SLOT(fi, entry);
+	if(back > fi->reach[entry]) fi->reach[entry] = (unsigned char)back;
+	fi->payload[num % FI_PAYLOADS] = (unsigned short)payload;
+	++fi->reach_end;
+}
+
+int fi_reach(struct frame_index *fi, off_t first, off_t last)
+{
+	int reach = 0;
+	size_t entry;
+	/* Frames per slot: an entry, or a block of them with compact storage. */
+	off_t span = fi->compact ? fi->step*FI_BLOCK : fi->step;
+
+	if(first < 0 || last < first || last >= fi->reach_end)
+	return -1;
+	for( entry = FI_SLOT(fi, (size_t)(first/fi->step));
+	     entry <= FI_SLOT(fi, (size_t)(last/fi->step)); ++entry )
+	{
+		/* The earliest frame of the slot from first on counts, as it
+		   needs the most of the frames before first. */
+		off_t ahead = (off_t)entry*span - first;
+		if(fi->reach[entry] == FI_REACH_UNKNOWN) return -1;
+		if(ahead < 0) ahead = 0;
+		if(fi->reach[entry] - ahead > reach) reach = (int)(fi->reach[entry] - ahead);
+	}
+	/* Not before the first frame. */
+	return reach > first ? (int)first : reach;
+}
+
+unsigned char fi_entry_reach(struct frame_index *fi, size_t i)
+{
+	return fi->reach[FI_SLOT(fi, i)];
+}
+
+void fi_set_reach(struct frame_index *fi, const unsigned char *reach, off_t reach_end)
+{
+	size_t i;
+	for(i=0; i<fi->fill; ++i)
+	{
+		size_t slot = FI_SLOT(fi, i);
+		/* A block takes the most of its entries. */
+		if(slot == i || i % FI_BLOCK == 0 || reach[i] > fi->reach[slot])
+		fi->reach[slot] = reach[i];
+	}
+	/* The payloads of the frames before reach_end are not known,
+	   frames after it cannot get a known reach anymore. */
+	memset(fi->payload, 0, sizeof(fi->payload));
+	fi->reach_end = reach_end > fi_next(fi) ? fi_next(fi) : reach_end;
+}
@@ -15,6 +15,11 @@
 	In this manner we maintain a good resolution with the given
 	maximum index size while covering the whole stream.
 
+	The compact storage keeps all entries instead, in blocks that start with
+	an absolute position, followed by variable length codes of the change
+	of the distance between entries (one byte per frame of a CBR stream, two
+	for the usual VBR). Looking up an entry decodes a part of one block.
+
 	copyright 2007-8 by the mpg123 project - free software under the terms of the LGPL 2.1
 	see COPYING and AUTHORS files in distribution or http://mpg123.org
 	initially written by Thomas Orgis
@@ -23,14 +28,40 @@
 #include "config.h"
 #include "compat.h"
 
+/* Layer III main data reaches back 511 bytes at most, that is 24 of the
+   smallest frames of MPEG 2.5. */
+#define FI_PAYLOADS 32
+#define FI_REACH_UNKNOWN 255
+/* Entries in a block of the compact storage. */
+#define FI_BLOCK 64
+
 struct frame_index
 {
-	off_t *data; /* actual data, the frame positions */
+	off_t *data; /* actual data, the frame positions (not for compact storage) */
 	off_t  step; /* advancement in frame number per index point */
 	off_t  next; /* frame offset supposed to come next into the index */
 	size_t size; /* total number of possible entries */
 	size_t fill; /* number of used entries */
 	size_t grow_size; /* if > 0: index allowed to grow on need with these steps, instead of lowering resolution */
+	/* Compact storage: the blocks, the codes and what's needed to append. */
+	int compact;
+	off_t  *anchor;  /* position of the first entry of each block */
+	size_t *codepos; /* where the codes of each block start */
+	unsigned char *code;
+	size_t code_fill;
+	size_t code_size;
+	off_t last_pos;
+	off_t last_dist;
+	off_t *flat; /* all positions for fi_positions(), when asked for */
+	size_t flat_fill;
+	/* Layer III bit reservoir: For each entry (block with compact storage), the
+	   most frames back any frame up to the next one takes main data from
+	   (FI_REACH_UNKNOWN if too far).
+	   That is known for frames before reach_end, which were seen in a row from
+	   the beginning, the last ones' payload sizes being kept in payload[]. */
+	unsigned char *reach;
+	off_t reach_end;
+	unsigned short payload[FI_PAYLOADS];
 };
 
 /* The condition for a framenum to be appended to the index. 
@@ -44,15 +75,45 @@ void fi_exit(struct frame_index *fi);
 
 /* Prepare a given size, preserving current fill, if possible.
    If the new size is smaller than fill, the entry density is reduced.
+   An empty index gets its memory only when adding the first entry.
    Return 0 on success. */
 int fi_resize(struct frame_index *fi, size_t newsize);
 
-/* Append a frame position, reducing index density if needed. */
+/* Switch to compact storage or back, keeping the entries (those that fit
+   into the given size for a plain index, see fi_resize()).
+   Return 0 on success. */
+int fi_compact(struct frame_index *fi, int compact, size_t size);
+
+/* Append a frame position, reducing index density if needed.
+   A compact index grows instead. */
 void fi_add(struct frame_index *fi, off_t pos);
 
+/* The position stored in entry i < fill. */
+off_t fi_get(struct frame_index *fi, size_t i);
+
+/* All positions as an array, valid until the index changes (it is a decoded
+   copy for compact storage). NULL if that copy cannot be had. */
+off_t *fi_positions(struct frame_index *fi);
+
 /* Replace the frame index */
 int fi_set(struct frame_index *fi, off_t *offsets, off_t step, size_t fill);
 
+/* Note how far back into the bit reservoir frame num reaches with its
+   main_data_begin and how much it adds to it itself. Only frames that follow
+   the ones noted before in a row count. */
+void fi_reservoir(struct frame_index *fi, off_t num, unsigned int main_data_begin, unsigned int payload);
+
+/* The reach noted for entry i, and the way to restore reach for all entries
+   (after fi_set()), with the frame count it is known for. */
+unsigned char fi_entry_reach(struct frame_index *fi, size_t i);
+void fi_set_reach(struct frame_index *fi, const unsigned char *reach, off_t reach_end);
+
+/* The number of frames before first that are needed to have the bit
+   reservoir of all frames from first to last filled, or -1 if unknown.
+   A frame reaches back FI_PAYLOADS frames at most, so the ones from
+   first+FI_PAYLOADS on never need anything before first. */
+int fi_reach(struct frame_index *fi, off_t first, off_t last);
+
 /* Empty the index (setting fill=0 and step=1), but keep current size. */
 void fi_reset(struct frame_index *fi);
 
@@ -0,0 +1,432 @@
+/*
+	indexcache: keeping the frame index of a file in a sidecar file
+
+	copyright 2016 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+
+	A full scan of a long VBR file takes its time, every time the file is
+	opened again. What the scan found out (frame index, exact frame and sample
+	count, gapless info) is small, though, and can be stored next to the file
+	or in a cache directory. A cache file is only used when size, modification
+	time and a hash of the start of the file still match, and when the first
+	frame is found where it was before.
+
+	The format is a sequence of 64 bit little endian signed integers:
+
+		"mpg123ix" (8 bytes), version
+		file size, mtime, hash of the first INDEX_CACHE_HASHBYTES bytes
+		audio_start, track_frames, track_samples
+		gapless_frames, begin_s, end_s, flags
+		frames with known bit reservoir reach
+		index step, index fill, fill offsets
+		reach bytes of the fill entries, padded to 8 bytes
+		checksum over everything before
+
+	A cache directory holds files named after a hash of the file name as
+	given to mpg123_open(). Collisions only cost a rescan, the stamp check
+	catches them.
+*/
+
+#include "mpg123lib_intern.h"
+#include <errno.h>
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef _MSC_VER
+#include <io.h>
+#endif
+#include "debug.h"
+
+#ifdef FRAME_INDEX
+
+#ifndef O_BINARY
+#define O_BINARY (0)
+#endif
+
+#define INDEX_CACHE_VERSION 2
+#define INDEX_CACHE_HASHBYTES 65536
+/* magic, version, stamp, track info, index header */
+#define INDEX_CACHE_FIELDS 15
+#define INDEX_CACHE_SUFFIX ".mpg123idx"
+
+/* bits in the flags field */
+#define INDEX_CACHE_FRANKENSTEIN 0x1
+
+struct index_cache
+{
+	off_t audio_start;
+	off_t track_frames;
+	off_t track_samples;
+	off_t gapless_frames;
+	off_t begin_s;
+	off_t end_s;
+	long flags;
+	off_t reach_end;
+	off_t step;
+	size_t fill;
+	off_t *data;
+	unsigned char *reach;
+};
+
+/* The reach bytes take that many 64 bit fields. */
+#define INDEX_CACHE_REACH(fill) (((fill)+7)/8)
+
+/* What identifies a certain state of the file. */
+struct index_stamp
+{
+	off_t size;
+	off_t mtime;
+	off_t hash;
+};
+
+/* FNV-1a, 32 bits are plenty together with size and mtime. */
+static uint32_t index_hash(uint32_t hash, const unsigned char *data, size_t count)
+{
+	size_t i;
+	for(i=0; i<count; ++i)
+	{
+		hash ^= data[i];
+		hash *= (uint32_t)16777619UL;
+	}
+	return hash;
+}
+#define INDEX_HASH_INIT ((uint32_t)2166136261UL)
+
+static void put_off(unsigned char *b, off_t val)
+{
+	int i;
+	for(i=0; i<8; ++i)
+	{
+		b[i] = (unsigned char)(val & 0xff);
+		val >>= 8; /* Sign extension with negative values, like in the file. */
+	}
+}
+
+/* Returns 0 if the value does not fit into off_t. */
+static int get_off(const unsigned char *b, off_t *val)
+{
+	int i, top = sizeof(off_t) < 8 ? (int)sizeof(off_t) : 8;
+	off_t v;
+	/* Bytes beyond off_t can only be sign extension. */
+	for(i=top; i<8; ++i)
+	if(b[i] != ((b[top-1] & 0x80) ? 0xff : 0)) return 0;
+	v = (off_t)b[top-1] - ((b[top-1] & 0x80) ? 256 : 0);
+	for(i=top-2; i>=0; --i) v = v*256 + b[i];
+	*val = v;
+	return 1;
+}
+
+static ssize_t read_all(int fd, unsigned char *buf, size_t count)
+{
+	size_t got = 0;
+	while(got < count)
+	{
+		ssize_t ret = read(fd, buf+got, count-got);
+		if(ret < 0 && errno == EINTR) continue;
+		if(ret < 0) return -1;
+		if(ret == 0) break;
+		got += ret;
+	}
+	return (ssize_t)got;
+}
+
+static int write_all(int fd, const unsigned char *buf, size_t count)
+{
+	size_t done = 0;
+	while(done < count)
+	{
+		ssize_t ret = write(fd, buf+done, count-done);
+		if(ret < 0 && errno == EINTR) continue;
+		if(ret <= 0) return -1;
+		done += ret;
+	}
+	return 0;
+}
+
+/* Size, mtime and start of the file, opened anew by name. */
+static int index_stamp(mpg123_handle *fr, struct index_stamp *st)
+{
+	struct stat buf;
+	unsigned char *block;
+	ssize_t got;
+	int fd;
+
+	if(fr->rdat.filename == NULL) return -1;
+	fd = compat_open(fr->rdat.filename, O_RDONLY|O_BINARY);
+	if(fd < 0) return -1;
+	block = malloc(INDEX_CACHE_HASHBYTES);
+	if(block == NULL || fstat(fd, &buf) != 0)
+	{
+		if(block != NULL) free(block);
+		compat_close(fd);
+		return -1;
+	}
+	got = read_all(fd, block, INDEX_CACHE_HASHBYTES);
+	compat_close(fd);
+	if(got >= 0)
+	{
+		st->size  = (off_t)buf.st_size;
+		st->mtime = (off_t)buf.st_mtime;
+		st->hash  = (off_t)index_hash(INDEX_HASH_INIT, block, (size_t)got);
+	}
+	free(block);
+	return got < 0 ? -1 : 0;
+}
+
+void index_cache_free(mpg123_handle *fr)
+{
+	if(fr->cached == NULL) return;
+	if(fr->cached->data != NULL) free(fr->cached->data);
+	if(fr->cached->reach != NULL) free(fr->cached->reach);
+	free(fr->cached);
+	fr->cached = NULL;
+}
+
+int index_cache_load(mpg123_handle *fr, const char *path)
+{
+	unsigned char head[INDEX_CACHE_FIELDS*8];
+	unsigned char *body = NULL;
+	off_t val[INDEX_CACHE_FIELDS];
+	struct index_stamp st;
+	struct index_cache *ic = NULL;
+	struct stat cst;
+	off_t bodylen;
+	size_t i, bodysize;
+	uint32_t sum;
+	int fd;
+
+	index_cache_free(fr);
+	if(index_stamp(fr, &st) != 0)
+	{
+		fr->err = MPG123_BAD_INDEX_CACHE;
+		return MPG123_ERR;
+	}
+	fd = compat_open(path, O_RDONLY|O_BINARY);
+	if(fd < 0)
+	{
+		fr->err = MPG123_BAD_FILE;
+		return MPG123_ERR;
+	}
+	if(read_all(fd, head, sizeof(head)) != (ssize_t)sizeof(head))
+	goto index_cache_load_bad;
+	for(i=1; i<INDEX_CACHE_FIELDS; ++i)
+	if(!get_off(head+8*i, &val[i])) goto index_cache_load_bad;
+	if(   memcmp(head, "mpg123ix", 8) || val[1] != INDEX_CACHE_VERSION
+	   || val[2] != st.size || val[3] != st.mtime || val[4] != st.hash )
+	{
+		debug1("index cache %s does not match", path);
+		goto index_cache_load_bad;
+	}
+	/* The offsets grow and cannot be more than there are bytes, neither can
+	   the frames they are step apart. That bounds the product, too. */
+	if(   val[13] < 1 || val[13] > st.size || val[14] < 0 || val[14] > st.size
+	   || val[14]-1 > st.size/val[13]
+	   || val[12] < 0 || val[12] > val[13]*val[14] )
+	goto index_cache_load_bad;
+	/* The track has at least the indexed frames. The gapless window (-1 frames
+	   for none) lies within it, its end only reaching out by the decoder delay
+	   with a short padding. Anything else makes for a rescan. */
+	if(   val[6] < 0 || val[7] < 0 || val[8] < -1 || val[9] < 0 || val[10] < 0
+	   || (val[14] > 0 && val[6] <= (val[14]-1)*val[13])
+	   || val[8] > val[6] || val[9] > val[10] || val[10] > val[7]+GAPLESS_DELAY )
+	{
+		debug1("index cache %s has bogus track info", path);
+		goto index_cache_load_bad;
+	}
+	/* Only allocate for what the cache file really holds. */
+	if(fstat(fd, &cst) != 0 || val[14] > (off_t)cst.st_size/8)
+	goto index_cache_load_bad;
+	bodylen  = val[14]*8 + INDEX_CACHE_REACH(val[14])*8 + 8;
+	bodysize = (size_t)bodylen;
+	if(  (off_t)bodysize != bodylen
+	  || (off_t)cst.st_size != (off_t)sizeof(head)+bodylen )
+	goto index_cache_load_bad;
+
+	ic = malloc(sizeof(*ic));
+	if(ic == NULL) goto index_cache_load_bad;
+	ic->audio_start    = val[5];
+	ic->track_frames   = val[6];
+	ic->track_samples  = val[7];
+	ic->gapless_frames = val[8];
+	ic->begin_s        = val[9];
+	ic->end_s          = val[10];
+	ic->flags          = (long)val[11];
+	ic->reach_end      = val[12];
+	ic->step           = val[13];
+	ic->fill           = (size_t)val[14];
+	ic->data  = malloc(ic->fill*sizeof(off_t)+1);
+	ic->reach = malloc(ic->fill+1);
+	body = malloc(bodysize);
+	if(ic->data == NULL || ic->reach == NULL || body == NULL) goto index_cache_load_bad;
+	if(read_all(fd, body, bodysize) != (ssize_t)bodysize)
+	goto index_cache_load_bad;
+	sum = index_hash(index_hash(INDEX_HASH_INIT, head, sizeof(head)), body, bodysize-8);
+	if(!get_off(body+bodysize-8, &val[0]) || val[0] != (off_t)sum)
+	goto index_cache_load_bad;
+	for(i=0; i<ic->fill; ++i)
+	{
+		if(  !get_off(body+8*i, &ic->data[i]) || ic->data[i] >= st.size
+		  || (i > 0 && ic->data[i] <= ic->data[i-1]) )
+		goto index_cache_load_bad;
+	}
+	memcpy(ic->reach, body+ic->fill*8, ic->fill);
+	free(body);
+	compat_close(fd);
+	fr->cached = ic;
+	debug3("loaded index cache %s: %"OFF_P" frames, %lu index entries", path, (off_p)ic->track_frames, (unsigned long)ic->fill);
+	/* Without the first frame, there is nothing to check against yet. */
+	if(fr->num >= 0 && index_cache_apply(fr) != 0) return MPG123_ERR;
+	return MPG123_OK;
+
+index_cache_load_bad:
+	if(body != NULL) free(body);
+	if(ic != NULL)
+	{
+		if(ic->data != NULL) free(ic->data);
+		if(ic->reach != NULL) free(ic->reach);
+		free(ic);
+	}
+	compat_close(fd);
+	fr->err = MPG123_BAD_INDEX_CACHE;
+	return MPG123_ERR;
+}
+
+int index_cache_apply(mpg123_handle *fr)
+{
+	int ret = -1;
+	struct index_cache *ic = fr->cached;
+	if(ic == NULL) return 0;
+	fr->cached = NULL;
+	if(ic->audio_start != fr->audio_start)
+	{
+		debug2("index cache for audio at %"OFF_P", not %"OFF_P, (off_p)ic->audio_start, (off_p)fr->audio_start);
+		fr->err = MPG123_BAD_INDEX_CACHE;
+	}
+	else if(fi_set(&fr->index, ic->data, ic->step, ic->fill) != 0)
+	fr->err = MPG123_OUT_OF_MEM;
+	else
+	{
+		ret = 0;
+		fi_set_reach(&fr->index, ic->reach, ic->reach_end);
+		fr->track_frames  = ic->track_frames;
+		fr->track_samples = ic->track_samples;
+		if(ic->flags & INDEX_CACHE_FRANKENSTEIN) fr->state_flags |= FRAME_FRANKENSTEIN;
+		fr->state_flags |= FRAME_SCANNED;
+#ifdef GAPLESS
+		fr->gapless_frames = ic->gapless_frames;
+		fr->begin_s = ic->begin_s;
+		fr->end_s   = ic->end_s;
+		/* Decoding already started with the old values. */
+		if(!fr->fresh)
+		{
+			frame_gapless_realinit(fr);
+			frame_set_frameseek(fr, fr->num+1);
+		}
+#endif
+	}
+	if(ic->data != NULL) free(ic->data);
+	if(ic->reach != NULL) free(ic->reach);
+	free(ic);
+	return ret;
+}
+
+int index_cache_save(mpg123_handle *fr, const char *path)
+{
+	unsigned char *buf;
+	struct index_stamp st;
+	size_t i, size;
+	off_t val[INDEX_CACHE_FIELDS];
+	int fd, ret;
+
+	if(index_stamp(fr, &st) != 0)
+	{
+		fr->err = MPG123_BAD_INDEX_CACHE;
+		return MPG123_ERR;
+	}
+	size = INDEX_CACHE_FIELDS*8 + fr->index.fill*8 + INDEX_CACHE_REACH(fr->index.fill)*8 + 8;
+	buf = malloc(size);
+	if(buf == NULL)
+	{
+		fr->err = MPG123_OUT_OF_MEM;
+		return MPG123_ERR;
+	}
+	val[1]  = INDEX_CACHE_VERSION;
+	val[2]  = st.size;
+	val[3]  = st.mtime;
+	val[4]  = st.hash;
+	val[5]  = fr->audio_start;
+	val[6]  = fr->track_frames;
+	val[7]  = fr->track_samples;
+#ifdef GAPLESS
+	val[8]  = fr->gapless_frames;
+	val[9]  = fr->begin_s;
+	val[10] = fr->end_s;
+#else
+	val[8] = val[9] = val[10] = 0;
+#endif
+	val[11] = (fr->state_flags & FRAME_FRANKENSTEIN) ? INDEX_CACHE_FRANKENSTEIN : 0;
+	val[12] = fr->index.reach_end;
+	val[13] = fr->index.step;
+	val[14] = (off_t)fr->index.fill;
+	memcpy(buf, "mpg123ix", 8);
+	for(i=1; i<INDEX_CACHE_FIELDS; ++i)
+	put_off(buf+8*i, val[i]);
+	for(i=0; i<fr->index.fill; ++i)
+	put_off(buf+INDEX_CACHE_FIELDS*8+8*i, fi_get(&fr->index, i));
+	memset(buf+INDEX_CACHE_FIELDS*8+fr->index.fill*8, 0, INDEX_CACHE_REACH(fr->index.fill)*8);
+	for(i=0; i<fr->index.fill; ++i)
+	buf[INDEX_CACHE_FIELDS*8+fr->index.fill*8+i] = fi_entry_reach(&fr->index, i);
+	put_off(buf+size-8, (off_t)index_hash(INDEX_HASH_INIT, buf, size-8));
+
+	ret = MPG123_ERR;
+	fd = compat_open(path, O_WRONLY|O_CREAT|O_TRUNC|O_BINARY);
+	if(fd >= 0)
+	{
+		if(write_all(fd, buf, size) == 0) ret = MPG123_OK;
+		if(compat_close(fd) != 0) ret = MPG123_ERR;
+	}
+	free(buf);
+	if(ret != MPG123_OK)
+	{
+		if(NOQUIET) error2("cannot write index cache %s: %s", path, strerror(errno));
+		fr->err = MPG123_BAD_FILE;
+	}
+	return ret;
+}
+
+/* The cache file for the currently open file, allocated. */
+static char *index_cache_path(mpg123_handle *fr)
+{
+	uint32_t hash;
+	size_t dirlen;
+	char *path;
+
+	if(fr->index_cache_dir == NULL || fr->rdat.filename == NULL) return NULL;
+	hash = index_hash( INDEX_HASH_INIT
+	,	(const unsigned char*)fr->rdat.filename, strlen(fr->rdat.filename) );
+	dirlen = strlen(fr->index_cache_dir);
+	path = malloc(dirlen+1+8+sizeof(INDEX_CACHE_SUFFIX));
+	if(path != NULL)
+	sprintf(path, "%s/%08lx%s", fr->index_cache_dir, (unsigned long)hash, INDEX_CACHE_SUFFIX);
+	return path;
+}
+
+void index_cache_lookup(mpg123_handle *fr)
+{
+	char *path = index_cache_path(fr);
+	if(path == NULL) return;
+	/* No cache file or a stale one: just no help this time. */
+	if(index_cache_load(fr, path) != MPG123_OK) fr->err = MPG123_OK;
+	free(path);
+}
+
+void index_cache_store(mpg123_handle *fr)
+{
+	char *path = index_cache_path(fr);
+	if(path == NULL) return;
+	/* Not being able to store it only costs time later. */
+	if(index_cache_save(fr, path) != MPG123_OK) fr->err = MPG123_OK;
+	free(path);
+}
+
+#endif
@@ -26,6 +26,8 @@
 #define synth_1to1_stereo_x86_64 INT123_synth_1to1_stereo_x86_64
 #define synth_1to1_avx INT123_synth_1to1_avx
 #define synth_1to1_stereo_avx INT123_synth_1to1_stereo_avx
+#define synth_1to1_avx512 INT123_synth_1to1_avx512
+#define synth_1to1_stereo_avx512 INT123_synth_1to1_stereo_avx512
 #define synth_1to1_arm INT123_synth_1to1_arm
 #define synth_1to1_neon INT123_synth_1to1_neon
 #define synth_1to1_stereo_neon INT123_synth_1to1_stereo_neon
@@ -45,6 +47,10 @@
 #define synth_ntom INT123_synth_ntom
 #define synth_ntom_mono INT123_synth_ntom_mono
 #define synth_ntom_m2s INT123_synth_ntom_m2s
+#define synth_resample INT123_synth_resample
+#define synth_resample_stereo INT123_synth_resample_stereo
+#define synth_resample_mono INT123_synth_resample_mono
+#define synth_resample_m2s INT123_synth_resample_m2s
 #define synth_1to1_8bit INT123_synth_1to1_8bit
 #define synth_1to1_8bit_i386 INT123_synth_1to1_8bit_i386
 #define synth_1to1_8bit_wrap INT123_synth_1to1_8bit_wrap
@@ -52,6 +58,7 @@
 #define synth_1to1_8bit_m2s INT123_synth_1to1_8bit_m2s
 #define synth_1to1_8bit_wrap_mono INT123_synth_1to1_8bit_wrap_mono
 #define synth_1to1_8bit_wrap_m2s INT123_synth_1to1_8bit_wrap_m2s
+#define synth_1to1_8bit_wrap_stereo INT123_synth_1to1_8bit_wrap_stereo
 #define synth_2to1_8bit INT123_synth_2to1_8bit
 #define synth_2to1_8bit_i386 INT123_synth_2to1_8bit_i386
 #define synth_2to1_8bit_mono INT123_synth_2to1_8bit_mono
@@ -63,6 +70,10 @@
 #define synth_ntom_8bit INT123_synth_ntom_8bit
 #define synth_ntom_8bit_mono INT123_synth_ntom_8bit_mono
 #define synth_ntom_8bit_m2s INT123_synth_ntom_8bit_m2s
+#define synth_resample_8bit INT123_synth_resample_8bit
+#define synth_resample_8bit_stereo INT123_synth_resample_8bit_stereo
+#define synth_resample_8bit_mono INT123_synth_resample_8bit_mono
+#define synth_resample_8bit_m2s INT123_synth_resample_8bit_m2s
 #define synth_1to1_real INT123_synth_1to1_real
 #define synth_1to1_real_i386 INT123_synth_1to1_real_i386
 #define synth_1to1_real_sse INT123_synth_1to1_real_sse
@@ -71,12 +82,19 @@
 #define synth_1to1_real_stereo_x86_64 INT123_synth_1to1_real_stereo_x86_64
 #define synth_1to1_real_avx INT123_synth_1to1_real_avx
 #define synth_1to1_real_stereo_avx INT123_synth_1to1_real_stereo_avx
+#define synth_1to1_real_avx512 INT123_synth_1to1_real_avx512
+#define synth_1to1_real_stereo_avx512 INT123_synth_1to1_real_stereo_avx512
+#define synth_1to1_real_stereo_planar_avx512 INT123_synth_1to1_real_stereo_planar_avx512
+#define synth_1to1_real_m2s_planar_avx512 INT123_synth_1to1_real_m2s_planar_avx512
 #define synth_1to1_real_altivec INT123_synth_1to1_real_altivec
 #define synth_1to1_real_stereo_altivec INT123_synth_1to1_real_stereo_altivec
 #define synth_1to1_real_neon INT123_synth_1to1_real_neon
 #define synth_1to1_real_stereo_neon INT123_synth_1to1_real_stereo_neon
 #define synth_1to1_real_mono INT123_synth_1to1_real_mono
 #define synth_1to1_real_m2s INT123_synth_1to1_real_m2s
+#define synth_1to1_real_planar INT123_synth_1to1_real_planar
+#define synth_1to1_real_stereo_planar INT123_synth_1to1_real_stereo_planar
+#define synth_1to1_real_m2s_planar INT123_synth_1to1_real_m2s_planar
 #define synth_2to1_real INT123_synth_2to1_real
 #define synth_2to1_real_i386 INT123_synth_2to1_real_i386
 #define synth_2to1_real_mono INT123_synth_2to1_real_mono
@@ -88,6 +106,10 @@
 #define synth_ntom_real INT123_synth_ntom_real
 #define synth_ntom_real_mono INT123_synth_ntom_real_mono
 #define synth_ntom_real_m2s INT123_synth_ntom_real_m2s
+#define synth_resample_real INT123_synth_resample_real
+#define synth_resample_real_stereo INT123_synth_resample_real_stereo
+#define synth_resample_real_mono INT123_synth_resample_real_mono
+#define synth_resample_real_m2s INT123_synth_resample_real_m2s
 #define synth_1to1_s32 INT123_synth_1to1_s32
 #define synth_1to1_s32_i386 INT123_synth_1to1_s32_i386
 #define synth_1to1_s32_sse INT123_synth_1to1_s32_sse
@@ -96,6 +118,8 @@
 #define synth_1to1_s32_stereo_x86_64 INT123_synth_1to1_s32_stereo_x86_64
 #define synth_1to1_s32_avx INT123_synth_1to1_s32_avx
 #define synth_1to1_s32_stereo_avx INT123_synth_1to1_s32_stereo_avx
+#define synth_1to1_s32_avx512 INT123_synth_1to1_s32_avx512
+#define synth_1to1_s32_stereo_avx512 INT123_synth_1to1_s32_stereo_avx512
 #define synth_1to1_s32_altivec INT123_synth_1to1_s32_altivec
 #define synth_1to1_s32_stereo_altivec INT123_synth_1to1_s32_stereo_altivec
 #define synth_1to1_s32_neon INT123_synth_1to1_s32_neon
@@ -113,6 +137,10 @@
 #define synth_ntom_s32 INT123_synth_ntom_s32
 #define synth_ntom_s32_mono INT123_synth_ntom_s32_mono
 #define synth_ntom_s32_m2s INT123_synth_ntom_s32_m2s
+#define synth_resample_s32 INT123_synth_resample_s32
+#define synth_resample_s32_stereo INT123_synth_resample_s32_stereo
+#define synth_resample_s32_mono INT123_synth_resample_s32_mono
+#define synth_resample_s32_m2s INT123_synth_resample_s32_m2s
 #define dct64 INT123_dct64
 #define dct64_i386 INT123_dct64_i386
 #define dct64_altivec INT123_dct64_altivec
@@ -125,7 +153,28 @@
 #define dct36_avx INT123_dct36_avx
 #define dct36_neon INT123_dct36_neon
 #define dct36_neon64 INT123_dct36_neon64
+#define dct12 INT123_dct12
+#define dct12_x86_64 INT123_dct12_x86_64
+#define antialias INT123_antialias
+#define antialias_x86_64 INT123_antialias_x86_64
+#define stereo_ms INT123_stereo_ms
+#define stereo_ms_x86_64 INT123_stereo_ms_x86_64
+#define hybrid_tail INT123_hybrid_tail
+#define hybrid_tail_x86_64 INT123_hybrid_tail_x86_64
+#define dequant12 INT123_dequant12
+#define dequant12_x86_64 INT123_dequant12_x86_64
+#define synth_blocks INT123_synth_blocks
+#define mix12 INT123_mix12
 #define synth_ntom_set_step INT123_synth_ntom_set_step
+#define resample_setup INT123_resample_setup
+#define resample_reset INT123_resample_reset
+#define resample_flush INT123_resample_flush
+#define resample_synth INT123_resample_synth
+#define resample_synth_stereo INT123_resample_synth_stereo
+#define resample_block INT123_resample_block
+#define resample_fir INT123_resample_fir
+#define resample_fir_x86_64 INT123_resample_fir_x86_64
+#define resample_fir_avx INT123_resample_fir_avx
 #define ntom_val INT123_ntom_val
 #define ntom_frame_outsamples INT123_ntom_frame_outsamples
 #define ntom_frmouts INT123_ntom_frmouts
@@ -138,14 +187,21 @@
 #define init_layer12_table INT123_init_layer12_table
 #define init_layer12_stuff INT123_init_layer12_stuff
 #define prepare_decode_tables INT123_prepare_decode_tables
+#define tabcache_decwin INT123_tabcache_decwin
+#define tabcache_layer INT123_tabcache_layer
+#define tabcache_release INT123_tabcache_release
 #define make_decode_tables INT123_make_decode_tables
 #define make_decode_tables_mmx INT123_make_decode_tables_mmx
 #define init_layer3_gainpow2_mmx INT123_init_layer3_gainpow2_mmx
 #define init_layer12_table_mmx INT123_init_layer12_table_mmx
 #define make_conv16to8_table INT123_make_conv16to8_table
 #define do_layer3 INT123_do_layer3
+#define III_frame_stats INT123_III_frame_stats
+#define layer3_pipe_exit INT123_layer3_pipe_exit
 #define do_layer2 INT123_do_layer2
+#define II_frame_stats INT123_II_frame_stats
 #define do_layer1 INT123_do_layer1
+#define I_frame_stats INT123_I_frame_stats
 #define do_equalizer INT123_do_equalizer
 #define dither_table_init INT123_dither_table_init
 #define frame_dither_init INT123_frame_dither_init
@@ -155,9 +211,14 @@
 #define frame_outbuffer INT123_frame_outbuffer
 #define frame_output_format INT123_frame_output_format
 #define frame_buffers INT123_frame_buffers
+#define frame_layer_buffers INT123_frame_layer_buffers
 #define frame_reset INT123_frame_reset
 #define frame_buffers_reset INT123_frame_buffers_reset
 #define frame_exit INT123_frame_exit
+#define frame_tap INT123_frame_tap
+#define loudness_add INT123_loudness_add
+#define loudness_reset INT123_loudness_reset
+#define loudness_exit INT123_loudness_exit
 #define frame_index_find INT123_frame_index_find
 #define frame_index_setup INT123_frame_index_setup
 #define do_volume INT123_do_volume
@@ -193,8 +254,15 @@
 #define fi_exit INT123_fi_exit
 #define fi_resize INT123_fi_resize
 #define fi_add INT123_fi_add
+#define fi_compact INT123_fi_compact
+#define fi_get INT123_fi_get
+#define fi_positions INT123_fi_positions
 #define fi_set INT123_fi_set
 #define fi_reset INT123_fi_reset
+#define fi_reservoir INT123_fi_reservoir
+#define fi_reach INT123_fi_reach
+#define fi_entry_reach INT123_fi_entry_reach
+#define fi_set_reach INT123_fi_set_reach
 #define double_to_long_rounded INT123_double_to_long_rounded
 #define scale_rounded INT123_scale_rounded
 #define decode_update INT123_decode_update
@@ -212,14 +280,31 @@
 #define read_frame_recover INT123_read_frame_recover
 #define read_frame INT123_read_frame
 #define set_pointer INT123_set_pointer
+#define layer3_reservoir INT123_layer3_reservoir
 #define position_info INT123_position_info
 #define compute_bpf INT123_compute_bpf
+#define header_frame_info INT123_header_frame_info
 #define time_to_frame INT123_time_to_frame
 #define get_songlen INT123_get_songlen
+#define scan_frames INT123_scan_frames
+#define index_cache_load INT123_index_cache_load
+#define index_cache_save INT123_index_cache_save
+#define index_cache_apply INT123_index_cache_apply
+#define index_cache_free INT123_index_cache_free
+#define index_cache_lookup INT123_index_cache_lookup
+#define index_cache_store INT123_index_cache_store
 #define open_stream INT123_open_stream
 #define open_stream_handle INT123_open_stream_handle
+#define open_memory INT123_open_memory
+#define readahead_start INT123_readahead_start
+#define readahead_stop INT123_readahead_stop
+#define readahead_read INT123_readahead_read
+#define readahead_seek INT123_readahead_seek
+#define readahead_state INT123_readahead_state
 #define open_feed INT123_open_feed
 #define feed_more INT123_feed_more
+#define feed_borrow INT123_feed_borrow
+#define feed_end INT123_feed_end
 #define feed_forget INT123_feed_forget
 #define feed_set_pos INT123_feed_set_pos
 #define open_bad INT123_open_bad
@@ -233,6 +318,7 @@
 #define dct64_real_x86_64 INT123_dct64_real_x86_64
 #define dct64_avx INT123_dct64_avx
 #define dct64_real_avx INT123_dct64_real_avx
+#define dct64_real_stereo_avx512 INT123_dct64_real_stereo_avx512
 #define dct64_neon INT123_dct64_neon
 #define dct64_real_neon INT123_dct64_real_neon
 #define dct64_neon64 INT123_dct64_neon64
@@ -262,6 +348,10 @@
 #define synth_1to1_s_avx_accurate_asm INT123_synth_1to1_s_avx_accurate_asm
 #define synth_1to1_real_s_avx_asm INT123_synth_1to1_real_s_avx_asm
 #define synth_1to1_s32_s_avx_asm INT123_synth_1to1_s32_s_avx_asm
+#define synth_1to1_s_avx512_asm INT123_synth_1to1_s_avx512_asm
+#define synth_1to1_real_s_avx512_asm INT123_synth_1to1_real_s_avx512_asm
+#define synth_1to1_real_p_avx512_asm INT123_synth_1to1_real_p_avx512_asm
+#define synth_1to1_s32_s_avx512_asm INT123_synth_1to1_s32_s_avx512_asm
 #define synth_1to1_neon_asm INT123_synth_1to1_neon_asm
 #define synth_1to1_neon_accurate_asm INT123_synth_1to1_neon_accurate_asm
 #define synth_1to1_real_neon_asm INT123_synth_1to1_real_neon_asm
@@ -0,0 +1,503 @@
+/*
+	l12_float_tables.h: Layer 1 and 2 constant tables for floating point decoders
+
+	generated by calctables.c, do not edit, run "make tables" instead
+
+	copyright 1995-2016 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+*/
+
+#ifndef MPG123_L12_FLOAT_TABLES_H
+#define MPG123_L12_FLOAT_TABLES_H
+
+static const double layer12_table[27][63] =
+{
+	{
+		0, 0, 0, 0,
+		0, 0, 0, 0,
+		0, 0, 0, 0,
+		0, 0, 0, 0,
+		0, 0, 0, 0,
+		0, 0, 0, 0,
+		0, 0, 0, 0,
+		0, 0, 0, 0,
+		0, 0, 0, 0,
+		0, 0, 0, 0,
+		0, 0, 0, 0,
+		0, 0, 0, 0,
+		0, 0, 0, 0,
+		0, 0, 0, 0,
+		0, 0, 0, 0,
+		0, 0, 0
+	},
+	{
+		-1.3333333333333333, -1.0582673679787995, -0.83994736659658209, -0.66666666666666663,
+		-0.52913368398939986, -0.41997368329829105, -0.33333333333333331, -0.26456684199469993,
+		-0.20998684164914552, -0.16666666666666666, -0.13228342099734994, -0.10499342082457276,
+		-0.083333333333333329, -0.066141710498674969, -0.052496710412286381, -0.041666666666666664,
+		-0.033070855249337491, -0.026248355206143187, -0.020833333333333332, -0.016535427624668746,
+		-0.013124177603071593, -0.010416666666666666, -0.0082677138123343728, -0.0065620888015357967,
+		-0.005208333333333333, -0.0041338569061671864, -0.0032810444007678984, -0.0026041666666666665,
+		-0.0020669284530835923, -0.00164052220038395, -0.0013020833333333333, -0.0010334642265417962,
+		-0.00082026110019197502, -0.00065104166666666663, -0.00051673211327089809, -0.00041013055009598751,
+		-0.00032552083333333332, -0.00025836605663544904, -0.00020506527504799376, -0.00016276041666666666,
+		-0.00012918302831772452, -0.00010253263752399688, -8.1380208333333329e-05, -6.4591514158862261e-05,
+		-5.1266318761998439e-05, -4.0690104166666664e-05, -3.229575707943113e-05, -2.5633159380999219e-05,
+		-2.0345052083333332e-05, -1.6147878539715565e-05, -1.281657969049961e-05, -1.0172526041666666e-05,
+		-8.073939269857791e-06, -6.4082898452497964e-06, -5.0862630208333331e-06, -4.0369696349288955e-06,
+		-3.2041449226248982e-06, -2.5431315104166665e-06, -2.0184848174644478e-06, -1.6020724613124491e-06,
+		-1.2715657552083333e-06, -1.0092424087322239e-06, -8.0103623065622455e-07
+	},
+	{
+		1.3333333333333333, 1.0582673679787995, 0.83994736659658209, 0.66666666666666663,
+		0.52913368398939986, 0.41997368329829105, 0.33333333333333331, 0.26456684199469993,
+		0.20998684164914552, 0.16666666666666666, 0.13228342099734994, 0.10499342082457276,
+		0.083333333333333329, 0.066141710498674969, 0.052496710412286381, 0.041666666666666664,
+		0.033070855249337491, 0.026248355206143187, 0.020833333333333332, 0.016535427624668746,
+		0.013124177603071593, 0.010416666666666666, 0.0082677138123343728, 0.0065620888015357967,
+		0.005208333333333333, 0.0041338569061671864, 0.0032810444007678984, 0.0026041666666666665,
+		0.0020669284530835923, 0.00164052220038395, 0.0013020833333333333, 0.0010334642265417962,
+		0.00082026110019197502, 0.00065104166666666663, 0.00051673211327089809, 0.00041013055009598751,
+		0.00032552083333333332, 0.00025836605663544904, 0.00020506527504799376, 0.00016276041666666666,
+		0.00012918302831772452, 0.00010253263752399688, 8.1380208333333329e-05, 6.4591514158862261e-05,
+		5.1266318761998439e-05, 4.0690104166666664e-05, 3.229575707943113e-05, 2.5633159380999219e-05,
+		2.0345052083333332e-05, 1.6147878539715565e-05, 1.281657969049961e-05, 1.0172526041666666e-05,
+		8.073939269857791e-06, 6.4082898452497964e-06, 5.0862630208333331e-06, 4.0369696349288955e-06,
+		3.2041449226248982e-06, 2.5431315104166665e-06, 2.0184848174644478e-06, 1.6020724613124491e-06,
+		1.2715657552083333e-06, 1.0092424087322239e-06, 8.0103623065622455e-07
+	},
+	{
+		0.5714285714285714, 0.45354315770519982, 0.35997744282710659, 0.2857142857142857,
+		0.22677157885259994, 0.17998872141355329, 0.14285714285714285, 0.11338578942629997,
+		0.089994360706776647, 0.071428571428571425, 0.056692894713149977, 0.044997180353388323,
+		0.035714285714285712, 0.028346447356574989, 0.022498590176694162, 0.017857142857142856,
+		0.014173223678287498, 0.011249295088347079, 0.0089285714285714281, 0.0070866118391437489,
+		0.0056246475441735395, 0.004464285714285714, 0.0035433059195718744, 0.0028123237720867698,
+		0.002232142857142857, 0.0017716529597859372, 0.0014061618860433849, 0.0011160714285714285,
+		0.00088582647989296807, 0.00070308094302169288, 0.00055803571428571425, 0.00044291323994648403,
+		0.00035154047151084644, 0.00027901785714285713, 0.00022145661997324202, 0.00017577023575542322,
+		0.00013950892857142856, 0.00011072830998662101, 8.788511787771161e-05, 6.9754464285714282e-05,
+		5.5364154993310504e-05, 4.3942558938855805e-05, 3.4877232142857141e-05, 2.7682077496655252e-05,
+		2.1971279469427902e-05, 1.743861607142857e-05, 1.3841038748327626e-05, 1.0985639734713951e-05,
+		8.7193080357142852e-06, 6.920519374163813e-06, 5.4928198673569756e-06, 4.3596540178571426e-06,
+		3.4602596870819103e-06, 2.7464099336784844e-06, 2.1798270089285713e-06, 1.7301298435409552e-06,
+		1.3732049668392422e-06, 1.0899135044642857e-06, 8.6506492177047758e-07, 6.866024834196211e-07,
+		5.4495675223214283e-07, 4.3253246088523879e-07, 3.4330124170981055e-07
+	},
+	{
+		0.26666666666666666, 0.21165347359575992, 0.16798947331931643, 0.13333333333333333,
+		0.10582673679787998, 0.083994736659658217, 0.066666666666666666, 0.052913368398939988,
+		0.041997368329829109, 0.033333333333333333, 0.02645668419946999, 0.020998684164914554,
+		0.016666666666666666, 0.013228342099734995, 0.010499342082457277, 0.0083333333333333332,
+		0.0066141710498674993, 0.0052496710412286377, 0.0041666666666666666, 0.0033070855249337497,
+		0.0026248355206143189, 0.0020833333333333333, 0.0016535427624668748, 0.0013124177603071594,
+		0.0010416666666666667, 0.00082677138123343741, 0.00065620888015357971, 0.00052083333333333333,
+		0.00041338569061671844, 0.00032810444007679002, 0.00026041666666666666, 0.00020669284530835922,
+		0.00016405222003839501, 0.00013020833333333333, 0.00010334642265417961, 8.2026110019197505e-05,
+		6.5104166666666666e-05, 5.1673211327089804e-05, 4.1013055009598752e-05, 3.2552083333333333e-05,
+		2.5836605663544902e-05, 2.0506527504799376e-05, 1.6276041666666666e-05, 1.2918302831772451e-05,
+		1.0253263752399688e-05, 8.1380208333333332e-06, 6.4591514158862256e-06, 5.1266318761998441e-06,
+		4.0690104166666666e-06, 3.2295757079431128e-06, 2.563315938099922e-06, 2.0345052083333333e-06,
+		1.6147878539715583e-06, 1.2816579690499593e-06, 1.0172526041666667e-06, 8.0739392698577915e-07,
+		6.4082898452497966e-07, 5.0862630208333333e-07, 4.0369696349288957e-07, 3.2041449226248983e-07,
+		2.5431315104166666e-07, 2.0184848174644479e-07, 1.6020724613124492e-07
+	},
+	{
+		0.12903225806451613, 0.10241297109472254, 0.081285229025475692, 0.064516129032258063,
+		0.051206485547361277, 0.040642614512737846, 0.032258064516129031, 0.025603242773680639,
+		0.020321307256368923, 0.016129032258064516, 0.012801621386840318, 0.010160653628184461,
+		0.0080645161290322578, 0.0064008106934201588, 0.0050803268140922307, 0.0040322580645161289,
+		0.0032004053467100803, 0.0025401634070461149, 0.0020161290322580645, 0.0016002026733550401,
+		0.0012700817035230575, 0.0010080645161290322, 0.00080010133667752007, 0.00063504085176152873,
+		0.00050403225806451612, 0.00040005066833876003, 0.00031752042588076437, 0.00025201612903225806,
+		0.00020002533416937991, 0.00015876021294038226, 0.00012600806451612903, 0.00010001266708468995,
+		7.9380106470191132e-05, 6.3004032258064514e-05, 5.0006333542344977e-05, 3.9690053235095566e-05,
+		3.1502016129032257e-05, 2.5003166771172489e-05, 1.9845026617547783e-05, 1.5751008064516129e-05,
+		1.2501583385586244e-05, 9.9225133087738915e-06, 7.8755040322580643e-06, 6.2507916927931221e-06,
+		4.9612566543869458e-06, 3.9377520161290321e-06, 3.1253958463965611e-06, 2.4806283271934729e-06,
+		1.9688760080645161e-06, 1.5626979231982805e-06, 1.2403141635967364e-06, 9.8443800403225804e-07,
+		7.8134896159914111e-07, 6.2015708179836748e-07, 4.9221900201612902e-07, 3.9067448079957056e-07,
+		3.1007854089918374e-07, 2.4610950100806451e-07, 1.9533724039978528e-07, 1.5503927044959187e-07,
+		1.2305475050403225e-07, 9.7668620199892639e-08, 7.7519635224795935e-08
+	},
+	{
+		0.063492063492063489, 0.050393684189466645, 0.039997493647456292, 0.031746031746031744,
+		0.025196842094733326, 0.019998746823728146, 0.015873015873015872, 0.012598421047366663,
+		0.009999373411864073, 0.0079365079365079361, 0.0062992105236833306, 0.0049996867059320365,
+		0.003968253968253968, 0.0031496052618416653, 0.0024998433529660182, 0.001984126984126984,
+		0.0015748026309208331, 0.0012499216764830089, 0.00099206349206349201, 0.00078740131546041654,
+		0.00062496083824150445, 0.000496031746031746, 0.00039370065773020827, 0.00031248041912075223,
+		0.000248015873015873, 0.00019685032886510414, 0.00015624020956037611, 0.0001240079365079365,
+		9.8425164432552014e-05, 7.8120104780188097e-05, 6.2003968253968251e-05, 4.9212582216276007e-05,
+		3.9060052390094049e-05, 3.1001984126984125e-05, 2.4606291108138003e-05, 1.9530026195047024e-05,
+		1.5500992063492063e-05, 1.2303145554069002e-05, 9.7650130975235122e-06, 7.7504960317460313e-06,
+		6.1515727770345009e-06, 4.8825065487617561e-06, 3.8752480158730157e-06, 3.0757863885172504e-06,
+		2.441253274380878e-06, 1.9376240079365078e-06, 1.5378931942586252e-06, 1.220626637190439e-06,
+		9.6881200396825391e-07, 7.6894659712931261e-07, 6.1031331859521951e-07, 4.8440600198412696e-07,
+		3.8447329856465673e-07, 3.0515665929760938e-07, 2.4220300099206348e-07, 1.9223664928232836e-07,
+		1.5257832964880469e-07, 1.2110150049603174e-07, 9.6118324641164182e-08, 7.6289164824402346e-08,
+		6.055075024801587e-08, 4.8059162320582091e-08, 3.8144582412201173e-08
+	},
+	{
+		0.031496062992125984, 0.024998441763278728, 0.019841276376297217, 0.015748031496062992,
+		0.012499220881639366, 0.0099206381881486085, 0.007874015748031496, 0.0062496104408196829,
+		0.0049603190940743043, 0.003937007874015748, 0.003124805220409841, 0.0024801595470371521,
+		0.001968503937007874, 0.0015624026102049205, 0.0012400797735185761, 0.00098425196850393699,
+		0.00078120130510246047, 0.00062003988675928782, 0.0004921259842519685, 0.00039060065255123024,
+		0.00031001994337964391, 0.00024606299212598425, 0.00019530032627561512, 0.00015500997168982195,
+		0.00012303149606299212, 9.7650163137807559e-05, 7.7504985844910977e-05, 6.1515748031496062e-05,
+		4.8825081568903752e-05, 3.8752492922455516e-05, 3.0757874015748031e-05, 2.4412540784451876e-05,
+		1.9376246461227758e-05, 1.5378937007874016e-05, 1.2206270392225938e-05, 9.6881232306138789e-06,
+		7.6894685039370078e-06, 6.103135196112969e-06, 4.8440616153069395e-06, 3.8447342519685039e-06,
+		3.0515675980564845e-06, 2.4220308076534697e-06, 1.9223671259842519e-06, 1.5257837990282423e-06,
+		1.2110154038267349e-06, 9.6118356299212597e-07, 7.6289189951412113e-07, 6.0550770191336743e-07,
+		4.8059178149606299e-07, 3.8144594975706057e-07, 3.0275385095668372e-07, 2.4029589074803149e-07,
+		1.9072297487853052e-07, 1.5137692547834165e-07, 1.2014794537401575e-07, 9.536148743926526e-08,
+		7.5688462739170823e-08, 6.0073972687007873e-08, 4.768074371963263e-08, 3.7844231369585412e-08,
+		3.0036986343503937e-08, 2.3840371859816315e-08, 1.8922115684792706e-08
+	},
+	{
+		0.015686274509803921, 0.012450204329162348, 0.0098817337246656714, 0.0078431372549019607,
+		0.0062251021645811748, 0.0049408668623328357, 0.0039215686274509803, 0.0031125510822905874,
+		0.0024704334311664179, 0.0019607843137254902, 0.0015562755411452935, 0.0012352167155832089,
+		0.00098039215686274508, 0.00077813777057264674, 0.00061760835779160446, 0.00049019607843137254,
+		0.00038906888528632348, 0.00030880417889580218, 0.00024509803921568627, 0.00019453444264316174,
+		0.00015440208944790109, 0.00012254901960784314, 9.726722132158087e-05, 7.7201044723950544e-05,
+		6.1274509803921568e-05, 4.8633610660790435e-05, 3.8600522361975272e-05, 3.0637254901960784e-05,
+		2.4316805330395204e-05, 1.9300261180987646e-05, 1.5318627450980392e-05, 1.2158402665197602e-05,
+		9.6501305904938231e-06, 7.659313725490196e-06, 6.079201332598801e-06, 4.8250652952469116e-06,
+		3.829656862745098e-06, 3.0396006662994005e-06, 2.4125326476234558e-06, 1.914828431372549e-06,
+		1.5198003331497002e-06, 1.2062663238117279e-06, 9.574142156862745e-07, 7.5990016657485012e-07,
+		6.0313316190586394e-07, 4.7870710784313725e-07, 3.7995008328742506e-07, 3.0156658095293197e-07,
+		2.3935355392156862e-07, 1.8997504164371253e-07, 1.5078329047646599e-07, 1.1967677696078431e-07,
+		9.4987520821856371e-08, 7.53916452382329e-08, 5.9838388480392156e-08, 4.7493760410928186e-08,
+		3.769582261911645e-08, 2.9919194240196078e-08, 2.3746880205464093e-08, 1.8847911309558225e-08,
+		1.4959597120098039e-08, 1.1873440102732046e-08, 9.4239556547791126e-09
+	},
+	{
+		0.0078277886497064575, 0.0062129199685643805, 0.0049311978469466656, 0.0039138943248532287,
+		0.0031064599842821907, 0.0024655989234733328, 0.0019569471624266144, 0.0015532299921410953,
+		0.0012327994617366664, 0.00097847358121330719, 0.00077661499607054756, 0.0006163997308683332,
+		0.00048923679060665359, 0.00038830749803527378, 0.0003081998654341666, 0.0002446183953033268,
+		0.00019415374901763695, 0.00015409993271708327, 0.0001223091976516634, 9.7076874508818473e-05,
+		7.7049966358541636e-05, 6.1154598825831699e-05, 4.8538437254409236e-05, 3.8524983179270818e-05,
+		3.057729941291585e-05, 2.4269218627204618e-05, 1.9262491589635409e-05, 1.5288649706457925e-05,
+		1.2134609313602302e-05, 9.6312457948177096e-06, 7.6443248532289624e-06, 6.0673046568011512e-06,
+		4.8156228974088548e-06, 3.8221624266144812e-06, 3.0336523284005756e-06, 2.4078114487044274e-06,
+		1.9110812133072406e-06, 1.5168261642002878e-06, 1.2039057243522137e-06, 9.555406066536203e-07,
+		7.5841308210014389e-07, 6.0195286217610685e-07, 4.7777030332681015e-07, 3.7920654105007195e-07,
+		3.0097643108805343e-07, 2.3888515166340507e-07, 1.8960327052503597e-07, 1.5048821554402671e-07,
+		1.1944257583170254e-07, 9.4801635262517987e-08, 7.5244107772013356e-08, 5.9721287915851269e-08,
+		4.7400817631259046e-08, 3.7622053886006632e-08, 2.9860643957925634e-08, 2.3700408815629523e-08,
+		1.8811026943003316e-08, 1.4930321978962817e-08, 1.1850204407814762e-08, 9.405513471501658e-09,
+		7.4651609894814086e-09, 5.9251022039073808e-09, 4.702756735750829e-09
+	},
+	{
+		0.0039100684261974585, 0.0031034233665067435, 0.0024631887583477481, 0.0019550342130987292,
+		0.001551711683253372, 0.0012315943791738741, 0.00097751710654936461, 0.00077585584162668598,
+		0.00061579718958693704, 0.00048875855327468231, 0.00038792792081334293, 0.00030789859479346852,
+		0.00024437927663734115, 0.00019396396040667147, 0.00015394929739673426, 0.00012218963831867058,
+		9.6981980203335761e-05, 7.6974648698367116e-05, 6.1094819159335288e-05, 4.849099010166788e-05,
+		3.8487324349183558e-05, 3.0547409579667644e-05, 2.424549505083394e-05, 1.9243662174591779e-05,
+		1.5273704789833822e-05, 1.212274752541697e-05, 9.6218310872958895e-06, 7.636852394916911e-06,
+		6.0613737627084817e-06, 4.8109155436479473e-06, 3.8184261974584555e-06, 3.0306868813542408e-06,
+		2.4054577718239736e-06, 1.9092130987292278e-06, 1.5153434406771204e-06, 1.2027288859119868e-06,
+		9.5460654936461388e-07, 7.5767172033856021e-07, 6.0136444295599341e-07, 4.7730327468230694e-07,
+		3.788358601692801e-07, 3.0068222147799671e-07, 2.3865163734115347e-07, 1.8941793008464005e-07,
+		1.5034111073899835e-07, 1.1932581867057673e-07, 9.4708965042320026e-08, 7.5170555369499177e-08,
+		5.9662909335288367e-08, 4.7354482521160013e-08, 3.7585277684749588e-08, 2.9831454667644184e-08,
+		2.3677241260580033e-08, 1.8792638842374771e-08, 1.4915727333822092e-08, 1.1838620630290016e-08,
+		9.3963194211873855e-09, 7.4578636669110459e-09, 5.9193103151450082e-09, 4.6981597105936927e-09,
+		3.728931833455523e-09, 2.9596551575725041e-09, 2.3490798552968464e-09
+	},
+	{
+		0.0019540791402051783, 0.0015509536413954072, 0.0012309927209524897, 0.00097703957010258913,
+		0.00077547682069770368, 0.00061549636047624487, 0.00048851978505129456, 0.00038773841034885184,
+		0.00030774818023812244, 0.00024425989252564728, 0.00019386920517442589, 0.00015387409011906122,
+		0.00012212994626282364, 9.6934602587212947e-05, 7.6937045059530609e-05, 6.106497313141182e-05,
+		4.8467301293606487e-05, 3.8468522529765298e-05, 3.053248656570591e-05, 2.4233650646803244e-05,
+		1.9234261264882649e-05, 1.5266243282852955e-05, 1.2116825323401622e-05, 9.6171306324413244e-06,
+		7.6331216414264776e-06, 6.0584126617008109e-06, 4.8085653162206622e-06, 3.8165608207132388e-06,
+		3.0292063308504037e-06, 2.4042826581103324e-06, 1.9082804103566194e-06, 1.5146031654252019e-06,
+		1.2021413290551662e-06, 9.541402051783097e-07, 7.5730158271260094e-07, 6.010706645275831e-07,
+		4.7707010258915485e-07, 3.7865079135630047e-07, 3.0053533226379155e-07, 2.3853505129457742e-07,
+		1.8932539567815023e-07, 1.5026766613189577e-07, 1.1926752564728871e-07, 9.4662697839075117e-08,
+		7.5133833065947887e-08, 5.9633762823644356e-08, 4.7331348919537559e-08, 3.7566916532973943e-08,
+		2.9816881411822178e-08, 2.3665674459768779e-08, 1.8783458266486972e-08, 1.4908440705911089e-08,
+		1.1832837229884403e-08, 9.3917291332434743e-09, 7.4542203529555445e-09, 5.9164186149422014e-09,
+		4.6958645666217371e-09, 3.7271101764777722e-09, 2.9582093074711007e-09, 2.3479322833108686e-09,
+		1.8635550882388861e-09, 1.4791046537355504e-09, 1.1739661416554343e-09
+	},
+	{
+		0.0009768009768009768, 0.00077528744906871759, 0.00061534605611471217, 0.0004884004884004884,
+		0.00038764372453435885, 0.00030767302805735609, 0.0002442002442002442, 0.00019382186226717942,
+		0.00015383651402867804, 0.0001221001221001221, 9.6910931133589699e-05, 7.6918257014339022e-05,
+		6.105006105006105e-05, 4.8455465566794849e-05, 3.8459128507169511e-05, 3.0525030525030525e-05,
+		2.4227732783397431e-05, 1.9229564253584752e-05, 1.5262515262515263e-05, 1.2113866391698716e-05,
+		9.614782126792376e-06, 7.6312576312576313e-06, 6.0569331958493579e-06, 4.807391063396188e-06,
+		3.8156288156288156e-06, 3.0284665979246789e-06, 2.403695531698094e-06, 1.9078144078144078e-06,
+		1.5142332989623386e-06, 1.2018477658490476e-06, 9.5390720390720391e-07, 7.5711664948116931e-07,
+		6.0092388292452382e-07, 4.7695360195360195e-07, 3.7855832474058465e-07, 3.0046194146226191e-07,
+		2.3847680097680098e-07, 1.8927916237029233e-07, 1.5023097073113095e-07, 1.1923840048840049e-07,
+		9.4639581185146163e-08, 7.5115485365565477e-08, 5.9619200244200244e-08, 4.7319790592573082e-08,
+		3.7557742682782739e-08, 2.9809600122100122e-08, 2.3659895296286541e-08, 1.8778871341391369e-08,
+		1.4904800061050061e-08, 1.182994764814327e-08, 9.3894356706956847e-09, 7.4524000305250305e-09,
+		5.9149738240716418e-09, 4.6947178353478366e-09, 3.7262000152625153e-09, 2.9574869120358209e-09,
+		2.3473589176739183e-09, 1.8631000076312576e-09, 1.4787434560179105e-09, 1.1736794588369591e-09,
+		9.3155000381562881e-10, 7.3937172800895523e-10, 5.8683972941847957e-10
+	},
+	{
+		0.00048834086192162129, 0.0003875963989667194, 0.00030763546572942823, 0.00024417043096081065,
+		0.00019379819948335973, 0.00015381773286471411, 0.00012208521548040532, 9.6899099741679863e-05,
+		7.6908866432357057e-05, 6.1042607740202661e-05, 4.8449549870839925e-05, 3.8454433216178528e-05,
+		3.0521303870101331e-05, 2.4224774935419962e-05, 1.9227216608089264e-05, 1.5260651935050665e-05,
+		1.2112387467709985e-05, 9.6136083040446304e-06, 7.6303259675253327e-06, 6.0561937338549923e-06,
+		4.8068041520223152e-06, 3.8151629837626663e-06, 3.0280968669274961e-06, 2.4034020760111576e-06,
+		1.9075814918813332e-06, 1.5140484334637481e-06, 1.2017010380055788e-06, 9.5379074594066659e-07,
+		7.5702421673187361e-07, 6.0085051900278972e-07, 4.7689537297033329e-07, 3.785121083659368e-07,
+		3.0042525950139486e-07, 2.3844768648516665e-07, 1.892560541829684e-07, 1.5021262975069743e-07,
+		1.1922384324258332e-07, 9.4628027091484201e-08, 7.5106314875348715e-08, 5.9611921621291662e-08,
+		4.7314013545742101e-08, 3.7553157437674357e-08, 2.9805960810645831e-08, 2.365700677287105e-08,
+		1.8776578718837179e-08, 1.4902980405322915e-08, 1.1828503386435525e-08, 9.3882893594185893e-09,
+		7.4514902026614577e-09, 5.9142516932177626e-09, 4.6941446797092947e-09, 3.7257451013307288e-09,
+		2.9571258466088846e-09, 2.3470723398546444e-09, 1.8628725506653644e-09, 1.4785629233044423e-09,
+		1.1735361699273222e-09, 9.3143627533268221e-10, 7.3928146165222115e-10, 5.8676808496366111e-10,
+		4.6571813766634111e-10, 3.6964073082611057e-10, 2.9338404248183055e-10
+	},
+	{
+		0.00024415552707074406, 0.00019378637025797466, 0.00015380834400230401, 0.00012207776353537203,
+		9.6893185128987344e-05, 7.6904172001152004e-05, 6.1038881767686015e-05, 4.8446592564493672e-05,
+		3.8452086000576002e-05, 3.0519440883843008e-05, 2.4223296282246833e-05, 1.9226043000288001e-05,
+		1.5259720441921504e-05, 1.2111648141123416e-05, 9.6130215001440004e-06, 7.6298602209607519e-06,
+		6.0558240705617099e-06, 4.8065107500719994e-06, 3.8149301104803759e-06, 3.0279120352808549e-06,
+		2.4032553750359997e-06, 1.907465055240188e-06, 1.5139560176404275e-06, 1.2016276875179998e-06,
+		9.5373252762009399e-07, 7.5697800882021373e-07, 6.0081384375899992e-07, 4.7686626381004699e-07,
+		3.7848900441010665e-07, 3.0040692187950012e-07, 2.384331319050235e-07, 1.8924450220505333e-07,
+		1.5020346093975006e-07, 1.1921656595251175e-07, 9.4622251102526664e-08, 7.510173046987503e-08,
+		5.9608282976255874e-08, 4.7311125551263332e-08, 3.7550865234937515e-08, 2.9804141488127937e-08,
+		2.3655562775631666e-08, 1.8775432617468757e-08, 1.4902070744063969e-08, 1.1827781387815833e-08,
+		9.3877163087343787e-09, 7.4510353720319843e-09, 5.9138906939079165e-09, 4.6938581543671894e-09,
+		3.7255176860159921e-09, 2.9569453469539582e-09, 2.3469290771835947e-09, 1.8627588430079961e-09,
+		1.4784726734769808e-09, 1.1734645385917959e-09, 9.3137942150399803e-10, 7.3923633673849039e-10,
+		5.8673226929589795e-10, 4.6568971075199902e-10, 3.6961816836924519e-10, 2.9336613464794897e-10,
+		2.3284485537599951e-10, 1.848090841846226e-10, 1.4668306732397449e-10
+	},
+	{
+		0.00012207403790398877, 9.6890228093398812e-05, 7.6901825000450037e-05, 6.1037018951994385e-05,
+		4.8445114046699413e-05, 3.8450912500225018e-05, 3.0518509475997192e-05, 2.4222557023349706e-05,
+		1.9225456250112509e-05, 1.5259254737998596e-05, 1.2111278511674852e-05, 9.6127281250562546e-06,
+		7.6296273689992981e-06, 6.0556392558374258e-06, 4.8063640625281273e-06, 3.814813684499649e-06,
+		3.0278196279187137e-06, 2.4031820312640632e-06, 1.9074068422498245e-06, 1.5139098139593569e-06,
+		1.2015910156320316e-06, 9.5370342112491226e-07, 7.5695490697967843e-07, 6.0079550781601581e-07,
+		4.7685171056245613e-07, 3.7847745348983922e-07, 3.003977539080079e-07, 2.3842585528122806e-07,
+		1.892387267449195e-07, 1.5019887695400403e-07, 1.1921292764061403e-07, 9.4619363372459751e-08,
+		7.5099438477002015e-08, 5.9606463820307016e-08, 4.7309681686229876e-08, 3.7549719238501008e-08,
+		2.9803231910153508e-08, 2.3654840843114938e-08, 1.8774859619250504e-08, 1.4901615955076754e-08,
+		1.1827420421557469e-08, 9.3874298096252519e-09, 7.450807977538377e-09, 5.9137102107787345e-09,
+		4.693714904812626e-09, 3.7254039887691885e-09, 2.9568551053893672e-09, 2.346857452406313e-09,
+		1.8627019943845943e-09, 1.4784275526946836e-09, 1.1734287262031565e-09, 9.3135099719229713e-10,
+		7.3921377634734263e-10, 5.8671436310157752e-10, 4.6567549859614856e-10, 3.6960688817367132e-10,
+		2.9335718155078876e-10, 2.3283774929807428e-10, 1.8480344408683566e-10, 1.4667859077539438e-10,
+		1.1641887464903714e-10, 9.2401722043417829e-11, 7.333929538769719e-11
+	},
+	{
+		6.1036087586785687e-05, 4.8444374821643374e-05, 3.8450325776909233e-05, 3.0518043793392844e-05,
+		2.422218741082169e-05, 1.9225162888454616e-05, 1.5259021896696422e-05, 1.2111093705410845e-05,
+		9.6125814442273082e-06, 7.6295109483482109e-06, 6.0555468527054217e-06, 4.8062907221136541e-06,
+		3.8147554741741054e-06, 3.0277734263527109e-06, 2.403145361056827e-06, 1.9073777370870527e-06,
+		1.5138867131763559e-06, 1.2015726805284133e-06, 9.5368886854352636e-07, 7.5694335658817793e-07,
+		6.0078634026420666e-07, 4.7684443427176318e-07, 3.7847167829408896e-07, 3.0039317013210333e-07,
+		2.3842221713588159e-07, 1.8923583914704448e-07, 1.5019658506605166e-07, 1.1921110856794079e-07,
+		9.4617919573522188e-08, 7.5098292533025872e-08, 5.9605554283970397e-08, 4.7308959786761094e-08,
+		3.7549146266512936e-08, 2.9802777141985199e-08, 2.3654479893380547e-08, 1.8774573133256468e-08,
+		1.4901388570992599e-08, 1.1827239946690274e-08, 9.387286566628234e-09, 7.4506942854962997e-09,
+		5.9136199733451368e-09, 4.693643283314117e-09, 3.7253471427481498e-09, 2.9568099866725684e-09,
+		2.3468216416570585e-09, 1.8626735713740749e-09, 1.4784049933362842e-09, 1.1734108208285292e-09,
+		9.3133678568703746e-10, 7.392024966681421e-10, 5.8670541041426462e-10, 4.6566839284351873e-10,
+		3.6960124833407146e-10, 2.9335270520713195e-10, 2.3283419642175937e-10, 1.8480062416703573e-10,
+		1.4667635260356597e-10, 1.1641709821087968e-10, 9.2400312083517865e-11, 7.3338176301782987e-11,
+		5.8208549105439841e-11, 4.6200156041758933e-11, 3.6669088150891494e-11
+	},
+	{
+		-1.6000000000000001, -1.2699208415745595, -1.0079368399158986, -0.80000000000000004,
+		-0.63496042078727988, -0.50396841995794928, -0.40000000000000002, -0.31748021039363994,
+		-0.25198420997897464, -0.20000000000000001, -0.15874010519681994, -0.12599210498948732,
+		-0.10000000000000001, -0.079370052598409971, -0.06299605249474366, -0.050000000000000003,
+		-0.039685026299204999, -0.031498026247371823, -0.025000000000000001, -0.0198425131496025,
+		-0.015749013123685911, -0.012500000000000001, -0.0099212565748012498, -0.0078745065618429557,
+		-0.0062500000000000003, -0.0049606282874006249, -0.0039372532809214779, -0.0031250000000000002,
+		-0.0024803141437003112, -0.0019686266404607402, -0.0015625000000000001, -0.0012401570718501556,
+		-0.00098431332023037011, -0.00078125000000000004, -0.00062007853592507779, -0.00049215666011518506,
+		-0.00039062500000000002, -0.00031003926796253889, -0.00024607833005759253, -0.00019531250000000001,
+		-0.00015501963398126945, -0.00012303916502879626, -9.7656250000000005e-05, -7.7509816990634724e-05,
+		-6.1519582514398132e-05, -4.8828125000000003e-05, -3.8754908495317362e-05, -3.0759791257199066e-05,
+		-2.4414062500000001e-05, -1.9377454247658681e-05, -1.5379895628599533e-05, -1.2207031250000001e-05,
+		-9.6887271238293506e-06, -7.6899478142997564e-06, -6.1035156250000003e-06, -4.8443635619146753e-06,
+		-3.8449739071498782e-06, -3.0517578125000002e-06, -2.4221817809573377e-06, -1.9224869535749391e-06,
+		-1.5258789062500001e-06, -1.2110908904786688e-06, -9.6124347678746954e-07
+	},
+	{
+		-0.80000000000000004, -0.63496042078727977, -0.50396841995794928, -0.40000000000000002,
+		-0.31748021039363994, -0.25198420997897464, -0.20000000000000001, -0.15874010519681997,
+		-0.12599210498948732, -0.10000000000000001, -0.079370052598409971, -0.06299605249474366,
+		-0.050000000000000003, -0.039685026299204985, -0.03149802624737183, -0.025000000000000001,
+		-0.0198425131496025, -0.015749013123685911, -0.012500000000000001, -0.0099212565748012498,
+		-0.0078745065618429557, -0.0062500000000000003, -0.0049606282874006249, -0.0039372532809214779,
+		-0.0031250000000000002, -0.0024803141437003125, -0.0019686266404607389, -0.0015625000000000001,
+		-0.0012401570718501556, -0.00098431332023037011, -0.00078125000000000004, -0.00062007853592507779,
+		-0.00049215666011518506, -0.00039062500000000002, -0.00031003926796253889, -0.00024607833005759253,
+		-0.00019531250000000001, -0.00015501963398126945, -0.00012303916502879626, -9.7656250000000005e-05,
+		-7.7509816990634724e-05, -6.1519582514398132e-05, -4.8828125000000003e-05, -3.8754908495317362e-05,
+		-3.0759791257199066e-05, -2.4414062500000001e-05, -1.9377454247658681e-05, -1.5379895628599533e-05,
+		-1.2207031250000001e-05, -9.6887271238293405e-06, -7.6899478142997665e-06, -6.1035156250000003e-06,
+		-4.8443635619146753e-06, -3.8449739071498782e-06, -3.0517578125000002e-06, -2.4221817809573377e-06,
+		-1.9224869535749391e-06, -1.5258789062500001e-06, -1.2110908904786688e-06, -9.6124347678746954e-07,
+		-7.6293945312500004e-07, -6.0554544523933441e-07, -4.8062173839373477e-07
+	},
+	{
+		0.80000000000000004, 0.63496042078727977, 0.50396841995794928, 0.40000000000000002,
+		0.31748021039363994, 0.25198420997897464, 0.20000000000000001, 0.15874010519681997,
+		0.12599210498948732, 0.10000000000000001, 0.079370052598409971, 0.06299605249474366,
+		0.050000000000000003, 0.039685026299204985, 0.03149802624737183, 0.025000000000000001,
+		0.0198425131496025, 0.015749013123685911, 0.012500000000000001, 0.0099212565748012498,
+		0.0078745065618429557, 0.0062500000000000003, 0.0049606282874006249, 0.0039372532809214779,
+		0.0031250000000000002, 0.0024803141437003125, 0.0019686266404607389, 0.0015625000000000001,
+		0.0012401570718501556, 0.00098431332023037011, 0.00078125000000000004, 0.00062007853592507779,
+		0.00049215666011518506, 0.00039062500000000002, 0.00031003926796253889, 0.00024607833005759253,
+		0.00019531250000000001, 0.00015501963398126945, 0.00012303916502879626, 9.7656250000000005e-05,
+		7.7509816990634724e-05, 6.1519582514398132e-05, 4.8828125000000003e-05, 3.8754908495317362e-05,
+		3.0759791257199066e-05, 2.4414062500000001e-05, 1.9377454247658681e-05, 1.5379895628599533e-05,
+		1.2207031250000001e-05, 9.6887271238293405e-06, 7.6899478142997665e-06, 6.1035156250000003e-06,
+		4.8443635619146753e-06, 3.8449739071498782e-06, 3.0517578125000002e-06, 2.4221817809573377e-06,
+		1.9224869535749391e-06, 1.5258789062500001e-06, 1.2110908904786688e-06, 9.6124347678746954e-07,
+		7.6293945312500004e-07, 6.0554544523933441e-07, 4.8062173839373477e-07
+	},
+	{
+		1.6000000000000001, 1.2699208415745595, 1.0079368399158986, 0.80000000000000004,
+		0.63496042078727988, 0.50396841995794928, 0.40000000000000002, 0.31748021039363994,
+		0.25198420997897464, 0.20000000000000001, 0.15874010519681994, 0.12599210498948732,
+		0.10000000000000001, 0.079370052598409971, 0.06299605249474366, 0.050000000000000003,
+		0.039685026299204999, 0.031498026247371823, 0.025000000000000001, 0.0198425131496025,
+		0.015749013123685911, 0.012500000000000001, 0.0099212565748012498, 0.0078745065618429557,
+		0.0062500000000000003, 0.0049606282874006249, 0.0039372532809214779, 0.0031250000000000002,
+		0.0024803141437003112, 0.0019686266404607402, 0.0015625000000000001, 0.0012401570718501556,
+		0.00098431332023037011, 0.00078125000000000004, 0.00062007853592507779, 0.00049215666011518506,
+		0.00039062500000000002, 0.00031003926796253889, 0.00024607833005759253, 0.00019531250000000001,
+		0.00015501963398126945, 0.00012303916502879626, 9.7656250000000005e-05, 7.7509816990634724e-05,
+		6.1519582514398132e-05, 4.8828125000000003e-05, 3.8754908495317362e-05, 3.0759791257199066e-05,
+		2.4414062500000001e-05, 1.9377454247658681e-05, 1.5379895628599533e-05, 1.2207031250000001e-05,
+		9.6887271238293506e-06, 7.6899478142997564e-06, 6.1035156250000003e-06, 4.8443635619146753e-06,
+		3.8449739071498782e-06, 3.0517578125000002e-06, 2.4221817809573377e-06, 1.9224869535749391e-06,
+		1.5258789062500001e-06, 1.2110908904786688e-06, 9.6124347678746954e-07
+	},
+	{
+		-1.7777777777777777, -1.411023157305066, -1.1199298221287761, -0.88888888888888884,
+		-0.70551157865253311, -0.55996491106438806, -0.44444444444444442, -0.35275578932626656,
+		-0.27998245553219403, -0.22222222222222221, -0.17637789466313325, -0.13999122776609702,
+		-0.1111111111111111, -0.088188947331566625, -0.069995613883048508, -0.055555555555555552,
+		-0.044094473665783326, -0.034997806941524247, -0.027777777777777776, -0.022047236832891663,
+		-0.017498903470762123, -0.013888888888888888, -0.011023618416445832, -0.0087494517353810617,
+		-0.0069444444444444441, -0.0055118092082229158, -0.0043747258676905309, -0.003472222222222222,
+		-0.0027559046041114562, -0.0021873629338452667, -0.001736111111111111, -0.0013779523020557281,
+		-0.0010936814669226334, -0.00086805555555555551, -0.00068897615102786404, -0.00054684073346131668,
+		-0.00043402777777777775, -0.00034448807551393202, -0.00027342036673065834, -0.00021701388888888888,
+		-0.00017224403775696601, -0.00013671018336532917, -0.00010850694444444444, -8.6122018878483005e-05,
+		-6.8355091682664585e-05, -5.4253472222222219e-05, -4.3061009439241503e-05, -3.4177545841332293e-05,
+		-2.712673611111111e-05, -2.1530504719620751e-05, -1.7088772920666146e-05, -1.3563368055555555e-05,
+		-1.0765252359810388e-05, -8.5443864603330613e-06, -6.7816840277777774e-06, -5.3826261799051938e-06,
+		-4.2721932301665306e-06, -3.3908420138888887e-06, -2.6913130899525969e-06, -2.1360966150832653e-06,
+		-1.6954210069444444e-06, -1.3456565449762984e-06, -1.0680483075416327e-06
+	},
+	{
+		-0.88888888888888884, -0.705511578652533, -0.55996491106438806, -0.44444444444444442,
+		-0.35275578932626656, -0.27998245553219403, -0.22222222222222221, -0.17637789466313328,
+		-0.13999122776609702, -0.1111111111111111, -0.088188947331566625, -0.069995613883048508,
+		-0.055555555555555552, -0.044094473665783313, -0.034997806941524254, -0.027777777777777776,
+		-0.022047236832891663, -0.017498903470762123, -0.013888888888888888, -0.011023618416445832,
+		-0.0087494517353810617, -0.0069444444444444441, -0.0055118092082229158, -0.0043747258676905309,
+		-0.003472222222222222, -0.0027559046041114579, -0.0021873629338452654, -0.001736111111111111,
+		-0.0013779523020557281, -0.0010936814669226334, -0.00086805555555555551, -0.00068897615102786404,
+		-0.00054684073346131668, -0.00043402777777777775, -0.00034448807551393202, -0.00027342036673065834,
+		-0.00021701388888888888, -0.00017224403775696601, -0.00013671018336532917, -0.00010850694444444444,
+		-8.6122018878483005e-05, -6.8355091682664585e-05, -5.4253472222222219e-05, -4.3061009439241503e-05,
+		-3.4177545841332293e-05, -2.712673611111111e-05, -2.1530504719620751e-05, -1.7088772920666146e-05,
+		-1.3563368055555555e-05, -1.0765252359810376e-05, -8.5443864603330732e-06, -6.7816840277777774e-06,
+		-5.3826261799051938e-06, -4.2721932301665306e-06, -3.3908420138888887e-06, -2.6913130899525969e-06,
+		-2.1360966150832653e-06, -1.6954210069444444e-06, -1.3456565449762984e-06, -1.0680483075416327e-06,
+		-8.4771050347222218e-07, -6.7282827248814922e-07, -5.3402415377081633e-07
+	},
+	{
+		-0.44444444444444442, -0.3527557893262665, -0.27998245553219403, -0.22222222222222221,
+		-0.17637789466313328, -0.13999122776609702, -0.1111111111111111, -0.088188947331566639,
+		-0.069995613883048508, -0.055555555555555552, -0.044094473665783313, -0.034997806941524254,
+		-0.027777777777777776, -0.022047236832891656, -0.017498903470762127, -0.013888888888888888,
+		-0.011023618416445832, -0.0087494517353810617, -0.0069444444444444441, -0.0055118092082229158,
+		-0.0043747258676905309, -0.003472222222222222, -0.0027559046041114579, -0.0021873629338452654,
+		-0.001736111111111111, -0.0013779523020557289, -0.0010936814669226327, -0.00086805555555555551,
+		-0.00068897615102786404, -0.00054684073346131668, -0.00043402777777777775, -0.00034448807551393202,
+		-0.00027342036673065834, -0.00021701388888888888, -0.00017224403775696601, -0.00013671018336532917,
+		-0.00010850694444444444, -8.6122018878483005e-05, -6.8355091682664585e-05, -5.4253472222222219e-05,
+		-4.3061009439241503e-05, -3.4177545841332293e-05, -2.712673611111111e-05, -2.1530504719620751e-05,
+		-1.7088772920666146e-05, -1.3563368055555555e-05, -1.0765252359810376e-05, -8.5443864603330732e-06,
+		-6.7816840277777774e-06, -5.3826261799051878e-06, -4.2721932301665366e-06, -3.3908420138888887e-06,
+		-2.6913130899525969e-06, -2.1360966150832653e-06, -1.6954210069444444e-06, -1.3456565449762984e-06,
+		-1.0680483075416327e-06, -8.4771050347222218e-07, -6.7282827248814922e-07, -5.3402415377081633e-07,
+		-4.2385525173611109e-07, -3.3641413624407461e-07, -2.6701207688540817e-07
+	},
+	{
+		0.44444444444444442, 0.3527557893262665, 0.27998245553219403, 0.22222222222222221,
+		0.17637789466313328, 0.13999122776609702, 0.1111111111111111, 0.088188947331566639,
+		0.069995613883048508, 0.055555555555555552, 0.044094473665783313, 0.034997806941524254,
+		0.027777777777777776, 0.022047236832891656, 0.017498903470762127, 0.013888888888888888,
+		0.011023618416445832, 0.0087494517353810617, 0.0069444444444444441, 0.0055118092082229158,
+		0.0043747258676905309, 0.003472222222222222, 0.0027559046041114579, 0.0021873629338452654,
+		0.001736111111111111, 0.0013779523020557289, 0.0010936814669226327, 0.00086805555555555551,
+		0.00068897615102786404, 0.00054684073346131668, 0.00043402777777777775, 0.00034448807551393202,
+		0.00027342036673065834, 0.00021701388888888888, 0.00017224403775696601, 0.00013671018336532917,
+		0.00010850694444444444, 8.6122018878483005e-05, 6.8355091682664585e-05, 5.4253472222222219e-05,
+		4.3061009439241503e-05, 3.4177545841332293e-05, 2.712673611111111e-05, 2.1530504719620751e-05,
+		1.7088772920666146e-05, 1.3563368055555555e-05, 1.0765252359810376e-05, 8.5443864603330732e-06,
+		6.7816840277777774e-06, 5.3826261799051878e-06, 4.2721932301665366e-06, 3.3908420138888887e-06,
+		2.6913130899525969e-06, 2.1360966150832653e-06, 1.6954210069444444e-06, 1.3456565449762984e-06,
+		1.0680483075416327e-06, 8.4771050347222218e-07, 6.7282827248814922e-07, 5.3402415377081633e-07,
+		4.2385525173611109e-07, 3.3641413624407461e-07, 2.6701207688540817e-07
+	},
+	{
+		0.88888888888888884, 0.705511578652533, 0.55996491106438806, 0.44444444444444442,
+		0.35275578932626656, 0.27998245553219403, 0.22222222222222221, 0.17637789466313328,
+		0.13999122776609702, 0.1111111111111111, 0.088188947331566625, 0.069995613883048508,
+		0.055555555555555552, 0.044094473665783313, 0.034997806941524254, 0.027777777777777776,
+		0.022047236832891663, 0.017498903470762123, 0.013888888888888888, 0.011023618416445832,
+		0.0087494517353810617, 0.0069444444444444441, 0.0055118092082229158, 0.0043747258676905309,
+		0.003472222222222222, 0.0027559046041114579, 0.0021873629338452654, 0.001736111111111111,
+		0.0013779523020557281, 0.0010936814669226334, 0.00086805555555555551, 0.00068897615102786404,
+		0.00054684073346131668, 0.00043402777777777775, 0.00034448807551393202, 0.00027342036673065834,
+		0.00021701388888888888, 0.00017224403775696601, 0.00013671018336532917, 0.00010850694444444444,
+		8.6122018878483005e-05, 6.8355091682664585e-05, 5.4253472222222219e-05, 4.3061009439241503e-05,
+		3.4177545841332293e-05, 2.712673611111111e-05, 2.1530504719620751e-05, 1.7088772920666146e-05,
+		1.3563368055555555e-05, 1.0765252359810376e-05, 8.5443864603330732e-06, 6.7816840277777774e-06,
+		5.3826261799051938e-06, 4.2721932301665306e-06, 3.3908420138888887e-06, 2.6913130899525969e-06,
+		2.1360966150832653e-06, 1.6954210069444444e-06, 1.3456565449762984e-06, 1.0680483075416327e-06,
+		8.4771050347222218e-07, 6.7282827248814922e-07, 5.3402415377081633e-07
+	},
+	{
+		1.7777777777777777, 1.411023157305066, 1.1199298221287761, 0.88888888888888884,
+		0.70551157865253311, 0.55996491106438806, 0.44444444444444442, 0.35275578932626656,
+		0.27998245553219403, 0.22222222222222221, 0.17637789466313325, 0.13999122776609702,
+		0.1111111111111111, 0.088188947331566625, 0.069995613883048508, 0.055555555555555552,
+		0.044094473665783326, 0.034997806941524247, 0.027777777777777776, 0.022047236832891663,
+		0.017498903470762123, 0.013888888888888888, 0.011023618416445832, 0.0087494517353810617,
+		0.0069444444444444441, 0.0055118092082229158, 0.0043747258676905309, 0.003472222222222222,
+		0.0027559046041114562, 0.0021873629338452667, 0.001736111111111111, 0.0013779523020557281,
+		0.0010936814669226334, 0.00086805555555555551, 0.00068897615102786404, 0.00054684073346131668,
+		0.00043402777777777775, 0.00034448807551393202, 0.00027342036673065834, 0.00021701388888888888,
+		0.00017224403775696601, 0.00013671018336532917, 0.00010850694444444444, 8.6122018878483005e-05,
+		6.8355091682664585e-05, 5.4253472222222219e-05, 4.3061009439241503e-05, 3.4177545841332293e-05,
+		2.712673611111111e-05, 2.1530504719620751e-05, 1.7088772920666146e-05, 1.3563368055555555e-05,
+		1.0765252359810388e-05, 8.5443864603330613e-06, 6.7816840277777774e-06, 5.3826261799051938e-06,
+		4.2721932301665306e-06, 3.3908420138888887e-06, 2.6913130899525969e-06, 2.1360966150832653e-06,
+		1.6954210069444444e-06, 1.3456565449762984e-06, 1.0680483075416327e-06
+	}
+};
+
+#endif
@@ -84,105 +84,140 @@ static int I_step_one(unsigned int balloc[], unsigned int scale_index[2][SBLIMIT
 	return 0;
 }
 
-static void I_step_two(real fraction[2][SBLIMIT],unsigned int balloc[2*SBLIMIT], unsigned int scale_index[2][SBLIMIT],mpg123_handle *fr)
+/*
+	The samples of the whole frame: each of the 12 blocks has the same allocation,
+	so that is turned into a list of what to read once. The codes are read to
+	integers, then dequant12() scales all of them in one go.
+*/
+static void I_step_two( real (*fraction)[SCALE_BLOCK][SBLIMIT]
+,	unsigned int balloc[2*SBLIMIT], unsigned int scale_index[2][SBLIMIT], mpg123_handle *fr )
 {
-	int i,n;
-	int smpb[2*SBLIMIT]; /* values: 0-65535 */
-	int *sample;
-	register unsigned int *ba;
+	int i,n,row;
+	int (*q)[SCALE_BLOCK][SBLIMIT] = fr->layer1.samples; /* values: -32767-32767 */
+	struct { int *o; int n; int joint; } plan[2*SBLIMIT], *pe = plan, *p;
+	ALIGNED(16) real cm[2][SBLIMIT];
+	unsigned char *wp = fr->wordpointer;
+	int bi = fr->bitindex;
+	register unsigned int *ba = balloc;
 	register unsigned int *sca = (unsigned int *) scale_index;
+	int stereo = fr->stereo == 2 ? 2 : 1;
+	int jsbound = stereo == 2 ? fr->jsbound : SBLIMIT;
 
-	if(fr->stereo == 2)
+	memset(cm, 0, sizeof(cm));
+	for(i=0;i<jsbound;i++)
 	{
-		int jsbound = fr->jsbound;
-		register real *f0 = fraction[0];
-		register real *f1 = fraction[1];
-		ba = balloc;
-		for(sample=smpb,i=0;i<jsbound;i++)
+		int ch;
+		for(ch=0; ch<stereo; ++ch)
+		if((n = *ba++))
 		{
-			if((n = *ba++)) *sample++ = getbits(fr, n+1);
-
-			if((n = *ba++)) *sample++ = getbits(fr, n+1);
+			pe->o = &q[ch][0][i];
+			pe->n = n;
+			pe->joint = 0;
+			++pe;
+			cm[ch][i] = fr->muls[n+1][*sca++];
 		}
-		for(i=jsbound;i<SBLIMIT;i++) 
-		if((n = *ba++))
-		*sample++ = getbits(fr, n+1);
+	}
+	for(i=jsbound;i<SBLIMIT;i++)
+	if((n = *ba++))
+	{
+		pe->o = &q[0][0][i];
+		pe->n = n;
+		pe->joint = 1;
+		++pe;
+		cm[0][i] = fr->muls[n+1][*sca++];
+		cm[1][i] = fr->muls[n+1][*sca++];
+	}
 
-		ba = balloc;
-		for(sample=smpb,i=0;i<jsbound;i++)
-		{
-			if((n=*ba++))
-			*f0++ = REAL_MUL_SCALE_LAYER12(DOUBLE_TO_REAL_15( ((-1)<<n) + (*sample++) + 1), fr->muls[n+1][*sca++]);
-			else *f0++ = DOUBLE_TO_REAL(0.0);
+	memset(q, 0, sizeof(int)*stereo*SCALE_BLOCK*SBLIMIT);
+	for(row=0; row<SCALE_BLOCK; ++row)
+	for(p=plan; p<pe; ++p)
+	{
+		n = p->n;
+		p->o[row*SBLIMIT] = ((-1)<<n) + (int)getbits_at(&wp, &bi, n+1) + 1;
+		if(p->joint)
+		p->o[(SCALE_BLOCK+row)*SBLIMIT] = p->o[row*SBLIMIT];
+	}
+	fr->wordpointer = wp;
+	fr->bitindex = bi;
 
-			if((n=*ba++))
-			*f1++ = REAL_MUL_SCALE_LAYER12(DOUBLE_TO_REAL_15( ((-1)<<n) + (*sample++) + 1), fr->muls[n+1][*sca++]);
-			else *f1++ = DOUBLE_TO_REAL(0.0);
-		}
-		for(i=jsbound;i<SBLIMIT;i++)
+	for(i=0; i<stereo; ++i)
+	{
+		opt_dequant12(fr)(fraction[i][0], q[i][0], cm[i], SCALE_BLOCK);
+		for(row=0; row<SCALE_BLOCK; ++row)
+		for(n=fr->down_sample_sblimit;n<SBLIMIT;n++)
+		fraction[i][row][n] = DOUBLE_TO_REAL(0.0);
+	}
+}
+
+/*
+	Bit allocation and scale factors of the current frame for mpg123_analyze_next(),
+	in place of decoding it. Above the joint stereo bound, one allocation is for both
+	channels, each with its own scale factor.
+*/
+int I_frame_stats(mpg123_handle *fr, struct mpg123_frame_stats *st)
+{
+	unsigned int balloc[2*SBLIMIT];
+	unsigned int scale_index[2][SBLIMIT];
+	unsigned int *ba = balloc;
+	unsigned int *sca = (unsigned int *) scale_index;
+	int i, ch;
+
+	fr->jsbound = (fr->mode == MPG_MD_JOINT_STEREO) ? (fr->mode_ext<<2)+4 : 32;
+	if(I_step_one(balloc, scale_index, fr)) return -1;
+
+	for(i=0; i<SBLIMIT; ++i)
+	{
+		if(fr->stereo == 2 && i >= fr->jsbound)
 		{
-			if((n=*ba++))
+			if(!*ba++) continue;
+			for(ch=0; ch<2; ++ch, ++sca)
 			{
-				real samp = DOUBLE_TO_REAL_15( ((-1)<<n) + (*sample++) + 1);
-				*f0++ = REAL_MUL_SCALE_LAYER12(samp, fr->muls[n+1][*sca++]);
-				*f1++ = REAL_MUL_SCALE_LAYER12(samp, fr->muls[n+1][*sca++]);
+				++st->subbands[ch];
+				if(*sca < (unsigned int)st->scale_index[ch]) st->scale_index[ch] = (int)*sca;
 			}
-			else *f0++ = *f1++ = DOUBLE_TO_REAL(0.0);
 		}
-		for(i=fr->down_sample_sblimit;i<32;i++)
-		fraction[0][i] = fraction[1][i] = 0.0;
-	}
-	else
-	{
-		register real *f0 = fraction[0];
-		ba = balloc;
-		for(sample=smpb,i=0;i<SBLIMIT;i++)
-		if ((n = *ba++))
-		*sample++ = getbits(fr, n+1);
-
-		ba = balloc;
-		for(sample=smpb,i=0;i<SBLIMIT;i++)
+		else for(ch=0; ch<fr->stereo; ++ch)
+		if(*ba++)
 		{
-			if((n=*ba++))
-			*f0++ = REAL_MUL_SCALE_LAYER12(DOUBLE_TO_REAL_15( ((-1)<<n) + (*sample++) + 1), fr->muls[n+1][*sca++]);
-			else *f0++ = DOUBLE_TO_REAL(0.0);
+			++st->subbands[ch];
+			if(*sca < (unsigned int)st->scale_index[ch]) st->scale_index[ch] = (int)*sca;
+			++sca;
 		}
-		for(i=fr->down_sample_sblimit;i<32;i++)
-		fraction[0][i] = DOUBLE_TO_REAL(0.0);
 	}
+	return 0;
 }
 
 int do_layer1(mpg123_handle *fr)
 {
-	int clip=0;
-	int i,stereo = fr->stereo;
+	int stereo = fr->stereo;
 	unsigned int balloc[2*SBLIMIT];
 	unsigned int scale_index[2][SBLIMIT];
-	real (*fraction)[SBLIMIT] = fr->layer1.fraction; /* fraction[2][SBLIMIT] */
+	real (*fraction)[SCALE_BLOCK][SBLIMIT] = fr->layer1.fraction; /* fraction[2][SCALE_BLOCK][SBLIMIT] */
 	int single = fr->single;
 
 	fr->jsbound = (fr->mode == MPG_MD_JOINT_STEREO) ? (fr->mode_ext<<2)+4 : 32;
 
-	if(stereo == 1 || single == SINGLE_MIX) /* I don't see mixing handled here */
+	if(stereo == 1)
 	single = SINGLE_LEFT;
 
 	if(I_step_one(balloc,scale_index,fr))
 	{
 		if(NOQUIET) error("Aborting layer I decoding after step one.\n");
-		return clip;
+		return 0;
 	}
 
-	for(i=0;i<SCALE_BLOCK;i++)
-	{
-		I_step_two(fraction,balloc,scale_index,fr);
+	/* All 12 blocks of the frame, then one go through the synth. */
+	I_step_two(fraction, balloc, scale_index, fr);
 
-		if(single != SINGLE_STEREO)
-		clip += (fr->synth_mono)(fraction[single], fr);
-		else
-		clip += (fr->synth_stereo)(fraction[0], fraction[1], fr);
+	if(single == SINGLE_MIX)
+	{
+		mix12(fraction[0][0], fraction[1][0], SCALE_BLOCK);
+		single = SINGLE_LEFT;
 	}
-
-	return clip;
+	if(single != SINGLE_STEREO)
+	return synth_blocks(fr, fraction[single][0], NULL, SCALE_BLOCK);
+	else
+	return synth_blocks(fr, fraction[0][0], fraction[1][0], SCALE_BLOCK);
 }
 
 
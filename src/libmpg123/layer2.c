@@ -24,6 +24,8 @@ static int grp_9tab[1024 * 3] = { 0, }; /* used: 729 */
 
 #if defined(REAL_IS_FIXED) && defined(PRECALC_TABLES)
 #include "l12_integer_tables.h"
+#elif defined(PRECALC_TABLES)
+#include "l12_float_tables.h"
 #else
 static const double mulmul[27] =
 {
@@ -81,6 +83,10 @@ real* init_layer12_table(mpg123_handle *fr, real *table, int m)
 	int i;
 	for(i=0;i<63;i++)
 	*table++ = layer12_table[m][i];
+#elif defined(PRECALC_TABLES)
+	int i;
+	for(i=0;i<63;i++)
+	*table++ = DOUBLE_TO_REAL(layer12_table[m][i]);
 #else
 	int i,j;
 	for(j=3,i=0;i<63;i++,j--)
@@ -93,7 +99,13 @@ real* init_layer12_table(mpg123_handle *fr, real *table, int m)
 #ifdef OPT_MMXORSSE
 real* init_layer12_table_mmx(mpg123_handle *fr, real *table, int m)
 {
-	int i,j;
+	int i;
+#ifdef PRECALC_TABLES
+	double scale = fr->p.down_sample ? 1.0 : 16384.0;
+	for(i=0;i<63;i++)
+	*table++ = DOUBLE_TO_REAL(scale * layer12_table[m][i]);
+#else
+	int j;
 	if(!fr->p.down_sample) 
 	{
 		for(j=3,i=0;i<63;i++,j--)
@@ -104,10 +116,71 @@ real* init_layer12_table_mmx(mpg123_handle *fr, real *table, int m)
 		for(j=3,i=0;i<63;i++,j--)
 		*table++ = DOUBLE_TO_REAL(mulmul[m] * pow(2.0,(double) j / 3.0));
 	}
+#endif
 	return table;
 }
 #endif
 
+/*
+	The integer samples q are the codes with the offset of their quantization
+	applied, cm holds the factors for each subband, from fr->muls.
+	Plain loops of fixed length, for the compiler to vectorize.
+*/
+void dequant12(real *out, const int *q, const real *cm, int rows)
+{
+	int r, i;
+	for(r=0; r<rows; ++r, out+=SBLIMIT, q+=SBLIMIT)
+	for(i=0; i<SBLIMIT; ++i)
+	out[i] = REAL_MUL_SCALE_LAYER12(DOUBLE_TO_REAL_15(q[i]), cm[i]);
+}
+
+/*
+	Mono mix of blocks of subband samples into the left channel. The synthesis
+	is linear, so one mono pass on the mean gives the mean of both outputs.
+*/
+void mix12(real *left, const real *right, int rows)
+{
+	int i;
+	const real half = DOUBLE_TO_REAL(0.5);
+	for(i=0; i<rows*SBLIMIT; ++i)
+	left[i] = REAL_MUL(left[i] + right[i], half);
+}
+
+/*
+	Layer I and II decode a whole frame before synthesis, 12 or 36 blocks per channel.
+	The equalizer and the choice of stereo or mono synth are the same for all of them.
+	That is also the place to hand out the subband samples for mpg123_tap().
+*/
+int synth_blocks(mpg123_handle *fr, real *left, real *right, int count)
+{
+	int clip = 0;
+	if(fr->tap_kinds & MPG123_TAP_SUBBANDS)
+	{
+		struct mpg123_tap_data td = { MPG123_TAP_SUBBANDS, 0, 0, 0, 0, NULL, 0 };
+		frame_tap(fr, &td, left, (size_t)count*SBLIMIT);
+		if(right)
+		{
+			td.channel = 1;
+			frame_tap(fr, &td, right, (size_t)count*SBLIMIT);
+		}
+	}
+	if(fr->p.flags & MPG123_TAP_ONLY)
+	return 0;
+	if(right)
+	{
+		func_synth_stereo synth = fr->synth_stereo;
+		for(; count; --count, left+=SBLIMIT, right+=SBLIMIT)
+		clip += synth(left, right, fr);
+	}
+	else
+	{
+		func_synth_mono synth = fr->synth_mono;
+		for(; count; --count, left+=SBLIMIT)
+		clip += synth(left, fr);
+	}
+	return clip;
+}
+
 #endif /* NO_LAYER12 */
 
 /* The rest is the actual decoding of layer II data. */
@@ -125,6 +198,8 @@ static void II_step_one(unsigned int *bit_alloc,int *scale,mpg123_handle *fr)
 	unsigned int scfsi_buf[64];
 	unsigned int *scfsi,*bita;
 	int sc,step;
+	unsigned char *wp = fr->wordpointer;
+	int bi = fr->bitindex;
 
 	bita = bit_alloc;
 	if(stereo)
@@ -132,13 +207,13 @@ static void II_step_one(unsigned int *bit_alloc,int *scale,mpg123_handle *fr)
 		for(i=jsbound;i;i--,alloc1+=(1<<step))
 		{
 			step=alloc1->bits;
-			*bita++ = (char) getbits(fr, step);
-			*bita++ = (char) getbits(fr, step);
+			*bita++ = (char) getbits_at(&wp, &bi, step);
+			*bita++ = (char) getbits_at(&wp, &bi, step);
 		}
 		for(i=sblimit-jsbound;i;i--,alloc1+=(1<<step))
 		{
 			step=alloc1->bits;
-			bita[0] = (char) getbits(fr, step);
+			bita[0] = (char) getbits_at(&wp, &bi, step);
 			bita[1] = bita[0];
 			bita+=2;
 		}
@@ -146,19 +221,19 @@ static void II_step_one(unsigned int *bit_alloc,int *scale,mpg123_handle *fr)
 		scfsi=scfsi_buf;
 
 		for(i=sblimit2;i;i--)
-		if(*bita++) *scfsi++ = (char) getbits_fast(fr, 2);
+		if(*bita++) *scfsi++ = (char) getbits_at(&wp, &bi, 2);
 	}
 	else /* mono */
 	{
 		for(i=sblimit;i;i--,alloc1+=(1<<step))
 		{
 			step=alloc1->bits;
-			*bita++ = (char) getbits(fr, step);
+			*bita++ = (char) getbits_at(&wp, &bi, step);
 		}
 		bita = bit_alloc;
 		scfsi=scfsi_buf;
 		for(i=sblimit;i;i--)
-		if(*bita++) *scfsi++ = (char) getbits_fast(fr, 2);
+		if(*bita++) *scfsi++ = (char) getbits_at(&wp, &bi, 2);
 	}
 
 	bita = bit_alloc;
@@ -168,128 +243,176 @@ static void II_step_one(unsigned int *bit_alloc,int *scale,mpg123_handle *fr)
 	switch(*scfsi++)
 	{
 		case 0: 
-			*scale++ = getbits_fast(fr, 6);
-			*scale++ = getbits_fast(fr, 6);
-			*scale++ = getbits_fast(fr, 6);
+			*scale++ = getbits_at(&wp, &bi, 6);
+			*scale++ = getbits_at(&wp, &bi, 6);
+			*scale++ = getbits_at(&wp, &bi, 6);
 		break;
 		case 1 : 
-			*scale++ = sc = getbits_fast(fr, 6);
+			*scale++ = sc = getbits_at(&wp, &bi, 6);
 			*scale++ = sc;
-			*scale++ = getbits_fast(fr, 6);
+			*scale++ = getbits_at(&wp, &bi, 6);
 		break;
 		case 2: 
-			*scale++ = sc = getbits_fast(fr, 6);
+			*scale++ = sc = getbits_at(&wp, &bi, 6);
 			*scale++ = sc;
 			*scale++ = sc;
 		break;
 		default:              /* case 3 */
-			*scale++ = getbits_fast(fr, 6);
-			*scale++ = sc = getbits_fast(fr, 6);
+			*scale++ = getbits_at(&wp, &bi, 6);
+			*scale++ = sc = getbits_at(&wp, &bi, 6);
 			*scale++ = sc;
 		break;
 	}
+	fr->wordpointer = wp;
+	fr->bitindex = bi;
 }
 
 
-static void II_step_two(unsigned int *bit_alloc,real fraction[2][4][SBLIMIT],int *scale,mpg123_handle *fr,int x1)
+/*
+	What to read for one subband and channel with bits allocated; that is the
+	same for all granules of a frame. Joint stereo subbands have one entry for
+	both channels.
+*/
+struct II_read
+{
+	int sb;
+	int ch;
+	int joint;
+	int k;  /* bits per sample, or per group of three samples */
+	int d1; /* offset of the codes, or table for grouping (>= 0) */
+	const int *scale; /* the 3 (joint: 6) scale factor indices */
+};
+
+/*
+	The entries in bitstream order, and the dequantization factors for the three
+	parts of the frame (x1 = granule/4) where the codes are plain integers.
+	Returns the end of the list.
+*/
+static struct II_read *II_plan( unsigned int *bit_alloc, int *scale
+,	struct II_read *plan, real cm[3][2][SBLIMIT], mpg123_handle *fr )
 {
-	int i,j,k,ba;
+	int i,j,k,ba,x1;
 	int stereo = fr->stereo;
 	int sblimit = fr->II_sblimit;
 	int jsbound = fr->jsbound;
 	const struct al_table *alloc2,*alloc1 = fr->alloc;
 	unsigned int *bita=bit_alloc;
-	int d1,step;
+	int step;
 
-	for(i=0;i<jsbound;i++,alloc1+=(1<<step))
+	memset(cm, 0, sizeof(real)*3*2*SBLIMIT);
+	for(i=0;i<sblimit;i++,alloc1+=(1<<step))
 	{
+		int joint = i >= jsbound;
 		step = alloc1->bits;
 		for(j=0;j<stereo;j++)
 		{
-			if( (ba=*bita++) ) 
+			if( (ba=*bita++) )
 			{
 				k=(alloc2 = alloc1+ba)->bits;
-				if( (d1=alloc2->d) < 0) 
+				plan->sb = i;
+				plan->ch = j;
+				plan->joint = joint;
+				plan->k = k;
+				plan->d1 = alloc2->d;
+				plan->scale = scale;
+				if(plan->d1 < 0)
+				for(x1=0; x1<3; ++x1)
 				{
-					real cm=fr->muls[k][scale[x1]];
-					fraction[j][0][i] = REAL_MUL_SCALE_LAYER12(DOUBLE_TO_REAL_15((int)getbits(fr, k) + d1), cm);
-					fraction[j][1][i] = REAL_MUL_SCALE_LAYER12(DOUBLE_TO_REAL_15((int)getbits(fr, k) + d1), cm);
-					fraction[j][2][i] = REAL_MUL_SCALE_LAYER12(DOUBLE_TO_REAL_15((int)getbits(fr, k) + d1), cm);
-				}        
-				else 
-				{
-					const int *table[] = { 0,0,0,grp_3tab,0,grp_5tab,0,0,0,grp_9tab };
-					unsigned int idx,*tab,m=scale[x1];
-					idx = (unsigned int) getbits(fr, k);
-					tab = (unsigned int *) (table[d1] + idx + idx + idx);
-					fraction[j][0][i] = REAL_SCALE_LAYER12(fr->muls[*tab++][m]);
-					fraction[j][1][i] = REAL_SCALE_LAYER12(fr->muls[*tab++][m]);
-					fraction[j][2][i] = REAL_SCALE_LAYER12(fr->muls[*tab][m]);  
+					cm[x1][j][i] = fr->muls[k][scale[x1]];
+					if(joint)
+					cm[x1][1][i] = fr->muls[k][scale[x1+3]];
 				}
-				scale+=3;
+				scale += joint ? 6 : 3;
+				++plan;
 			}
-			else
-			fraction[j][0][i] = fraction[j][1][i] = fraction[j][2][i] = DOUBLE_TO_REAL(0.0);
+			/* channel 1 and channel 2 bitalloc are the same */
+			if(joint){ ++bita; break; }
 		}
 	}
+	return plan;
+}
+
+/*
+	The three samples of a subband with k <= 16 bits each, from one 64 bit word
+	(3*16 bits plus up to 7 bits of offset fit).
+*/
+#define II_GET3(q0, q1, q2, k, d1) \
+{ \
+	uint64_t w = getbits_word(wp) << bi; \
+	q0 = (int)(w >> (64-k)) + d1; \
+	q1 = (int)((w << k) >> (64-k)) + d1; \
+	q2 = (int)((w << 2*k) >> (64-k)) + d1; \
+	bi += 3*k; \
+	wp += bi>>3; \
+	bi &= 7; \
+}
+
+/*
+	The samples of the whole frame: 12 granules with three samples per subband and
+	channel. The codes are read to integers first, dequant12() scales them all in one
+	go. Grouped codes (3, 5 and 9 levels) are stored as they come and looked up in
+	fr->muls afterwards.
+*/
+static void II_step_two( unsigned int *bit_alloc, int *scale
+,	real (*fraction)[3*SCALE_BLOCK][SBLIMIT], mpg123_handle *fr )
+{
+	const int *table[] = { 0,0,0,grp_3tab,0,grp_5tab,0,0,0,grp_9tab };
+	int (*q)[3*SCALE_BLOCK][SBLIMIT] = fr->layer2.samples;
+	int stereo = fr->stereo;
+	int i,j,gr;
+	unsigned char *wp = fr->wordpointer;
+	int bi = fr->bitindex;
+	struct II_read plan[2*SBLIMIT], *pe, *p;
+	ALIGNED(16) real cm[3][2][SBLIMIT];
 
-	for(i=jsbound;i<sblimit;i++,alloc1+=(1<<step))
+	pe = II_plan(bit_alloc, scale, plan, cm, fr);
+	memset(q, 0, sizeof(int)*stereo*3*SCALE_BLOCK*SBLIMIT);
+
+	for(gr=0; gr<SCALE_BLOCK; ++gr)
+	for(p=plan; p<pe; ++p)
 	{
-		step = alloc1->bits;
-		bita++;	/* channel 1 and channel 2 bitalloc are the same */
-		if( (ba=*bita++) )
+		int *o = &q[p->ch][3*gr][p->sb];
+		if(p->d1 < 0)
 		{
-			k=(alloc2 = alloc1+ba)->bits;
-			if( (d1=alloc2->d) < 0)
+			II_GET3(o[0], o[SBLIMIT], o[2*SBLIMIT], p->k, p->d1);
+			if(p->joint)
 			{
-				real cm;
-				cm=fr->muls[k][scale[x1+3]];
-				fraction[0][0][i] = DOUBLE_TO_REAL_15((int)getbits(fr, k) + d1);
-				fraction[0][1][i] = DOUBLE_TO_REAL_15((int)getbits(fr, k) + d1);
-				fraction[0][2][i] = DOUBLE_TO_REAL_15((int)getbits(fr, k) + d1);
-				fraction[1][0][i] = REAL_MUL_SCALE_LAYER12(fraction[0][0][i], cm);
-				fraction[1][1][i] = REAL_MUL_SCALE_LAYER12(fraction[0][1][i], cm);
-				fraction[1][2][i] = REAL_MUL_SCALE_LAYER12(fraction[0][2][i], cm);
-				cm=fr->muls[k][scale[x1]];
-				fraction[0][0][i] = REAL_MUL_SCALE_LAYER12(fraction[0][0][i], cm);
-				fraction[0][1][i] = REAL_MUL_SCALE_LAYER12(fraction[0][1][i], cm);
-				fraction[0][2][i] = REAL_MUL_SCALE_LAYER12(fraction[0][2][i], cm);
+				int *o1 = &q[1][3*gr][p->sb];
+				o1[0] = o[0];
+				o1[SBLIMIT] = o[SBLIMIT];
+				o1[2*SBLIMIT] = o[2*SBLIMIT];
 			}
-			else
-			{
-				const int *table[] = { 0,0,0,grp_3tab,0,grp_5tab,0,0,0,grp_9tab };
-				unsigned int idx,*tab,m1,m2;
-				m1 = scale[x1]; m2 = scale[x1+3];
-				idx = (unsigned int) getbits(fr, k);
-				tab = (unsigned int *) (table[d1] + idx + idx + idx);
-				fraction[0][0][i] = REAL_SCALE_LAYER12(fr->muls[*tab][m1]); fraction[1][0][i] = REAL_SCALE_LAYER12(fr->muls[*tab++][m2]);
-				fraction[0][1][i] = REAL_SCALE_LAYER12(fr->muls[*tab][m1]); fraction[1][1][i] = REAL_SCALE_LAYER12(fr->muls[*tab++][m2]);
-				fraction[0][2][i] = REAL_SCALE_LAYER12(fr->muls[*tab][m1]); fraction[1][2][i] = REAL_SCALE_LAYER12(fr->muls[*tab][m2]);
-			}
-			scale+=6;
 		}
 		else
+		o[0] = (int)getbits_at(&wp, &bi, p->k);
+	}
+	fr->wordpointer = wp;
+	fr->bitindex = bi;
+
+	for(j=0;j<stereo;j++)
+	for(i=0;i<3;i++)
+	opt_dequant12(fr)(fraction[j][4*3*i], q[j][4*3*i], cm[i][j], 4*3);
+
+	for(p=plan; p<pe; ++p)
+	if(p->d1 >= 0)
+	for(gr=0; gr<SCALE_BLOCK; ++gr)
+	{
+		const int *tab = table[p->d1] + 3*q[p->ch][3*gr][p->sb];
+		for(j=0; j<=p->joint; ++j)
 		{
-			fraction[0][0][i] = fraction[0][1][i] = fraction[0][2][i] =
-			fraction[1][0][i] = fraction[1][1][i] = fraction[1][2][i] = DOUBLE_TO_REAL(0.0);
+			real *out = &fraction[p->ch+j][3*gr][p->sb];
+			int m = p->scale[(gr>>2)+3*j];
+			out[0]         = REAL_SCALE_LAYER12(fr->muls[tab[0]][m]);
+			out[SBLIMIT]   = REAL_SCALE_LAYER12(fr->muls[tab[1]][m]);
+			out[2*SBLIMIT] = REAL_SCALE_LAYER12(fr->muls[tab[2]][m]);
 		}
-/*
-	Historic comment...
-	should we use individual scalefac for channel 2 or
-	is the current way the right one , where we just copy channel 1 to
-	channel 2 ?? 
-	The current 'strange' thing is, that we throw away the scalefac
-	values for the second channel ...!!
-	-> changed .. now we use the scalefac values of channel one !! 
-*/
 	}
 
-	if(sblimit > (fr->down_sample_sblimit) )
-	sblimit = fr->down_sample_sblimit;
-
-	for(i=sblimit;i<SBLIMIT;i++)
-	for (j=0;j<stereo;j++)
-	fraction[j][0][i] = fraction[j][1][i] = fraction[j][2][i] = DOUBLE_TO_REAL(0.0);
+	if(fr->down_sample_sblimit < SBLIMIT)
+	for(j=0;j<stereo;j++)
+	for(gr=0;gr<3*SCALE_BLOCK;gr++)
+	for(i=fr->down_sample_sblimit;i<SBLIMIT;i++)
+	fraction[j][gr][i] = DOUBLE_TO_REAL(0.0);
 }
 
 
@@ -326,18 +449,9 @@ static void II_select_table(mpg123_handle *fr)
 }
 
 
-int do_layer2(mpg123_handle *fr)
+/* Allocation table and joint stereo bound of the current frame. */
+static void II_frame_setup(mpg123_handle *fr)
 {
-	int clip=0;
-	int i,j;
-	int stereo = fr->stereo;
-	/* pick_table clears unused subbands */
-	/* replacement for real fraction[2][4][SBLIMIT], needs alignment. */
-	real (*fraction)[4][SBLIMIT] = fr->layer2.fraction;
-	unsigned int bit_alloc[64];
-	int scale[192];
-	int single = fr->single;
-
 	II_select_table(fr);
 	fr->jsbound = (fr->mode == MPG_MD_JOINT_STEREO) ? (fr->mode_ext<<2)+4 : fr->II_sblimit;
 
@@ -346,26 +460,62 @@ int do_layer2(mpg123_handle *fr)
 		fprintf(stderr, "Truncating stereo boundary to sideband limit.\n");
 		fr->jsbound=fr->II_sblimit;
 	}
+}
 
-	/* TODO: What happens with mono mixing, actually? */
-	if(stereo == 1 || single == SINGLE_MIX) /* also, mix not really handled */
+/*
+	Bit allocation and scale factors of the current frame for mpg123_analyze_next(),
+	in place of decoding it. Allocation and scale factors come per subband and channel.
+*/
+int II_frame_stats(mpg123_handle *fr, struct mpg123_frame_stats *st)
+{
+	unsigned int bit_alloc[64];
+	int scale[192];
+	unsigned int *bita = bit_alloc;
+	int *sc = scale;
+	int i, ch;
+
+	II_frame_setup(fr);
+	II_step_one(bit_alloc, scale, fr);
+	for(i=0; i<fr->II_sblimit; ++i)
+	for(ch=0; ch<fr->stereo; ++ch)
+	if(*bita++)
+	{
+		int k;
+		++st->subbands[ch];
+		for(k=0; k<3; ++k, ++sc)
+		if(*sc < st->scale_index[ch]) st->scale_index[ch] = *sc;
+	}
+	return 0;
+}
+
+int do_layer2(mpg123_handle *fr)
+{
+	int stereo = fr->stereo;
+	/* pick_table clears unused subbands */
+	/* replacement for real fraction[2][3*SCALE_BLOCK][SBLIMIT], needs alignment. */
+	real (*fraction)[3*SCALE_BLOCK][SBLIMIT] = fr->layer2.fraction;
+	unsigned int bit_alloc[64];
+	int scale[192];
+	int single = fr->single;
+
+	II_frame_setup(fr);
+
+	if(stereo == 1)
 	single = SINGLE_LEFT;
 
 	II_step_one(bit_alloc, scale, fr);
+	/* All 36 blocks of the frame, then one go through the synth. */
+	II_step_two(bit_alloc, scale, fraction, fr);
 
-	for(i=0;i<SCALE_BLOCK;i++)
+	if(single == SINGLE_MIX)
 	{
-		II_step_two(bit_alloc,fraction,scale,fr,i>>2);
-		for(j=0;j<3;j++) 
-		{
-			if(single != SINGLE_STEREO)
-			clip += (fr->synth_mono)(fraction[single][j], fr);
-			else
-			clip += (fr->synth_stereo)(fraction[0][j], fraction[1][j], fr);
-		}
+		mix12(fraction[0][0], fraction[1][0], 3*SCALE_BLOCK);
+		single = SINGLE_LEFT;
 	}
-
-	return clip;
+	if(single != SINGLE_STEREO)
+	return synth_blocks(fr, fraction[single][0], NULL, 3*SCALE_BLOCK);
+	else
+	return synth_blocks(fr, fraction[0][0], fraction[1][0], 3*SCALE_BLOCK);
 }
 
 #endif /* NO_LAYER2 */
@@ -15,12 +15,11 @@
 */
 
 #include "mpg123lib_intern.h"
-#ifdef USE_NEW_HUFFTABLE
-#include "newhuffman.h"
-#else
 #include "huffman.h"
-#endif
 #include "getbits.h"
+#ifdef USE_THREADS
+#include <pthread.h>
+#endif
 #include "debug.h"
 
 
@@ -33,6 +32,9 @@
 #ifdef REAL_IS_FIXED
 #define NEW_DCT9
 #include "l3_integer_tables.h"
+#elif defined(PRECALC_TABLES)
+#define NEW_DCT9
+#include "l3_float_tables.h"
 #else
 /* static one-time calculated tables... or so */
 static real ispow[8207];
@@ -71,6 +73,8 @@ struct gr_info_s
 	unsigned preflag;
 	unsigned scalefac_scale;
 	unsigned count1table_select;
+	unsigned global_gain;
+	unsigned subblock_gain[3];
 	real *full_gain[3];
 	real *pow2gain;
 };
@@ -159,13 +163,168 @@ static int *mapend[9][3];
 static unsigned int n_slen2[512]; /* MPEG 2.0 slen for 'normal' mode */
 static unsigned int i_slen2[256]; /* MPEG 2.0 slen for intensity stereo */
 
+/*
+	Multi-symbol Huffman decoding: the next HUFF_BITS bits of the stream index
+	a table of the complete codes (sign bits included) they contain, built from
+	the code trees in huffman.h at init. One lookup yields up to HUFF_PAIRS big
+	value pairs or HUFF_QUADS count1 quadruples. Escapes (15 with linbits) and
+	codes that do not fit still go through the tree, with the first steps of the
+	walk taken from the lookup. MPG123_PLAIN_HUFFMAN switches back to the tree only.
+*/
+#define HUFF_BITS  8
+#define HUFF_PAIRS 3
+#define HUFF_QUADS 4
+#define HUFF_BIT(w, pos) ((w) & (1<<(HUFF_BITS-1-(pos))))
+
+struct huff_pairs
+{
+	unsigned char n; /* number of complete pairs, 0: use the tree */
+	unsigned char bits[HUFF_PAIRS]; /* bits used up to and including pair i */
+	signed char xy[2*HUFF_PAIRS]; /* values with sign; for n == 0 and node == 0 the code value without sign bits */
+	unsigned short node; /* for n == 0: position in the tree after HUFF_BITS bits, 0 if the code is complete */
+};
+
+struct huff_quads
+{
+	unsigned char n; /* number of complete quadruples, 0: use the tree */
+	unsigned char bits[HUFF_QUADS];
+	unsigned char v[HUFF_QUADS]; /* 0x8>>i: value i is non-zero, 0x80>>i: it is negative */
+};
+
+/* Tables 16-23 and 24-31 share their trees. */
+static struct huff_pairs huff_pairs_buf[16][1<<HUFF_BITS];
+static const struct huff_pairs *huff_pairs_tab[32];
+static struct huff_quads huff_quads_tab[2][1<<HUFF_BITS];
+
+/* Walk the tree with the bits of w from *pos on. Returns the leaf value or -1 if the bits end before it, with the tree position in *node. */
+static int huff_walk(const short *tree, unsigned int w, int *pos, int *node)
+{
+	const short *val = tree;
+	short y;
+
+	while((y=*val++)<0)
+	{
+		if(*pos == HUFF_BITS)
+		{
+			*node = (int)(val-1-tree);
+			return -1;
+		}
+		if(HUFF_BIT(w, *pos)) val -= y;
+		++*pos;
+	}
+	return y;
+}
+
+static void init_huff_pairs(struct huff_pairs *tab, const short *tree, int escapes)
+{
+	unsigned int w;
+
+	for(w=0; w<(1<<HUFF_BITS); ++w)
+	{
+		struct huff_pairs *e = tab+w;
+		int pos = 0;
+
+		memset(e, 0, sizeof(*e));
+		while(e->n < HUFF_PAIRS)
+		{
+			int end = pos, node = 0;
+			int code = huff_walk(tree, w, &end, &node);
+			int x, y;
+
+			if(code < 0)
+			{
+				if(!e->n) e->node = node;
+				break;
+			}
+			x = code >> 4;
+			y = code & 0xf;
+			if( (escapes && (x == 15 || y == 15))
+			||  end + (x != 0) + (y != 0) > HUFF_BITS )
+			{ /* The tree walk is done, sign bits and linbits are left to the decoder. */
+				if(!e->n)
+				{
+					e->xy[0] = x;
+					e->xy[1] = y;
+					e->bits[0] = end;
+				}
+				break;
+			}
+			if(x){ if(HUFF_BIT(w, end)) x = -x; ++end; }
+			if(y){ if(HUFF_BIT(w, end)) y = -y; ++end; }
+			e->xy[2*e->n]   = x;
+			e->xy[2*e->n+1] = y;
+			e->bits[e->n++] = end;
+			pos = end;
+		}
+	}
+}
+
+static void init_huff_quads(struct huff_quads *tab, const short *tree)
+{
+	unsigned int w;
+
+	for(w=0; w<(1<<HUFF_BITS); ++w)
+	{
+		struct huff_quads *e = tab+w;
+		int pos = 0;
+
+		memset(e, 0, sizeof(*e));
+		while(e->n < HUFF_QUADS)
+		{
+			int end = pos, node = 0, i;
+			int code = huff_walk(tree, w, &end, &node);
+			unsigned char v;
+
+			if(code < 0) break;
+			v = code;
+			for(i=0; i<4; ++i)
+			if(code & (0x8>>i))
+			{
+				if(end == HUFF_BITS) break;
+				if(HUFF_BIT(w, end)) v |= 0x80>>i;
+				++end;
+			}
+			if(i < 4) break;
+			e->v[e->n] = v;
+			e->bits[e->n++] = end;
+			pos = end;
+		}
+	}
+}
+
+static void init_huffman(void)
+{
+	int i, trees = 0;
+
+	for(i=0; i<32; ++i)
+	{
+		int j;
+		for(j=0; j<i; ++j)
+		if(ht[j].table == ht[i].table) break;
+
+		if(j < i) huff_pairs_tab[i] = huff_pairs_tab[j];
+		else
+		{
+			init_huff_pairs(huff_pairs_buf[trees], ht[i].table, ht[i].linbits > 0);
+			huff_pairs_tab[i] = huff_pairs_buf[trees++];
+		}
+	}
+	for(i=0; i<2; ++i)
+	init_huff_quads(huff_quads_tab[i], htc[i].table);
+}
+
 /* Some helpers used in init_layer3 */
 
 #ifdef OPT_MMXORSSE
 real init_layer3_gainpow2_mmx(mpg123_handle *fr, int i)
 {
+#ifdef PRECALC_TABLES
+	if(!fr->p.down_sample) return DOUBLE_TO_REAL(16384.0 * gainpow2[i+256]);
+	else return DOUBLE_TO_REAL(gainpow2[i+256]);
+#else
 	if(!fr->p.down_sample) return DOUBLE_TO_REAL(16384.0 * pow((double)2.0,-0.25 * (double) (i+210) ));
 	else return DOUBLE_TO_REAL(pow((double)2.0,-0.25 * (double) (i+210)));
+#endif
 }
 #endif
 
@@ -173,6 +332,8 @@ real init_layer3_gainpow2(mpg123_handle *fr, int i)
 {
 #if defined(REAL_IS_FIXED) && defined(PRECALC_TABLES)
 	return gainpow2[i+256];
+#elif defined(PRECALC_TABLES)
+	return DOUBLE_TO_REAL(gainpow2[i+256]);
 #else
 	return DOUBLE_TO_REAL_SCALE_LAYER3(pow((double)2.0,-0.25 * (double) (i+210)),i+256);
 #endif
@@ -184,7 +345,7 @@ void init_layer3(void)
 {
 	int i,j,k,l;
 
-#if !defined(REAL_IS_FIXED) || !defined(PRECALC_TABLES)
+#ifndef PRECALC_TABLES
 	for(i=0;i<8207;i++)
 	ispow[i] = DOUBLE_TO_REAL_POW43(pow((double)i,(double)4.0/3.0));
 
@@ -263,6 +424,7 @@ void init_layer3(void)
 	}
 #endif
 
+#if !defined(PRECALC_TABLES) || defined(REAL_IS_FIXED)
 	for(j=0;j<4;j++)
 	{
 		const int len[4] = { 36,36,12,36 };
@@ -270,6 +432,7 @@ void init_layer3(void)
 
 		for(i=1;i<len[j];i+=2) win1[j][i] = - win[j][i];
 	}
+#endif
 
 	for(j=0;j<9;j++)
 	{
@@ -365,6 +528,8 @@ void init_layer3(void)
 		int n = k + j * 4 + i * 20;
 		n_slen2[n+400] = i|(j<<3)|(k<<6)|(1<<12);
 	}
+
+	init_huffman();
 }
 
 
@@ -396,11 +561,20 @@ void init_layer3_stuff(mpg123_handle *fr, real (*gainpow2)(mpg123_handle *fr, in
 	Now come the actualy decoding routines.
 */
 
+/*
+	The mono mix of M/S stereo (without intensity stereo) is the mid channel
+	alone: (L+R)/2 = M/sqrt(2), with the 1/sqrt(2) already in the M/S gain.
+	The side channel is not decoded at all then.
+*/
+#define MIX_MID_ONLY(single, ms_stereo, i_stereo) \
+	((single) == SINGLE_MIX && (ms_stereo) && !(i_stereo))
+
 /* read additional side information (for MPEG 1 and MPEG 2) */
 static int III_get_side_info(mpg123_handle *fr, struct III_sideinfo *si,int stereo, int ms_stereo,long sfreq,int single)
 {
 	int ch, gr;
-	int powdiff = (single == SINGLE_MIX) ? 4 : 0;
+	/* Halving for the mono mix, but the mid channel alone is (L+R)/2 already. */
+	int powdiff = (single == SINGLE_MIX && !MIX_MID_ONLY(single, ms_stereo, fr->mode_ext & 0x1)) ? 4 : 0;
 
 	const int tabs[2][5] = { { 2,9,5,3,4 } , { 1,8,1,2,9 } };
 	const int *tab = tabs[fr->lsf];
@@ -460,9 +634,7 @@ static int III_get_side_info(mpg123_handle *fr, struct III_sideinfo *si,int ster
 			if(NOQUIET) error("big_values too large!");
 			gr_info->big_values = 288;
 		}
-		gr_info->pow2gain = fr->gainpow2+256 - getbits_fast(fr, 8) + powdiff;
-		if(ms_stereo) gr_info->pow2gain += 2;
-
+		gr_info->global_gain = getbits_fast(fr, 8);
 		gr_info->scalefac_compress = getbits(fr, tab[4]);
 
 		if(get1bit(fr))
@@ -478,7 +650,7 @@ static int III_get_side_info(mpg123_handle *fr, struct III_sideinfo *si,int ster
 			*/
 			gr_info->table_select[2] = 0;
 			for(i=0;i<3;i++)
-			gr_info->full_gain[i] = gr_info->pow2gain + (getbits_fast(fr, 3)<<3);
+			gr_info->subblock_gain[i] = getbits_fast(fr, 3);
 
 			if(gr_info->block_type == 0)
 			{
@@ -516,7 +688,10 @@ static int III_get_side_info(mpg123_handle *fr, struct III_sideinfo *si,int ster
 		{
 			int i,r0c,r1c;
 			for (i=0; i<3; i++)
-			gr_info->table_select[i] = getbits_fast(fr, 5);
+			{
+				gr_info->table_select[i] = getbits_fast(fr, 5);
+				gr_info->subblock_gain[i] = 0;
+			}
 
 			r0c = getbits_fast(fr, 4); /* 0 .. 15 */
 			r1c = getbits_fast(fr, 3); /* 0 .. 7 */
@@ -534,6 +709,19 @@ static int III_get_side_info(mpg123_handle *fr, struct III_sideinfo *si,int ster
 		gr_info->scalefac_scale = get1bit(fr);
 		gr_info->count1table_select = get1bit(fr);
 	}
+
+	/* The gain tables are not set up yet when mpg123_analyze_next() comes first. */
+	if(fr->gainpow2 != NULL)
+	for (gr=0; gr<tab[0]; gr++)
+	for (ch=0; ch<stereo; ch++)
+	{
+		struct gr_info_s *gr_info = &(si->ch[ch].gr[gr]);
+		int i;
+		gr_info->pow2gain = fr->gainpow2+256 - gr_info->global_gain + powdiff;
+		if(ms_stereo) gr_info->pow2gain += 2;
+		for(i=0;i<3;i++)
+		gr_info->full_gain[i] = gr_info->pow2gain + (gr_info->subblock_gain[i]<<3);
+	}
 	return 0;
 }
 
@@ -697,19 +885,104 @@ static unsigned char pretab_choice[2][22] =
 
 /* 24 is enough because tab13 has max. a 19 bit huffvector */
 #define BITSHIFT ((sizeof(long)-1)*8)
+/*
+	Top up mask to at least BITSHIFT valid bits with the whole bytes that fit,
+	from one word load. The bits below the valid ones get filled with the
+	following stream bits; those are the same that a later refill ORs in.
+*/
 #define REFRESH_MASK \
-	while(num < BITSHIFT) { \
-		mask |= ((unsigned long)getbyte(fr))<<(BITSHIFT-num); \
-		num += 8; \
-		part2remain -= 8; }
+	if(num < BITSHIFT) { \
+		int bytes = (BITSHIFT+7-num)>>3; \
+		mask |= (unsigned long)(getbits_word(fr->wordpointer)>>(64-8*sizeof(long)+num)); \
+		fr->wordpointer += bytes; \
+		num += 8*bytes; \
+		part2remain -= 8*bytes; }
+
+#define HUFF_LOOKUP(tab) ((tab) + ((unsigned long)mask >> (BITSHIFT+8-HUFF_BITS)))
 
-static int III_dequantize_sample(mpg123_handle *fr, real xr[SBLIMIT][SSLIMIT],int *scf, struct gr_info_s *gr_info,int sfreq,int part2bits)
+/*
+	Decode big values with table h: either complete pairs from the lookup table hp
+	(with signs) into pairs/pair, or one pair without signs and linbits into x, y.
+*/
+#define HUFF_NEXT_PAIR \
+{ \
+	const short *val = h->table; \
+	REFRESH_MASK; \
+	if(hp) \
+	{ \
+		const struct huff_pairs *e = HUFF_LOOKUP(hp); \
+		if(e->n) \
+		{ \
+			pairs = e->n < lp ? e->n : lp; \
+			pair  = e->xy; \
+			num  -= e->bits[pairs-1]; \
+			mask <<= e->bits[pairs-1]; \
+		} \
+		else if(!e->node) \
+		{ \
+			x = e->xy[0]; \
+			y = e->xy[1]; \
+			num  -= e->bits[0]; \
+			mask <<= e->bits[0]; \
+			val = NULL; \
+		} \
+		else \
+		{ \
+			val  += e->node; \
+			num  -= HUFF_BITS; \
+			mask <<= HUFF_BITS; \
+		} \
+	} \
+	if(!pairs && val) \
+	{ \
+		while((y=*val++)<0) \
+		{ \
+			if (mask < 0) val -= y; \
+			num--; \
+			mask <<= 1; \
+		} \
+		x = y >> 4; \
+		y &= 0xf; \
+	} \
+}
+
+/*
+	Complete count1 quadruples from the lookup table hq into quads/quad, as many
+	as fit into the part2_3_length bits left; the last one must not end exactly
+	there without sign bits, as the tree decoding drops such a quadruple.
+*/
+#define HUFF_NEXT_QUADS \
+{ \
+	const struct huff_quads *e = HUFF_LOOKUP(hq); \
+	int left = part2remain+num; \
+	while( quads < e->n && quads < l3 \
+	&&    ( e->bits[quads] < left || (e->bits[quads] == left && (e->v[quads] & 0xf)) ) ) \
+		++quads; \
+	if(quads) \
+	{ \
+		quad  = e->v; \
+		num  -= e->bits[quads-1]; \
+		mask <<= e->bits[quads-1]; \
+	} \
+}
+
+/*
+	Only the scale factor bands that start below sblimit subbands are decoded,
+	the bits of the others are skipped via part2_3_length without Huffman
+	decoding. Their samples stay zero.
+*/
+static int III_dequantize_sample(mpg123_handle *fr, real xr[SBLIMIT][SSLIMIT],int *scf, struct gr_info_s *gr_info,int sfreq,int part2bits,int sblimit)
 {
 	int shift = 1 + gr_info->scalefac_scale;
 	real *xrpnt = (real *) xr;
+	const real *xrcut = (real *) xr[sblimit];
 	int l[3],l3;
 	int part2remain = gr_info->part2_3_length - part2bits;
 	int *me;
+	int lookup = !(fr->p.flags & MPG123_PLAIN_HUFFMAN);
+	const struct huff_quads *hq = lookup ? huff_quads_tab[gr_info->count1table_select] : NULL;
+	const unsigned char *quad = NULL;
+	int quads = 0;
 #ifdef REAL_IS_FIXED
 	int gainpow2_scale_idx = 378;
 #endif
@@ -779,13 +1052,17 @@ static int III_dequantize_sample(mpg123_handle *fr, real xr[SBLIMIT][SSLIMIT],in
 		{
 			int lp = l[i];
 			const struct newhuff *h = ht+gr_info->table_select[i];
+			const struct huff_pairs *hp = lookup ? huff_pairs_tab[gr_info->table_select[i]] : NULL;
+			const signed char *pair = NULL;
+			int pairs = 0;
 			for(;lp;lp--,mc--)
 			{
-				register long x,y;
+				register long x=0,y=0;
 				if( (!mc) )
 				{
 					mc    = *m++;
 					xrpnt = ((real *) xr) + (*m++);
+					if(xrpnt >= xrcut) goto short_cut;
 					lwin  = *m++;
 					cb    = *m++;
 					if(lwin == 3)
@@ -805,31 +1082,31 @@ static int III_dequantize_sample(mpg123_handle *fr, real xr[SBLIMIT][SSLIMIT],in
 						step = 3;
 					}
 				}
+				if(!pairs) HUFF_NEXT_PAIR
+				if(pairs)
 				{
-					const short *val = h->table;
-					REFRESH_MASK;
-#ifdef USE_NEW_HUFFTABLE
-					while((y=val[(unsigned long)mask>>(BITSHIFT+4)])<0)
+					pairs--;
+					x = *pair++;
+					y = *pair++;
+					if(x)
 					{
-						val -= y;
-						num -= 4;
-						mask <<= 4;
+						max[lwin] = cb;
+						if(x < 0) *xrpnt = REAL_MUL_SCALE_LAYER3(-ispow[-x], v, gainpow2_scale_idx);
+						else      *xrpnt = REAL_MUL_SCALE_LAYER3( ispow[x], v, gainpow2_scale_idx);
 					}
-					num -= (y >> 8);
-					mask <<= (y >> 8);
-					x = (y >> 4) & 0xf;
-					y &= 0xf;
-#else
-					while((y=*val++)<0)
-					{
-						if (mask < 0) val -= y;
+					else *xrpnt = DOUBLE_TO_REAL(0.0);
 
-						num--;
-						mask <<= 1;
+					xrpnt += step;
+					if(y)
+					{
+						max[lwin] = cb;
+						if(y < 0) *xrpnt = REAL_MUL_SCALE_LAYER3(-ispow[-y], v, gainpow2_scale_idx);
+						else      *xrpnt = REAL_MUL_SCALE_LAYER3( ispow[y], v, gainpow2_scale_idx);
 					}
-					x = y >> 4;
-					y &= 0xf;
-#endif
+					else *xrpnt = DOUBLE_TO_REAL(0.0);
+
+					xrpnt += step;
+					continue;
 				}
 				if(x == 15 && h->linbits)
 				{
@@ -882,11 +1159,12 @@ static int III_dequantize_sample(mpg123_handle *fr, real xr[SBLIMIT][SSLIMIT],in
 			}
 		}
 
-		for(;l3 && (part2remain+num > 0);l3--)
+		for(;l3 && (quads || part2remain+num > 0);l3--)
 		{
 			const struct newhuff* h;
 			const short* val;
 			register short a;
+			int looked_up;
 			/*
 				This is only a humble hack to prevent a special segfault.
 				More insight into the real workings is still needed.
@@ -906,18 +1184,31 @@ static int III_dequantize_sample(mpg123_handle *fr, real xr[SBLIMIT][SSLIMIT],in
 			h = htc+gr_info->count1table_select;
 			val = h->table;
 
-			REFRESH_MASK;
-			while((a=*val++)<0)
+			if(!quads)
 			{
-				if(mask < 0) val -= a;
-
-				num--;
-				mask <<= 1;
+				REFRESH_MASK;
+				if(hq) HUFF_NEXT_QUADS
 			}
-			if(part2remain+num <= 0)
+			looked_up = quads > 0;
+			if(looked_up)
 			{
-				num -= part2remain+num;
-				break;
+				quads--;
+				a = *quad++;
+			}
+			else
+			{
+				while((a=*val++)<0)
+				{
+					if(mask < 0) val -= a;
+
+					num--;
+					mask <<= 1;
+				}
+				if(part2remain+num <= 0)
+				{
+					num -= part2remain+num;
+					break;
+				}
 			}
 
 			for(i=0;i<4;i++)
@@ -928,6 +1219,7 @@ static int III_dequantize_sample(mpg123_handle *fr, real xr[SBLIMIT][SSLIMIT],in
 					{
 						mc = *m++;
 						xrpnt = ((real *) xr) + (*m++);
+						if(xrpnt >= xrcut) goto short_cut;
 						lwin = *m++;
 						cb = *m++;
 						if(lwin == 3)
@@ -951,15 +1243,20 @@ static int III_dequantize_sample(mpg123_handle *fr, real xr[SBLIMIT][SSLIMIT],in
 				}
 				if( (a & (0x8>>i)) )
 				{
+					int negative;
 					max[lwin] = cb;
-					if(part2remain+num <= 0)
-					break;
+					if(looked_up) negative = a & (0x80>>i);
+					else
+					{
+						if(part2remain+num <= 0)
+						break;
 
-					if(mask < 0) *xrpnt = -REAL_SCALE_LAYER3(v, gainpow2_scale_idx);
+						negative = mask < 0;
+						num--;
+						mask <<= 1;
+					}
+					if(negative) *xrpnt = -REAL_SCALE_LAYER3(v, gainpow2_scale_idx);
 					else         *xrpnt =  REAL_SCALE_LAYER3(v, gainpow2_scale_idx);
-
-					num--;
-					mask <<= 1;
 				}
 				else *xrpnt = DOUBLE_TO_REAL(0.0);
 
@@ -987,7 +1284,7 @@ static int III_dequantize_sample(mpg123_handle *fr, real xr[SBLIMIT][SSLIMIT],in
 				m++; /* cb */
 			}
 		}
-
+short_cut:
 		gr_info->maxband[0] = max[0]+1;
 		gr_info->maxband[1] = max[1]+1;
 		gr_info->maxband[2] = max[2]+1;
@@ -1015,12 +1312,16 @@ static int III_dequantize_sample(mpg123_handle *fr, real xr[SBLIMIT][SSLIMIT],in
 		{
 			int lp = l[i];
 			const struct newhuff *h = ht+gr_info->table_select[i];
+			const struct huff_pairs *hp = lookup ? huff_pairs_tab[gr_info->table_select[i]] : NULL;
+			const signed char *pair = NULL;
+			int pairs = 0;
 
 			for(;lp;lp--,mc--)
 			{
-				long x,y;
+				long x=0,y=0;
 				if(!mc)
 				{
+					if(xrpnt >= xrcut) goto long_cut;
 					mc = *m++;
 					cb = *m++;
 #ifdef CUT_SFB21
@@ -1035,31 +1336,29 @@ static int III_dequantize_sample(mpg123_handle *fr, real xr[SBLIMIT][SSLIMIT],in
 						v = gr_info->pow2gain[(*(scf++) + (*pretab++)) << shift];
 					}
 				}
+				if(!pairs) HUFF_NEXT_PAIR
+				if(pairs)
 				{
-					const short *val = h->table;
-					REFRESH_MASK;
-#ifdef USE_NEW_HUFFTABLE
-					while((y=val[(unsigned long)mask>>(BITSHIFT+4)])<0)
+					pairs--;
+					x = *pair++;
+					y = *pair++;
+					if(x)
 					{
-						val -= y;
-						num -= 4;
-						mask <<= 4;
+						max = cb;
+						if(x < 0) *xrpnt++ = REAL_MUL_SCALE_LAYER3(-ispow[-x], v, gainpow2_scale_idx);
+						else      *xrpnt++ = REAL_MUL_SCALE_LAYER3( ispow[x], v, gainpow2_scale_idx);
 					}
-					num -= (y >> 8);
-					mask <<= (y >> 8);
-					x = (y >> 4) & 0xf;
-					y &= 0xf;
-#else
-					while((y=*val++)<0)
-					{
-						if (mask < 0) val -= y;
+					else *xrpnt++ = DOUBLE_TO_REAL(0.0);
 
-						num--;
-						mask <<= 1;
+					if(y)
+					{
+						max = cb;
+						if(y < 0) *xrpnt++ = REAL_MUL_SCALE_LAYER3(-ispow[-y], v, gainpow2_scale_idx);
+						else      *xrpnt++ = REAL_MUL_SCALE_LAYER3( ispow[y], v, gainpow2_scale_idx);
 					}
-					x = y >> 4;
-					y &= 0xf;
-#endif
+					else *xrpnt++ = DOUBLE_TO_REAL(0.0);
+
+					continue;
 				}
 
 				if(x == 15 && h->linbits)
@@ -1111,24 +1410,38 @@ static int III_dequantize_sample(mpg123_handle *fr, real xr[SBLIMIT][SSLIMIT],in
 		}
 
 		/* short (count1table) values */
-		for(;l3 && (part2remain+num > 0);l3--)
+		for(;l3 && (quads || part2remain+num > 0);l3--)
 		{
 			const struct newhuff *h = htc+gr_info->count1table_select;
 			const short *val = h->table;
 			register short a;
+			int looked_up;
 
-			REFRESH_MASK;
-			while((a=*val++)<0)
+			if(!quads)
 			{
-				if (mask < 0) val -= a;
-
-				num--;
-				mask <<= 1;
+				REFRESH_MASK;
+				if(hq) HUFF_NEXT_QUADS
 			}
-			if(part2remain+num <= 0)
+			looked_up = quads > 0;
+			if(looked_up)
 			{
-				num -= part2remain+num;
-				break;
+				quads--;
+				a = *quad++;
+			}
+			else
+			{
+				while((a=*val++)<0)
+				{
+					if (mask < 0) val -= a;
+
+					num--;
+					mask <<= 1;
+				}
+				if(part2remain+num <= 0)
+				{
+					num -= part2remain+num;
+					break;
+				}
 			}
 
 			for(i=0;i<4;i++)
@@ -1137,6 +1450,7 @@ static int III_dequantize_sample(mpg123_handle *fr, real xr[SBLIMIT][SSLIMIT],in
 				{
 					if(!mc)
 					{
+						if(xrpnt >= xrcut) goto long_cut;
 						mc = *m++;
 						cb = *m++;
 #ifdef CUT_SFB21
@@ -1155,20 +1469,25 @@ static int III_dequantize_sample(mpg123_handle *fr, real xr[SBLIMIT][SSLIMIT],in
 				}
 				if( (a & (0x8>>i)) )
 				{
+					int negative;
 					max = cb;
-					if(part2remain+num <= 0)
-					break;
+					if(looked_up) negative = a & (0x80>>i);
+					else
+					{
+						if(part2remain+num <= 0)
+						break;
 
-					if(mask < 0) *xrpnt++ = -REAL_SCALE_LAYER3(v, gainpow2_scale_idx);
+						negative = mask < 0;
+						num--;
+						mask <<= 1;
+					}
+					if(negative) *xrpnt++ = -REAL_SCALE_LAYER3(v, gainpow2_scale_idx);
 					else         *xrpnt++ =  REAL_SCALE_LAYER3(v, gainpow2_scale_idx);
-
-					num--;
-					mask <<= 1;
 				}
 				else *xrpnt++ = DOUBLE_TO_REAL(0.0);
 			}
 		}
-
+long_cut:
 		gr_info->maxbandl = max+1;
 		gr_info->maxb = fr->longLimit[sfreq][gr_info->maxbandl];
 	}
@@ -1368,7 +1687,41 @@ maybe still wrong??? (copy 12 to 13?) */
 }
 
 
-static void III_antialias(real xr[SBLIMIT][SSLIMIT],struct gr_info_s *gr_info)
+/* Turn mid/side into left/right, for the first count values of both channels. */
+void stereo_ms(real *in0, real *in1, int count)
+{
+	int i;
+	for(i=0;i<count;i++)
+	{
+		real tmp0 = in0[i];
+		real tmp1 = in1[i];
+		in0[i] = tmp0 + tmp1;
+		in1[i] = tmp0 - tmp1;
+	}
+}
+
+/* 31 alias-reduction operations between each pair of sub-bands */
+/* with 8 butterflies between each pair, starting at xr1 = xr[1] */
+void antialias(real *xr1, int sblim)
+{
+	int sb;
+
+	for(sb=sblim; sb; sb--,xr1+=10)
+	{
+		int ss;
+		const real *cs=aa_cs,*ca=aa_ca;
+		real *xr2 = xr1;
+
+		for(ss=7;ss>=0;ss--)
+		{ /* upper and lower butterfly inputs */
+			register real bu = *--xr2,bd = *xr1;
+			*xr2   = REAL_MUL(bu, *cs) - REAL_MUL(bd, *ca);
+			*xr1++ = REAL_MUL(bd, *cs++) + REAL_MUL(bu, *ca++);
+		}
+	}
+}
+
+static void III_antialias(mpg123_handle *fr, real xr[SBLIMIT][SSLIMIT],struct gr_info_s *gr_info)
 {
 	int sblim;
 
@@ -1380,27 +1733,7 @@ static void III_antialias(real xr[SBLIMIT][SSLIMIT],struct gr_info_s *gr_info)
 	}
 	else sblim = gr_info->maxb-1;
 
-	/* 31 alias-reduction operations between each pair of sub-bands */
-	/* with 8 butterflies between each pair                         */
-
-	{
-		int sb;
-		real *xr1=(real *) xr[1];
-
-		for(sb=sblim; sb; sb--,xr1+=10)
-		{
-			int ss;
-			real *cs=aa_cs,*ca=aa_ca;
-			real *xr2 = xr1;
-
-			for(ss=7;ss>=0;ss--)
-			{ /* upper and lower butterfly inputs */
-				register real bu = *--xr2,bd = *xr1;
-				*xr2   = REAL_MUL(bu, *cs) - REAL_MUL(bd, *ca);
-				*xr1++ = REAL_MUL(bd, *cs++) + REAL_MUL(bu, *ca++);
-			}
-		}
-	}
+	opt_antialias(fr)((real *) xr[1], sblim);
 }
 
 /* 
@@ -1724,7 +2057,7 @@ void dct36(real *inbuf,real *o1,real *o2,real *wintab,real *tsbuf)
 
 
 /* new DCT12 */
-static void dct12(real *in,real *rawout1,real *rawout2,register real *wi,register real *ts)
+void dct12(real *in,real *rawout1,real *rawout2,register real *wi,register real *ts)
 {
 #define DCT12_PART1 \
 	in5 = in[5*3];  \
@@ -1861,9 +2194,24 @@ static void dct12(real *in,real *rawout1,real *rawout2,register real *wi,registe
 }
 
 
+/* The count subbands above maxb: only the overlap from the last granule is left. */
+void hybrid_tail(real *rawout1, real *rawout2, real *ts, int count)
+{
+	for(;count;count--,ts++)
+	{
+		int i;
+		for(i=0;i<SSLIMIT;i++)
+		{
+			ts[i*SBLIMIT] = *rawout1++;
+			*rawout2++ = DOUBLE_TO_REAL(0.0);
+		}
+	}
+}
+
+
 static void III_hybrid(real fsIn[SBLIMIT][SSLIMIT], real tsOut[SSLIMIT][SBLIMIT], int ch,struct gr_info_s *gr_info, mpg123_handle *fr)
 {
-	real (*block)[2][SBLIMIT*SSLIMIT] = fr->hybrid_block;
+	real (*block)[2][SBLIMIT*SSLIMIT] = fr->layer3.hybrid_block;
 	int *blc = fr->hybrid_blc;
 
 	real *tspnt = (real *) tsOut;
@@ -1892,8 +2240,8 @@ static void III_hybrid(real fsIn[SBLIMIT][SSLIMIT], real tsOut[SSLIMIT][SBLIMIT]
 	{
 		for(; sb<gr_info->maxb; sb+=2,tspnt+=2,rawout1+=36,rawout2+=36)
 		{
-			dct12(fsIn[sb]  ,rawout1   ,rawout2   ,win[2] ,tspnt);
-			dct12(fsIn[sb+1],rawout1+18,rawout2+18,win1[2],tspnt+1);
+			opt_dct12(fr)(fsIn[sb]  ,rawout1   ,rawout2   ,win[2] ,tspnt);
+			opt_dct12(fr)(fsIn[sb+1],rawout1+18,rawout2+18,win1[2],tspnt+1);
 		}
 	}
 	else
@@ -1905,22 +2253,374 @@ static void III_hybrid(real fsIn[SBLIMIT][SSLIMIT], real tsOut[SSLIMIT][SBLIMIT]
 		}
 	}
 
-	for(;sb<SBLIMIT;sb++,tspnt++)
+	opt_hybrid_tail(fr)(rawout1, rawout2, tspnt, SBLIMIT-(int)sb);
+}
+
+
+/*
+	Decoding of one granule is split in two stages:
+	III_granule_in() reads scale factors and Huffman data from the bitstream and
+	dequantizes (including stereo processing) into hybridIn,
+	III_granule_out() runs antialias, hybrid and synth on that.
+	The stages only share the hybridIn buffer and the side info of the granule,
+	which enables the pipelined decoding with MPG123_PIPELINE below.
+*/
+static int III_granule_in( mpg123_handle *fr, struct III_sideinfo *sideinfo, int gr
+,	int scalefacs[2][39], real hybridIn[2][SBLIMIT][SSLIMIT]
+,	int stereo, int single, int ms_stereo, int i_stereo, int sfreq )
+{
 	{
-		int i;
-		for(i=0;i<SSLIMIT;i++)
+		struct gr_info_s *gr_info = &(sideinfo->ch[0].gr[gr]);
+		long part2bits;
+		if(fr->lsf)
+		part2bits = III_get_scale_factors_2(fr, scalefacs[0],gr_info,0);
+		else
+		part2bits = III_get_scale_factors_1(fr, scalefacs[0],gr_info,0,gr);
+
+		if(III_dequantize_sample(fr, hybridIn[0], scalefacs[0],gr_info,sfreq,part2bits,fr->down_sample_sblimit))
 		{
-			tspnt[i*SBLIMIT] = *rawout1++;
-			*rawout2++ = DOUBLE_TO_REAL(0.0);
+			if(VERBOSE2) error("dequantization failed!");
+			return -1;
+		}
+	}
+
+	/* No need for the side channel in the mix, just pass its bits. */
+	if(stereo == 2 && MIX_MID_ONLY(single, ms_stereo, i_stereo))
+	skipbits(fr, sideinfo->ch[1].gr[gr].part2_3_length);
+	else if(stereo == 2)
+	{
+		struct gr_info_s *gr_info = &(sideinfo->ch[1].gr[gr]);
+		long part2bits;
+		if(fr->lsf) 
+		part2bits = III_get_scale_factors_2(fr, scalefacs[1],gr_info,i_stereo);
+		else
+		part2bits = III_get_scale_factors_1(fr, scalefacs[1],gr_info,1,gr);
+
+		/* Intensity stereo starts above the last non-zero band of the right channel, so that needs all. */
+		if(III_dequantize_sample(fr, hybridIn[1],scalefacs[1],gr_info,sfreq,part2bits,i_stereo ? SBLIMIT : fr->down_sample_sblimit))
+		{
+			if(VERBOSE2) error("dequantization failed!");
+			return -1;
+		}
+
+		if(ms_stereo)
+		{
+			unsigned int maxb = sideinfo->ch[0].gr[gr].maxb;
+			if(sideinfo->ch[1].gr[gr].maxb > maxb) maxb = sideinfo->ch[1].gr[gr].maxb;
+
+			opt_stereo_ms(fr)((real *)hybridIn[0], (real *)hybridIn[1], SSLIMIT*(int)maxb);
+		}
+
+		if(i_stereo) III_i_stereo(hybridIn,scalefacs[1],gr_info,sfreq,ms_stereo,fr->lsf);
+
+		if(ms_stereo || i_stereo || (single == SINGLE_MIX) )
+		{
+			if(gr_info->maxb > sideinfo->ch[0].gr[gr].maxb) 
+			sideinfo->ch[0].gr[gr].maxb = gr_info->maxb;
+			else
+			gr_info->maxb = sideinfo->ch[0].gr[gr].maxb;
+		}
+
+		switch(single)
+		{
+			case SINGLE_MIX:
+			{
+				register int i;
+				register real *in0 = (real *) hybridIn[0],*in1 = (real *) hybridIn[1];
+				for(i=0;i<SSLIMIT*(int)gr_info->maxb;i++,in0++)
+				*in0 = (*in0 + *in1++); /* *0.5 done by pow-scale */ 
+			}
+			break;
+			case SINGLE_RIGHT:
+			{
+				register int i;
+				register real *in0 = (real *) hybridIn[0],*in1 = (real *) hybridIn[1];
+				for(i=0;i<SSLIMIT*(int)gr_info->maxb;i++)
+				*in0++ = *in1++;
+			}
+			break;
 		}
 	}
+	return 0;
+}
+
+static int III_granule_out( mpg123_handle *fr, struct III_sideinfo *sideinfo, int gr
+,	real hybridIn[2][SBLIMIT][SSLIMIT], int stereo1, int single )
+{
+	int ch, ss, clip=0;
+	/*  hybridOut[2][SSLIMIT][SBLIMIT] */
+	real (*hybridOut)[SSLIMIT][SBLIMIT] = fr->layer3.hybrid_out;
+
+	if(fr->tap_kinds & MPG123_TAP_SPECTRUM)
+	for(ch=0;ch<stereo1;ch++)
+	{
+		struct gr_info_s *gr_info = &(sideinfo->ch[ch].gr[gr]);
+		struct mpg123_tap_data td = { MPG123_TAP_SPECTRUM, 0, 0, 0, 0, NULL, 0 };
+		td.channel = ch;
+		td.granule = gr;
+		td.block_type = (int)gr_info->block_type;
+		td.mixed_block = (int)gr_info->mixed_block_flag;
+		frame_tap(fr, &td, hybridIn[ch][0], SSLIMIT*(size_t)gr_info->maxb);
+	}
+	/* Nothing more wanted from this granule. */
+	if((fr->p.flags & MPG123_TAP_ONLY) && !(fr->tap_kinds & MPG123_TAP_SUBBANDS))
+	return 0;
+
+	for(ch=0;ch<stereo1;ch++)
+	{
+		struct gr_info_s *gr_info = &(sideinfo->ch[ch].gr[gr]);
+		III_antialias(fr, hybridIn[ch],gr_info);
+		III_hybrid(hybridIn[ch], hybridOut[ch], ch,gr_info, fr);
+	}
+
+	if(fr->tap_kinds & MPG123_TAP_SUBBANDS)
+	for(ch=0;ch<stereo1;ch++)
+	{
+		struct gr_info_s *gr_info = &(sideinfo->ch[ch].gr[gr]);
+		struct mpg123_tap_data td = { MPG123_TAP_SUBBANDS, 0, 0, 0, 0, NULL, 0 };
+		td.channel = ch;
+		td.granule = gr;
+		td.block_type = (int)gr_info->block_type;
+		td.mixed_block = (int)gr_info->mixed_block_flag;
+		frame_tap(fr, &td, hybridOut[ch][0], SSLIMIT*SBLIMIT);
+	}
+	if(fr->p.flags & MPG123_TAP_ONLY)
+	return 0;
+
+#ifdef OPT_I486
+	if(single != SINGLE_STEREO || fr->af.encoding != MPG123_ENC_SIGNED_16 || fr->down_sample != 0)
+	{
+#endif
+	for(ss=0;ss<SSLIMIT;ss++)
+	{
+		if(single != SINGLE_STEREO)
+		clip += (fr->synth_mono)(hybridOut[0][ss], fr);
+		else
+		clip += (fr->synth_stereo)(hybridOut[0][ss], hybridOut[1][ss], fr);
+
+	}
+#ifdef OPT_I486
+	} else
+	{
+		/* Only stereo, 16 bits benefit from the 486 optimization. */
+		ss=0;
+		while(ss < SSLIMIT)
+		{
+			int n;
+			n=(fr->buffer.size - fr->buffer.fill) / (2*2*32);
+			if(n > (SSLIMIT-ss)) n=SSLIMIT-ss;
+
+			/* Clip counting makes no sense with this function. */
+			absynth_1to1_i486(hybridOut[0][ss], 0, fr, n);
+			absynth_1to1_i486(hybridOut[1][ss], 1, fr, n);
+			ss+=n;
+			fr->buffer.fill+=(2*2*32)*n;
+		}
+	}
+#endif
+	return clip;
+}
+
+#ifdef USE_THREADS
+/*
+	Pipelined decoding (MPG123_PIPELINE):
+	A helper thread per handle runs III_granule_in() for the granules of the
+	current frame, each into its own slot of a small ring of hybridIn buffers.
+	The decoding thread runs III_granule_out() on a granule as soon as it is
+	ready, so synthesis of the first granule overlaps with Huffman decoding
+	and dequantization of the second one.
+	Reading of the frame and its side info stays with the decoding thread:
+	The reader, the seeking and the frame bookkeeping are not thread-safe.
+	The helper is done with a frame before do_layer3() returns, so nothing
+	else in the handle needs any locking.
+*/
+struct layer3_pipe
+{
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t wake;  /* helper waits for a new frame or quit */
+	pthread_cond_t ready; /* decoder waits for the next granule */
+	int quit;
+	unsigned long job;    /* counts frames handed to the helper */
+	int granules;         /* granules to decode in current frame */
+	int done;             /* granules dequantized in current frame */
+	int busy;             /* helper working on current frame */
+	struct III_sideinfo *sideinfo;
+	int stereo, single, ms_stereo, i_stereo, sfreq;
+	void *space;
+	real (*in)[2][SBLIMIT][SSLIMIT]; /* ALIGNED(16) real in[2][2][SBLIMIT][SSLIMIT] */
+};
+
+static void *layer3_pipe_thread(void *arg)
+{
+	mpg123_handle *fr = arg;
+	struct layer3_pipe *pipe = fr->layer3.pipe;
+	unsigned long job = 0;
+	int scalefacs[2][39];
+
+	pthread_mutex_lock(&pipe->lock);
+	while(1)
+	{
+		int gr;
+		while(!pipe->quit && pipe->job == job)
+		pthread_cond_wait(&pipe->wake, &pipe->lock);
+		if(pipe->quit) break;
+
+		job = pipe->job;
+		pthread_mutex_unlock(&pipe->lock);
+		for(gr=0; gr<pipe->granules; ++gr)
+		{
+			int err = III_granule_in( fr, pipe->sideinfo, gr, scalefacs, pipe->in[gr]
+			,	pipe->stereo, pipe->single, pipe->ms_stereo, pipe->i_stereo, pipe->sfreq );
+			pthread_mutex_lock(&pipe->lock);
+			if(!err) ++pipe->done;
+			pthread_cond_signal(&pipe->ready);
+			pthread_mutex_unlock(&pipe->lock);
+			if(err) break;
+		}
+		pthread_mutex_lock(&pipe->lock);
+		pipe->busy = 0;
+		pthread_cond_signal(&pipe->ready);
+	}
+	pthread_mutex_unlock(&pipe->lock);
+	return NULL;
 }
 
+/* Start the helper thread, on failure the flag is dropped and decoding stays serial. */
+static struct layer3_pipe *layer3_pipe_init(mpg123_handle *fr)
+{
+	struct layer3_pipe *pipe;
+	size_t insize = sizeof(real)*2*2*SBLIMIT*SSLIMIT;
+
+	pipe = malloc(sizeof(struct layer3_pipe));
+	if(pipe != NULL)
+	{
+		pipe->space = malloc(insize+63);
+		if(pipe->space == NULL)
+		{
+			free(pipe);
+			pipe = NULL;
+		}
+	}
+	if(pipe != NULL)
+	{
+		/* Same 64 byte alignment as fr->layerscratch. */
+		uintptr_t aoff = (uintptr_t)(char*)pipe->space % 64;
+		pipe->in = (real(*)[2][SBLIMIT][SSLIMIT])
+			((char*)pipe->space + (aoff ? 64-aoff : 0));
+		pipe->quit = 0;
+		pipe->job = 0;
+		pipe->granules = pipe->done = pipe->busy = 0;
+		pthread_mutex_init(&pipe->lock, NULL);
+		pthread_cond_init(&pipe->wake, NULL);
+		pthread_cond_init(&pipe->ready, NULL);
+		fr->layer3.pipe = pipe;
+		if(pthread_create(&pipe->thread, NULL, layer3_pipe_thread, fr))
+		{
+			fr->layer3.pipe = NULL;
+			pthread_cond_destroy(&pipe->ready);
+			pthread_cond_destroy(&pipe->wake);
+			pthread_mutex_destroy(&pipe->lock);
+			free(pipe->space);
+			free(pipe);
+			pipe = NULL;
+		}
+	}
+	if(pipe == NULL)
+	{
+		if(NOQUIET) error("cannot start pipeline thread, decoding serially");
+		fr->p.flags &= ~MPG123_PIPELINE;
+	}
+	return pipe;
+}
+
+void layer3_pipe_exit(mpg123_handle *fr)
+{
+	struct layer3_pipe *pipe = fr->layer3.pipe;
+	if(pipe == NULL) return;
+
+	pthread_mutex_lock(&pipe->lock);
+	pipe->quit = 1;
+	pthread_cond_signal(&pipe->wake);
+	pthread_mutex_unlock(&pipe->lock);
+	pthread_join(pipe->thread, NULL);
+	pthread_cond_destroy(&pipe->ready);
+	pthread_cond_destroy(&pipe->wake);
+	pthread_mutex_destroy(&pipe->lock);
+	free(pipe->space);
+	free(pipe);
+	fr->layer3.pipe = NULL;
+}
+
+static int III_pipelined( mpg123_handle *fr, struct layer3_pipe *pipe
+,	struct III_sideinfo *sideinfo, int granules, int stereo, int stereo1
+,	int single, int ms_stereo, int i_stereo, int sfreq )
+{
+	int gr, clip=0;
+
+	pthread_mutex_lock(&pipe->lock);
+	pipe->sideinfo  = sideinfo;
+	pipe->granules  = granules;
+	pipe->stereo    = stereo;
+	pipe->single    = single;
+	pipe->ms_stereo = ms_stereo;
+	pipe->i_stereo  = i_stereo;
+	pipe->sfreq     = sfreq;
+	pipe->done = 0;
+	pipe->busy = 1;
+	++pipe->job;
+	pthread_cond_signal(&pipe->wake);
+	for(gr=0;gr<granules;gr++)
+	{
+		while(pipe->busy && pipe->done <= gr)
+		pthread_cond_wait(&pipe->ready, &pipe->lock);
+		/* Dequantization failed, the rest of the frame is lost. */
+		if(pipe->done <= gr) break;
+
+		pthread_mutex_unlock(&pipe->lock);
+		clip += III_granule_out(fr, sideinfo, gr, pipe->in[gr], stereo1, single);
+		pthread_mutex_lock(&pipe->lock);
+	}
+	/* The helper must be done with the side info on our stack. */
+	while(pipe->busy)
+	pthread_cond_wait(&pipe->ready, &pipe->lock);
+	pthread_mutex_unlock(&pipe->lock);
+
+	return clip;
+}
+#endif
+
+/* Side info of the current frame for mpg123_analyze_next(), in place of decoding it. */
+int III_frame_stats(mpg123_handle *fr, struct mpg123_frame_stats *st)
+{
+	struct III_sideinfo sideinfo;
+	int ms_stereo = fr->mode == MPG_MD_JOINT_STEREO ? (fr->mode_ext & 0x2)>>1 : 0;
+	int gr, ch;
+
+	if(III_get_side_info(fr, &sideinfo, fr->stereo, ms_stereo, fr->sampling_frequency, SINGLE_STEREO))
+	return -1;
+
+	st->granules = fr->lsf ? 1 : 2;
+	st->main_data_begin = (int)sideinfo.main_data_begin;
+	for(gr=0; gr<st->granules; ++gr)
+	for(ch=0; ch<fr->stereo; ++ch)
+	{
+		struct gr_info_s *gr_info = &(sideinfo.ch[ch].gr[gr]);
+		struct mpg123_granule_stats *gs = &st->gr[gr][ch];
+		gs->part2_3_length    = (int)gr_info->part2_3_length;
+		gs->big_values        = (int)gr_info->big_values;
+		gs->global_gain       = (int)gr_info->global_gain;
+		gs->scalefac_compress = (int)gr_info->scalefac_compress;
+		gs->block_type        = (int)gr_info->block_type;
+		gs->mixed_block       = (int)gr_info->mixed_block_flag;
+	}
+	return 0;
+}
 
 /* And at the end... the main layer3 handler */
 int do_layer3(mpg123_handle *fr)
 {
-	int gr, ch, ss,clip=0;
+	int gr, clip=0;
 	int scalefacs[2][39]; /* max 39 for short[13][3] mode, mixed: 38, long: 22 */
 	struct III_sideinfo sideinfo;
 	int stereo = fr->stereo;
@@ -1958,127 +2658,28 @@ int do_layer3(mpg123_handle *fr)
 
 	set_pointer(fr,sideinfo.main_data_begin);
 
+#ifdef USE_THREADS
+	/* With a single granule (MPEG 2/2.5), there is nothing to overlap. */
+	if(granules > 1 && (fr->p.flags & MPG123_PIPELINE))
+	{
+		struct layer3_pipe *pipe = fr->layer3.pipe;
+		if(pipe == NULL) pipe = layer3_pipe_init(fr);
+		if(pipe != NULL)
+		return III_pipelined( fr, pipe, &sideinfo, granules, stereo, stereo1
+		,	single, ms_stereo, i_stereo, sfreq );
+	}
+#endif
+
 	for(gr=0;gr<granules;gr++)
 	{
 		/*  hybridIn[2][SBLIMIT][SSLIMIT] */
 		real (*hybridIn)[SBLIMIT][SSLIMIT] = fr->layer3.hybrid_in;
-		/*  hybridOut[2][SSLIMIT][SBLIMIT] */
-		real (*hybridOut)[SSLIMIT][SBLIMIT] = fr->layer3.hybrid_out;
-
-		{
-			struct gr_info_s *gr_info = &(sideinfo.ch[0].gr[gr]);
-			long part2bits;
-			if(fr->lsf)
-			part2bits = III_get_scale_factors_2(fr, scalefacs[0],gr_info,0);
-			else
-			part2bits = III_get_scale_factors_1(fr, scalefacs[0],gr_info,0,gr);
-
-			if(III_dequantize_sample(fr, hybridIn[0], scalefacs[0],gr_info,sfreq,part2bits))
-			{
-				if(VERBOSE2) error("dequantization failed!");
-				return clip;
-			}
-		}
 
-		if(stereo == 2)
-		{
-			struct gr_info_s *gr_info = &(sideinfo.ch[1].gr[gr]);
-			long part2bits;
-			if(fr->lsf) 
-			part2bits = III_get_scale_factors_2(fr, scalefacs[1],gr_info,i_stereo);
-			else
-			part2bits = III_get_scale_factors_1(fr, scalefacs[1],gr_info,1,gr);
-
-			if(III_dequantize_sample(fr, hybridIn[1],scalefacs[1],gr_info,sfreq,part2bits))
-			{
-				if(VERBOSE2) error("dequantization failed!");
-				return clip;
-			}
-
-			if(ms_stereo)
-			{
-				int i;
-				unsigned int maxb = sideinfo.ch[0].gr[gr].maxb;
-				if(sideinfo.ch[1].gr[gr].maxb > maxb) maxb = sideinfo.ch[1].gr[gr].maxb;
-
-				for(i=0;i<SSLIMIT*(int)maxb;i++)
-				{
-					real tmp0 = ((real *)hybridIn[0])[i];
-					real tmp1 = ((real *)hybridIn[1])[i];
-					((real *)hybridIn[0])[i] = tmp0 + tmp1;
-					((real *)hybridIn[1])[i] = tmp0 - tmp1;
-				}
-			}
-
-			if(i_stereo) III_i_stereo(hybridIn,scalefacs[1],gr_info,sfreq,ms_stereo,fr->lsf);
-
-			if(ms_stereo || i_stereo || (single == SINGLE_MIX) )
-			{
-				if(gr_info->maxb > sideinfo.ch[0].gr[gr].maxb) 
-				sideinfo.ch[0].gr[gr].maxb = gr_info->maxb;
-				else
-				gr_info->maxb = sideinfo.ch[0].gr[gr].maxb;
-			}
-
-			switch(single)
-			{
-				case SINGLE_MIX:
-				{
-					register int i;
-					register real *in0 = (real *) hybridIn[0],*in1 = (real *) hybridIn[1];
-					for(i=0;i<SSLIMIT*(int)gr_info->maxb;i++,in0++)
-					*in0 = (*in0 + *in1++); /* *0.5 done by pow-scale */ 
-				}
-				break;
-				case SINGLE_RIGHT:
-				{
-					register int i;
-					register real *in0 = (real *) hybridIn[0],*in1 = (real *) hybridIn[1];
-					for(i=0;i<SSLIMIT*(int)gr_info->maxb;i++)
-					*in0++ = *in1++;
-				}
-				break;
-			}
-		}
-
-		for(ch=0;ch<stereo1;ch++)
-		{
-			struct gr_info_s *gr_info = &(sideinfo.ch[ch].gr[gr]);
-			III_antialias(hybridIn[ch],gr_info);
-			III_hybrid(hybridIn[ch], hybridOut[ch], ch,gr_info, fr);
-		}
-
-#ifdef OPT_I486
-		if(single != SINGLE_STEREO || fr->af.encoding != MPG123_ENC_SIGNED_16 || fr->down_sample != 0)
-		{
-#endif
-		for(ss=0;ss<SSLIMIT;ss++)
-		{
-			if(single != SINGLE_STEREO)
-			clip += (fr->synth_mono)(hybridOut[0][ss], fr);
-			else
-			clip += (fr->synth_stereo)(hybridOut[0][ss], hybridOut[1][ss], fr);
+		if(III_granule_in( fr, &sideinfo, gr, scalefacs, hybridIn
+		,	stereo, single, ms_stereo, i_stereo, sfreq ))
+		return clip;
 
-		}
-#ifdef OPT_I486
-		} else
-		{
-			/* Only stereo, 16 bits benefit from the 486 optimization. */
-			ss=0;
-			while(ss < SSLIMIT)
-			{
-				int n;
-				n=(fr->buffer.size - fr->buffer.fill) / (2*2*32);
-				if(n > (SSLIMIT-ss)) n=SSLIMIT-ss;
-
-				/* Clip counting makes no sense with this function. */
-				absynth_1to1_i486(hybridOut[0][ss], 0, fr, n);
-				absynth_1to1_i486(hybridOut[1][ss], 1, fr, n);
-				ss+=n;
-				fr->buffer.fill+=(2*2*32)*n;
-			}
-		}
-#endif
+		clip += III_granule_out(fr, &sideinfo, gr, hybridIn, stereo1, single);
 	}
   
 	return clip;
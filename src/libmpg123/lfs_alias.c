@@ -124,6 +124,12 @@ int attribute_align_arg ALIAS_NAME(mpg123_decode_frame)(mpg123_handle *mh, lfs_a
 	return NATIVE_NAME(mpg123_decode_frame)(mh, num, audio, bytes);
 }
 
+int NATIVE_NAME(mpg123_decode_frame_planar)(mpg123_handle *mh, lfs_alias_t *num, unsigned char **planes, size_t *bytes);
+int attribute_align_arg ALIAS_NAME(mpg123_decode_frame_planar)(mpg123_handle *mh, lfs_alias_t *num, unsigned char **planes, size_t *bytes)
+{
+	return NATIVE_NAME(mpg123_decode_frame_planar)(mh, num, planes, bytes);
+}
+
 int NATIVE_NAME(mpg123_framebyframe_decode)(mpg123_handle *mh, lfs_alias_t *num, unsigned char **audio, size_t *bytes);
 int attribute_align_arg ALIAS_NAME(mpg123_framebyframe_decode)(mpg123_handle *mh, lfs_alias_t *num, unsigned char **audio, size_t *bytes)
 {
@@ -45,6 +45,7 @@ if(/^\s*MPG123_EXPORT\s+(\S+)\s+(mpg123_\S+)\((.*)\);\s*$/)
 }' < mpg123.h.in
 
 mpg123_decode_frame
+mpg123_decode_frame_planar
 mpg123_framebyframe_decode
 mpg123_framepos
 mpg123_tell
@@ -181,6 +182,26 @@ int attribute_align_arg mpg123_decode_frame(mpg123_handle *mh, long *num, unsign
 	return err;
 }
 
+#undef mpg123_decode_frame_planar
+/* int mpg123_decode_frame_planar(mpg123_handle *mh, off_t *num, unsigned char **planes, size_t *bytes) */
+int attribute_align_arg mpg123_decode_frame_planar(mpg123_handle *mh, long *num, unsigned char **planes, size_t *bytes)
+{
+	off_t largenum;
+	int err;
+
+	err = MPG123_LARGENAME(mpg123_decode_frame_planar)(mh, &largenum, planes, bytes);
+	if(err == MPG123_OK && num != NULL)
+	{
+		*num = largenum;
+		if(*num != largenum)
+		{
+			mh->err = MPG123_LFS_OVERFLOW;
+			err = MPG123_ERR;
+		}
+	}
+	return err;
+}
+
 #undef mpg123_framebyframe_decode
 /* int mpg123_framebyframe_decode(mpg123_handle *mh, off_t *num, unsigned char **audio, size_t *bytes); */
 int attribute_align_arg mpg123_framebyframe_decode(mpg123_handle *mh, long *num, unsigned char **audio, size_t *bytes)
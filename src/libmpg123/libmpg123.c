@@ -12,7 +12,7 @@
 
 #include "gapless.h"
 
-#define SEEKFRAME(mh) ((mh)->ignoreframe < 0 ? 0 : (mh)->ignoreframe)
+#define SEEKFRAME(mh) ((mh)->seekframe < 0 ? 0 : (mh)->seekframe)
 
 static int initialized = 0;
 
@@ -120,8 +120,9 @@ int attribute_align_arg mpg123_param(mpg123_handle *mh, enum mpg123_parms key, l
 	else
 	{ /* Special treatment for some settings. */
 #ifdef FRAME_INDEX
-		if(key == MPG123_INDEX_SIZE)
-		{ /* Apply frame index size and grow property on the fly. */
+		if(  key == MPG123_INDEX_SIZE || key == MPG123_FLAGS
+		  || key == MPG123_ADD_FLAGS || key == MPG123_REMOVE_FLAGS )
+		{ /* Apply frame index size, grow property and compact storage on the fly. */
 			r = frame_index_setup(mh);
 			if(r != MPG123_OK) mh->err = MPG123_INDEX_FAIL;
 		}
@@ -130,6 +131,9 @@ int attribute_align_arg mpg123_param(mpg123_handle *mh, enum mpg123_parms key, l
 		/* Feeder pool size is applied right away, reader will react to that. */
 		if(key == MPG123_FEEDPOOL || key == MPG123_FEEDBUFFER)
 		bc_poolsize(&mh->rdat.buffer, mh->p.feedpool, mh->p.feedbuffer);
+		/* Same for the waiting of the decoding thread, which is this one. */
+		if(key == MPG123_FEED_WAIT)
+		mh->rdat.buffer.wait = mh->p.feed_wait;
 #endif
 	}
 	return r;
@@ -241,6 +245,32 @@ int attribute_align_arg mpg123_par(mpg123_pars *mp, enum mpg123_parms key, long
 			ret = MPG123_MISSING_FEATURE;
 #endif
 		break;
+		case MPG123_RESAMPLE:
+#ifndef NO_NTOM
+			if(val < MPG123_RESAMPLE_NTOM || val > MPG123_RESAMPLE_MAX) ret = MPG123_BAD_VALUE;
+#ifndef RESAMPLER
+			else if(val != MPG123_RESAMPLE_NTOM) ret = MPG123_MISSING_FEATURE;
+#endif
+			else mp->resample = (int)val;
+#else
+			ret = MPG123_MISSING_FEATURE;
+#endif
+		break;
+		case MPG123_SCAN_THREADS:
+			if(val >= 1) mp->scan_threads = val;
+			else ret = MPG123_BAD_VALUE;
+		break;
+		case MPG123_READAHEAD:
+			if(val >= 0) mp->readahead = val;
+			else ret = MPG123_BAD_VALUE;
+		break;
+		case MPG123_FEED_WAIT:
+			mp->feed_wait = val;
+		break;
+		case MPG123_BANDWIDTH:
+			if(val >= 0) mp->bandwidth = val;
+			else ret = MPG123_BAD_VALUE;
+		break;
 		default:
 			ret = MPG123_BAD_PARAM;
 	}
@@ -330,6 +360,25 @@ int attribute_align_arg mpg123_getpar(mpg123_pars *mp, enum mpg123_parms key, lo
 			ret = MPG123_MISSING_FEATURE;
 #endif
 		break;
+		case MPG123_RESAMPLE:
+#ifndef NO_NTOM
+			if(val) *val = mp->resample;
+#else
+			ret = MPG123_MISSING_FEATURE;
+#endif
+		break;
+		case MPG123_SCAN_THREADS:
+			if(val) *val = mp->scan_threads;
+		break;
+		case MPG123_READAHEAD:
+			if(val) *val = mp->readahead;
+		break;
+		case MPG123_FEED_WAIT:
+			if(val) *val = mp->feed_wait;
+		break;
+		case MPG123_BANDWIDTH:
+			if(val) *val = mp->bandwidth;
+		break;
 		default:
 			ret = MPG123_BAD_PARAM;
 	}
@@ -372,6 +421,25 @@ int attribute_align_arg mpg123_getstate(mpg123_handle *mh, enum mpg123_state key
 			theval = mh->state_flags & FRAME_FRESH_DECODER;
 			mh->state_flags &= ~FRAME_FRESH_DECODER;
 		break;
+		case MPG123_READAHEAD_FILL:
+		case MPG123_READAHEAD_STALLS:
+		{
+			size_t fill;
+			long stalls;
+			readahead_state(&mh->rdat, &fill, &stalls);
+			if(key == MPG123_READAHEAD_STALLS) theval = stalls;
+			else
+			{
+				theval  = (long)fill;
+				thefval = (double)fill;
+				if((size_t)theval != fill)
+				{
+					mh->err = MPG123_INT_OVERFLOW;
+					ret = MPG123_ERR;
+				}
+			}
+		}
+		break;
 		default:
 			mh->err = MPG123_BAD_KEY;
 			ret = MPG123_ERR;
@@ -452,6 +520,19 @@ int attribute_align_arg mpg123_open_handle(mpg123_handle *mh, void *iohandle)
 	return open_stream_handle(mh, iohandle);
 }
 
+int attribute_align_arg mpg123_open_memory(mpg123_handle *mh, const void *data, size_t size)
+{
+	if(mh == NULL) return MPG123_BAD_HANDLE;
+
+	mpg123_close(mh);
+	if(data == NULL && size > 0)
+	{
+		mh->err = MPG123_NULL_BUFFER;
+		return MPG123_ERR;
+	}
+	return open_memory(mh, data, size);
+}
+
 int attribute_align_arg mpg123_open_feed(mpg123_handle *mh)
 {
 	if(mh == NULL) return MPG123_BAD_HANDLE;
@@ -529,6 +610,9 @@ int decode_update(mpg123_handle *mh)
 		case 3:
 		{
 			if(synth_ntom_set_step(mh) != 0) return -1;
+#ifdef RESAMPLER
+			if(resample_setup(mh) != 0) return -1;
+#endif
 			if(frame_freq(mh) > mh->af.rate)
 			{
 				mh->down_sample_sblimit = SBLIMIT * mh->af.rate;
@@ -539,10 +623,23 @@ int decode_update(mpg123_handle *mh)
 			                 ( ( NTOM_MUL-1+mh->spf
 			                   * (((size_t)NTOM_MUL*mh->af.rate)/frame_freq(mh))
 			                 )/NTOM_MUL ));
+#ifdef RESAMPLER
+			/* Room for flushing the filter delay after the last frame, in whole blocks. */
+			if(mh->rs_taps > 0)
+			mh->outblock += outblock_bytes(mh,
+			                  2+(mh->rs_taps/2-1+SBLIMIT)*mh->af.rate/frame_freq(mh) );
+#endif
 		}
 		break;
 #endif
 	}
+	/* A preview of the low frequencies only needs the subbands up to there. */
+	if(mh->p.bandwidth > 0 && mh->p.bandwidth < native_rate/2)
+	{
+		long sblimit = (mh->p.bandwidth*2*SBLIMIT + native_rate-1)/native_rate;
+		if(sblimit < 1) sblimit = 1;
+		if(sblimit < mh->down_sample_sblimit) mh->down_sample_sblimit = (int)sblimit;
+	}
 
 	if(!(mh->p.flags & MPG123_FORCE_MONO))
 	{
@@ -611,7 +708,13 @@ static int get_next_frame(mpg123_handle *mh)
 		mh->to_decode = FALSE;
 		b = read_frame(mh); /* That sets to_decode only if a full frame was read. */
 		debug4("read of frame %li returned %i (to_decode=%i) at sample %li", (long)mh->num, b, mh->to_decode, (long)mpg123_tell(mh));
-		if(b == MPG123_NEED_MORE) return MPG123_NEED_MORE; /* need another call with data */
+		if(b == MPG123_NEED_MORE) /* need another call with data, unless there is none coming */
+		{
+#ifndef NO_FEEDER
+			if(mh->rdat.buffer.end) return MPG123_DONE;
+#endif
+			return MPG123_NEED_MORE;
+		}
 		else if(b <= 0)
 		{
 			/* More sophisticated error control? */
@@ -704,7 +807,7 @@ static void decode_the_frame(mpg123_handle *fr)
 #endif
 		if(fr->buffer.fill < needed_bytes)
 		{
-			if(VERBOSE2)
+			if(VERBOSE2 && !(fr->p.flags & MPG123_TAP_ONLY))
 			fprintf(stderr, "Note: broken frame %li, filling up with %"SIZE_P" zeroes, from %"SIZE_P"\n", (long)fr->num, (size_p)(needed_bytes-fr->buffer.fill), (size_p)fr->buffer.fill);
 
 			/*
@@ -713,12 +816,24 @@ static void decode_the_frame(mpg123_handle *fr)
 				but we have funny 8bit formats that have a different opinion on zero...
 				Unsigned 16 or 32 bit formats are handled later.
 			*/
+			if(fr->planar_synth)
+			{
+				/* Each channel has its own half of the frame to fill up. */
+				size_t half = fr->buffer.fill/2, plane = needed_bytes/2;
+				memset( fr->buffer.data + half, zero_byte(fr), plane - half );
+				memset( fr->buffer.data + plane + half, zero_byte(fr), plane - half );
+			}
+			else
 			memset( fr->buffer.data + fr->buffer.fill, zero_byte(fr), needed_bytes - fr->buffer.fill );
 
 			fr->buffer.fill = needed_bytes;
 #ifndef NO_NTOM
 			/* ntom_val will be wrong when the decoding wasn't carried out completely */
-			ntom_set_ntom(fr, fr->num+1);
+			if(fr->down_sample == 3) ntom_set_ntom(fr, fr->num+1);
+#endif
+#ifdef RESAMPLER
+			/* The filter history does not match the silence, either. */
+			resample_reset(fr);
 #endif
 		}
 #ifdef DEBUG
@@ -728,6 +843,9 @@ static void decode_the_frame(mpg123_handle *fr)
 			error2("I got _more_ bytes than expected (%"SIZE_P" / %"SIZE_P"), that should not be possible!", (size_p)fr->buffer.fill, (size_p)needed_bytes);
 		}
 	}
+#endif
+#ifdef RESAMPLER
+	resample_flush(fr);
 #endif
 	postprocess_buffer(fr);
 }
@@ -761,6 +879,8 @@ int attribute_align_arg mpg123_framebyframe_decode(mpg123_handle *mh, off_t *num
 	mh->to_decode = mh->to_ignore = FALSE;
 	mh->buffer.p = mh->buffer.data;
 	FRAME_BUFFERCHECK(mh);
+	if(mh->p.flags & MPG123_LOUDNESS)
+	loudness_add(mh, mh->buffer.p, mh->buffer.fill, mh->planar);
 	*audio = mh->buffer.p;
 	*bytes = mh->buffer.fill;
 	return MPG123_OK;
@@ -801,6 +921,61 @@ int attribute_align_arg mpg123_framebyframe_next(mpg123_handle *mh)
 	return MPG123_OK;
 }
 
+/*
+	Read the next frame and only parse its side information / bit allocation.
+	No decoder setup needed for that, the header change is left pending for
+	the next get_next_frame(), which then does the decode_update().
+*/
+int attribute_align_arg mpg123_analyze_next(mpg123_handle *mh, struct mpg123_frame_stats *stats)
+{
+	int b;
+	if(mh == NULL) return MPG123_BAD_HANDLE;
+	if(stats == NULL) return MPG123_ERR_NULL;
+
+	mh->to_decode = mh->to_ignore = FALSE;
+	mh->buffer.fill = 0;
+
+	b = read_frame(mh);
+	if(b == MPG123_NEED_MORE)
+	{
+#ifndef NO_FEEDER
+		if(mh->rdat.buffer.end) return MPG123_DONE;
+#endif
+		return MPG123_NEED_MORE;
+	}
+	else if(b <= 0)
+	{
+		if(b==0 || (mh->rdat.filelen >= 0 && mh->rdat.filepos == mh->rdat.filelen))
+		{
+			mh->track_frames = mh->num + 1;
+			return MPG123_DONE;
+		}
+		else return MPG123_ERR;
+	}
+
+	memset(stats, 0, sizeof(*stats));
+	stats->layer = mh->lay;
+	stats->channels = mh->stereo;
+	stats->scale_index[0] = stats->scale_index[1] = 63;
+	switch(mh->lay)
+	{
+#ifndef NO_LAYER1
+		case 1: b = I_frame_stats(mh, stats); break;
+#endif
+#ifndef NO_LAYER2
+		case 2: b = II_frame_stats(mh, stats); break;
+#endif
+#ifndef NO_LAYER3
+		case 3: b = III_frame_stats(mh, stats); break;
+#endif
+		default: b = -1;
+	}
+	if(b) stats->bad = 1;
+	/* The frame is used up, nothing left to decode. */
+	mh->to_decode = FALSE;
+	return MPG123_OK;
+}
+
 /*
 	Put _one_ decoded frame into the frame structure's buffer, accessible at the location stored in <audio>, with <bytes> bytes available.
 	The buffer contents will be lost on next call to mpg123_decode_frame.
@@ -838,6 +1013,8 @@ int attribute_align_arg mpg123_decode_frame(mpg123_handle *mh, off_t *num, unsig
 			mh->to_decode = mh->to_ignore = FALSE;
 			mh->buffer.p = mh->buffer.data;
 			FRAME_BUFFERCHECK(mh);
+			if(mh->p.flags & MPG123_LOUDNESS)
+			loudness_add(mh, mh->buffer.p, mh->buffer.fill, mh->planar);
 			if(audio != NULL) *audio = mh->buffer.p;
 			if(bytes != NULL) *bytes = mh->buffer.fill;
 
@@ -852,6 +1029,39 @@ int attribute_align_arg mpg123_decode_frame(mpg123_handle *mh, off_t *num, unsig
 	}
 }
 
+/*
+	The same with the output split into channels. The data is planar already
+	(MPG123_PLANAR), so the second channel simply starts in the middle.
+*/
+int attribute_align_arg mpg123_decode_frame_planar(mpg123_handle *mh, off_t *num, unsigned char **planes, size_t *bytes)
+{
+	unsigned char *audio;
+	size_t fill;
+	int ret;
+
+	if(bytes != NULL) *bytes = 0;
+	if(mh == NULL) return MPG123_BAD_HANDLE;
+	if(planes == NULL) return MPG123_ERR_NULL;
+
+	ret = mpg123_decode_frame(mh, num, &audio, &fill);
+	if(ret != MPG123_OK) return ret;
+
+	if(mh->af.channels == 2)
+	{
+		if(!mh->planar)
+		{
+			mh->err = MPG123_NOT_PLANAR;
+			return MPG123_ERR;
+		}
+		fill /= 2;
+		planes[1] = audio + fill;
+	}
+	planes[0] = audio;
+	if(bytes != NULL) *bytes = fill;
+
+	return MPG123_OK;
+}
+
 int attribute_align_arg mpg123_read(mpg123_handle *mh, unsigned char *out, size_t size, size_t *done)
 {
 	return mpg123_decode(mh, NULL, 0, out, size, done);
@@ -869,8 +1079,10 @@ int attribute_align_arg mpg123_feed(mpg123_handle *mh, const unsigned char *in,
 			else
 			{
 				/* The need for more data might have triggered an error.
-				   This one is outdated now with the new data. */
-				if(mh->err == MPG123_ERR_READER) mh->err = MPG123_OK;
+				   This one is outdated now with the new data.
+				   A concurrently feeding thread leaves that to the decoding one. */
+				if(mh->err == MPG123_ERR_READER && mh->rdat.buffer.sync == NULL)
+				mh->err = MPG123_OK;
 
 				return MPG123_OK;
 			}
@@ -888,6 +1100,48 @@ int attribute_align_arg mpg123_feed(mpg123_handle *mh, const unsigned char *in,
 #endif
 }
 
+int attribute_align_arg mpg123_feed_borrowed(mpg123_handle *mh, const unsigned char *in, size_t size, void (*release)(void *), void *handle)
+{
+	if(mh == NULL) return MPG123_BAD_HANDLE;
+#ifndef NO_FEEDER
+	if(size > 0)
+	{
+		if(in == NULL)
+		{
+			mh->err = MPG123_NULL_BUFFER;
+			return MPG123_ERR;
+		}
+		if(size > LONG_MAX)
+		{
+			mh->err = MPG123_BAD_BUFFER;
+			return MPG123_ERR;
+		}
+		if(feed_borrow(mh, in, (long)size, release, handle) != 0) return MPG123_ERR;
+		if(mh->err == MPG123_ERR_READER && mh->rdat.buffer.sync == NULL)
+		mh->err = MPG123_OK;
+	}
+	/* Nothing borrowed, nothing to keep. */
+	else if(release != NULL) release(handle);
+
+	return MPG123_OK;
+#else
+	mh->err = MPG123_MISSING_FEATURE;
+	return MPG123_ERR;
+#endif
+}
+
+int attribute_align_arg mpg123_feed_end(mpg123_handle *mh)
+{
+	if(mh == NULL) return MPG123_BAD_HANDLE;
+#ifndef NO_FEEDER
+	feed_end(mh);
+	return MPG123_OK;
+#else
+	mh->err = MPG123_MISSING_FEATURE;
+	return MPG123_ERR;
+#endif
+}
+
 /*
 	The old picture:
 	while(1) {
@@ -931,6 +1185,13 @@ int attribute_align_arg mpg123_decode(mpg123_handle *mh, const unsigned char *in
 				ret = MPG123_NEW_FORMAT;
 				goto decodeend;
 			}
+			/* A byte stream has no place for the planes of a frame. */
+			if(mh->planar)
+			{
+				mh->err = MPG123_PLANAR_OUTPUT;
+				ret = MPG123_ERR;
+				goto decodeend;
+			}
 			if(mh->buffer.size - mh->buffer.fill < mh->outblock)
 			{
 				ret = MPG123_NO_SPACE;
@@ -941,6 +1202,8 @@ int attribute_align_arg mpg123_decode(mpg123_handle *mh, const unsigned char *in
 			mh->buffer.p = mh->buffer.data;
 			debug2("decoded frame %li, got %li samples in buffer", (long)mh->num, (long)(mh->buffer.fill / (samples_to_bytes(mh, 1))));
 			FRAME_BUFFERCHECK(mh);
+			if(mh->p.flags & MPG123_LOUDNESS)
+			loudness_add(mh, mh->buffer.p, mh->buffer.fill, mh->planar);
 		}
 		if(mh->buffer.fill) /* Copy (part of) the decoded data to the caller's buffer. */
 		{
@@ -1090,6 +1353,11 @@ off_t attribute_align_arg mpg123_tell(mpg123_handle *mh)
 		else
 		{ /* We serve what we have in buffer and then the beginning of next frame... */
 			pos = frame_outs(mh, mh->num+1) - bytes_to_samples(mh, mh->buffer.fill);
+#ifdef RESAMPLER
+			/* The last frame may have the flushed filter delay after it. */
+			if((mh->p.flags & MPG123_GAPLESS) && mh->num == mh->gapless_frames-1)
+			pos += mh->rs_tail;
+#endif
 		}
 		/* Substract padding and delay from the beginning. */
 		pos = SAMPLE_ADJUST(mh,pos);
@@ -1114,13 +1382,29 @@ off_t attribute_align_arg mpg123_tell_stream(mpg123_handle *mh)
 	return mh->rd->tell(mh);
 }
 
+/* Put the synth ring buffer offset where continuous decoding from the
+   start would have it (one step per 32 samples) for the first frame to
+   decode, so that the optimized synths sum up in the same order and the
+   output matches to the bit. Frames before ignoreframe are not synthesized. */
+static void seek_ring_offset(mpg123_handle *mh)
+{
+	if(mh->num >= 0)
+	{
+		off_t blocks = (mh->num < mh->ignoreframe ? mh->ignoreframe : mh->num)*(mh->spf/32);
+		mh->bo = (int)((1 + 16 - blocks%16) & 0xf);
+	}
+}
+
 static int do_the_seek(mpg123_handle *mh)
 {
 	int b;
 	off_t fnum = SEEKFRAME(mh);
 	mh->buffer.fill = 0;
 
-	/* If we are inside the ignoreframe - firstframe window, we may get away without actual seeking. */
+	/* The frames read up to ignoreframe are skipped without synthesis, also
+	   when we do not need to seek for real. */
+	if(mh->num < mh->ignoreframe) seek_ring_offset(mh);
+	/* If we are inside the seekframe - firstframe window, we may get away without actual seeking. */
 	if(mh->num < mh->firstframe)
 	{
 		mh->to_decode = FALSE; /* In any case, don't decode the current frame, perhaps ignore instead. */
@@ -1153,8 +1437,11 @@ static int do_the_seek(mpg123_handle *mh)
 	}
 	debug1("seek_frame returned: %i", b);
 	if(b<0) return b;
+	seek_ring_offset(mh);
 	/* Only mh->to_ignore is TRUE. */
 	if(mh->num < mh->firstframe) mh->to_decode = FALSE;
+	/* Frames before ignoreframe are only read for the bit reservoir. */
+	if(mh->num < mh->ignoreframe) frame_skip(mh);
 
 	mh->playnum = mh->num;
 	return 0;
@@ -1333,6 +1620,11 @@ off_t attribute_align_arg mpg123_length(mpg123_handle *mh)
 	debug1("mpg123_length: internal sample length: %"OFF_P, (off_p)length);
 
 	length = frame_ins2outs(mh, length);
+#ifdef RESAMPLER
+	/* Up to the end of the flushed filter delay. */
+	if((mh->p.flags & MPG123_GAPLESS) && length == mh->fullend_os)
+	length += mh->rs_tail;
+#endif
 	debug1("mpg123_length: external sample length: %"OFF_P, (off_p)length);
 	length = SAMPLE_ADJUST(mh,length);
 	return length;
@@ -1344,6 +1636,7 @@ int attribute_align_arg mpg123_scan(mpg123_handle *mh)
 	off_t oldpos;
 	off_t track_frames = 0;
 	off_t track_samples = 0;
+	off_t more_frames;
 
 	if(mh == NULL) return MPG123_BAD_HANDLE;
 	if(!(mh->rdat.flags & READER_SEEKABLE)){ mh->err = MPG123_NO_SEEK; return MPG123_ERR; }
@@ -1356,6 +1649,8 @@ int attribute_align_arg mpg123_scan(mpg123_handle *mh)
 		if(b == MPG123_DONE) return MPG123_OK;
 		else return MPG123_ERR; /* Must be error here, NEED_MORE is not for seekable streams. */
 	}
+	/* Nothing new to learn, maybe thanks to the index cache. */
+	if(mh->state_flags & FRAME_SCANNED) return MPG123_OK;
 	oldpos = mpg123_tell(mh);
 	b = mh->rd->seek_frame(mh, 0);
 	if(b<0 || mh->num != 0) return MPG123_ERR;
@@ -1364,11 +1659,26 @@ int attribute_align_arg mpg123_scan(mpg123_handle *mh)
 	track_samples = mh->spf; /* Internal samples. */
 	debug("TODO: We should disable gapless code when encountering inconsistent mh->spf!");
 	debug("      ... at least unset MPG123_ACCURATE.");
-	/* Do not increment mh->track_frames in the loop as tha would confuse Frankenstein detection. */
-	while(read_frame(mh) == 1)
+	/* Usually, the headers are enough to count the frames. */
+	if(!(mh->p.flags & MPG123_FULL_SCAN) && scan_frames(mh, &more_frames))
+	{
+		track_frames  += more_frames;
+		track_samples += more_frames*mh->spf;
+	}
+	else
 	{
-		++track_frames;
-		track_samples += mh->spf;
+		/* The header scan left the reader somewhere. */
+		if(!(mh->p.flags & MPG123_FULL_SCAN))
+		{
+			b = mh->rd->seek_frame(mh, 0);
+			if(b<0 || mh->num != 0) return MPG123_ERR;
+		}
+		/* Do not increment mh->track_frames in the loop as tha would confuse Frankenstein detection. */
+		while(read_frame(mh) == 1)
+		{
+			++track_frames;
+			track_samples += mh->spf;
+		}
 	}
 	mh->track_frames = track_frames;
 	mh->track_samples = track_samples;
@@ -1376,6 +1686,10 @@ int attribute_align_arg mpg123_scan(mpg123_handle *mh)
 #ifdef GAPLESS
 	/* Also, think about usefulness of that extra value track_samples ... it could be used for consistency checking. */
 	if(mh->p.flags & MPG123_GAPLESS) frame_gapless_update(mh, mh->track_samples);
+#endif
+	mh->state_flags |= FRAME_SCANNED;
+#ifdef FRAME_INDEX
+	if(mh->index_cache_dir != NULL) index_cache_store(mh);
 #endif
 	return mpg123_seek(mh, oldpos, SEEK_SET) >= 0 ? MPG123_OK : MPG123_ERR;
 }
@@ -1522,9 +1836,14 @@ int attribute_align_arg mpg123_index(mpg123_handle *mh, off_t **offsets, off_t *
 		return MPG123_ERR;
 	}
 #ifdef FRAME_INDEX
-	*offsets = mh->index.data;
+	*offsets = fi_positions(&mh->index);
 	*step    = mh->index.step;
 	*fill    = mh->index.fill;
+	if(*offsets == NULL && *fill)
+	{
+		mh->err = MPG123_OUT_OF_MEM;
+		return MPG123_ERR;
+	}
 #else
 	*offsets = NULL;
 	*step    = 0;
@@ -1554,6 +1873,59 @@ int attribute_align_arg mpg123_set_index(mpg123_handle *mh, off_t *offsets, off_
 #endif
 }
 
+int attribute_align_arg mpg123_index_cache(mpg123_handle *mh, const char *dir)
+{
+	if(mh == NULL) return MPG123_BAD_HANDLE;
+#ifdef FRAME_INDEX
+	if(mh->index_cache_dir != NULL) free(mh->index_cache_dir);
+	mh->index_cache_dir = NULL;
+	if(dir != NULL && (mh->index_cache_dir = strdup(dir)) == NULL)
+	{
+		mh->err = MPG123_OUT_OF_MEM;
+		return MPG123_ERR;
+	}
+	return MPG123_OK;
+#else
+	mh->err = MPG123_MISSING_FEATURE;
+	return MPG123_ERR;
+#endif
+}
+
+int attribute_align_arg mpg123_index_save(mpg123_handle *mh, const char *path)
+{
+	if(mh == NULL) return MPG123_BAD_HANDLE;
+#ifdef FRAME_INDEX
+	if(path == NULL)
+	{
+		mh->err = MPG123_ERR_NULL;
+		return MPG123_ERR;
+	}
+	/* Only store what is known for sure. */
+	if(!(mh->state_flags & FRAME_SCANNED) && mpg123_scan(mh) != MPG123_OK)
+	return MPG123_ERR;
+	return index_cache_save(mh, path);
+#else
+	mh->err = MPG123_MISSING_FEATURE;
+	return MPG123_ERR;
+#endif
+}
+
+int attribute_align_arg mpg123_index_load(mpg123_handle *mh, const char *path)
+{
+	if(mh == NULL) return MPG123_BAD_HANDLE;
+#ifdef FRAME_INDEX
+	if(path == NULL)
+	{
+		mh->err = MPG123_ERR_NULL;
+		return MPG123_ERR;
+	}
+	return index_cache_load(mh, path);
+#else
+	mh->err = MPG123_MISSING_FEATURE;
+	return MPG123_ERR;
+#endif
+}
+
 int attribute_align_arg mpg123_close(mpg123_handle *mh)
 {
 	if(mh == NULL) return MPG123_BAD_HANDLE;
@@ -1561,6 +1933,15 @@ int attribute_align_arg mpg123_close(mpg123_handle *mh)
 	/* mh->rd is never NULL! */
 	if(mh->rd->close != NULL) mh->rd->close(mh);
 
+	if(mh->rdat.filename != NULL)
+	{
+		free(mh->rdat.filename);
+		mh->rdat.filename = NULL;
+	}
+#ifdef FRAME_INDEX
+	index_cache_free(mh);
+#endif
+
 	if(mh->new_format)
 	{
 		debug("Hey, we are closing a track before the new format has been queried...");
@@ -1628,6 +2009,10 @@ static const char *mpg123_error[] =
 	,"Custom I/O obviously not prepared."
 	,"Overflow in LFS (large file support) conversion."
 	,"Overflow in integer conversion."
+	,"Stereo output is interleaved, not planar (MPG123_PLANAR not in effect)."
+	,"Index cache file does not match the stream or is damaged."
+	,"No loudness measurement (MPG123_LOUDNESS not set or too little output)."
+	,"Stereo output is planar (MPG123_PLANAR), not for mpg123_read() or mpg123_decode()."
 };
 
 const char* attribute_align_arg mpg123_plain_strerror(int errcode)
@@ -0,0 +1,529 @@
+/*
+	loudness: measurement of the decoded output after ITU-R BS.1770-4 and EBU R 128
+
+	copyright 2016 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+
+	The output is K-weighted (high shelf and high-pass, designed for the
+	actual sampling rate) and its mean square collected in sub-blocks of
+	100 ms. Four of those are a momentary block (400 ms, overlapping by 75%),
+	30 a short-term window (3 s). Instead of keeping every block for the
+	gating, they go into histograms of 0.1 LU from -70 LUFS, with the summed
+	energy per bin for the integrated loudness. That keeps the memory fixed
+	for streams of any length. The true peak comes from the 48 tap
+	interpolation filter of BS.1770 Annex 2, four times oversampling.
+
+	Both channels are filtered in one go, as two lanes of an array, and the
+	interpolation runs all four phases per tap. There is no SIMD kernel as
+	for the synth or the resampler: each output of the K-weighting biquads
+	is needed for the next one, and that chain of multiply-adds bounds the
+	speed. Two channels packed into one register (tried with SSE2) still
+	wait for it just the same. The true peak filter would vectorise, but it
+	only runs for chunks that could raise the peak found so far, which are
+	few after the first seconds.
+*/
+
+#include "mpg123lib_intern.h"
+#include "debug.h"
+
+#define LANES 2
+/* Samples per channel converted and filtered at once. */
+#define CHUNK 256
+/* Sub-blocks of 100 ms in the short-term window and in a momentary block. */
+#define SHORT_TERM 30
+#define MOMENTARY 4
+/* Histogram bins of 0.1 LU from the absolute gate up to +30 LUFS. */
+#define GATE_ABS -70.
+#define BINS 1000
+#define BIN_OF(l) ((int)(((l)-GATE_ABS)*10.))
+#define BIN_VALUE(b) (GATE_ABS+((b)+0.5)/10.)
+#define TP_TAPS 12
+#define TP_PHASES 4
+/* Largest sum of absolute coefficients of a phase: No output exceeds the
+   input peak times that. */
+#define TP_GAIN 2.03
+/* A measured gain stays, whatever tags come along in the stream. */
+#define LOUDNESS_RVA_LEVEL 100
+/* Reference loudness of ReplayGain 2.0. */
+#define REFERENCE_LUFS -18.
+
+/* The interpolation filter by tap (oldest sample first) and phase. */
+static const float tp_coef[TP_TAPS][TP_PHASES] =
+{
+	 {-0.0083007812500f, -0.0189208984375f, -0.0291748046875f,  0.0017089843750f}
+	,{ 0.0148925781250f,  0.0330810546875f,  0.0292968750000f,  0.0109863281250f}
+	,{-0.0266113281250f, -0.0582275390625f, -0.0517578125000f, -0.0196533203125f}
+	,{ 0.0476074218750f,  0.1015625000000f,  0.0891113281250f,  0.0332031250000f}
+	,{-0.1022949218750f, -0.2003173828125f, -0.1665039062500f, -0.0594482421875f}
+	,{ 0.9721679687500f,  0.7797851562500f,  0.4650878906250f,  0.1373291015625f}
+	,{ 0.1373291015625f,  0.4650878906250f,  0.7797851562500f,  0.9721679687500f}
+	,{-0.0594482421875f, -0.1665039062500f, -0.2003173828125f, -0.1022949218750f}
+	,{ 0.0332031250000f,  0.0891113281250f,  0.1015625000000f,  0.0476074218750f}
+	,{-0.0196533203125f, -0.0517578125000f, -0.0582275390625f, -0.0266113281250f}
+	,{ 0.0109863281250f,  0.0292968750000f,  0.0330810546875f,  0.0148925781250f}
+	,{ 0.0017089843750f, -0.0291748046875f, -0.0189208984375f, -0.0083007812500f}
+};
+
+struct loudness_meter
+{
+	long rate;    /* 0 before the first samples of a format */
+	int channels;
+	/* K-weighting: shelf numerator and denominator, high-pass denominator
+	   (its numerator being 1, -2, 1), states of both for each lane */
+	double sb[3], sa[2], ha[2];
+	double sz1[LANES], sz2[LANES], hz1[LANES], hz2[LANES];
+	/* per lane: TP_TAPS-1 older samples, then the current chunk */
+	float hist[LANES][TP_TAPS-1+CHUNK];
+	double sample_peak;
+	double true_peak;
+	/* the sub-block in progress, its length varying with the rate */
+	double sub_sum;
+	long sub_fill, sub_len;
+	int sub_phase; /* number within the second */
+	double ring_sum[SHORT_TERM];
+	long ring_count[SHORT_TERM];
+	int ring_pos;
+	long subblocks; /* completed ones of this format */
+	double momentary_max;
+	double short_term_max;
+	/* momentary blocks over the absolute gate, short-term values likewise */
+	unsigned long block_count[BINS];
+	double block_energy[BINS];
+	unsigned long st_count[BINS];
+	double st_energy[BINS];
+	double seconds;
+};
+
+static double block_loudness(double z)
+{
+	return z > 0. ? -0.691 + 10.*log10(z) : -HUGE_VAL;
+}
+
+/* Filter design of the BS.1770 pre-filter for any sampling rate. */
+static void kweight_setup(struct loudness_meter *m)
+{
+	double f0 = 1681.974450955533;
+	double q  = 0.7071752369554196;
+	double vh = pow(10., 3.999843853973347/20.);
+	double vb = pow(vh, 0.4996667741545416);
+	double k  = tan(M_PI*f0/m->rate);
+	double a0 = 1. + k/q + k*k;
+	m->sb[0] = (vh + vb*k/q + k*k)/a0;
+	m->sb[1] = 2.*(k*k - vh)/a0;
+	m->sb[2] = (vh - vb*k/q + k*k)/a0;
+	m->sa[0] = 2.*(k*k - 1.)/a0;
+	m->sa[1] = (1. - k/q + k*k)/a0;
+	f0 = 38.13547087602444;
+	q  = 0.5003270373238773;
+	k  = tan(M_PI*f0/m->rate);
+	a0 = 1. + k/q + k*k;
+	m->ha[0] = 2.*(k*k - 1.)/a0;
+	m->ha[1] = (1. - k/q + k*k)/a0;
+}
+
+/* Start over with filters and blocks, for a new format. */
+static void format_reset(struct loudness_meter *m, long rate, int channels)
+{
+	int c;
+	m->rate = rate;
+	m->channels = channels;
+	kweight_setup(m);
+	for(c=0; c<LANES; ++c)
+	{
+		int i;
+		m->sz1[c] = m->sz2[c] = m->hz1[c] = m->hz2[c] = 0.;
+		for(i=0; i<TP_TAPS-1; ++i)
+		m->hist[c][i] = 0.f;
+	}
+	m->sub_sum = 0.;
+	m->sub_fill = 0;
+	m->sub_phase = 0;
+	m->sub_len = rate/10;
+	m->ring_pos = 0;
+	m->subblocks = 0;
+}
+
+static void subblock_done(struct loudness_meter *m)
+{
+	int i;
+	m->ring_sum[m->ring_pos] = m->sub_sum;
+	m->ring_count[m->ring_pos] = m->sub_fill;
+	m->ring_pos = (m->ring_pos+1) % SHORT_TERM;
+	++m->subblocks;
+	m->sub_sum = 0.;
+	m->sub_fill = 0;
+	m->sub_phase = (m->sub_phase+1) % 10;
+	/* Exactly a tenth of the rate, also for 11025 Hz. */
+	m->sub_len = (m->sub_phase+1)*m->rate/10 - m->sub_phase*m->rate/10;
+	if(m->subblocks >= MOMENTARY)
+	{
+		double sum = 0.;
+		long count = 0;
+		double l;
+		for(i=1; i<=MOMENTARY; ++i)
+		{
+			int p = (m->ring_pos + SHORT_TERM - i) % SHORT_TERM;
+			sum   += m->ring_sum[p];
+			count += m->ring_count[p];
+		}
+		l = block_loudness(sum/count);
+		if(l > m->momentary_max) m->momentary_max = l;
+		if(l >= GATE_ABS)
+		{
+			int b = BIN_OF(l);
+			if(b >= BINS) b = BINS-1;
+			++m->block_count[b];
+			m->block_energy[b] += sum/count;
+		}
+	}
+	if(m->subblocks >= SHORT_TERM)
+	{
+		double sum = 0.;
+		long count = 0;
+		double l;
+		for(i=0; i<SHORT_TERM; ++i)
+		{
+			sum   += m->ring_sum[i];
+			count += m->ring_count[i];
+		}
+		l = block_loudness(sum/count);
+		if(l > m->short_term_max) m->short_term_max = l;
+		if(l >= GATE_ABS)
+		{
+			int b = BIN_OF(l);
+			if(b >= BINS) b = BINS-1;
+			++m->st_count[b];
+			m->st_energy[b] += sum/count;
+		}
+	}
+}
+
+/* Fetch count samples of one channel into a lane of x, spaced by step bytes. */
+static void fetch(double (*x)[LANES], int lane, const unsigned char *p, size_t step, size_t count, int enc, double scale)
+{
+	size_t i;
+	switch(enc)
+	{
+		case MPG123_ENC_SIGNED_16:
+			scale /= 32768.;
+			for(i=0; i<count; ++i)
+			x[i][lane] = scale * *(const short*)(p+i*step);
+		break;
+		case MPG123_ENC_UNSIGNED_16:
+			scale /= 32768.;
+			for(i=0; i<count; ++i)
+			x[i][lane] = scale * ((long)*(const unsigned short*)(p+i*step) - 32768);
+		break;
+		case MPG123_ENC_SIGNED_32:
+			scale /= 2147483648.;
+			for(i=0; i<count; ++i)
+			x[i][lane] = scale * *(const int32_t*)(p+i*step);
+		break;
+		case MPG123_ENC_UNSIGNED_32:
+			scale /= 2147483648.;
+			for(i=0; i<count; ++i)
+			x[i][lane] = scale * (int32_t)(*(const uint32_t*)(p+i*step) ^ 0x80000000UL);
+		break;
+		case MPG123_ENC_SIGNED_24:
+		case MPG123_ENC_UNSIGNED_24:
+		{
+			uint32_t flip = enc == MPG123_ENC_UNSIGNED_24 ? 0x80000000UL : 0;
+			scale /= 2147483648.;
+			for(i=0; i<count; ++i)
+			{
+				const unsigned char *s = p+i*step;
+#ifdef WORDS_BIGENDIAN
+				uint32_t v = (uint32_t)s[0]<<24 | (uint32_t)s[1]<<16 | (uint32_t)s[2]<<8;
+#else
+				uint32_t v = (uint32_t)s[2]<<24 | (uint32_t)s[1]<<16 | (uint32_t)s[0]<<8;
+#endif
+				x[i][lane] = scale * (int32_t)(v ^ flip);
+			}
+		}
+		break;
+		case MPG123_ENC_SIGNED_8:
+			scale /= 128.;
+			for(i=0; i<count; ++i)
+			x[i][lane] = scale * *(const signed char*)(p+i*step);
+		break;
+		case MPG123_ENC_UNSIGNED_8:
+			scale /= 128.;
+			for(i=0; i<count; ++i)
+			x[i][lane] = scale * ((int)p[i*step] - 128);
+		break;
+		case MPG123_ENC_FLOAT_32:
+			for(i=0; i<count; ++i)
+			x[i][lane] = scale * *(const float*)(p+i*step);
+		break;
+		case MPG123_ENC_FLOAT_64:
+			for(i=0; i<count; ++i)
+			x[i][lane] = scale * *(const double*)(p+i*step);
+		break;
+		default:
+			for(i=0; i<count; ++i)
+			x[i][lane] = 0.;
+	}
+}
+
+/* Peaks of one chunk, skipping the interpolation where it cannot find a
+   higher one than known already. */
+static void chunk_peaks(struct loudness_meter *m, double (*x)[LANES], size_t count)
+{
+	size_t i;
+	int c, t;
+	float amax = 0.f;
+	for(c=0; c<m->channels; ++c)
+	for(i=0; i<count; ++i)
+	{
+		float s = (float)x[i][c];
+		m->hist[c][TP_TAPS-1+i] = s;
+		if(s < 0) s = -s;
+		if(s > amax) amax = s;
+	}
+	if(amax > m->sample_peak) m->sample_peak = amax;
+	for(c=0; c<m->channels; ++c)
+	{
+		float *h = m->hist[c];
+		float hmax = amax;
+		for(i=0; i<TP_TAPS-1; ++i)
+		if(h[i] > hmax || -h[i] > hmax) hmax = h[i] < 0 ? -h[i] : h[i];
+		if(hmax*TP_GAIN > m->true_peak)
+		{
+			/* Extremes per phase, without branches in the loop. */
+			float hi[TP_PHASES] = {0.f, 0.f, 0.f, 0.f};
+			float lo[TP_PHASES] = {0.f, 0.f, 0.f, 0.f};
+			int p;
+			for(i=0; i<count; ++i)
+			{
+				float acc[TP_PHASES] = {0.f, 0.f, 0.f, 0.f};
+				for(t=0; t<TP_TAPS; ++t)
+				for(p=0; p<TP_PHASES; ++p)
+				acc[p] += tp_coef[t][p]*h[i+t];
+				for(p=0; p<TP_PHASES; ++p)
+				{
+					hi[p] = acc[p] > hi[p] ? acc[p] : hi[p];
+					lo[p] = acc[p] < lo[p] ? acc[p] : lo[p];
+				}
+			}
+			for(p=0; p<TP_PHASES; ++p)
+			{
+				if(hi[p] > m->true_peak) m->true_peak = hi[p];
+				if(-lo[p] > m->true_peak) m->true_peak = -lo[p];
+			}
+		}
+		for(i=0; i<TP_TAPS-1; ++i)
+		h[i] = h[count+i];
+	}
+}
+
+/* K-weighting of a chunk, the summed squares of the channels per sample into y. */
+static void chunk_kweight(struct loudness_meter *m, double (*x)[LANES], double *y, size_t count)
+{
+	size_t i;
+	int c;
+	for(i=0; i<count; ++i)
+	{
+		double sum = 0.;
+		for(c=0; c<LANES; ++c)
+		{
+			double s = m->sb[0]*x[i][c] + m->sz1[c];
+			double o;
+			m->sz1[c] = m->sb[1]*x[i][c] - m->sa[0]*s + m->sz2[c];
+			m->sz2[c] = m->sb[2]*x[i][c] - m->sa[1]*s;
+			o = s + m->hz1[c];
+			m->hz1[c] = -2.*s - m->ha[0]*o + m->hz2[c];
+			m->hz2[c] = s - m->ha[1]*o;
+			sum += o*o;
+		}
+		y[i] = sum;
+	}
+}
+
+void loudness_add(mpg123_handle *fr, const unsigned char *buf, size_t bytes, int planar)
+{
+	struct loudness_meter *m = fr->loudness;
+	double x[CHUNK][LANES];
+	double y[CHUNK];
+	const unsigned char *base[LANES];
+	size_t step, frames, done;
+	double scale = fr->lastscale > 0. ? 1./fr->lastscale : 1.;
+	int c;
+
+	if(bytes == 0 || fr->af.channels < 1 || fr->af.channels > LANES || fr->af.encsize < 1
+	   || fr->af.encoding == MPG123_ENC_ULAW_8 || fr->af.encoding == MPG123_ENC_ALAW_8)
+	return;
+	if(m == NULL)
+	{
+		/* The histograms start out empty, the first samples set up the rest. */
+		if((fr->loudness = m = malloc(sizeof(*m))) == NULL)
+		{
+			if(NOQUIET) error("out of memory for loudness measurement");
+			return;
+		}
+		loudness_reset(fr);
+	}
+	if(m->rate != fr->af.rate || m->channels != fr->af.channels)
+	format_reset(m, fr->af.rate, fr->af.channels);
+
+	frames = bytes/(fr->af.encsize*fr->af.channels);
+	for(c=0; c<fr->af.channels; ++c)
+	base[c] = buf + c*(planar ? frames : 1)*fr->af.encsize;
+	step = planar ? fr->af.encsize : fr->af.encsize*fr->af.channels;
+	for(done=0; done<frames; )
+	{
+		size_t count = frames-done > CHUNK ? CHUNK : frames-done;
+		size_t i;
+		for(c=0; c<LANES; ++c)
+		{
+			if(c < fr->af.channels)
+			fetch(x, c, base[c]+done*step, step, count, fr->af.encoding, scale);
+			else for(i=0; i<count; ++i)
+			x[i][c] = 0.;
+		}
+		chunk_peaks(m, x, count);
+		chunk_kweight(m, x, y, count);
+		for(i=0; i<count; ++i)
+		{
+			m->sub_sum += y[i];
+			if(++m->sub_fill == m->sub_len)
+			subblock_done(m);
+		}
+		done += count;
+	}
+	m->seconds += (double)frames/m->rate;
+}
+
+void loudness_reset(mpg123_handle *fr)
+{
+	struct loudness_meter *m = fr->loudness;
+	int b;
+	if(m == NULL) return;
+	m->rate = 0;
+	m->channels = 0;
+	m->sample_peak = m->true_peak = 0.;
+	m->momentary_max = m->short_term_max = -HUGE_VAL;
+	for(b=0; b<BINS; ++b)
+	{
+		m->block_count[b] = m->st_count[b] = 0;
+		m->block_energy[b] = m->st_energy[b] = 0.;
+	}
+	m->seconds = 0.;
+}
+
+void loudness_exit(mpg123_handle *fr)
+{
+	if(fr->loudness != NULL)
+	{
+		free(fr->loudness);
+		fr->loudness = NULL;
+	}
+}
+
+/* First bin at or above the gate, relative to the energy mean of all bins. */
+static int gate_bin(const unsigned long *count, const double *energy, double relative)
+{
+	double sum = 0.;
+	unsigned long n = 0;
+	double gate;
+	int b;
+	for(b=0; b<BINS; ++b)
+	{
+		n   += count[b];
+		sum += energy[b];
+	}
+	if(n == 0) return -1;
+	gate = block_loudness(sum/n) + relative;
+	if(gate < GATE_ABS) return 0;
+	/* Bins are taken whole, by their middle. */
+	for(b=0; b<BINS && BIN_VALUE(b) < gate; ++b)
+	;
+	return b;
+}
+
+/* Value of the histogram from the gate bin on at that fraction of the count. */
+static double percentile(const unsigned long *count, int first, double fraction)
+{
+	unsigned long n = 0, want, sum = 0;
+	int b;
+	for(b=first; b<BINS; ++b)
+	n += count[b];
+	if(n == 0) return 0.;
+	want = (unsigned long)((n-1)*fraction + 0.5);
+	for(b=first; b<BINS; ++b)
+	{
+		sum += count[b];
+		if(sum > want) break;
+	}
+	return BIN_VALUE(b < BINS ? b : BINS-1);
+}
+
+int attribute_align_arg mpg123_loudness(mpg123_handle *mh, struct mpg123_loudness *lr)
+{
+	struct loudness_meter *m;
+	int b, first;
+
+	if(mh == NULL) return MPG123_BAD_HANDLE;
+	if(lr == NULL)
+	{
+		mh->err = MPG123_NULL_POINTER;
+		return MPG123_ERR;
+	}
+	if(!(mh->p.flags & MPG123_LOUDNESS))
+	{
+		mh->err = MPG123_NO_LOUDNESS;
+		return MPG123_ERR;
+	}
+	lr->integrated = lr->momentary_max = lr->short_term_max = -HUGE_VAL;
+	lr->range = lr->true_peak = lr->sample_peak = lr->gain = 0.;
+	lr->seconds = 0.;
+	if((m = mh->loudness) == NULL) return MPG123_OK;
+
+	lr->momentary_max  = m->momentary_max;
+	lr->short_term_max = m->short_term_max;
+	lr->true_peak   = m->true_peak > m->sample_peak ? m->true_peak : m->sample_peak;
+	lr->sample_peak = m->sample_peak;
+	lr->seconds = m->seconds;
+	if((first = gate_bin(m->block_count, m->block_energy, -10.)) >= 0)
+	{
+		double sum = 0.;
+		unsigned long n = 0;
+		for(b=first; b<BINS; ++b)
+		{
+			n   += m->block_count[b];
+			sum += m->block_energy[b];
+		}
+		if(n > 0)
+		{
+			lr->integrated = block_loudness(sum/n);
+			lr->gain = REFERENCE_LUFS - lr->integrated;
+		}
+	}
+	/* EBU Tech 3342: the spread between 10% and 95% of the short-term values. */
+	if((first = gate_bin(m->st_count, m->st_energy, -20.)) >= 0)
+	lr->range = percentile(m->st_count, first, 0.95) - percentile(m->st_count, first, 0.10);
+	return MPG123_OK;
+}
+
+int attribute_align_arg mpg123_loudness_rva(mpg123_handle *mh, int mode)
+{
+	struct mpg123_loudness lr;
+	int ret;
+
+	if(mh == NULL) return MPG123_BAD_HANDLE;
+	if(mode != MPG123_RVA_MIX && mode != MPG123_RVA_ALBUM)
+	{
+		mh->err = MPG123_BAD_RVA;
+		return MPG123_ERR;
+	}
+	if((ret = mpg123_loudness(mh, &lr)) != MPG123_OK) return ret;
+	if(lr.integrated == -HUGE_VAL)
+	{
+		mh->err = MPG123_NO_LOUDNESS;
+		return MPG123_ERR;
+	}
+	mh->rva.gain[mode-1]  = (float)lr.gain;
+	mh->rva.peak[mode-1]  = (float)lr.true_peak;
+	mh->rva.level[mode-1] = LOUDNESS_RVA_LEVEL;
+	do_rva(mh);
+	return MPG123_OK;
+}
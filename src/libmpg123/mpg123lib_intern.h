@@ -204,6 +204,15 @@ static inline int32_t scale_rounded(int32_t x, int shift)
 #  define real double
 #endif
 
+/*
+  floating-point decoders also use constant tables, generated by calctables.c
+  into l12_float_tables.h, l3_float_tables.h and dct_float_tables.h
+  define NO_PRECALC_TABLES for run-time calculation in mpg123_init()
+*/
+#if !defined(REAL_IS_FIXED) && !defined(NO_PRECALC_TABLES)
+#define PRECALC_TABLES
+#endif
+
 #ifndef REAL_IS_FIXED
 # if (defined SIZEOF_INT32_T) && (SIZEOF_INT32_T != 4)
 #  error "Bad 32bit types!!!"
@@ -285,6 +294,7 @@ static inline int32_t scale_rounded(int32_t x, int shift)
 #include "decode.h"
 #include "parse.h"
 #include "frame.h"
+#include "tabcache.h"
 
 /* fr is a mpg123_handle* by convention here... */
 #define NOQUIET  (!(fr->p.flags & MPG123_QUIET))
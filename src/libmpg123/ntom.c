@@ -146,3 +146,255 @@ off_t ntom_frameoff(mpg123_handle *fr, off_t soff)
 	return ioff/(off_t)fr->spf;
 #endif
 }
+
+#ifdef RESAMPLER
+#ifndef M_PI
+# define M_PI 3.14159265358979323846
+#endif
+
+/*
+	Windowed-sinc resampling on top of the native rate synth.
+
+	The output samples are the very same the NtoM synth produces, in number and
+	in their position given by ntom_val and ntom_step, so all the offset
+	computations above stay valid. Only the value of each sample is interpolated
+	from the surrounding native samples instead of taking the nearest one.
+	The filter needs rs_taps/2 samples after the wanted position, so the
+	output lags behind by rs_taps/2-1 native samples (gapless decoding
+	compensates that).
+	The coefficient table holds rs_phases+1 rows for fractional positions
+	from 0 to 1, each one followed by the difference to the next row for linear
+	interpolation between them. The filter gain includes the SHORT_SCALE of the
+	synth output.
+*/
+
+static const struct
+{
+	int taps;      /* at the native rate, for upsampling */
+	int phases;
+	double cutoff; /* fraction of the lower Nyquist frequency */
+	double beta;   /* of the Kaiser window */
+} resample_quality[MPG123_RESAMPLE_MAX+1] =
+{
+	 {  0,   0, 0.,   0. } /* NtoM synth */
+	,{ 16,  32, 0.80, 5. }
+	,{ 32,  64, 0.90, 7. }
+	,{ 64, 128, 0.95, 9. }
+};
+
+static double bessel_i0(double x)
+{
+	double sum = 1., term = 1.;
+	int k;
+	for(k=1; k<64 && term > sum*1e-12; ++k)
+	{
+		term *= (x/(2*k))*(x/(2*k));
+		sum  += term;
+	}
+	return sum;
+}
+
+/* Windowed sinc at t native samples from the output position. */
+static double resample_tap(double t, double half, double fc, double beta)
+{
+	double u = t/half;
+	double h = 2.*fc;
+	if(u*u >= 1.) return 0.;
+	if(t != 0.) h = sin(2.*M_PI*fc*t)/(M_PI*t);
+	return h*bessel_i0(beta*sqrt(1.-u*u))/bessel_i0(beta);
+}
+
+int resample_setup(mpg123_handle *fr)
+{
+	long in  = frame_freq(fr);
+	long out = fr->af.rate;
+	int quality = fr->p.resample;
+	int taps, phases, p, n;
+	double fc, beta;
+	size_t size;
+	uintptr_t aoff;
+
+	fr->rs_taps = 0;
+	if(quality <= MPG123_RESAMPLE_NTOM || quality > MPG123_RESAMPLE_MAX) return 0;
+
+	/* Downsampling needs a longer filter at the native rate for the same steepness. */
+	taps = resample_quality[quality].taps;
+	if(out < in) taps = (int)((taps*in+out-1)/out);
+	/* Be reasonable with extreme ratios, the transition just gets wider. */
+	if(taps > NTOM_MAX*resample_quality[quality].taps)
+		taps = NTOM_MAX*resample_quality[quality].taps;
+	taps = (taps+15) & ~15;
+	phases = resample_quality[quality].phases;
+	fc = 0.5*resample_quality[quality].cutoff*(out < in ? (double)out/in : 1.);
+	beta = resample_quality[quality].beta;
+
+	size = sizeof(real)*((size_t)(phases+1)*2*taps + 2*(taps+SBLIMIT)) + 32;
+	if(fr->rs_buffer == NULL || fr->rs_buffer_size < size)
+	{
+		if(fr->rs_buffer != NULL) free(fr->rs_buffer);
+		fr->rs_buffer_size = 0;
+		fr->rs_buffer = malloc(size);
+		if(fr->rs_buffer == NULL)
+		{
+			if(NOQUIET) error("Failed to allocate resampler memory!");
+			fr->err = MPG123_OUT_OF_MEM;
+			return -1;
+		}
+		fr->rs_buffer_size = size;
+	}
+	/* AVX wants 32 byte alignment of the coefficient rows. */
+	aoff = (uintptr_t)(char*)fr->rs_buffer % 32;
+	fr->rs_coef = (real*)((char*)fr->rs_buffer + (aoff ? 32-aoff : 0));
+	fr->rs_hist[0] = fr->rs_coef + (size_t)(phases+1)*2*taps;
+	fr->rs_hist[1] = fr->rs_hist[0] + taps+SBLIMIT;
+
+	for(p=0; p<=phases; ++p)
+	{
+		real *row = fr->rs_coef + (size_t)p*2*taps;
+		double sum = 0.;
+		/* Entry n weights the native sample taps-1-n before the newest one,
+		   the output position is taps/2-1 plus the fraction before that. */
+		for(n=0; n<taps; ++n)
+		sum += resample_tap(taps/2-n-(double)p/phases, taps/2, fc, beta);
+		/* Each row gets unity gain, there shall be no ripple at DC. */
+		for(n=0; n<taps; ++n)
+		row[n] = DOUBLE_TO_REAL(SHORT_SCALE/sum
+		*	resample_tap(taps/2-n-(double)p/phases, taps/2, fc, beta));
+	}
+	for(p=0; p<=phases; ++p)
+	{
+		real *row = fr->rs_coef + (size_t)p*2*taps;
+		for(n=0; n<taps; ++n)
+		row[taps+n] = p < phases ? row[2*taps+n]-row[n] : 0;
+	}
+	fr->rs_taps = taps;
+	fr->rs_phases = phases;
+	resample_reset(fr);
+	if(VERBOSE2)
+		fprintf(stderr, "Resampler: %i taps, %i phases, cutoff %g\n", taps, phases, fc);
+
+	return 0;
+}
+
+void resample_reset(mpg123_handle *fr)
+{
+	if(fr->rs_taps > 0)
+	memset(fr->rs_hist[0], 0, sizeof(real)*2*(fr->rs_taps+SBLIMIT));
+}
+
+/*
+	With a short padding, the last rs_tail samples of a gapless track are
+	still in the filter after the last frame, they need the native samples
+	after it. Synthesize silence to get them, appended to the output of the
+	frame, which then ends at end_os.
+*/
+void resample_flush(mpg123_handle *fr)
+{
+	ALIGNED(16) real zero[SBLIMIT];
+	/* The buffer still is in the format of the synth. */
+	size_t start = fr->buffer.fill;
+	size_t tail = (size_t)decoder_synth_bytes(fr, fr->rs_tail);
+	int i;
+
+	if(  fr->rs_tail <= 0 || !(fr->p.flags & MPG123_GAPLESS)
+	  || (fr->p.flags & MPG123_TAP_ONLY) || fr->num != fr->gapless_frames-1 )
+		return;
+	for(i=0; i<SBLIMIT; ++i) zero[i] = 0;
+	while(fr->buffer.fill-start < tail)
+	{
+		if(fr->stereo == 1 || fr->single != SINGLE_STEREO)
+		(fr->synth_mono)(zero, fr);
+		else
+		(fr->synth_stereo)(zero, zero, fr);
+	}
+	fr->buffer.fill = start+tail;
+}
+
+/* Run the 1to1 real synth of the decoder for one channel, into the history. */
+int resample_synth(mpg123_handle *fr, real *bandPtr, int channel)
+{
+	real block[2*SBLIMIT];
+	real *hist = fr->rs_hist[channel] + fr->rs_taps-1;
+	unsigned char *samples = fr->buffer.data;
+	size_t fill = fr->buffer.fill;
+	int i, clip;
+
+	fr->buffer.data = (unsigned char*) block;
+	fr->buffer.fill = 0;
+	clip = (fr->synths.plain[r_1to1][f_real])(bandPtr, channel, fr, 0);
+	fr->buffer.data = samples;
+	fr->buffer.fill = fill;
+	for(i=0; i<SBLIMIT; ++i)
+	hist[i] = block[2*i+channel];
+
+	return clip;
+}
+
+/* Same for both channels with the stereo synth, which must not be a wrapper over fr->synth. */
+int resample_synth_stereo(mpg123_handle *fr, real *bandPtr_l, real *bandPtr_r)
+{
+	real block[2*SBLIMIT];
+	real *left  = fr->rs_hist[0] + fr->rs_taps-1;
+	real *right = fr->rs_hist[1] + fr->rs_taps-1;
+	unsigned char *samples = fr->buffer.data;
+	size_t fill = fr->buffer.fill;
+	int i, clip;
+
+	fr->buffer.data = (unsigned char*) block;
+	fr->buffer.fill = 0;
+	clip = (fr->synths.stereo[r_1to1][f_real])(bandPtr_l, bandPtr_r, fr);
+	fr->buffer.data = samples;
+	fr->buffer.fill = fill;
+	for(i=0; i<SBLIMIT; ++i)
+	{
+		left[i]  = block[2*i];
+		right[i] = block[2*i+1];
+	}
+
+	return clip;
+}
+
+/*
+	The current block of SBLIMIT native samples of the channel is stored after
+	the rs_taps-1 older ones in rs_hist. Compute the output samples for it,
+	continuing from the given NtoM counter, and move the history along.
+	Returns the number of samples (at most NTOM_MAX*SBLIMIT).
+*/
+int resample_block(mpg123_handle *fr, int channel, real *out, unsigned long *ntom)
+{
+	real (*fir)(const real *, const real *, int, real) = opt_resample_fir(fr);
+	real *hist = fr->rs_hist[channel];
+	const real *x = hist;
+	unsigned long step = fr->ntom_step;
+	unsigned long ntm = *ntom;
+	int taps = fr->rs_taps;
+	int i, count = 0;
+
+	for(i=0; i<SBLIMIT; ++i, ++x)
+	{
+		ntm += step;
+		while(ntm >= NTOM_MUL)
+		{
+			unsigned long pos;
+			ntm -= NTOM_MUL;
+			/* The wanted position is ntm/step samples before the current one. */
+			pos = ntm*fr->rs_phases;
+			out[count++] = fir( x, fr->rs_coef + (pos/step)*2*taps, taps
+			,	(real)(pos%step)/(real)step );
+		}
+	}
+	memmove(hist, hist+SBLIMIT, sizeof(real)*(taps-1));
+	*ntom = ntm;
+	return count;
+}
+
+real resample_fir(const real *x, const real *coef, int taps, real frac)
+{
+	const real *delta = coef+taps;
+	real sum = 0;
+	int i;
+	for(i=0; i<taps; ++i)
+	sum += x[i]*(coef[i] + frac*delta[i]);
+	return sum;
+}
+#endif
@@ -28,6 +28,7 @@ static struct cpuflags cpu_flags;
 #define cpu_sse2(s)     1
 #define cpu_sse3(s)     1
 #define cpu_avx(s)      1
+#define cpu_avx512(s)   1
 #define cpu_neon(s)     1
 #endif
 
@@ -120,6 +121,23 @@ static const struct synth_s synth_base =
 	}
 };
 
+#ifdef RESAMPLER
+/* The windowed-sinc resampler synths, running the 1to1 real synth of the decoder below. */
+static const struct
+{
+	func_synth plain[f_limit];
+	func_synth_stereo stereo[f_limit];
+	func_synth_mono mono2stereo[f_limit];
+	func_synth_mono mono[f_limit];
+} resample_synths =
+{
+	 OUT_SYNTHS(synth_resample, synth_resample_8bit, synth_resample_real, synth_resample_s32)
+	,OUT_SYNTHS(synth_resample_stereo, synth_resample_8bit_stereo, synth_resample_real_stereo, synth_resample_s32_stereo)
+	,OUT_SYNTHS(synth_resample_m2s, synth_resample_8bit_m2s, synth_resample_real_m2s, synth_resample_s32_m2s)
+	,OUT_SYNTHS(synth_resample_mono, synth_resample_8bit_mono, synth_resample_real_mono, synth_resample_s32_mono)
+};
+#endif
+
 #ifdef OPT_X86
 /* More plain synths for i386 */
 const func_synth plain_i386[r_limit][f_limit] =
@@ -151,6 +169,7 @@ enum optcla decclass(const enum optdec type)
 		|| type == neon
 		|| type == neon64
 		|| type == avx
+		|| type == avx512
 	) ? mmxsse : normal;
 }
 
@@ -198,6 +217,14 @@ static int find_dectype(mpg123_handle *fr)
 	if(basic_synth == synth_1to1_8bit_wrap)
 	basic_synth = fr->synths.plain[r_1to1][f_16]; /* That is what's really below the surface. */
 #endif
+#endif
+#ifdef RESAMPLER
+	{
+		enum synth_format fi;
+		for(fi=0; fi<f_limit; ++fi)
+		if(basic_synth == resample_synths.plain[fi])
+		basic_synth = fr->synths.plain[r_1to1][f_real]; /* The resampler feeds on that one. */
+	}
 #endif
 
 	if(FALSE) ; /* Just to initialize the else if ladder. */
@@ -250,6 +277,9 @@ static int find_dectype(mpg123_handle *fr)
 #ifdef OPT_AVX
 	else if(basic_synth == synth_1to1_avx) type = avx;
 #endif
+#ifdef OPT_AVX512
+	else if(basic_synth == synth_1to1_avx512) type = avx512;
+#endif
 #ifdef OPT_ARM
 	else if(basic_synth == synth_1to1_arm) type = arm;
 #endif
@@ -288,6 +318,9 @@ static int find_dectype(mpg123_handle *fr)
 #ifdef OPT_AVX
 	else if(basic_synth == synth_1to1_real_avx) type = avx;
 #endif
+#ifdef OPT_AVX512
+	else if(basic_synth == synth_1to1_real_avx512) type = avx512;
+#endif
 #ifdef OPT_ALTIVEC
 	else if(basic_synth == synth_1to1_real_altivec) type = altivec;
 #endif
@@ -313,6 +346,9 @@ static int find_dectype(mpg123_handle *fr)
 #ifdef OPT_AVX
 	else if(basic_synth == synth_1to1_s32_avx) type = avx;
 #endif
+#ifdef OPT_AVX512
+	else if(basic_synth == synth_1to1_s32_avx512) type = avx512;
+#endif
 #ifdef OPT_ALTIVEC
 	else if(basic_synth == synth_1to1_s32_altivec) type = altivec;
 #endif
@@ -364,6 +400,8 @@ int set_synth_functions(mpg123_handle *fr)
 {
 	enum synth_resample resample = r_none;
 	enum synth_format basic_format = f_none; /* Default is always 16bit, or whatever. */
+	func_gainpow2 gainpow2 = NULL;
+	func_layer12_table layer12 = NULL;
 
 	/* Select the basic output format, different from 16bit: 8bit, real. */
 	if(FALSE){}
@@ -420,6 +458,20 @@ int set_synth_functions(mpg123_handle *fr)
 	fr->synth_mono = fr->af.channels==2
 		? fr->synths.mono2stereo[resample][basic_format] /* Mono MPEG file decoded to stereo. */
 		: fr->synths.mono[resample][basic_format];       /* Mono MPEG file decoded to mono. */
+#ifdef RESAMPLER
+	/* Windowed-sinc resampling instead of the NtoM synth, if resample_setup() prepared a filter. */
+	if(resample == r_ntom && fr->rs_taps > 0)
+	{
+		fr->synth = resample_synths.plain[basic_format];
+		/* The stereo resampler needs a real stereo synth below, not the wrapper over fr->synth. */
+		if(fr->synths.stereo[r_1to1][f_real] != synth_stereo_wrap)
+		fr->synth_stereo = resample_synths.stereo[basic_format];
+		else fr->synth_stereo = synth_stereo_wrap;
+		fr->synth_mono = fr->af.channels==2
+			? resample_synths.mono2stereo[basic_format]
+			: resample_synths.mono[basic_format];
+	}
+#endif
 
 	if(find_dectype(fr) != MPG123_OK) /* Actually determine the currently active decoder breed. */
 	{
@@ -427,6 +479,36 @@ int set_synth_functions(mpg123_handle *fr)
 		return MPG123_ERR;
 	}
 
+	/* Planar output: directly from the synth where there is one for it, otherwise rearranged after decoding. */
+	fr->planar = (fr->p.flags & MPG123_PLANAR) && fr->af.channels == 2;
+	fr->planar_synth = FALSE;
+#if !defined(NO_REAL) && !defined(REAL_IS_FIXED)
+	if(fr->planar && basic_format == f_real && resample == r_1to1)
+	{
+		if(fr->synth == synth_1to1_real)
+		{
+			fr->synth_stereo = synth_1to1_real_stereo_planar;
+			fr->synth_mono   = synth_1to1_real_m2s_planar;
+			fr->planar_synth = TRUE;
+		}
+#ifdef OPT_AVX512
+		else if(fr->cpu_opts.type == avx512)
+		{
+			fr->synth_stereo = synth_1to1_real_stereo_planar_avx512;
+			fr->synth_mono   = synth_1to1_real_m2s_planar_avx512;
+			fr->planar_synth = TRUE;
+		}
+#endif
+	}
+#endif
+	if(fr->planar && !fr->planar_synth && frame_planebuf(fr) != 0)
+	{
+		fr->err = MPG123_OUT_OF_MEM;
+		if(NOQUIET) error("Failed to set up buffer for planar output!");
+
+		return MPG123_ERR;
+	}
+
 	if(frame_buffers(fr) != 0)
 	{
 		fr->err = MPG123_NO_BUFFERS;
@@ -465,13 +547,15 @@ int set_synth_functions(mpg123_handle *fr)
 	   && fr->cpu_opts.type != neon64
 	   && fr->cpu_opts.type != avx
 #	endif
+	   /* The AVX-512 synth always works on the float window. */
+	   && fr->cpu_opts.type != avx512
 	  )
 	{
 #ifndef NO_LAYER3
-		init_layer3_stuff(fr, init_layer3_gainpow2_mmx);
+		gainpow2 = init_layer3_gainpow2_mmx;
 #endif
 #ifndef NO_LAYER12
-		init_layer12_stuff(fr, init_layer12_table_mmx);
+		layer12 = init_layer12_table_mmx;
 #endif
 		fr->make_decode_tables = make_decode_tables_mmx;
 	}
@@ -479,16 +563,20 @@ int set_synth_functions(mpg123_handle *fr)
 #endif
 	{
 #ifndef NO_LAYER3
-		init_layer3_stuff(fr, init_layer3_gainpow2);
+		gainpow2 = init_layer3_gainpow2;
 #endif
 #ifndef NO_LAYER12
-		init_layer12_stuff(fr, init_layer12_table);
+		layer12 = init_layer12_table;
 #endif
 		fr->make_decode_tables = make_decode_tables;
 	}
 
-	/* We allocated the table buffers just now, so (re)create the tables. */
-	fr->make_decode_tables(fr);
+	/* Get the (possibly shared) tables for this decoder setup. */
+	if(tabcache_layer(fr, gainpow2, layer12) != 0 || tabcache_decwin(fr) != 0)
+	{
+		if(NOQUIET) error("Failed to set up decoder tables!");
+		return -1;
+	}
 
 	return 0;
 }
@@ -524,6 +612,22 @@ int frame_cpu_opt(mpg123_handle *fr, const char* cpu)
 #if (defined OPT_3DNOW_VINTAGE || defined OPT_3DNOWEXT_VINTAGE || defined OPT_SSE || defined OPT_X86_64 || defined OPT_AVX || defined OPT_NEON || defined OPT_NEON64)
 	fr->cpu_opts.the_dct36 = dct36;
 #endif
+#if (defined OPT_X86_64 || defined OPT_AVX)
+	fr->cpu_opts.the_dct12 = dct12;
+	fr->cpu_opts.the_antialias = antialias;
+	fr->cpu_opts.the_stereo_ms = stereo_ms;
+	fr->cpu_opts.the_hybrid_tail = hybrid_tail;
+#endif
+#endif
+#ifndef NO_LAYER12
+#if (defined OPT_X86_64 || defined OPT_AVX)
+	fr->cpu_opts.the_dequant12 = dequant12;
+#endif
+#endif
+#ifdef RESAMPLER
+#if (defined OPT_X86_64 || defined OPT_AVX)
+	fr->cpu_opts.the_resample_fir = resample_fir;
+#endif
 #endif
 #endif
 	/* covers any i386+ cpu; they actually differ only in the synth_1to1 function, mostly... */
@@ -721,6 +825,8 @@ int frame_cpu_opt(mpg123_handle *fr, const char* cpu)
 			fr->synths.plain[r_1to1][f_8] = synth_1to1_8bit_wrap;
 			fr->synths.mono[r_1to1][f_8] = synth_1to1_8bit_wrap_mono;
 			fr->synths.mono2stereo[r_1to1][f_8] = synth_1to1_8bit_wrap_m2s;
+			if(fr->synths.stereo[r_1to1][f_16] != synth_stereo_wrap)
+			fr->synths.stereo[r_1to1][f_8] = synth_1to1_8bit_wrap_stereo;
 		}
 #		endif
 #		endif
@@ -734,6 +840,40 @@ int frame_cpu_opt(mpg123_handle *fr, const char* cpu)
 
 #endif /* OPT_X86 */
 
+#ifdef OPT_AVX512
+	if(!done && (auto_choose || want_dec == avx512) && cpu_avx512(cpu_flags))
+	{
+		chosen = "x86-64 (AVX512)";
+		fr->cpu_opts.type = avx512;
+#		ifndef NO_LAYER3
+		fr->cpu_opts.the_dct36 = dct36_avx;
+		fr->cpu_opts.the_dct12 = dct12_x86_64;
+		fr->cpu_opts.the_antialias = antialias_x86_64;
+		fr->cpu_opts.the_stereo_ms = stereo_ms_x86_64;
+		fr->cpu_opts.the_hybrid_tail = hybrid_tail_x86_64;
+#		endif
+#		ifndef NO_LAYER12
+		fr->cpu_opts.the_dequant12 = dequant12_x86_64;
+#		endif
+#		ifdef RESAMPLER
+		fr->cpu_opts.the_resample_fir = resample_fir_avx;
+#		endif
+#		ifndef NO_16BIT
+		fr->synths.plain[r_1to1][f_16] = synth_1to1_avx512;
+		fr->synths.stereo[r_1to1][f_16] = synth_1to1_stereo_avx512;
+#		endif
+#		ifndef NO_REAL
+		fr->synths.plain[r_1to1][f_real] = synth_1to1_real_avx512;
+		fr->synths.stereo[r_1to1][f_real] = synth_1to1_real_stereo_avx512;
+#		endif
+#		ifndef NO_32BIT
+		fr->synths.plain[r_1to1][f_32] = synth_1to1_s32_avx512;
+		fr->synths.stereo[r_1to1][f_32] = synth_1to1_s32_stereo_avx512;
+#		endif
+		done = 1;
+	}
+#endif
+
 #ifdef OPT_AVX
 	if(!done && (auto_choose || want_dec == avx) && cpu_avx(cpu_flags))
 	{
@@ -742,6 +882,16 @@ int frame_cpu_opt(mpg123_handle *fr, const char* cpu)
 #ifdef OPT_MULTI
 #		ifndef NO_LAYER3
 		fr->cpu_opts.the_dct36 = dct36_avx;
+		fr->cpu_opts.the_dct12 = dct12_x86_64;
+		fr->cpu_opts.the_antialias = antialias_x86_64;
+		fr->cpu_opts.the_stereo_ms = stereo_ms_x86_64;
+		fr->cpu_opts.the_hybrid_tail = hybrid_tail_x86_64;
+#		endif
+#		ifndef NO_LAYER12
+		fr->cpu_opts.the_dequant12 = dequant12_x86_64;
+#		endif
+#		ifdef RESAMPLER
+		fr->cpu_opts.the_resample_fir = resample_fir_avx;
 #		endif
 #endif
 #		ifndef NO_16BIT
@@ -768,6 +918,16 @@ int frame_cpu_opt(mpg123_handle *fr, const char* cpu)
 #ifdef OPT_MULTI
 #		ifndef NO_LAYER3
 		fr->cpu_opts.the_dct36 = dct36_x86_64;
+		fr->cpu_opts.the_dct12 = dct12_x86_64;
+		fr->cpu_opts.the_antialias = antialias_x86_64;
+		fr->cpu_opts.the_stereo_ms = stereo_ms_x86_64;
+		fr->cpu_opts.the_hybrid_tail = hybrid_tail_x86_64;
+#		endif
+#		ifndef NO_LAYER12
+		fr->cpu_opts.the_dequant12 = dequant12_x86_64;
+#		endif
+#		ifdef RESAMPLER
+		fr->cpu_opts.the_resample_fir = resample_fir_x86_64;
 #		endif
 #endif
 #		ifndef NO_16BIT
@@ -909,6 +1069,9 @@ int frame_cpu_opt(mpg123_handle *fr, const char* cpu)
 		fr->synths.plain[r_1to1][f_8] = synth_1to1_8bit_wrap;
 		fr->synths.mono[r_1to1][f_8] = synth_1to1_8bit_wrap_mono;
 		fr->synths.mono2stereo[r_1to1][f_8] = synth_1to1_8bit_wrap_m2s;
+		/* An optimized stereo synth gets both channels in one call. */
+		if(fr->synths.stereo[r_1to1][f_16] != synth_stereo_wrap)
+		fr->synths.stereo[r_1to1][f_8] = synth_1to1_8bit_wrap_stereo;
 	}
 #	endif
 #	endif
@@ -991,6 +1154,9 @@ static const char *mpg123_supported_decoder_list[] =
 	#ifdef OPT_ALTIVEC
 	NULL,
 	#endif
+	#ifdef OPT_AVX512
+	NULL,
+	#endif
 	#ifdef OPT_AVX
 	NULL,
 	#endif
@@ -1057,6 +1223,9 @@ static const char *mpg123_decoder_list[] =
 	#ifdef OPT_ALTIVEC
 	dn_altivec,
 	#endif
+	#ifdef OPT_AVX512
+	dn_avx512,
+	#endif
 	#ifdef OPT_AVX
 	dn_avx,
 	#endif
@@ -1136,6 +1305,9 @@ void check_decoders(void )
 #ifdef OPT_I386
 	*(d++) = dn_idrei;
 #endif
+#ifdef OPT_AVX512
+	if(cpu_avx512(cpu_flags)) *(d++) = dn_avx512;
+#endif
 #ifdef OPT_AVX
 	if(cpu_avx(cpu_flags)) *(d++) = dn_avx;
 #endif
@@ -24,6 +24,7 @@
 	OPT_ALTIVEC (Motorola/IBM PPC with AltiVec under MacOSX)
 	OPT_X86_64 (x86-64 / AMD64 / Intel 64)
 	OPT_AVX
+	OPT_AVX512 (only together with OPT_AVX in OPT_MULTI)
 
 	or you define OPT_MULTI and give a combination which makes sense (do not include i486, do not mix altivec and x86).
 
@@ -61,6 +62,7 @@ perl <<'EOT'
 ,['arm','ARM']
 ,['neon','NEON']
 ,['avx','AVX']
+,['avx512','AVX512']
 ,['dreidnow_vintage', '3DNow_vintage']
 ,['dreidnowext_vintage', '3DNowExt_vintage']
 ,['sse_vintage', 'SSE_vintage']
@@ -110,6 +112,7 @@ enum optdec
 	,neon
 	,neon64
 	,avx
+	,avx512
 	,dreidnow_vintage
 	,dreidnowext_vintage
 	,sse_vintage
@@ -133,6 +136,7 @@ static const char dn_arm[] = "ARM";
 static const char dn_neon[] = "NEON";
 static const char dn_neon64[] = "NEON64";
 static const char dn_avx[] = "AVX";
+static const char dn_avx512[] = "AVX512";
 static const char dn_dreidnow_vintage[] = "3DNow_vintage";
 static const char dn_dreidnowext_vintage[] = "3DNowExt_vintage";
 static const char dn_sse_vintage[] = "SSE_vintage";
@@ -156,6 +160,7 @@ static const char* decname[] =
 	,dn_neon
 	,dn_neon64
 	,dn_avx
+	,dn_avx512
 	,dn_dreidnow_vintage
 	,dn_dreidnowext_vintage
 	,dn_sse_vintage
@@ -194,7 +199,7 @@ enum optcla decclass(const enum optdec);
  || (defined OPT_3DNOW_VINTAGE) || (defined OPT_3DNOWEXT_VINTAGE) \
  || (defined OPT_SSE_VINTAGE) \
  || (defined OPT_NEON) || (defined OPT_NEON64) || (defined OPT_AVX) \
- || (defined OPT_GENERIC_DITHER)
+ || (defined OPT_AVX512) || (defined OPT_GENERIC_DITHER)
 #error "Bad decoder choice together with fixed point math!"
 #endif
 #endif
@@ -331,6 +336,12 @@ extern const int costab_mmxsse[];
 #ifndef OPT_MULTI
 #	define defopt x86_64
 #	define opt_dct36(fr) dct36_x86_64
+#	define opt_dct12(fr) dct12_x86_64
+#	define opt_antialias(fr) antialias_x86_64
+#	define opt_stereo_ms(fr) stereo_ms_x86_64
+#	define opt_hybrid_tail(fr) hybrid_tail_x86_64
+#	define opt_dequant12(fr) dequant12_x86_64
+#	define opt_resample_fir(fr) resample_fir_x86_64
 #endif
 #endif
 
@@ -339,6 +350,23 @@ extern const int costab_mmxsse[];
 #ifndef OPT_MULTI
 #	define defopt avx
 #	define opt_dct36(fr) dct36_avx
+#	define opt_dct12(fr) dct12_x86_64
+#	define opt_antialias(fr) antialias_x86_64
+#	define opt_stereo_ms(fr) stereo_ms_x86_64
+#	define opt_hybrid_tail(fr) hybrid_tail_x86_64
+#	define opt_dequant12(fr) dequant12_x86_64
+#	define opt_resample_fir(fr) resample_fir_avx
+#endif
+#endif
+
+/* The AVX-512 decoder borrows the AVX dct36 and mono synths,
+   it only exists in a runtime-dispatched build alongside OPT_AVX. */
+#ifdef OPT_AVX512
+#ifndef OPT_AVX
+#error "OPT_AVX512 needs OPT_AVX."
+#endif
+#ifndef OPT_MULTI
+#error "OPT_AVX512 is only supported in OPT_MULTI builds."
 #endif
 #endif
 
@@ -380,12 +408,32 @@ void check_decoders(void);
 #	if (defined OPT_3DNOW_VINTAGE || defined OPT_3DNOWEXT_VINTAGE || defined OPT_SSE || defined OPT_X86_64 || defined OPT_AVX || defined OPT_NEON || defined OPT_NEON64)
 #		define opt_dct36(fr) ((fr)->cpu_opts.the_dct36)
 #	endif
+#	if (defined OPT_X86_64 || defined OPT_AVX)
+#		define opt_dct12(fr) ((fr)->cpu_opts.the_dct12)
+#		define opt_antialias(fr) ((fr)->cpu_opts.the_antialias)
+#		define opt_stereo_ms(fr) ((fr)->cpu_opts.the_stereo_ms)
+#		define opt_hybrid_tail(fr) ((fr)->cpu_opts.the_hybrid_tail)
+#		define opt_dequant12(fr) ((fr)->cpu_opts.the_dequant12)
+#		define opt_resample_fir(fr) ((fr)->cpu_opts.the_resample_fir)
+#	endif
 
 #endif /* OPT_MULTI else */
 
 #	ifndef opt_dct36
 #		define opt_dct36(fr) dct36
 #	endif
+#	ifndef opt_dct12
+#		define opt_dct12(fr) dct12
+#		define opt_antialias(fr) antialias
+#		define opt_stereo_ms(fr) stereo_ms
+#		define opt_hybrid_tail(fr) hybrid_tail
+#	endif
+#	ifndef opt_dequant12
+#		define opt_dequant12(fr) dequant12
+#	endif
+#	ifndef opt_resample_fir
+#		define opt_resample_fir(fr) resample_fir
+#	endif
 
 #endif /* MPG123_H_OPTIMIZE */
 
@@ -0,0 +1,267 @@
+/*
+	parallel: decoding of a seekable file in segments, on multiple threads
+
+	copyright 2016 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+
+	The idea is simple: The main handle scans the file to know the exact track
+	length and to have the full frame index. Then the output range is cut into
+	segments and each segment is decoded by a fresh handle that opens the same
+	file, takes over index and length info and seeks to the segment start.
+	The usual seek machinery decodes and discards some frames before the wanted
+	one (fr->ignoreframe), which refills the Layer III bit reservoir and the
+	synth/hybrid history. With enough of that pre-roll, the output of a segment
+	is identical to what a sequential decode produces at that position.
+*/
+
+#include "mpg123lib_intern.h"
+#ifdef USE_THREADS
+#include <pthread.h>
+#endif
+#include "debug.h"
+
+struct segment
+{
+	mpg123_handle *mh;
+	off_t begin; /* first output sample */
+	unsigned char *out;
+	size_t size; /* bytes wanted */
+	size_t fill; /* bytes got */
+	int err;
+#ifdef USE_THREADS
+	pthread_t thread;
+	int running;
+#endif
+};
+
+/* Pre-roll frames needed for an exact Layer III segment start.
+   The first frame after the seek has no bit reservoir data at all, the frames
+   up to the reservoir size after it are at risk, and the one before the
+   segment start has to be fine to provide the hybrid overlap. With variable
+   bitrate, the frames at a segment start can be as small as the lowest
+   bitrate makes them, so that is the size to count with. Free format keeps
+   one size. */
+static long segment_preframes(mpg123_handle *mh)
+{
+	long preframes = mh->p.preframes;
+#ifndef NO_LAYER3
+	if(mh->lay == 3)
+	{
+		long maxres  = mh->lsf ? 255 : 511;
+		long framesize = mh->freeformat
+		?	mh->framesize
+		:	(mh->lsf ? 8 : 32) * 144000L / (frame_freq(mh)<<mh->lsf) - 4;
+		long payload = framesize - mh->ssize - (mh->error_protection ? 2 : 0);
+		long need;
+		if(payload < 1) payload = 1;
+		need = (maxres+payload-1)/payload + 1;
+		if(need > preframes) preframes = need;
+	}
+#endif
+	return preframes;
+}
+
+/* Create a handle for one segment, looking just like the main one. */
+static mpg123_handle *segment_handle(mpg123_handle *mh, long preframes, int *err)
+{
+	mpg123_handle *sh;
+	long rate;
+	int channels, encoding;
+
+	sh = mpg123_parnew(&mh->p, mpg123_current_decoder(mh), err);
+	if(sh == NULL) return NULL;
+
+	sh->p.preframes = preframes;
+	/* Segments are joined as they come, that only works for interleaved samples. */
+	sh->p.flags &= ~MPG123_PLANAR;
+	/* The main handle measures the joined output. */
+	sh->p.flags &= ~MPG123_LOUDNESS;
+	/* The tap stays with the main handle, segments have to synthesize. */
+	sh->p.flags &= ~MPG123_TAP_ONLY;
+	sh->rdat.r_read  = mh->rdat.r_read;
+	sh->rdat.r_lseek = mh->rdat.r_lseek;
+	sh->have_eq_settings = mh->have_eq_settings;
+	memcpy(sh->equalizer, mh->equalizer, sizeof(mh->equalizer));
+
+	if(   mpg123_open(sh, mh->rdat.filename) != MPG123_OK
+	   || mpg123_getformat(sh, &rate, &channels, &encoding) != MPG123_OK )
+	{
+		*err = mpg123_errcode(sh);
+		mpg123_delete(sh);
+		return NULL;
+	}
+	if(   rate != mh->af.rate || channels != mh->af.channels
+	   || encoding != mh->af.encoding )
+	{
+		*err = MPG123_BAD_OUTFORMAT;
+		mpg123_delete(sh);
+		return NULL;
+	}
+	/* Take over what the scan of the main handle found out. */
+#ifdef FRAME_INDEX
+	if(  (fi_positions(&mh->index) == NULL && mh->index.fill)
+	  || fi_set(&sh->index, fi_positions(&mh->index), mh->index.step, mh->index.fill) != 0 )
+	{
+		*err = MPG123_INDEX_FAIL;
+		mpg123_delete(sh);
+		return NULL;
+	}
+#endif
+	sh->track_frames  = mh->track_frames;
+	sh->track_samples = mh->track_samples;
+#ifdef GAPLESS
+	sh->gapless_frames = mh->gapless_frames;
+	sh->begin_s = mh->begin_s;
+	sh->end_s   = mh->end_s;
+	frame_gapless_realinit(sh);
+#endif
+	*err = MPG123_OK;
+	return sh;
+}
+
+static void decode_segment(struct segment *seg)
+{
+	if(mpg123_seek(seg->mh, seg->begin, SEEK_SET) != seg->begin)
+	{
+		seg->err = mpg123_errcode(seg->mh);
+		if(seg->err == MPG123_OK) seg->err = MPG123_ERR_READER;
+		return;
+	}
+	while(seg->fill < seg->size)
+	{
+		size_t got = 0;
+		int ret = mpg123_read( seg->mh, seg->out+seg->fill
+		,	seg->size-seg->fill, &got );
+		seg->fill += got;
+		if(ret == MPG123_DONE) break;
+		/* Format changes inside the track are not supported here. */
+		if(ret != MPG123_OK)
+		{
+			seg->err = ret == MPG123_NEW_FORMAT
+			?	MPG123_BAD_OUTFORMAT
+			:	mpg123_errcode(seg->mh);
+			return;
+		}
+	}
+	seg->err = MPG123_OK;
+}
+
+#ifdef USE_THREADS
+static void *segment_thread(void *arg)
+{
+	decode_segment((struct segment*)arg);
+	return NULL;
+}
+#endif
+
+int attribute_align_arg mpg123_decode_parallel(mpg123_handle *mh, int segments, unsigned char *outmemory, size_t outmemsize, size_t *done)
+{
+	struct segment *seg;
+	off_t length;
+	size_t samplesize;
+	long preframes;
+	int i;
+	int ret = MPG123_OK;
+
+	if(done != NULL) *done = 0;
+	if(mh == NULL) return MPG123_BAD_HANDLE;
+	if(segments < 1)
+	{
+		mh->err = MPG123_BAD_VALUE;
+		return MPG123_ERR;
+	}
+	if(outmemory == NULL || done == NULL)
+	{
+		mh->err = MPG123_NULL_POINTER;
+		return MPG123_ERR;
+	}
+	if(mh->rdat.filename == NULL)
+	{
+		mh->err = MPG123_BAD_FILE;
+		return MPG123_ERR;
+	}
+	if(mpg123_scan(mh) != MPG123_OK) return MPG123_ERR;
+
+	length = mpg123_length(mh);
+	if(length < 0) return MPG123_ERR;
+	if(mh->af.encsize < 1 || mh->af.channels < 1)
+	{
+		mh->err = MPG123_BAD_OUTFORMAT;
+		return MPG123_ERR;
+	}
+	samplesize = mh->af.encsize * mh->af.channels;
+	if((size_t)length > outmemsize/samplesize)
+	{
+		mh->err = MPG123_BAD_BUFFER;
+		return MPG123_ERR;
+	}
+	/* No point in segments without any samples. */
+	if((off_t)segments > length) segments = length > 0 ? (int)length : 1;
+
+	seg = malloc(sizeof(struct segment)*segments);
+	if(seg == NULL)
+	{
+		mh->err = MPG123_OUT_OF_MEM;
+		return MPG123_ERR;
+	}
+	preframes = segment_preframes(mh);
+	debug2("decoding %"OFF_P" samples in %i segments", (off_p)length, segments);
+
+	for(i=0; i<segments; ++i)
+	{
+		off_t end = length/segments*(i+1) + (i+1 == segments ? length%segments : 0);
+		seg[i].begin = length/segments*i;
+		seg[i].out   = outmemory + seg[i].begin*samplesize;
+		seg[i].size  = (size_t)(end-seg[i].begin)*samplesize;
+		seg[i].fill  = 0;
+		seg[i].err   = MPG123_OK;
+#ifdef USE_THREADS
+		seg[i].running = 0;
+#endif
+		seg[i].mh = ret == MPG123_OK
+		?	segment_handle(mh, preframes, &seg[i].err)
+		:	NULL;
+		if(seg[i].mh == NULL && ret == MPG123_OK) ret = seg[i].err;
+	}
+
+	if(ret == MPG123_OK) for(i=0; i<segments; ++i)
+	{
+#ifdef USE_THREADS
+		/* The last one runs here, as do segments that did not get a thread. */
+		if(i+1 < segments && !pthread_create(&seg[i].thread, NULL, segment_thread, seg+i))
+		seg[i].running = 1;
+		else
+#endif
+		decode_segment(seg+i);
+	}
+
+	for(i=0; i<segments; ++i)
+	{
+#ifdef USE_THREADS
+		if(seg[i].running) pthread_join(seg[i].thread, NULL);
+#endif
+		if(seg[i].mh != NULL) mpg123_delete(seg[i].mh);
+	}
+	/* Deliver the complete part from the beginning. */
+	for(i=0; i<segments; ++i)
+	{
+		if(ret == MPG123_OK && seg[i].err != MPG123_OK) ret = seg[i].err;
+		if(ret != MPG123_OK) break;
+
+		*done += seg[i].fill;
+		if(seg[i].fill < seg[i].size) break;
+	}
+	free(seg);
+
+	if(ret != MPG123_OK)
+	{
+		mh->err = ret;
+		return MPG123_ERR;
+	}
+	if(mh->p.flags & MPG123_LOUDNESS)
+	{
+		loudness_reset(mh);
+		loudness_add(mh, outmemory, *done, 0);
+	}
+	return MPG123_OK;
+}
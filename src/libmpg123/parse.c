@@ -551,18 +551,35 @@ init_resync:
 
 	/* if filepos is invalid, so is framepos */
 	framepos = fr->rd->tell(fr) - 4;
+	/* Buffers for frame data and the decoder of this layer come on first use. */
+	if(frame_layer_buffers(fr) != 0)
+	{
+		if(NOQUIET) error("cannot allocate frame buffers");
+		fr->err = MPG123_OUT_OF_MEM;
+		ret = PARSE_ERR;
+		goto read_frame_bad;
+	}
 	/* flip/init buffer for Layer 3 */
 	{
 		unsigned char *newbuf = fr->bsspace[fr->bsnum]+512;
+		unsigned char *inplace = NULL;
+		/* Layer I and II just read the frame body, memory and feed readers can leave it where it is.
+		   Layer III joins it with the bit reservoir in front and may patch the side info. */
+		if(fr->lay != 3 && fr->rd->frame_body_inplace != NULL)
+		inplace = fr->rd->frame_body_inplace(fr, fr->framesize);
+		if(inplace != NULL) newbuf = inplace;
 		/* read main data into memory */
-		if((ret=fr->rd->read_frame_body(fr,newbuf,fr->framesize))<0)
+		else if((ret=fr->rd->read_frame_body(fr,newbuf,fr->framesize))<0)
 		{
 			/* if failed: flip back */
 			debug("need more?");
 			goto read_frame_bad;
 		}
-		fr->bsbufold = fr->bsbuf;
+		/* Fed input of a frame left in place may be released already,
+		   a Layer III frame following it takes stale reservoir bytes from bsspace. */
+		fr->bsbufold = fr->bsinplace ? fr->bsspace[(fr->bsnum+1)&1]+512 : fr->bsbuf;
 		fr->bsbuf = newbuf;
+		fr->bsinplace = inplace != NULL;
 	}
 	fr->bsnum = (fr->bsnum + 1) & 1;
 
@@ -599,6 +616,11 @@ init_resync:
 	{
 		fr->mean_framesize = ((fr->mean_frames-1)*fr->mean_framesize+compute_bpf(fr)) / fr->mean_frames ;
 	}
+#ifdef FRAME_INDEX
+	/* With the first frame, a loaded index cache can be checked against the stream. */
+	if(fr->num < 0 && fr->cached != NULL && index_cache_apply(fr) != 0 && NOQUIET)
+	error("index cache does not fit the stream, ignoring it");
+#endif
 	++fr->num; /* 0 for first frame! */
 	debug4("Frame %"OFF_P" %08lx %i, next filepos=%"OFF_P, 
 	(off_p)fr->num, newhead, fr->framesize, (off_p)fr->rd->tell(fr));
@@ -624,8 +646,15 @@ init_resync:
 #ifdef FRAME_INDEX
 	/* Keep track of true frame positions in our frame index.
 	   but only do so when we are sure that the frame number is accurate... */
-	if((fr->state_flags & FRAME_ACCURATE) && FI_NEXT(fr->index, fr->num))
-	fi_add(&fr->index, framepos);
+	if(fr->state_flags & FRAME_ACCURATE)
+	{
+		unsigned int main_data_begin, payload;
+		if(FI_NEXT(fr->index, fr->num))
+		fi_add(&fr->index, framepos);
+		/* ... together with the reach into the bit reservoir, for seeking. */
+		layer3_reservoir(newhead, fr->bsbuf, fr->framesize, &main_data_begin, &payload);
+		fi_reservoir(&fr->index, fr->num, main_data_begin, payload);
+	}
 #endif
 
 	if(fr->silent_resync > 0) --fr->silent_resync;
@@ -885,6 +914,22 @@ void set_pointer(mpg123_handle *fr, long backstep)
 	fr->bitindex = 0; 
 }
 
+void layer3_reservoir(unsigned long head, const unsigned char *data, long size, unsigned int *main_data_begin, unsigned int *payload)
+{
+	int lsf  = (HDR_VERSION_VAL(head) & 0x1) ? 0 : 1;
+	int crc  = HDR_CRC_VAL(head) ? 0 : 2;
+	long ssize = (HDR_CHANNEL_VAL(head) == MPG_MD_MONO)
+	?	(lsf ? 9 : 17)
+	:	(lsf ? 17 : 32);
+
+	*main_data_begin = *payload = 0;
+	if(HDR_LAYER_VAL(head) != 1 || size < ssize+2*crc) return;
+	data += crc;
+	*main_data_begin = lsf ? data[0] : ((unsigned int)data[0]<<1 | data[1]>>7);
+	/* Same count as in III_get_side_info(), CRC bytes are subtracted twice there. */
+	*payload = (unsigned int)(size - ssize - 2*crc);
+}
+
 /********************************/
 
 double compute_bpf(mpg123_handle *fr)
@@ -911,6 +956,61 @@ double compute_bpf(mpg123_handle *fr)
 	return bpf;
 }
 
+/*
+	What decode_header() and compute_bpf() would yield for a header, without
+	touching the handle. For scanning a stream by its headers alone.
+	Returns FALSE for anything that needs the full parser: invalid headers,
+	free format, layers missing in this build, oversized frames.
+*/
+int header_frame_info(unsigned long head, long *framesize, double *bpf)
+{
+	int lsf, lay, bitrate;
+	long freq, size;
+
+	if(!head_check(head) || HDR_FREE_FORMAT(head)) return FALSE;
+
+	lay = 4 - HDR_LAYER_VAL(head);
+	if(HDR_VERSION_VAL(head) & 0x2)
+	{
+		lsf  = (HDR_VERSION_VAL(head) & 0x1) ? 0 : 1;
+		freq = freqs[HDR_SAMPLERATE_VAL(head) + lsf*3];
+	}
+	else
+	{
+		lsf  = 1;
+		freq = freqs[6 + HDR_SAMPLERATE_VAL(head)];
+	}
+	bitrate = tabsel_123[lsf][lay-1][HDR_BITRATE_VAL(head)];
+
+	switch(lay)
+	{
+#ifndef NO_LAYER1
+		case 1:
+			size = ((bitrate*12000L/freq + HDR_PADDING_VAL(head))<<2) - 4;
+			*bpf = (double)bitrate * 12000.0 * 4.0 / (freq<<lsf);
+		break;
+#endif
+#ifndef NO_LAYER2
+		case 2:
+			size = bitrate*144000L/freq + HDR_PADDING_VAL(head) - 4;
+			*bpf = (double)bitrate * 144000 / (freq<<lsf);
+		break;
+#endif
+#ifndef NO_LAYER3
+		case 3:
+			size = bitrate*144000L/(freq<<lsf) + HDR_PADDING_VAL(head) - 4;
+			*bpf = (double)bitrate * 144000 / (freq<<lsf);
+		break;
+#endif
+		default:
+			return FALSE;
+	}
+	if(size > MAXFRAMESIZE) return FALSE;
+
+	*framesize = size;
+	return TRUE;
+}
+
 int attribute_align_arg mpg123_spf(mpg123_handle *mh)
 {
 	if(mh == NULL) return MPG123_ERR;
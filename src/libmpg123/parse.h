@@ -17,9 +17,16 @@ long frame_freq(mpg123_handle *fr);
 int read_frame_recover(mpg123_handle* fr); /* dead? */
 int read_frame(mpg123_handle *fr);
 void set_pointer(mpg123_handle *fr, long backstep);
+/* Layer III main_data_begin of the frame with header head and size bytes of
+   data after it, and the bytes that frame adds to the bit reservoir. Zero for
+   other layers. */
+void layer3_reservoir(unsigned long head, const unsigned char *data, long size, unsigned int *main_data_begin, unsigned int *payload);
 int position_info(mpg123_handle* fr, unsigned long no, long buffsize, unsigned long* frames_left, double* current_seconds, double* seconds_left);
 double compute_bpf(mpg123_handle *fr);
+int header_frame_info(unsigned long head, long *framesize, double *bpf);
 long time_to_frame(mpg123_handle *fr, double seconds);
 int get_songlen(mpg123_handle *fr,int no);
+/* Header-only counting of the frames after frame 0 for mpg123_scan() (scan.c). */
+int scan_frames(mpg123_handle *fr, off_t *frames);
 
 #endif
@@ -0,0 +1,281 @@
+/*
+	readahead: reading the input stream ahead on a background thread
+
+	copyright 2016 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+
+	With MPG123_READAHEAD, a thread keeps reading from the descriptor into a
+	ring buffer while the decoder takes data out of it. A slow medium (cold
+	cache, network file system, sluggish server) only stalls decoding when the
+	buffered data runs out, which is counted for mpg123_getstate().
+
+	The thread owns the descriptor: seeks are handed to it, too, except for
+	those landing in what is buffered. Some of the already consumed data is
+	kept for the small steps back of the parser.
+*/
+
+#include "mpg123lib_intern.h"
+#ifdef USE_THREADS
+#include <pthread.h>
+#endif
+#include "debug.h"
+
+#ifdef USE_THREADS
+
+/* Smallest ring, largest single read. */
+#define READAHEAD_MIN   32768
+#define READAHEAD_CHUNK 262144
+
+struct readahead
+{
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond; /* any change of state, waited on by both sides */
+	unsigned char *ring;
+	size_t size;
+	size_t chunk; /* read in that steps, once that much space is free */
+	size_t keep;  /* consumed bytes not to overwrite, even while reading */
+	size_t head;  /* ring offset of the next byte for the decoder */
+	size_t fill;  /* bytes buffered from head on */
+	size_t back;  /* consumed bytes before head that are kept, up to keep */
+	off_t pos;    /* stream position of head */
+	int eof;
+	int error;
+	int quit;
+	int seeking;
+	off_t seek_offset;
+	int seek_whence;
+	off_t seek_result;
+	long stalls;
+	struct reader_data *rdat;
+	ssize_t (*read)(struct reader_data *, void *, size_t);
+	off_t   (*seek)(struct reader_data *, off_t, int);
+};
+
+static void *readahead_thread(void *arg)
+{
+	struct readahead *ra = arg;
+	pthread_mutex_lock(&ra->lock);
+	while(!ra->quit)
+	{
+		size_t end, count;
+		ssize_t got;
+		if(ra->seeking)
+		{
+			off_t res;
+			pthread_mutex_unlock(&ra->lock);
+			res = ra->seek(ra->rdat, ra->seek_offset, ra->seek_whence);
+			pthread_mutex_lock(&ra->lock);
+			/* A failed seek left the descriptor where it was, buffer still good. */
+			if(res >= 0)
+			{
+				ra->pos = res;
+				ra->head = ra->fill = ra->back = 0;
+				ra->eof = ra->error = 0;
+			}
+			ra->seek_result = res;
+			ra->seeking = 0;
+			pthread_cond_broadcast(&ra->cond);
+			continue;
+		}
+		/* After steps back, fill can reach into the kept part. */
+		if(ra->eof || ra->error || ra->fill + ra->keep + ra->chunk > ra->size)
+		{
+			pthread_cond_wait(&ra->cond, &ra->lock);
+			continue;
+		}
+		end = (ra->head + ra->fill) % ra->size;
+		count = ra->size - ra->keep - ra->fill;
+		if(count > ra->size - end) count = ra->size - end;
+		if(count > ra->chunk) count = ra->chunk;
+		/* The decoder only takes from the front meanwhile, never touching this part. */
+		pthread_mutex_unlock(&ra->lock);
+		got = ra->read(ra->rdat, ra->ring+end, count);
+		pthread_mutex_lock(&ra->lock);
+		if(got < 0) ra->error = 1;
+		else if(got == 0) ra->eof = 1;
+		else ra->fill += got;
+		pthread_cond_broadcast(&ra->cond);
+	}
+	pthread_mutex_unlock(&ra->lock);
+	return NULL;
+}
+
+int readahead_start(mpg123_handle *fr
+,	ssize_t (*read)(struct reader_data *, void *, size_t)
+,	off_t (*seek)(struct reader_data *, off_t, int) )
+{
+	struct readahead *ra;
+	size_t size = fr->p.readahead > READAHEAD_MIN ? (size_t)fr->p.readahead : READAHEAD_MIN;
+
+	if(fr->rdat.ahead != NULL) return 0;
+	ra = malloc(sizeof(*ra));
+	if(ra == NULL) return -1;
+	memset(ra, 0, sizeof(*ra));
+	ra->ring = malloc(size);
+	if(ra->ring == NULL)
+	{
+		free(ra);
+		return -1;
+	}
+	ra->size  = size;
+	ra->keep  = size/8;
+	ra->chunk = size/4 > READAHEAD_CHUNK ? READAHEAD_CHUNK : size/4;
+	ra->pos   = fr->rdat.filepos;
+	ra->rdat  = &fr->rdat;
+	ra->read  = read;
+	ra->seek  = seek;
+	pthread_mutex_init(&ra->lock, NULL);
+	pthread_cond_init(&ra->cond, NULL);
+	if(pthread_create(&ra->thread, NULL, readahead_thread, ra))
+	{
+		pthread_cond_destroy(&ra->cond);
+		pthread_mutex_destroy(&ra->lock);
+		free(ra->ring);
+		free(ra);
+		return -1;
+	}
+	debug2("readahead of %lu bytes in steps of %lu", (unsigned long)size, (unsigned long)ra->chunk);
+	fr->rdat.ahead  = ra;
+	fr->rdat.fdread = readahead_read;
+	return 0;
+}
+
+void readahead_stop(mpg123_handle *fr)
+{
+	struct readahead *ra = fr->rdat.ahead;
+	if(ra == NULL) return;
+
+	pthread_mutex_lock(&ra->lock);
+	ra->quit = 1;
+	pthread_cond_broadcast(&ra->cond);
+	pthread_mutex_unlock(&ra->lock);
+	/* That waits for a read in progress. */
+	pthread_join(ra->thread, NULL);
+	pthread_cond_destroy(&ra->cond);
+	pthread_mutex_destroy(&ra->lock);
+	free(ra->ring);
+	free(ra);
+	fr->rdat.ahead = NULL;
+}
+
+ssize_t readahead_read(mpg123_handle *fr, void *buf, size_t count)
+{
+	struct readahead *ra = fr->rdat.ahead;
+	size_t got = 0;
+	ssize_t ret;
+
+	pthread_mutex_lock(&ra->lock);
+	if(ra->fill == 0 && !ra->eof && !ra->error)
+	{
+		++ra->stalls;
+		do pthread_cond_wait(&ra->cond, &ra->lock);
+		while(ra->fill == 0 && !ra->eof && !ra->error);
+	}
+	if(ra->fill == 0)
+	{
+		ret = ra->error ? -1 : 0;
+		/* Next time, try again like a plain read() would (the file may grow). */
+		ra->eof = ra->error = 0;
+	}
+	else
+	{
+		while(got < count && ra->fill > 0)
+		{
+			size_t part = count - got;
+			if(part > ra->fill) part = ra->fill;
+			if(part > ra->size - ra->head) part = ra->size - ra->head;
+			memcpy((unsigned char*)buf+got, ra->ring+ra->head, part);
+			ra->head = (ra->head + part) % ra->size;
+			ra->fill -= part;
+			got += part;
+		}
+		ra->back = ra->back + got > ra->keep ? ra->keep : ra->back + got;
+		ra->pos += got;
+		ret = (ssize_t)got;
+	}
+	pthread_cond_broadcast(&ra->cond);
+	pthread_mutex_unlock(&ra->lock);
+	return ret;
+}
+
+off_t readahead_seek(struct reader_data *rdat, off_t offset, int whence)
+{
+	struct readahead *ra = rdat->ahead;
+	off_t ret;
+
+	pthread_mutex_lock(&ra->lock);
+	/* The descriptor is somewhere ahead, relative seeks are relative to the decoder. */
+	if(whence == SEEK_CUR)
+	{
+		offset += ra->pos;
+		whence  = SEEK_SET;
+	}
+	if(whence == SEEK_SET && offset >= ra->pos && offset - ra->pos <= (off_t)ra->fill)
+	{
+		size_t skip = (size_t)(offset - ra->pos);
+		ra->head  = (ra->head + skip) % ra->size;
+		ra->fill -= skip;
+		ra->back  = ra->back + skip > ra->keep ? ra->keep : ra->back + skip;
+		ra->pos   = offset;
+		ret = offset;
+	}
+	else if(whence == SEEK_SET && offset < ra->pos && ra->pos - offset <= (off_t)ra->back)
+	{
+		size_t step = (size_t)(ra->pos - offset);
+		ra->head  = (ra->head + ra->size - step) % ra->size;
+		ra->fill += step;
+		ra->back -= step;
+		ra->pos   = offset;
+		ret = offset;
+	}
+	else
+	{
+		ra->seek_offset = offset;
+		ra->seek_whence = whence;
+		ra->seeking = 1;
+		pthread_cond_broadcast(&ra->cond);
+		while(ra->seeking) pthread_cond_wait(&ra->cond, &ra->lock);
+		ret = ra->seek_result;
+	}
+	pthread_cond_broadcast(&ra->cond);
+	pthread_mutex_unlock(&ra->lock);
+	return ret;
+}
+
+void readahead_state(struct reader_data *rdat, size_t *fill, long *stalls)
+{
+	struct readahead *ra = rdat->ahead;
+	*fill = 0;
+	*stalls = 0;
+	if(ra == NULL) return;
+
+	pthread_mutex_lock(&ra->lock);
+	*fill   = ra->fill;
+	*stalls = ra->stalls;
+	pthread_mutex_unlock(&ra->lock);
+}
+
+#else
+
+/* Nothing to start, just reading directly. */
+int readahead_start(mpg123_handle *fr
+,	ssize_t (*read)(struct reader_data *, void *, size_t)
+,	off_t (*seek)(struct reader_data *, off_t, int) )
+{
+	return 0;
+}
+
+void readahead_stop(mpg123_handle *fr){}
+
+ssize_t readahead_read(mpg123_handle *fr, void *buf, size_t count){ return -1; }
+
+off_t readahead_seek(struct reader_data *rdat, off_t offset, int whence){ return -1; }
+
+void readahead_state(struct reader_data *rdat, size_t *fill, long *stalls)
+{
+	*fill = 0;
+	*stalls = 0;
+}
+
+#endif
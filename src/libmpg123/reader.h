@@ -19,6 +19,10 @@ struct buffy
 	ssize_t size;
 	ssize_t realsize;
 	struct buffy *next;
+	/* Data borrowed from the client, handed back via release(handle) when forgotten. */
+	int borrowed;
+	void (*release)(void *);
+	void *handle;
 };
 
 
@@ -37,6 +41,9 @@ struct bufferchain
 	size_t pool_fill;    /* That many buffers are there. */
 	/* A pool of buffers to re-use, if activated. It's a linked list that is worked on from the front. */
 	struct buffy *pool;
+	int end;             /* Input ended with mpg123_feed_end(), no more to wait for. */
+	long wait;           /* Milliseconds to wait for concurrent feeding, <0 for no limit. */
+	struct feedsync *sync; /* Handover from the feeding thread (MPG123_CONCURRENT_FEED), or NULL. */
 };
 
 /* Call this before any buffer chain use (even bc_init()). */
@@ -58,6 +65,8 @@ struct reader_data
 	/* Custom opaque I/O handle from the client. */
 	void *iohandle;
 	int   flags;
+	/* Path of a file opened via mpg123_open(), to be able to open it again. */
+	char *filename;
 	long timeout_sec;
 	ssize_t (*fdread) (mpg123_handle *, void *, size_t);
 	/* User can replace the read and lseek functions. The r_* are the stored replacement functions or NULL. */
@@ -74,6 +83,11 @@ struct reader_data
 	off_t   (*lseek)(int fd, off_t offset, int whence);
 	/* Buffered readers want that abstracted, set internally. */
 	ssize_t (*fullread)(mpg123_handle *, unsigned char *, ssize_t);
+	/* Background reading into a ring buffer, see readahead.c. */
+	struct readahead *ahead;
+	/* The memory reader has all input in one block: a mapped file or client data. */
+	unsigned char *memdata;
+	size_t memsize;
 #ifndef NO_FEEDER
 	struct bufferchain buffer; /* Not dynamically allocated, these few struct bytes aren't worth the trouble. */
 #endif
@@ -94,17 +108,34 @@ struct reader
 	off_t   (*tell)           (mpg123_handle *);
 	void    (*rewind)         (mpg123_handle *);
 	void    (*forget)         (mpg123_handle *);
+	unsigned char* (*frame_body_inplace)(mpg123_handle *, int size); /* body at its place in input, or NULL to read a copy */
 };
 
 /* Open a file by path or use an opened file descriptor. */
 int open_stream(mpg123_handle *, const char *path, int fd);
 /* Open an external handle. */
 int open_stream_handle(mpg123_handle *, void *iohandle);
+/* Read from a block of memory owned by the client. */
+int open_memory(mpg123_handle *, const unsigned char *data, size_t size);
+
+/* Reading ahead on a thread, below fdread and the seeks on the descriptor (readahead.c).
+   Without thread support, the start does nothing. */
+int     readahead_start(mpg123_handle *fr
+,	ssize_t (*read)(struct reader_data *, void *, size_t)
+,	off_t (*seek)(struct reader_data *, off_t, int) );
+void    readahead_stop(mpg123_handle *fr);
+ssize_t readahead_read(mpg123_handle *fr, void *buf, size_t count);
+off_t   readahead_seek(struct reader_data *rdat, off_t offset, int whence);
+void    readahead_state(struct reader_data *rdat, size_t *fill, long *stalls);
 
 /* feed based operation has some specials */
 int open_feed(mpg123_handle *);
 /* externally called function, returns 0 on success, -1 on error */
 int  feed_more(mpg123_handle *fr, const unsigned char *in, long count);
+/* Same without copying: the chain keeps a reference and calls release(handle) when done. */
+int  feed_borrow(mpg123_handle *fr, const unsigned char *in, long count, void (*release)(void *), void *handle);
+/* Mark the end of input, waking up a waiting decoder. */
+void feed_end(mpg123_handle *fr);
 void feed_forget(mpg123_handle *fr);  /* forget the data that has been read (free some buffers) */
 off_t feed_set_pos(mpg123_handle *fr, off_t pos); /* Set position (inside available data if possible), return wanted byte offset of next feed. */
 
@@ -116,6 +147,7 @@ void open_bad(mpg123_handle *);
 #define READER_BUFFERED  0x8
 #define READER_NONBLOCK  0x20
 #define READER_HANDLEIO  0x40
+#define READER_MAPPED    0x80
 
 #define READER_STREAM 0
 #define READER_ICY_STREAM 1
@@ -123,12 +155,14 @@ void open_bad(mpg123_handle *);
 /* These two add a little buffering to enable small seeks for peek ahead. */
 #define READER_BUF_STREAM 3
 #define READER_BUF_ICY_STREAM 4
+/* Whole input in memory, mapped file or client buffer. */
+#define READER_MEMORY 5
 
 #ifdef READ_SYSTEM
-#define READER_SYSTEM 5
-#define READERS 6
+#define READER_SYSTEM 6
+#define READERS 7
 #else
-#define READERS 5
+#define READERS 6
 #endif
 
 #define READER_ERROR MPG123_ERR
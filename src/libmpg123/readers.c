@@ -22,6 +22,14 @@
 #ifdef _MSC_VER
 #include <io.h>
 #endif
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+#include <sys/mman.h>
+#define MAP_FILES
+#endif
+
+#if !defined(NO_FEEDER) && defined(USE_THREADS)
+#include <pthread.h>
+#endif
 
 #include "compat.h"
 #include "debug.h"
@@ -37,6 +45,8 @@ static ssize_t plain_fullread(mpg123_handle *fr,unsigned char *buf, ssize_t coun
 /* Wrapper to decide between descriptor-based and external handle-based I/O. */
 static off_t io_seek(struct reader_data *rdat, off_t offset, int whence);
 static ssize_t io_read(struct reader_data *rdat, void *buf, size_t count);
+/* The seek on the descriptor itself, below a readahead thread. */
+static off_t io_seek_direct(struct reader_data *rdat, off_t offset, int whence);
 
 #ifndef NO_FEEDER
 /* Bufferchain methods. */
@@ -51,6 +61,10 @@ static ssize_t bc_give(struct bufferchain *bc, unsigned char *out, ssize_t size)
 static ssize_t bc_skip(struct bufferchain *bc, ssize_t count);
 static ssize_t bc_seekback(struct bufferchain *bc, ssize_t count);
 static void bc_forget(struct bufferchain *bc);
+#ifdef USE_THREADS
+static void bc_sync_stop(struct bufferchain *bc);
+static void bc_adopt(struct bufferchain *bc);
+#endif
 #endif
 
 /* A normal read and a read with timeout. */
@@ -238,12 +252,16 @@ static off_t stream_lseek(mpg123_handle *fr, off_t pos, int whence)
 
 static void stream_close(mpg123_handle *fr)
 {
+	readahead_stop(fr);
 	if(fr->rdat.flags & READER_FD_OPENED) compat_close(fr->rdat.filept);
 
 	fr->rdat.filept = 0;
 
 #ifndef NO_FEEDER
 	if(fr->rdat.flags & READER_BUFFERED)  bc_reset(&fr->rdat.buffer);
+#ifdef USE_THREADS
+	bc_sync_stop(&fr->rdat.buffer);
+#endif
 #endif
 	if(fr->rdat.flags & READER_HANDLEIO)
 	{
@@ -454,6 +472,38 @@ static off_t get_fileinfo(mpg123_handle *fr)
 #ifndef NO_FEEDER
 /* Methods for the buffer chain, mainly used for feed reader, but not just that. */
 
+#ifdef USE_THREADS
+/*
+	Concurrent feeding (MPG123_CONCURRENT_FEED): The feeding thread fills
+	buffies of its own and hands them over in a list, the decoding thread
+	appends that list to the chain when it runs short of data, waiting for
+	more if so configured. Only the handover and the buffer pool need the
+	lock, the chain itself is only touched by the decoding side.
+*/
+struct feedsync
+{
+	pthread_mutex_t lock;
+	pthread_cond_t fed;
+	struct buffy *first; /* handed over, not in the chain yet */
+	struct buffy *last;
+	ssize_t size;
+	int end;
+};
+
+static void bc_lock(struct bufferchain *bc)
+{
+	if(bc->sync != NULL) pthread_mutex_lock(&bc->sync->lock);
+}
+
+static void bc_unlock(struct bufferchain *bc)
+{
+	if(bc->sync != NULL) pthread_mutex_unlock(&bc->sync->lock);
+}
+#else
+#define bc_lock(bc)
+#define bc_unlock(bc)
+#endif
+
 
 static struct buffy* buffy_new(size_t size, size_t minsize)
 {
@@ -470,6 +520,9 @@ static struct buffy* buffy_new(size_t size, size_t minsize)
 	}
 	newbuf->size = 0;
 	newbuf->next = NULL;
+	newbuf->borrowed = 0;
+	newbuf->release = NULL;
+	newbuf->handle = NULL;
 	return newbuf;
 }
 
@@ -498,11 +551,21 @@ void bc_prepare(struct bufferchain *bc, size_t pool_size, size_t bufblock)
 	bc_poolsize(bc, pool_size, bufblock);
 	bc->pool = NULL;
 	bc->pool_fill = 0;
+	bc->wait = 0;
+	bc->sync = NULL;
 	bc_init(bc); /* Ensure that members are zeroed for read-only use. */
 }
 
 size_t bc_fill(struct bufferchain *bc)
 {
+#ifdef USE_THREADS
+	if(bc->sync != NULL)
+	{
+		pthread_mutex_lock(&bc->sync->lock);
+		bc_adopt(bc);
+		pthread_mutex_unlock(&bc->sync->lock);
+	}
+#endif
 	return (size_t)(bc->size - bc->pos);
 }
 
@@ -522,19 +585,21 @@ void bc_cleanup(struct bufferchain *bc)
 /* Fetch a buffer from the pool (if possible) or create one. */
 static struct buffy* bc_alloc(struct bufferchain *bc, size_t size)
 {
+	struct buffy *buf = NULL;
 	/* Easy route: Just try the first available buffer.
 	   Size does not matter, it's only a hint for creation of new buffers. */
+	bc_lock(bc);
 	if(bc->pool)
 	{
-		struct buffy *buf = bc->pool;
+		buf = bc->pool;
 		bc->pool = buf->next;
 		buf->next = NULL; /* That shall be set to a sensible value later. */
 		buf->size = 0;
 		--bc->pool_fill;
 		debug2("bc_alloc: picked %p from pool (fill now %"SIZE_P")", (void*)buf, (size_p)bc->pool_fill);
-		return buf;
 	}
-	else return buffy_new(size, bc->bufblock);
+	bc_unlock(bc);
+	return buf != NULL ? buf : buffy_new(size, bc->bufblock);
 }
 
 /* Either stuff the buffer back into the pool or free it for good. */
@@ -542,18 +607,30 @@ static void bc_free(struct bufferchain *bc, struct buffy* buf)
 {
 	if(!buf) return;
 
+	/* Borrowed data goes back to the client, the pool only has own memory. */
+	if(buf->borrowed)
+	{
+		if(buf->release != NULL) buf->release(buf->handle);
+		free(buf);
+		return;
+	}
+	bc_lock(bc);
 	if(bc->pool_fill < bc->pool_size)
 	{
 		buf->next = bc->pool;
 		bc->pool = buf;
 		++bc->pool_fill;
+		buf = NULL;
 	}
-	else buffy_del(buf);
+	bc_unlock(bc);
+	buffy_del(buf);
 }
 
 /* Make the buffer count in the pool match the pool size. */
 static int bc_fill_pool(struct bufferchain *bc)
 {
+	int ret = 0;
+	bc_lock(bc);
 	/* Remove superfluous ones. */
 	while(bc->pool_fill > bc->pool_size)
 	{
@@ -570,14 +647,19 @@ static int bc_fill_pool(struct bufferchain *bc)
 		/* Again, just work on the front. */
 		struct buffy* buf;
 		buf = buffy_new(0, bc->bufblock); /* Use default block size. */
-		if(!buf) return -1;
+		if(!buf)
+		{
+			ret = -1;
+			break;
+		}
 
 		buf->next = bc->pool;
 		bc->pool = buf;
 		++bc->pool_fill;
 	}
+	bc_unlock(bc);
 
-	return 0;
+	return ret;
 }
 
 
@@ -589,10 +671,29 @@ static void bc_init(struct bufferchain *bc)
 	bc->pos   = 0;
 	bc->firstpos = 0;
 	bc->fileoff  = 0;
+	bc->end      = 0;
 }
 
 static void bc_reset(struct bufferchain *bc)
 {
+#ifdef USE_THREADS
+	/* Also drop what the feeding thread handed over meanwhile. */
+	if(bc->sync != NULL)
+	{
+		struct feedsync *fs = bc->sync;
+		pthread_mutex_lock(&fs->lock);
+		if(fs->first != NULL)
+		{
+			if(bc->last != NULL) bc->last->next = fs->first;
+			else bc->first = fs->first;
+			bc->last = fs->last;
+		}
+		fs->first = fs->last = NULL;
+		fs->size = 0;
+		fs->end = 0;
+		pthread_mutex_unlock(&fs->lock);
+	}
+#endif
 	/* Free current chain, possibly stuffing back into the pool. */
 	while(bc->first)
 	{
@@ -604,6 +705,104 @@ static void bc_reset(struct bufferchain *bc)
 	bc_init(bc);
 }
 
+#ifdef USE_THREADS
+static int bc_sync_start(struct bufferchain *bc)
+{
+	struct feedsync *fs;
+	if(bc->sync != NULL) return 0;
+	fs = malloc(sizeof(*fs));
+	if(fs == NULL) return -1;
+	fs->first = fs->last = NULL;
+	fs->size = 0;
+	fs->end = 0;
+	pthread_mutex_init(&fs->lock, NULL);
+	pthread_cond_init(&fs->fed, NULL);
+	bc->sync = fs;
+	return 0;
+}
+
+/* After bc_reset(), with the feeding thread gone. */
+static void bc_sync_stop(struct bufferchain *bc)
+{
+	struct feedsync *fs = bc->sync;
+	if(fs == NULL) return;
+	bc->sync = NULL;
+	pthread_cond_destroy(&fs->fed);
+	pthread_mutex_destroy(&fs->lock);
+	free(fs);
+}
+
+/* Feeding side: hand over the filled buffies from first to last. */
+static void bc_handover(struct bufferchain *bc, struct buffy *first, struct buffy *last, ssize_t size)
+{
+	struct feedsync *fs = bc->sync;
+	pthread_mutex_lock(&fs->lock);
+	if(fs->last != NULL) fs->last->next = first;
+	else fs->first = first;
+	fs->last = last;
+	fs->size += size;
+	fs->end = 0;
+	pthread_cond_signal(&fs->fed);
+	pthread_mutex_unlock(&fs->lock);
+}
+
+/* Decoding side: append what was handed over to the chain, with the lock held. */
+static void bc_adopt(struct bufferchain *bc)
+{
+	struct feedsync *fs = bc->sync;
+	if(fs->first != NULL)
+	{
+		if(bc->last != NULL) bc->last->next = fs->first;
+		else bc->first = fs->first;
+		bc->last = fs->last;
+		bc->size += fs->size;
+		fs->first = fs->last = NULL;
+		fs->size = 0;
+	}
+	bc->end = fs->end;
+}
+
+/* Wait for the chain to hold count bytes from the current position on, up to bc->wait ms. */
+static int bc_sync_more(struct bufferchain *bc, ssize_t count)
+{
+	struct feedsync *fs = bc->sync;
+	struct timespec until;
+	int timeout = 0;
+
+	if(bc->wait > 0)
+	{
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		until.tv_sec  = now.tv_sec + bc->wait/1000;
+		until.tv_nsec = now.tv_usec*1000L + (bc->wait%1000)*1000000L;
+		if(until.tv_nsec >= 1000000000L)
+		{
+			++until.tv_sec;
+			until.tv_nsec -= 1000000000L;
+		}
+	}
+	pthread_mutex_lock(&fs->lock);
+	bc_adopt(bc);
+	while(bc->wait != 0 && !timeout && !bc->end && bc->size - bc->pos < count)
+	{
+		if(bc->wait < 0) pthread_cond_wait(&fs->fed, &fs->lock);
+		else timeout = pthread_cond_timedwait(&fs->fed, &fs->lock, &until) != 0;
+		bc_adopt(bc);
+	}
+	pthread_mutex_unlock(&fs->lock);
+	return bc->size - bc->pos >= count;
+}
+#endif
+
+/* Enough data for count bytes from the current position now, maybe after taking over concurrently fed data? */
+static int bc_more(struct bufferchain *bc, ssize_t count)
+{
+#ifdef USE_THREADS
+	if(bc->sync != NULL) return bc_sync_more(bc, count);
+#endif
+	return 0;
+}
+
 /* Create a new buffy at the end to be filled. */
 static int bc_append(struct bufferchain *bc, ssize_t size)
 {
@@ -626,6 +825,38 @@ static int bc_add(struct bufferchain *bc, const unsigned char *data, ssize_t siz
 {
 	int ret = 0;
 	ssize_t part = 0;
+#ifdef USE_THREADS
+	/* Fill fresh buffies, the ones in the chain belong to the decoding side. */
+	if(bc->sync != NULL)
+	{
+		struct buffy *first = NULL, *last = NULL;
+		ssize_t total = size;
+		while(size > 0)
+		{
+			struct buffy *newbuf = bc_alloc(bc, size);
+			if(newbuf == NULL)
+			{
+				while(first != NULL)
+				{
+					newbuf = first->next;
+					bc_free(bc, first);
+					first = newbuf;
+				}
+				return -2;
+			}
+			part = newbuf->realsize < size ? newbuf->realsize : size;
+			memcpy(newbuf->data, data, part);
+			newbuf->size = part;
+			if(last != NULL) last->next = newbuf;
+			else first = newbuf;
+			last = newbuf;
+			size -= part;
+			data += part;
+		}
+		if(first != NULL) bc_handover(bc, first, last, total);
+		return 0;
+	}
+#endif
 	debug2("bc_add: adding %"SSIZE_P" bytes at %"OFF_P, (ssize_p)size, (off_p)(bc->fileoff+bc->size));
 	if(size >=4) debug4("first bytes: %02x %02x %02x %02x", data[0], data[1], data[2], data[3]);
 
@@ -653,6 +884,37 @@ static int bc_add(struct bufferchain *bc, const unsigned char *data, ssize_t siz
 	return ret;
 }
 
+/* Append the client's data itself as a new buffy, to be released once forgotten. */
+static int bc_borrow(struct bufferchain *bc, const unsigned char *data, ssize_t size, void (*release)(void *), void *handle)
+{
+	struct buffy *newbuf;
+	if(size < 1) return -1;
+
+	newbuf = malloc(sizeof(struct buffy));
+	if(newbuf == NULL) return -2;
+	newbuf->data = (unsigned char*)data; /* Never written to. */
+	newbuf->size = newbuf->realsize = size; /* Full, bc_add() starts a new one after it. */
+	newbuf->next = NULL;
+	newbuf->borrowed = 1;
+	newbuf->release = release;
+	newbuf->handle = handle;
+#ifdef USE_THREADS
+	if(bc->sync != NULL)
+	{
+		bc_handover(bc, newbuf, newbuf, size);
+		return 0;
+	}
+#endif
+	debug3("bc_borrow: %"SSIZE_P" bytes at %"OFF_P" from %p", (ssize_p)size, (off_p)(bc->fileoff+bc->size), (void*)data);
+
+	if(bc->last != NULL)  bc->last->next = newbuf;
+	else if(bc->first == NULL) bc->first = newbuf;
+
+	bc->last  = newbuf;
+	bc->size += size;
+	return 0;
+}
+
 /* Common handler for "You want more than I can give." situation. */
 static ssize_t bc_need_more(struct bufferchain *bc)
 {
@@ -665,10 +927,12 @@ static ssize_t bc_need_more(struct bufferchain *bc)
 /* Give some data, advancing position but not forgetting yet. */
 static ssize_t bc_give(struct bufferchain *bc, unsigned char *out, ssize_t size)
 {
-	struct buffy *b = bc->first;
+	struct buffy *b;
 	ssize_t gotcount = 0;
 	ssize_t offset = 0;
-	if(bc->size - bc->pos < size) return bc_need_more(bc);
+	if(bc->size - bc->pos < size && !bc_more(bc, size)) return bc_need_more(bc);
+
+	b = bc->first; /* Maybe just taken over by bc_more(). */
 
 	/* find the current buffer */
 	while(b != NULL && (offset + b->size) <= bc->pos)
@@ -706,7 +970,7 @@ static ssize_t bc_skip(struct bufferchain *bc, ssize_t count)
 {
 	if(count >= 0)
 	{
-		if(bc->size - bc->pos < count) return bc_need_more(bc);
+		if(bc->size - bc->pos < count && !bc_more(bc, count)) return bc_need_more(bc);
 		else return bc->pos += count;
 	}
 	else return READER_ERROR;
@@ -749,6 +1013,14 @@ static void bc_forget(struct bufferchain *bc)
 static int feed_init(mpg123_handle *fr)
 {
 	bc_init(&fr->rdat.buffer);
+#ifdef USE_THREADS
+	if((fr->p.flags & MPG123_CONCURRENT_FEED) && bc_sync_start(&fr->rdat.buffer) != 0)
+	{
+		fr->err = MPG123_OUT_OF_MEM;
+		return -1;
+	}
+#endif
+	fr->rdat.buffer.wait = fr->p.feed_wait;
 	bc_fill_pool(&fr->rdat.buffer);
 	fr->rdat.filelen = 0;
 	fr->rdat.filepos = 0;
@@ -766,18 +1038,59 @@ int feed_more(mpg123_handle *fr, const unsigned char *in, long count)
 		ret = READER_ERROR;
 		if(NOQUIET) error1("Failed to add buffer, return: %i", ret);
 	}
-	else /* Not talking about filelen... that stays at 0. */
+	else if(fr->rdat.buffer.sync == NULL) /* Not talking about filelen... that stays at 0. */
+	{
+		fr->rdat.buffer.end = 0;
+		if(VERBOSE3) debug3("feed_more: %p %luB bufsize=%lu", fr->rdat.buffer.last->data,
+			(unsigned long)fr->rdat.buffer.last->size, (unsigned long)fr->rdat.buffer.size);
+	}
+	return ret;
+}
 
-	if(VERBOSE3) debug3("feed_more: %p %luB bufsize=%lu", fr->rdat.buffer.last->data,
-		(unsigned long)fr->rdat.buffer.last->size, (unsigned long)fr->rdat.buffer.size);
+int feed_borrow(mpg123_handle *fr, const unsigned char *in, long count, void (*release)(void *), void *handle)
+{
+	int ret = 0;
+	if(VERBOSE3) debug("feed_borrow");
+	/* Only the feed reader (the one with that init) gives the data back in any case. */
+	if(fr->rd == NULL || fr->rd->init != feed_init)
+	{
+		fr->err = MPG123_NO_READER;
+		return READER_ERROR;
+	}
+	if((ret = bc_borrow(&fr->rdat.buffer, in, count, release, handle)) != 0)
+	{
+		if(NOQUIET) error1("Failed to add buffer, return: %i", ret);
+		fr->err = MPG123_OUT_OF_MEM;
+		ret = READER_ERROR;
+	}
+	else if(fr->rdat.buffer.sync == NULL) fr->rdat.buffer.end = 0;
 	return ret;
 }
 
+void feed_end(mpg123_handle *fr)
+{
+#ifdef USE_THREADS
+	struct feedsync *fs = fr->rdat.buffer.sync;
+	if(fs != NULL)
+	{
+		pthread_mutex_lock(&fs->lock);
+		fs->end = 1;
+		pthread_cond_broadcast(&fs->fed);
+		pthread_mutex_unlock(&fs->lock);
+	}
+	else
+#endif
+	fr->rdat.buffer.end = 1;
+}
+
 static ssize_t feed_read(mpg123_handle *fr, unsigned char *out, ssize_t count)
 {
 	ssize_t gotcount = bc_give(&fr->rdat.buffer, out, count);
 	if(gotcount >= 0 && gotcount != count) return READER_ERROR;
-	else return gotcount;
+	/* The feeding thread cannot touch the error code, data came in after all. */
+	if(gotcount > 0 && fr->err == MPG123_ERR_READER && fr->rdat.buffer.sync != NULL)
+	fr->err = MPG123_OK;
+	return gotcount;
 }
 
 /* returns reached position... negative ones are bad... */
@@ -800,6 +1113,29 @@ static int feed_back_bytes(mpg123_handle *fr, off_t bytes)
 
 static int feed_seek_frame(mpg123_handle *fr, off_t num){ return READER_ERROR; }
 
+/* A frame body inside one buffy stays there, with enough data behind it
+   for the bit reader. The buffy lives on until the parser moved past it,
+   which is after the next frame has been read. */
+static unsigned char* feed_frame_body_inplace(mpg123_handle *fr, int size)
+{
+	struct bufferchain *bc = &fr->rdat.buffer;
+	struct buffy *b = bc->first;
+	ssize_t offset = 0;
+	unsigned char *body;
+
+	if(size > MAXFRAMESIZE || bc->size - bc->pos < size) return NULL;
+	while(b != NULL && (offset + b->size) <= bc->pos)
+	{
+		offset += b->size;
+		b = b->next;
+	}
+	if(b == NULL || b->size - (bc->pos - offset) < MAXFRAMESIZE+BSBUF_PAD)
+	return NULL;
+	body = b->data + (bc->pos - offset);
+	bc->pos += size;
+	return body;
+}
+
 /* Not just for feed reader, also for self-feeding buffered reader. */
 static void buffered_forget(mpg123_handle *fr)
 {
@@ -810,6 +1146,7 @@ static void buffered_forget(mpg123_handle *fr)
 off_t feed_set_pos(mpg123_handle *fr, off_t pos)
 {
 	struct bufferchain *bc = &fr->rdat.buffer;
+	bc_fill(bc); /* Count in what was fed concurrently. */
 	if(pos >= bc->fileoff && pos-bc->fileoff < bc->size)
 	{ /* We have the position! */
 		bc->pos = (ssize_t)(pos - bc->fileoff);
@@ -875,6 +1212,12 @@ int feed_more(mpg123_handle *fr, const unsigned char *in, long count)
 	fr->err = MPG123_MISSING_FEATURE;
 	return -1;
 }
+int feed_borrow(mpg123_handle *fr, const unsigned char *in, long count, void (*release)(void *), void *handle)
+{
+	fr->err = MPG123_MISSING_FEATURE;
+	return -1;
+}
+void feed_end(mpg123_handle *fr){}
 off_t feed_set_pos(mpg123_handle *fr, off_t pos)
 {
 	fr->err = MPG123_MISSING_FEATURE;
@@ -882,6 +1225,107 @@ off_t feed_set_pos(mpg123_handle *fr, off_t pos)
 }
 #endif /* NO_FEEDER */
 
+/* Reader for input that is all in memory: a mapped file or a client buffer.
+   Reading is copying, seeking is just setting the position. */
+
+/* Ask for pages ahead of a new position in a mapped file. */
+#define MEM_READAHEAD (256*1024)
+
+#if defined(MAP_FILES) && defined(HAVE_MADVISE)
+static void mem_advise(mpg123_handle *fr, off_t pos, size_t len, int advice)
+{
+	long page = sysconf(_SC_PAGESIZE);
+	size_t start;
+	if(  !(fr->rdat.flags & READER_MAPPED) || page <= 0
+	  || pos < 0 || (size_t)pos >= fr->rdat.memsize )
+	return;
+	start = (size_t)pos - (size_t)pos % (size_t)page;
+	if(len > fr->rdat.memsize - start) len = fr->rdat.memsize - start;
+	madvise(fr->rdat.memdata+start, len, advice);
+}
+#else
+#define mem_advise(fr, pos, len, advice)
+#endif
+
+static int mem_init(mpg123_handle *fr)
+{
+	fr->rdat.filepos = 0;
+	fr->rdat.filelen = (off_t)fr->rdat.memsize;
+	fr->rdat.flags |= READER_SEEKABLE;
+	if(fr->rdat.memsize >= 128)
+	{
+		memcpy(fr->id3buf, fr->rdat.memdata+fr->rdat.memsize-128, 128);
+		if(!strncmp((char*)fr->id3buf,"TAG",3))
+		{
+			fr->rdat.filelen -= 128;
+			fr->rdat.flags |= READER_ID3TAG;
+			fr->metaflags  |= MPG123_NEW_ID3;
+		}
+	}
+	mem_advise(fr, 0, fr->rdat.memsize, MADV_SEQUENTIAL);
+	return 0;
+}
+
+static void mem_close(mpg123_handle *fr)
+{
+#ifdef MAP_FILES
+	if(fr->rdat.flags & READER_MAPPED)
+	munmap(fr->rdat.memdata, fr->rdat.memsize);
+#endif
+	fr->rdat.flags &= ~READER_MAPPED;
+	fr->rdat.memdata = NULL;
+	fr->rdat.memsize = 0;
+	stream_close(fr);
+}
+
+static ssize_t mem_fullread(mpg123_handle *fr, unsigned char *buf, ssize_t count)
+{
+	off_t left = (off_t)fr->rdat.memsize - fr->rdat.filepos;
+	if(left <= 0) return 0;
+	if(count > left) count = (ssize_t)left;
+	memcpy(buf, fr->rdat.memdata+fr->rdat.filepos, count);
+	fr->rdat.filepos += count;
+	return count;
+}
+
+/* Like lseek(), the position may go beyond the end; reading gives nothing there. */
+static off_t mem_skip_bytes(mpg123_handle *fr, off_t len)
+{
+	off_t pos = fr->rdat.filepos + len;
+	if(pos < 0)
+	{
+		fr->err = MPG123_LSEEK_FAILED;
+		return READER_ERROR;
+	}
+	fr->rdat.filepos = pos;
+	/* A jump, not just stepping over some bytes. */
+	if(len > MEM_READAHEAD || -len > MEM_READAHEAD)
+	mem_advise(fr, pos, MEM_READAHEAD, MADV_WILLNEED);
+	return pos;
+}
+
+static int mem_back_bytes(mpg123_handle *fr, off_t bytes)
+{
+	return mem_skip_bytes(fr, -bytes) >= 0 ? 0 : READER_ERROR;
+}
+
+/* The decoder reads a bit beyond the frame body; hand out the body in place only
+   if there is as much memory behind it as in the frame buffer. */
+static unsigned char* mem_frame_body_inplace(mpg123_handle *fr, int size)
+{
+	unsigned char *body;
+	if((off_t)fr->rdat.memsize - fr->rdat.filepos < MAXFRAMESIZE+BSBUF_PAD || size > MAXFRAMESIZE)
+	return NULL;
+	body = fr->rdat.memdata+fr->rdat.filepos;
+	fr->rdat.filepos += size;
+	return body;
+}
+
+static void mem_rewind(mpg123_handle *fr)
+{
+	fr->rdat.filepos = 0;
+}
+
 /*****************************************************************
  * read frame helper
  */
@@ -905,6 +1349,7 @@ static void bad_rewind(mpg123_handle *mh){}
 #define READER_FEED       2
 #define READER_BUF_STREAM 3
 #define READER_BUF_ICY_STREAM 4
+#define READER_MEMORY 5
 static struct reader readers[] =
 {
 	{ /* READER_STREAM */
@@ -919,6 +1364,7 @@ static struct reader readers[] =
 		stream_seek_frame,
 		generic_tell,
 		stream_rewind,
+		NULL,
 		NULL
 	} ,
 	{ /* READER_ICY_STREAM */
@@ -933,6 +1379,7 @@ static struct reader readers[] =
 		stream_seek_frame,
 		generic_tell,
 		stream_rewind,
+		NULL,
 		NULL
 	},
 #ifdef NO_FEEDER
@@ -943,6 +1390,7 @@ static struct reader readers[] =
 #define feed_back_bytes NULL
 #define feed_skip_bytes NULL
 #define buffered_forget NULL
+#define feed_frame_body_inplace NULL
 #endif
 	{ /* READER_FEED */
 		feed_init,
@@ -956,7 +1404,8 @@ static struct reader readers[] =
 		feed_seek_frame,
 		generic_tell,
 		stream_rewind,
-		buffered_forget
+		buffered_forget,
+		feed_frame_body_inplace
 	},
 	{ /* READER_BUF_STREAM */
 		default_init,
@@ -970,7 +1419,8 @@ static struct reader readers[] =
 		stream_seek_frame,
 		generic_tell,
 		stream_rewind,
-		buffered_forget
+		buffered_forget,
+		NULL
 	} ,
 	{ /* READER_BUF_ICY_STREAM */
 		default_init,
@@ -984,8 +1434,24 @@ static struct reader readers[] =
 		stream_seek_frame,
 		generic_tell,
 		stream_rewind,
-		buffered_forget
+		buffered_forget,
+		NULL
 	},
+	{ /* READER_MEMORY */
+		mem_init,
+		mem_close,
+		mem_fullread,
+		generic_head_read,
+		generic_head_shift,
+		mem_skip_bytes,
+		generic_read_frame_body,
+		mem_back_bytes,
+		stream_seek_frame,
+		generic_tell,
+		mem_rewind,
+		NULL,
+		mem_frame_body_inplace
+	}
 #ifdef READ_SYSTEM
 	,{
 		system_init,
@@ -1000,6 +1466,7 @@ static struct reader readers[] =
 		NULL,
 		NULL,
 		NULL,
+		NULL,
 	}
 #endif
 };
@@ -1017,6 +1484,7 @@ static struct reader bad_reader =
 	bad_seek_frame,
 	bad_tell,
 	bad_rewind,
+	NULL,
 	NULL
 };
 
@@ -1095,6 +1563,12 @@ static int default_init(mpg123_handle *fr)
 		fr->rdat.flags |= READER_BUFFERED;
 #endif /* NO_FEEDER */
 	}
+	/* Only for our own I/O on the descriptor, not calling back client code from a thread. */
+	if(  fr->p.readahead > 0
+	  && !(fr->rdat.flags & (READER_HANDLEIO|READER_NONBLOCK))
+	  && fr->rdat.r_read == NULL && fr->rdat.r_lseek == NULL
+	  && readahead_start(fr, io_read, io_seek_direct) != 0 && NOQUIET )
+	error("cannot start readahead, reading directly");
 	return 0;
 }
 
@@ -1162,6 +1636,37 @@ static int open_finish(mpg123_handle *fr)
 	return MPG123_OK;
 }
 
+/* With MPG123_MMAP, map a regular file as a whole for the memory reader.
+   Anything else stays with the normal stream reader. */
+static int open_mapped(mpg123_handle *fr)
+{
+#ifdef MAP_FILES
+	struct stat st;
+	void *map;
+	if(  !(fr->p.flags & MPG123_MMAP)
+	  || fr->rdat.r_read != NULL || fr->rdat.r_lseek != NULL
+#ifndef NO_ICY
+	  || fr->p.icy_interval > 0
+#endif
+	  || fstat(fr->rdat.filept, &st) != 0 || !S_ISREG(st.st_mode)
+	  || st.st_size <= 0 || (off_t)(size_t)st.st_size != st.st_size )
+	return 0;
+
+	map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fr->rdat.filept, 0);
+	if(map == MAP_FAILED)
+	{
+		if(VERBOSE2) fprintf(stderr, "Note: cannot map file (%s), reading it.\n", strerror(errno));
+		return 0;
+	}
+	fr->rdat.memdata = map;
+	fr->rdat.memsize = (size_t)st.st_size;
+	fr->rdat.flags |= READER_MAPPED;
+	return 1;
+#else
+	return 0;
+#endif
+}
+
 int open_stream(mpg123_handle *fr, const char *bs_filenam, int fd)
 {
 	int filept_opened = 1;
@@ -1188,9 +1693,25 @@ int open_stream(mpg123_handle *fr, const char *bs_filenam, int fd)
 	fr->rdat.filelen = -1;
 	fr->rdat.filept  = filept;
 	fr->rdat.flags = 0;
-	if(filept_opened)	fr->rdat.flags |= READER_FD_OPENED;
+	if(filept_opened)
+	{
+		fr->rdat.flags |= READER_FD_OPENED;
+		/* Not fatal when that fails, only parallel decoding needs the name. */
+		fr->rdat.filename = strdup(bs_filenam);
+	}
 
-	return open_finish(fr);
+	if(open_mapped(fr))
+	{
+		debug("memory reader on mapped file");
+		fr->rd = &readers[READER_MEMORY];
+		if(fr->rd->init(fr) < 0) return MPG123_ERR;
+	}
+	else if(open_finish(fr) != MPG123_OK) return MPG123_ERR;
+#ifdef FRAME_INDEX
+	/* A matching index cache file spares the scan. */
+	if(fr->index_cache_dir != NULL) index_cache_lookup(fr);
+#endif
+	return MPG123_OK;
 }
 
 int open_stream_handle(mpg123_handle *fr, void *iohandle)
@@ -1205,8 +1726,38 @@ int open_stream_handle(mpg123_handle *fr, void *iohandle)
 	return open_finish(fr);
 }
 
+int open_memory(mpg123_handle *fr, const unsigned char *data, size_t size)
+{
+	debug("memory reader");
+#ifndef NO_ICY
+	if(fr->p.icy_interval > 0)
+	{
+		if(NOQUIET) error("Memory reader cannot do ICY parsing!");
+
+		return -1;
+	}
+	clear_icy(&fr->icy);
+#endif
+	fr->rdat.filelen = -1;
+	fr->rdat.filept  = -1;
+	fr->rdat.flags = 0;
+	/* Never written to, the reader only hands out copies or frame bodies for reading. */
+	fr->rdat.memdata = (unsigned char*)data;
+	fr->rdat.memsize = size;
+	fr->rd = &readers[READER_MEMORY];
+	if(fr->rd->init(fr) < 0) return -1;
+
+	return MPG123_OK;
+}
+
 /* Wrappers for actual reading/seeking... I'm full of wrappers here. */
 static off_t io_seek(struct reader_data *rdat, off_t offset, int whence)
+{
+	if(rdat->ahead != NULL) return readahead_seek(rdat, offset, whence);
+	else return io_seek_direct(rdat, offset, whence);
+}
+
+static off_t io_seek_direct(struct reader_data *rdat, off_t offset, int whence)
 {
 	if(rdat->flags & READER_HANDLEIO)
 	{
@@ -0,0 +1,452 @@
+/*
+	scan: counting the frames of a seekable stream by their headers alone
+
+	copyright 2016 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+
+	mpg123_scan() used to run read_frame() for each frame, which copies every
+	frame body into the bit reservoir buffers and carries all the checking for
+	junk and resync. A stream that is just a sequence of compatible frames (the
+	usual case) can be counted by reading big blocks and hopping from header
+	to header. Anything irregular (free format, junk or tags in between, format
+	changes) makes this scan give up and mpg123_scan() falls back to the full
+	parser, so that the result is the same in any case.
+
+	Large files can be cut into byte ranges for several threads, each one
+	opening the file on its own. A range after the first one starts at the
+	first position that looks like a chain of frames. The ranges are joined
+	where the frames of the previous range end. When that is not where the next
+	one started (a false sync), the next range is walked again from there.
+*/
+
+#include "mpg123lib_intern.h"
+#include "mpeghead.h"
+#ifdef USE_THREADS
+#include <pthread.h>
+#endif
+#include "debug.h"
+
+#ifndef O_BINARY
+#define O_BINARY (0)
+#endif
+
+#define SCAN_BLOCK 65536
+/* Each thread gets at least that many bytes. */
+#define SCAN_RANGE_MIN (4*1024*1024)
+/* Consecutive good headers to trust a sync point inside the stream. */
+#define SCAN_CHAIN 4
+
+enum scan_status
+{
+	 SCAN_GOOD = 0
+	,SCAN_IRREGULAR /* needs the full parser */
+	,SCAN_FAIL      /* read error or out of memory */
+};
+
+struct scan_input
+{
+	mpg123_handle *mh; /* Either reading through the handle's reader, */
+	int fd;            /* or from an own file descriptor. */
+	unsigned char *data;
+	off_t start; /* file offset of data[0] */
+	size_t fill;
+	off_t end;   /* end of MPEG data (before an ID3v1 tag) */
+	off_t size;  /* end of the file */
+	int err;
+};
+
+/* What the index needs to know of a frame after joining. */
+struct scan_frame
+{
+	unsigned short size;
+	unsigned short main_data_begin;
+	unsigned short payload;
+};
+
+struct scan_range
+{
+	off_t begin; /* Frames starting in [begin, end) are counted. */
+	off_t end;
+	off_t first; /* Offset of the first frame. */
+	off_t next;  /* Offset after the last frame. */
+	off_t frames;
+	double bpf;  /* Sum of compute_bpf() values of the frames. */
+	/* Frames for filling the index after joining. */
+	struct scan_frame *sizes;
+	size_t sizes_fill;
+	size_t sizes_size;
+	int status;
+	struct scan_input in;
+#ifdef USE_THREADS
+	pthread_t thread;
+	int running;
+#endif
+};
+
+/* Same test as head_compatible() in parse.c, plus the size of a frame that fits. */
+static int scan_head(unsigned long head, unsigned long head0, long *size, double *bpf)
+{
+	return (head & HDR_CMPMASK) == (head0 & HDR_CMPMASK)
+	&&	(HDR_CHANNEL_VAL(head) == MPG_MD_MONO) == (HDR_CHANNEL_VAL(head0) == MPG_MD_MONO)
+	&&	header_frame_info(head, size, bpf);
+}
+
+static ssize_t scan_read(struct scan_input *in, unsigned char *buf, size_t count)
+{
+	size_t got = 0;
+	if(in->mh != NULL) return in->mh->rd->fullread(in->mh, buf, (ssize_t)count);
+	while(got < count)
+	{
+		ssize_t ret = read(in->fd, buf+got, count-got);
+		if(ret < 0) return ret;
+		if(ret == 0) break;
+		got += ret;
+	}
+	return (ssize_t)got;
+}
+
+/* Jump to a file position, only forward when reading through the handle. */
+static int scan_goto(struct scan_input *in, off_t pos)
+{
+	in->start = pos;
+	in->fill  = 0;
+	if(in->mh != NULL)
+	return in->mh->rd->skip_bytes(in->mh, pos - in->mh->rd->tell(in->mh)) == pos ? 0 : -1;
+	else
+	return lseek(in->fd, pos, SEEK_SET) == pos ? 0 : -1;
+}
+
+/*
+	Make count bytes at pos available, keeping those from keep on.
+	Returns NULL at the end of the file or on error (in->err).
+*/
+static unsigned char *scan_bytes(struct scan_input *in, off_t keep, off_t pos, size_t count)
+{
+	if(pos+(off_t)count > in->size) return NULL;
+	if(pos+(off_t)count > in->start+(off_t)in->fill)
+	{
+		ssize_t got;
+		if(keep >= in->start+(off_t)in->fill)
+		{
+			if(scan_goto(in, keep)){ in->err = 1; return NULL; }
+		}
+		else if(keep > in->start)
+		{
+			in->fill -= (size_t)(keep-in->start);
+			memmove(in->data, in->data+(keep-in->start), in->fill);
+			in->start = keep;
+		}
+		if(pos+(off_t)count > in->start+SCAN_BLOCK)
+		{
+			in->err = 1;
+			return NULL;
+		}
+		got = scan_read(in, in->data+in->fill, SCAN_BLOCK-in->fill);
+		if(got < 0){ in->err = 1; return NULL; }
+		in->fill += got;
+		if(pos+(off_t)count > in->start+(off_t)in->fill) return NULL;
+	}
+	return in->data + (pos-in->start);
+}
+
+static unsigned long scan_word(const unsigned char *b)
+{
+	return ((unsigned long)b[0]<<24) | ((unsigned long)b[1]<<16)
+	|      ((unsigned long)b[2]<<8)  |  (unsigned long)b[3];
+}
+
+/*
+	Walk the frames from r->first on until one starts at or after r->end.
+	With fr given, index positions are stored right away (num being the
+	number of the first frame), otherwise the sizes are recorded. Layer III
+	needs a look at the side info for the bit reservoir, too.
+*/
+static int scan_walk(struct scan_range *r, unsigned long head0, mpg123_handle *fr, off_t num)
+{
+	off_t pos = r->first;
+
+	r->frames = 0;
+	r->bpf = 0.;
+	r->sizes_fill = 0;
+	while(pos < r->end)
+	{
+		unsigned char *b;
+		long size;
+		double bpf;
+		unsigned int main_data_begin, payload;
+
+		/* Less than a header left at the end is no frame for read_frame(), either. */
+		if((b = scan_bytes(&r->in, pos, pos, 4)) == NULL)
+		{
+			if(r->in.err) return SCAN_FAIL;
+			break;
+		}
+		if(!scan_head(scan_word(b), head0, &size, &bpf)) return SCAN_IRREGULAR;
+		/* A truncated frame at the end is not there for read_frame(), either.
+		   Reaching into the ID3v1 tag is another story. */
+		if(pos+4+size > r->in.end)
+		{
+			if(r->in.end != r->in.size) return SCAN_IRREGULAR;
+			break;
+		}
+		main_data_begin = payload = 0;
+		if(HDR_LAYER_VAL(scan_word(b)) == 1)
+		{
+			/* Header, CRC and the first bytes of side info. */
+			long need = size < 4 ? size : 4;
+			if((b = scan_bytes(&r->in, pos, pos, 4+need)) == NULL)
+			return r->in.err ? SCAN_FAIL : SCAN_IRREGULAR;
+			layer3_reservoir(scan_word(b), b+4, size, &main_data_begin, &payload);
+		}
+		if(fr != NULL)
+		{
+#ifdef FRAME_INDEX
+			if(fr->state_flags & FRAME_ACCURATE)
+			{
+				if(FI_NEXT(fr->index, num))
+				fi_add(&fr->index, pos);
+				fi_reservoir(&fr->index, num, main_data_begin, payload);
+			}
+#endif
+		}
+		else
+		{
+			if(r->sizes_fill == r->sizes_size)
+			{
+				size_t newsize = r->sizes_size ? 2*r->sizes_size : 4096;
+				struct scan_frame *sizes = safe_realloc(r->sizes, newsize*sizeof(*sizes));
+				if(sizes == NULL) return SCAN_FAIL;
+				r->sizes = sizes;
+				r->sizes_size = newsize;
+			}
+			r->sizes[r->sizes_fill].size = (unsigned short)size;
+			r->sizes[r->sizes_fill].main_data_begin = (unsigned short)main_data_begin;
+			r->sizes[r->sizes_fill].payload = (unsigned short)payload;
+			++r->sizes_fill;
+		}
+		++num;
+		++r->frames;
+		r->bpf += bpf;
+		pos += 4+size;
+	}
+	r->next = pos;
+	return SCAN_GOOD;
+}
+
+/* Find the first frame in the range, one that is followed by more of its kind. */
+static int scan_sync(struct scan_range *r, unsigned long head0)
+{
+	off_t pos;
+
+	for(pos = r->begin; pos < r->end; ++pos)
+	{
+		off_t p = pos;
+		int i;
+		for(i=0; i<SCAN_CHAIN; ++i)
+		{
+			unsigned char *b;
+			long size;
+			double bpf;
+			if((b = scan_bytes(&r->in, pos, p, 4)) == NULL)
+			{
+				if(r->in.err) return SCAN_FAIL;
+				break;
+			}
+			if(!scan_head(scan_word(b), head0, &size, &bpf)) break;
+			p += 4+size;
+			if(p == r->in.end){ i = SCAN_CHAIN; break; }
+		}
+		if(i == SCAN_CHAIN)
+		{
+			r->first = pos;
+			return SCAN_GOOD;
+		}
+	}
+	/* Frames are not that big, something is fishy. */
+	return SCAN_IRREGULAR;
+}
+
+static void scan_range_run(struct scan_range *r, unsigned long head0)
+{
+	r->status = scan_goto(&r->in, r->begin) ? SCAN_FAIL : SCAN_GOOD;
+	if(r->status == SCAN_GOOD && r->first < 0)
+	r->status = scan_sync(r, head0);
+	if(r->status == SCAN_GOOD)
+	r->status = scan_walk(r, head0, NULL, 0);
+}
+
+#ifdef USE_THREADS
+struct scan_job
+{
+	struct scan_range *r;
+	unsigned long head0;
+};
+
+static void *scan_thread(void *arg)
+{
+	struct scan_job *job = arg;
+	scan_range_run(job->r, job->head0);
+	return NULL;
+}
+
+/* Count the frames from start on in parts, returning the number of threads
+   used (0 when that is not possible here) and the result in whole. */
+static int scan_parallel(mpg123_handle *fr, off_t start, struct scan_range *whole)
+{
+	struct scan_range *r;
+	struct scan_job *job;
+	unsigned long head0 = fr->oldhead;
+	long threads = fr->p.scan_threads;
+	off_t length = whole->in.end - start;
+	off_t num;
+	int i, status = SCAN_GOOD;
+
+	if(threads > length/SCAN_RANGE_MIN) threads = (long)(length/SCAN_RANGE_MIN);
+	if(  threads < 2 || fr->rdat.filename == NULL
+	  || !(fr->rdat.flags & READER_FD_OPENED) || (fr->rdat.flags & READER_HANDLEIO)
+	  || fr->rdat.r_read != NULL || fr->rdat.r_lseek != NULL )
+	return 0;
+
+	r   = malloc(threads*sizeof(*r));
+	job = malloc(threads*sizeof(*job));
+	if(r == NULL || job == NULL)
+	{
+		if(r)   free(r);
+		if(job) free(job);
+		return 0;
+	}
+	memset(r, 0, threads*sizeof(*r));
+	for(i=0; i<threads; ++i)
+	{
+		r[i].begin = start + length/threads*i;
+		r[i].end   = i+1 == threads ? whole->in.end : start + length/threads*(i+1);
+		r[i].first = i ? -1 : start;
+		r[i].in    = whole->in;
+		r[i].in.mh = NULL;
+		r[i].in.data = malloc(SCAN_BLOCK);
+		r[i].in.fd = r[i].in.data != NULL
+		?	compat_open(fr->rdat.filename, O_RDONLY|O_BINARY)
+		:	-1;
+		r[i].status = r[i].in.fd < 0 ? SCAN_FAIL : SCAN_GOOD;
+	}
+	for(i=0; i<threads; ++i)
+	{
+		if(r[i].status != SCAN_GOOD) continue;
+		job[i].r = r+i;
+		job[i].head0 = head0;
+		/* The first range runs here, as do ranges that did not get a thread. */
+		if(i && !pthread_create(&r[i].thread, NULL, scan_thread, job+i))
+		r[i].running = 1;
+		else
+		scan_range_run(r+i, head0);
+	}
+	for(i=0; i<threads; ++i)
+	if(r[i].running) pthread_join(r[i].thread, NULL);
+
+	/* Join the ranges, redoing those that started off the track. */
+	for(i=0; i<threads && status == SCAN_GOOD; ++i)
+	{
+		if(i && r[i].first != r[i-1].next && r[i].in.fd >= 0)
+		{
+			debug3("scan range %i: sync at %"OFF_P" instead of %"OFF_P, i, (off_p)r[i].first, (off_p)r[i-1].next);
+			r[i].first = r[i-1].next;
+			r[i].status = scan_goto(&r[i].in, r[i].first)
+			?	SCAN_FAIL
+			:	scan_walk(r+i, head0, NULL, 0);
+		}
+		status = r[i].status;
+	}
+	num = 1;
+	whole->frames = 0;
+	whole->bpf = 0.;
+	for(i=0; i<threads; ++i)
+	{
+		if(status == SCAN_GOOD)
+		{
+			off_t pos = r[i].first;
+			size_t j;
+			for(j=0; j<r[i].sizes_fill; ++j)
+			{
+#ifdef FRAME_INDEX
+				if(fr->state_flags & FRAME_ACCURATE)
+				{
+					if(FI_NEXT(fr->index, num))
+					fi_add(&fr->index, pos);
+					fi_reservoir(&fr->index, num, r[i].sizes[j].main_data_begin, r[i].sizes[j].payload);
+				}
+#endif
+				pos += 4+r[i].sizes[j].size;
+				++num;
+			}
+			whole->frames += r[i].frames;
+			whole->bpf    += r[i].bpf;
+		}
+		if(r[i].in.fd >= 0) compat_close(r[i].in.fd);
+		if(r[i].in.data) free(r[i].in.data);
+		if(r[i].sizes) free(r[i].sizes);
+	}
+	whole->status = status;
+	free(job);
+	free(r);
+	return (int)threads;
+}
+#endif
+
+/*
+	Count the frames after the current one, which is frame 0 as mpg123_scan()
+	just went there. Returns TRUE and stores the count, or FALSE if the
+	stream needs read_frame() for that (the reader is at some place then).
+*/
+int scan_frames(mpg123_handle *fr, off_t *frames)
+{
+	struct scan_range whole;
+	off_t start = fr->rd->tell(fr);
+
+	if(fr->rdat.filelen < 0 || start < 0) return FALSE;
+	memset(&whole, 0, sizeof(whole));
+	whole.in.mh    = fr;
+	whole.in.fd    = -1;
+	whole.in.start = start;
+	whole.in.end   = fr->rdat.filelen;
+	whole.in.size  = fr->rdat.filelen + (fr->rdat.flags & READER_ID3TAG ? 128 : 0);
+	whole.begin = whole.first = start;
+	whole.end   = whole.in.end;
+
+#ifdef USE_THREADS
+	if(!scan_parallel(fr, start, &whole))
+#endif
+	{
+		whole.in.data = malloc(SCAN_BLOCK);
+		if(whole.in.data == NULL) return FALSE;
+		whole.status = scan_walk(&whole, fr->oldhead, fr, 1);
+		free(whole.in.data);
+	}
+	debug3("header scan: status %i, %"OFF_P" frames after %"OFF_P, whole.status, (off_p)whole.frames, (off_p)start);
+	if(whole.status != SCAN_GOOD) return FALSE;
+	/* Frame 0 stays the current one, so the reader has to be back after it. */
+	if(fr->rd->tell(fr) != start && fr->rd->skip_bytes(fr, start - fr->rd->tell(fr)) < 0)
+	return FALSE;
+
+	/* What read_frame() would have noted on the way. */
+	if(whole.frames > 0)
+	{
+		off_t n = fr->mean_frames + whole.frames;
+		fr->mean_framesize = (fr->mean_frames*fr->mean_framesize + whole.bpf)/n;
+		fr->mean_frames = n;
+	}
+	if(!(fr->state_flags & FRAME_FRANKENSTEIN))
+	{
+		off_t announced = fr->track_frames;
+#ifdef GAPLESS
+		if(fr->gapless_frames > 0 && (announced <= 0 || fr->gapless_frames < announced))
+		announced = fr->gapless_frames;
+#endif
+		if(announced > 0 && whole.frames >= announced)
+		{
+			fr->state_flags |= FRAME_FRANKENSTEIN;
+			if(NOQUIET) fprintf(stderr, "\nWarning: Encountered more data after announced end of track (frame %"OFF_P"/%"OFF_P"). Frankenstein!\n", (off_p)announced, (off_p)announced);
+		}
+	}
+	*frames = whole.frames;
+	return TRUE;
+}
@@ -626,6 +626,102 @@ int synth_1to1_stereo_avx(real *bandPtr_l,real *bandPtr_r, mpg123_handle *fr)
 #endif
 #endif
 
+#ifdef OPT_AVX512
+/* Assembler routines. */
+int synth_1to1_x86_64_accurate_asm(real *window, real *b0, short *samples, int bo1);
+int synth_1to1_s_avx512_asm(real *window, real *b0l, real *b0r, short *samples, int bo1);
+void dct64_real_avx(real *out0, real *out1, real *samples);
+void dct64_real_stereo_avx512(real *out0l, real *out1l, real *out0r, real *out1r, real *samples_l, real *samples_r);
+/* Hull for C mpg123 API */
+/* The AVX-512 decoder always synthesizes from the float window, with accurate rounding.
+   For a single channel, the AVX (SSE) code is as good as it gets. */
+int synth_1to1_avx512(real *bandPtr,int channel, mpg123_handle *fr, int final)
+{
+	short *samples = (short *) (fr->buffer.data+fr->buffer.fill);
+
+	real *b0, **buf;
+	int bo1;
+	int clip;
+
+	if(fr->have_eq_settings) do_equalizer(bandPtr,channel,fr->equalizer);
+
+	if(!channel)
+	{
+		fr->bo--;
+		fr->bo &= 0xf;
+		buf = fr->real_buffs[0];
+	}
+	else
+	{
+		samples++;
+		buf = fr->real_buffs[1];
+	}
+
+	if(fr->bo & 0x1)
+	{
+		b0 = buf[0];
+		bo1 = fr->bo;
+		dct64_real_avx(buf[1]+((fr->bo+1)&0xf),buf[0]+fr->bo,bandPtr);
+	}
+	else
+	{
+		b0 = buf[1];
+		bo1 = fr->bo+1;
+		dct64_real_avx(buf[0]+fr->bo,buf[1]+fr->bo+1,bandPtr);
+	}
+
+	clip = synth_1to1_x86_64_accurate_asm(fr->decwin, b0, samples, bo1);
+
+	if(final) fr->buffer.fill += 128;
+
+	return clip;
+}
+
+int synth_1to1_stereo_avx512(real *bandPtr_l, real *bandPtr_r, mpg123_handle *fr)
+{
+	short *samples = (short *) (fr->buffer.data+fr->buffer.fill);
+
+	real *b0l, *b0r, **bufl, **bufr;
+	int bo1;
+	int clip;
+
+	if(fr->have_eq_settings)
+	{
+		do_equalizer(bandPtr_l,0,fr->equalizer);
+		do_equalizer(bandPtr_r,1,fr->equalizer);
+	}
+
+	fr->bo--;
+	fr->bo &= 0xf;
+	bufl = fr->real_buffs[0];
+	bufr = fr->real_buffs[1];
+
+	/* Both channels in one go, left in the lower and right in the upper half of the registers. */
+	if(fr->bo & 0x1)
+	{
+		b0l = bufl[0];
+		b0r = bufr[0];
+		bo1 = fr->bo;
+		dct64_real_stereo_avx512( bufl[1]+((fr->bo+1)&0xf), bufl[0]+fr->bo
+		,	bufr[1]+((fr->bo+1)&0xf), bufr[0]+fr->bo, bandPtr_l, bandPtr_r );
+	}
+	else
+	{
+		b0l = bufl[1];
+		b0r = bufr[1];
+		bo1 = fr->bo+1;
+		dct64_real_stereo_avx512( bufl[0]+fr->bo, bufl[1]+fr->bo+1
+		,	bufr[0]+fr->bo, bufr[1]+fr->bo+1, bandPtr_l, bandPtr_r );
+	}
+
+	clip = synth_1to1_s_avx512_asm(fr->decwin, b0l, b0r, samples, bo1);
+
+	fr->buffer.fill += 128;
+
+	return clip;
+}
+#endif
+
 #ifdef OPT_ARM
 #ifdef ACCURATE_ROUNDING
 /* Assembler routines. */
@@ -1177,6 +1273,19 @@ int synth_1to1_stereo_neon64(real *bandPtr_l,real *bandPtr_r, mpg123_handle *fr)
 #undef MONO_NAME
 #undef MONO2STEREO_NAME
 
+#ifdef RESAMPLER
+/* Windowed-sinc resampling over the 1to1 real synth, see ntom.c . */
+#define SYNTH_NAME       synth_resample
+#define STEREO_NAME      synth_resample_stereo
+#define MONO_NAME        synth_resample_mono
+#define MONO2STEREO_NAME synth_resample_m2s
+#include "synth_resample.h"
+#undef SYNTH_NAME
+#undef STEREO_NAME
+#undef MONO_NAME
+#undef MONO2STEREO_NAME
+#endif
+
 #endif
 
 /* Done with short output. */
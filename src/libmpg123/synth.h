@@ -8,6 +8,7 @@
 	This header is used multiple times to create different variants of these functions.
 	See decode.c and friends.
 	Hint: BLOCK, MONO_NAME, MONO2STEREO_NAME, SYNTH_NAME and SAMPLE_T as well as WRITE_SAMPLE do vary.
+	With PLANAR_OUTPUT defined, the channels are not interleaved (see MPG123_PLANAR).
 
 	Thomas looked closely at the decode_1to1, decode_2to1 and decode_4to1 contents, seeing that they are too similar to be separate files.
 	This is what resulted...
@@ -30,8 +31,14 @@ int SYNTH_NAME(real *bandPtr, int channel, mpg123_handle *fr, int final)
 #define BACKPEDAL 0x00 /* i386 code does not need that. */
 #define MY_DCT64 dct64_i386
 #endif
+#ifdef PLANAR_OUTPUT
+	/* The left channel fills the first half of the frame's output, the right one the second half. */
+	static const int step = 1;
+	SAMPLE_T *samples = (SAMPLE_T *) (fr->buffer.data + fr->buffer.fill/2);
+#else
 	static const int step = 2;
 	SAMPLE_T *samples = (SAMPLE_T *) (fr->buffer.data + fr->buffer.fill);
+#endif
 
 	real *b0, **buf; /* (*buf)[0x110]; */
 	int clip = 0; 
@@ -52,7 +59,11 @@ int SYNTH_NAME(real *bandPtr, int channel, mpg123_handle *fr, int final)
 		   (re)sampling the noise the same way as the original signal. */
 		fr->ditherindex -= 32;
 #endif
+#ifdef PLANAR_OUTPUT
+		samples += fr->spf>>fr->down_sample;
+#else
 		samples++;
+#endif
 		buf = fr->real_buffs[1];
 	}
 #ifdef USE_DITHER
@@ -51,11 +51,15 @@
 #define SYNTH_NAME       synth_1to1_8bit_wrap
 #define MONO_NAME        synth_1to1_8bit_wrap_mono
 #define MONO2STEREO_NAME synth_1to1_8bit_wrap_m2s
+#define BASE_STEREO_NAME fr->synths.stereo[r_1to1][f_16]
+#define STEREO_NAME      synth_1to1_8bit_wrap_stereo
 #include "synth_8bit.h"
 #undef BASE_SYNTH_NAME
 #undef SYNTH_NAME
 #undef MONO_NAME
 #undef MONO2STEREO_NAME
+#undef BASE_STEREO_NAME
+#undef STEREO_NAME
 
 #undef BLOCK
 
@@ -136,6 +140,19 @@
 #undef MONO_NAME
 #undef MONO2STEREO_NAME
 
+#ifdef RESAMPLER
+/* Windowed-sinc resampling over the 1to1 real synth, see ntom.c . */
+#define SYNTH_NAME       synth_resample_8bit
+#define STEREO_NAME      synth_resample_8bit_stereo
+#define MONO_NAME        synth_resample_8bit_mono
+#define MONO2STEREO_NAME synth_resample_8bit_m2s
+#include "synth_resample.h"
+#undef SYNTH_NAME
+#undef STEREO_NAME
+#undef MONO_NAME
+#undef MONO2STEREO_NAME
+#endif
+
 #endif
 
 #undef SAMPLE_T
@@ -7,6 +7,7 @@
 
 	Only variable is the BLOCK size to choose 1to1, 2to1 or 4to1.
 	Oh, and the names: BASE_SYNTH_NAME, SYNTH_NAME, MONO_NAME, MONO2STEREO_NAME
+	(optionally BASE_STEREO_NAME and STEREO_NAME for a wrapper over the stereo synth)
 	(p.ex. opt_synth_1to1(fr), synth_1to1_8bit, synth_1to1_8bit_mono, ...).
 */
 
@@ -84,3 +85,27 @@ int MONO2STEREO_NAME(real *bandPtr, mpg123_handle *fr)
 	return ret;
 }
 
+
+#ifdef STEREO_NAME
+/* Both channels in one go from the optimized 16bit stereo synth, then one conversion pass. */
+int STEREO_NAME(real *bandPtr_l, real *bandPtr_r, mpg123_handle *fr)
+{
+	short samples_tmp[BLOCK];
+	int i,ret;
+
+	unsigned char *samples = fr->buffer.data;
+	int pnt = fr->buffer.fill;
+	fr->buffer.data = (unsigned char*) samples_tmp;
+	fr->buffer.fill = 0;
+	ret = BASE_STEREO_NAME(bandPtr_l, bandPtr_r, fr);
+	fr->buffer.data = samples;
+
+	samples += pnt;
+	for(i=0;i<BLOCK;i++)
+		samples[i] = fr->conv16to8[samples_tmp[i]>>AUSHIFT];
+
+	fr->buffer.fill = pnt + BLOCK;
+
+	return ret;
+}
+#endif
@@ -0,0 +1,140 @@
+/*
+	synth_avx512: common parts of the AVX-512 stereo synths for x86-64
+
+	copyright 1995-2016 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+
+	Included by synth_stereo_avx512*.S, which only differ in the conversion
+	and storage of the 16 samples per channel produced by SYNTH_HALF.
+	The window is the mirrored float one of the SSE/AVX decoders.
+
+	Only zmm0-5 and zmm16-31 are used, so there is no need to save anything
+	for the MS ABI. The output part may use zmm0-5, zmm24-31 and k1-k3.
+*/
+
+#ifdef IS_MSABI
+/* real *window; */
+#define WINDOW %r10
+/* real *b0l; */
+#define B0L %rdx
+/* real *b0r; */
+#define B0R %r8
+/* void *samples; */
+#define SAMPLES %r9
+#else
+/* real *window; */
+#define WINDOW %rdi
+/* real *b0l; */
+#define B0L %rsi
+/* real *b0r; */
+#define B0R %rdx
+/* void *samples; */
+#define SAMPLES %r9
+#endif
+
+/* Set WINDOW to window+16-bo1, bo1 being the 5th argument. Leaves %r11 zeroed for counting clips. */
+.macro SYNTH_ENTER
+#ifdef IS_MSABI
+	push		%rbp
+	mov			%rsp, %rbp
+	movl		48(%rbp), %eax /* 5th argument; placed after 32-byte shadow space */
+	mov			%rcx, WINDOW
+#else
+	mov			%r8d, %eax
+	mov			%rcx, SAMPLES
+#endif
+	shl			$2, %eax
+	add			$64, WINDOW
+	sub			%rax, WINDOW
+	xor			%r11d, %r11d
+.endm
+
+.macro SYNTH_LEAVE
+	vzeroupper
+#ifdef IS_MSABI
+	mov			%rbp, %rsp
+	pop			%rbp
+#endif
+	ret
+.endm
+
+/* Reduce the 16-tap products of four samples to one vector of 4 sums per 128 bit lane,
+   \op being vsubps (even minus odd taps) or vaddps (all taps). */
+.macro REDUCE4 op, a, b, c, d, out
+	vunpcklps	%\b, %\a, %zmm24
+	vunpckhps	%\b, %\a, %\a
+	vaddps		%zmm24, %\a, %\a
+	vunpcklps	%\d, %\c, %zmm25
+	vunpckhps	%\d, %\c, %\c
+	vaddps		%zmm25, %\c, %\c
+	vunpcklpd	%\c, %\a, %zmm24
+	vunpckhpd	%\c, %\a, %zmm25
+	\op			%zmm25, %zmm24, %\out
+.endm
+
+/* Four samples of both channels: window rows are 32 floats apart,
+   b0 rows 16 floats forward (first half) or backward (second half). */
+.macro SYNTH_GROUP op, b1, b2, b3, step, ul, ur
+	vmovups		(WINDOW), %zmm26
+	vmovups		128(WINDOW), %zmm27
+	vmovups		256(WINDOW), %zmm28
+	vmovups		384(WINDOW), %zmm29
+	vmulps		(B0L), %zmm26, %zmm0
+	vmulps		\b1(B0L), %zmm27, %zmm1
+	vmulps		\b2(B0L), %zmm28, %zmm2
+	vmulps		\b3(B0L), %zmm29, %zmm3
+	vmulps		(B0R), %zmm26, %zmm4
+	vmulps		\b1(B0R), %zmm27, %zmm5
+	vmulps		\b2(B0R), %zmm28, %zmm30
+	vmulps		\b3(B0R), %zmm29, %zmm31
+	add			$512, WINDOW
+	add			$\step, B0L
+	add			$\step, B0R
+	REDUCE4		\op, zmm0, zmm1, zmm2, zmm3, \ul
+	REDUCE4		\op, zmm4, zmm5, zmm30, zmm31, \ur
+.endm
+
+/* Lane m of \u0 to \u3 holds the partial sums of samples 4m to 4m+3;
+   add them up to the 16 samples in \u0. */
+.macro COMBINE u0, u1, u2, u3
+	vshuff32x4	$0x88, %\u1, %\u0, %zmm24
+	vshuff32x4	$0xdd, %\u1, %\u0, %zmm25
+	vaddps		%zmm25, %zmm24, %zmm24
+	vshuff32x4	$0x88, %\u3, %\u2, %zmm25
+	vshuff32x4	$0xdd, %\u3, %\u2, %\u0
+	vaddps		%\u0, %zmm25, %zmm25
+	vshuff32x4	$0x88, %zmm25, %zmm24, %\u0
+	vshuff32x4	$0xdd, %zmm25, %zmm24, %\u1
+	vaddps		%\u1, %\u0, %\u0
+.endm
+
+/* 16 samples per channel, left in zmm16, right in zmm20.
+   The first half of the block walks forward in b0, the second one backward. */
+.macro SYNTH_HALF op, b1, b2, b3, step
+	SYNTH_GROUP	\op, \b1, \b2, \b3, \step, zmm16, zmm20
+	SYNTH_GROUP	\op, \b1, \b2, \b3, \step, zmm17, zmm21
+	SYNTH_GROUP	\op, \b1, \b2, \b3, \step, zmm18, zmm22
+	SYNTH_GROUP	\op, \b1, \b2, \b3, \step, zmm19, zmm23
+	COMBINE		zmm16, zmm17, zmm18, zmm19
+	COMBINE		zmm20, zmm21, zmm22, zmm23
+.endm
+
+/* Interleave zmm16 (left) and zmm20 (right) to samples 0-7 in zmm0, 8-15 in zmm1. */
+.macro INTERLEAVE
+	vunpcklps	%zmm20, %zmm16, %zmm0
+	vunpckhps	%zmm20, %zmm16, %zmm1
+	vshuff32x4	$0x44, %zmm1, %zmm0, %zmm2
+	vshuff32x4	$0xee, %zmm1, %zmm0, %zmm3
+	vshuff32x4	$0xd8, %zmm2, %zmm2, %zmm0
+	vshuff32x4	$0xd8, %zmm3, %zmm3, %zmm1
+.endm
+
+/* Count the samples of \reg outside the 16 bit range in %r11d, mask of the positive ones in k1. */
+.macro COUNT_CLIPS reg, max, min
+	vcmpnleps	\max(%rip){1to16}, %\reg, %k1
+	vcmpltps	\min(%rip){1to16}, %\reg, %k2
+	korw		%k2, %k1, %k3
+	kmovw		%k3, %ecx
+	popcnt		%ecx, %ecx
+	add			%ecx, %r11d
+.endm
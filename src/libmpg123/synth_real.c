@@ -38,6 +38,30 @@
 #undef MONO_NAME
 #undef MONO2STEREO_NAME
 
+/* Planar output for the generic decoder, see MPG123_PLANAR. */
+#define PLANAR_OUTPUT
+#define SYNTH_NAME synth_1to1_real_planar
+#include "synth.h"
+#undef SYNTH_NAME
+#undef PLANAR_OUTPUT
+
+int synth_1to1_real_stereo_planar(real *bandPtr_l, real *bandPtr_r, mpg123_handle *fr)
+{
+	int clip;
+	clip  = synth_1to1_real_planar(bandPtr_l, 0, fr, 0);
+	clip += synth_1to1_real_planar(bandPtr_r, 1, fr, 1);
+	return clip;
+}
+
+int synth_1to1_real_m2s_planar(real *bandPtr, mpg123_handle *fr)
+{
+	real *samples = (real *) (fr->buffer.data + fr->buffer.fill/2);
+	int ret;
+	ret = synth_1to1_real_planar(bandPtr, 0, fr, 1);
+	memcpy(samples+fr->spf, samples, (BLOCK/2)*sizeof(real));
+	return ret;
+}
+
 #ifdef OPT_X86
 #define NO_AUTOINCREMENT
 #define SYNTH_NAME synth_1to1_real_i386
@@ -232,6 +256,139 @@ int synth_1to1_real_stereo_avx(real *bandPtr_l, real *bandPtr_r, mpg123_handle *
 }
 #endif
 
+#ifdef OPT_AVX512
+/* Assembler routines. */
+int synth_1to1_real_s_avx512_asm(real *window, real *b0l, real *b0r, real *samples, int bo1);
+int synth_1to1_real_p_avx512_asm(real *window, real *b0l, real *b0r, real *left, int bo1, real *right);
+void dct64_real_stereo_avx512(real *out0l, real *out1l, real *out0r, real *out1r, real *samples_l, real *samples_r);
+/* Hull for C mpg123 API */
+/* Only the stereo synth gains from the wide registers, a single channel uses the AVX code. */
+int synth_1to1_real_avx512(real *bandPtr,int channel, mpg123_handle *fr, int final)
+{
+	return synth_1to1_real_avx(bandPtr, channel, fr, final);
+}
+
+int synth_1to1_real_stereo_avx512(real *bandPtr_l, real *bandPtr_r, mpg123_handle *fr)
+{
+	real *samples = (real *) (fr->buffer.data+fr->buffer.fill);
+
+	real *b0l, *b0r, **bufl, **bufr;
+	int bo1;
+
+	if(fr->have_eq_settings)
+	{
+		do_equalizer(bandPtr_l,0,fr->equalizer);
+		do_equalizer(bandPtr_r,1,fr->equalizer);
+	}
+
+	fr->bo--;
+	fr->bo &= 0xf;
+	bufl = fr->real_buffs[0];
+	bufr = fr->real_buffs[1];
+
+	/* Both channels in one go, left in the lower and right in the upper half of the registers. */
+	if(fr->bo & 0x1)
+	{
+		b0l = bufl[0];
+		b0r = bufr[0];
+		bo1 = fr->bo;
+		dct64_real_stereo_avx512( bufl[1]+((fr->bo+1)&0xf), bufl[0]+fr->bo
+		,	bufr[1]+((fr->bo+1)&0xf), bufr[0]+fr->bo, bandPtr_l, bandPtr_r );
+	}
+	else
+	{
+		b0l = bufl[1];
+		b0r = bufr[1];
+		bo1 = fr->bo+1;
+		dct64_real_stereo_avx512( bufl[0]+fr->bo, bufl[1]+fr->bo+1
+		,	bufr[0]+fr->bo, bufr[1]+fr->bo+1, bandPtr_l, bandPtr_r );
+	}
+
+	synth_1to1_real_s_avx512_asm(fr->decwin, b0l, b0r, samples, bo1);
+
+	fr->buffer.fill += 256;
+
+	return 0;
+}
+
+/* Planar output (MPG123_PLANAR): the right channel goes to the second half of the frame's output. */
+int synth_1to1_real_stereo_planar_avx512(real *bandPtr_l, real *bandPtr_r, mpg123_handle *fr)
+{
+	real *samples = (real *) (fr->buffer.data+fr->buffer.fill/2);
+
+	real *b0l, *b0r, **bufl, **bufr;
+	int bo1;
+
+	if(fr->have_eq_settings)
+	{
+		do_equalizer(bandPtr_l,0,fr->equalizer);
+		do_equalizer(bandPtr_r,1,fr->equalizer);
+	}
+
+	fr->bo--;
+	fr->bo &= 0xf;
+	bufl = fr->real_buffs[0];
+	bufr = fr->real_buffs[1];
+
+	if(fr->bo & 0x1)
+	{
+		b0l = bufl[0];
+		b0r = bufr[0];
+		bo1 = fr->bo;
+		dct64_real_stereo_avx512( bufl[1]+((fr->bo+1)&0xf), bufl[0]+fr->bo
+		,	bufr[1]+((fr->bo+1)&0xf), bufr[0]+fr->bo, bandPtr_l, bandPtr_r );
+	}
+	else
+	{
+		b0l = bufl[1];
+		b0r = bufr[1];
+		bo1 = fr->bo+1;
+		dct64_real_stereo_avx512( bufl[0]+fr->bo, bufl[1]+fr->bo+1
+		,	bufr[0]+fr->bo, bufr[1]+fr->bo+1, bandPtr_l, bandPtr_r );
+	}
+
+	synth_1to1_real_p_avx512_asm(fr->decwin, b0l, b0r, samples, bo1, samples+fr->spf);
+
+	fr->buffer.fill += 256;
+
+	return 0;
+}
+
+/* A mono stream to planar stereo: the same window data for both output channels. */
+int synth_1to1_real_m2s_planar_avx512(real *bandPtr, mpg123_handle *fr)
+{
+	real *samples = (real *) (fr->buffer.data+fr->buffer.fill/2);
+
+	real *b0, **buf;
+	int bo1;
+
+	if(fr->have_eq_settings) do_equalizer(bandPtr,0,fr->equalizer);
+
+	fr->bo--;
+	fr->bo &= 0xf;
+	buf = fr->real_buffs[0];
+
+	if(fr->bo & 0x1)
+	{
+		b0 = buf[0];
+		bo1 = fr->bo;
+		dct64_real_avx(buf[1]+((fr->bo+1)&0xf),buf[0]+fr->bo,bandPtr);
+	}
+	else
+	{
+		b0 = buf[1];
+		bo1 = fr->bo+1;
+		dct64_real_avx(buf[0]+fr->bo,buf[1]+fr->bo+1,bandPtr);
+	}
+
+	synth_1to1_real_p_avx512_asm(fr->decwin, b0, b0, samples, bo1, samples+fr->spf);
+
+	fr->buffer.fill += 256;
+
+	return 0;
+}
+#endif
+
 #if defined(OPT_SSE) || defined(OPT_SSE_VINTAGE)
 /* Assembler routines. */
 int synth_1to1_real_sse_asm(real *window, real *b0, real *samples, int bo1);
@@ -577,6 +734,19 @@ int synth_1to1_real_stereo_neon64(real *bandPtr_l, real *bandPtr_r, mpg123_handl
 #undef MONO_NAME
 #undef MONO2STEREO_NAME
 
+#ifdef RESAMPLER
+/* Windowed-sinc resampling over the 1to1 real synth, see ntom.c . */
+#define SYNTH_NAME       synth_resample_real
+#define STEREO_NAME      synth_resample_real_stereo
+#define MONO_NAME        synth_resample_real_mono
+#define MONO2STEREO_NAME synth_resample_real_m2s
+#include "synth_resample.h"
+#undef SYNTH_NAME
+#undef STEREO_NAME
+#undef MONO_NAME
+#undef MONO2STEREO_NAME
+#endif
+
 #endif
 
 #undef SAMPLE_T
@@ -0,0 +1,107 @@
+/*
+	synth_resample.h: synth functions for windowed-sinc resampling
+
+	This header is used multiple times to create different variants of these functions.
+	Hint: SYNTH_NAME, STEREO_NAME, MONO_NAME, MONO2STEREO_NAME as well as SAMPLE_T and WRITE_SAMPLE do vary.
+
+	copyright 2016 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+
+	The 1to1 real synth of the decoder delivers a block of native samples,
+	resample_block() turns them into the samples the NtoM synth would have
+	produced (see ntom.c), those just get written out here.
+*/
+
+int SYNTH_NAME(real *bandPtr, int channel, mpg123_handle *fr, int final)
+{
+	real out[NTOM_MAX*SBLIMIT];
+	SAMPLE_T *samples = (SAMPLE_T *) (fr->buffer.data + fr->buffer.fill) + channel;
+	unsigned long ntom;
+	int clip, i, count;
+
+	/* Same bookkeeping as the NtoM synth: both channels start from ntom_val[0]. */
+	if(!channel) fr->ntom_val[1] = fr->ntom_val[0];
+	ntom = fr->ntom_val[channel];
+	clip  = resample_synth(fr, bandPtr, channel);
+	count = resample_block(fr, channel, out, &ntom);
+	fr->ntom_val[channel] = ntom;
+
+	for(i=0; i<count; ++i)
+	{
+		WRITE_SAMPLE(samples,out[i],clip);
+		samples += 2;
+	}
+	if(final) fr->buffer.fill += count*2*sizeof(SAMPLE_T);
+
+	return clip;
+}
+
+int STEREO_NAME(real *bandPtr_l, real *bandPtr_r, mpg123_handle *fr)
+{
+	real out[2][NTOM_MAX*SBLIMIT];
+	SAMPLE_T *samples = (SAMPLE_T *) (fr->buffer.data + fr->buffer.fill);
+	unsigned long ntom;
+	int clip, i, count;
+
+	clip = resample_synth_stereo(fr, bandPtr_l, bandPtr_r);
+	ntom = fr->ntom_val[0];
+	count = resample_block(fr, 0, out[0], &ntom);
+	ntom = fr->ntom_val[0];
+	resample_block(fr, 1, out[1], &ntom);
+	fr->ntom_val[0] = fr->ntom_val[1] = ntom;
+
+	for(i=0; i<count; ++i)
+	{
+		WRITE_SAMPLE(samples,out[0][i],clip);
+		WRITE_SAMPLE(samples+1,out[1][i],clip);
+		samples += 2;
+	}
+	fr->buffer.fill += count*2*sizeof(SAMPLE_T);
+
+	return clip;
+}
+
+int MONO_NAME(real *bandPtr, mpg123_handle *fr)
+{
+	real out[NTOM_MAX*SBLIMIT];
+	SAMPLE_T *samples = (SAMPLE_T *) (fr->buffer.data + fr->buffer.fill);
+	unsigned long ntom;
+	int clip, i, count;
+
+	ntom = fr->ntom_val[1] = fr->ntom_val[0];
+	clip  = resample_synth(fr, bandPtr, 0);
+	count = resample_block(fr, 0, out, &ntom);
+	fr->ntom_val[0] = ntom;
+
+	for(i=0; i<count; ++i)
+	{
+		WRITE_SAMPLE(samples,out[i],clip);
+		samples++;
+	}
+	fr->buffer.fill += count*sizeof(SAMPLE_T);
+
+	return clip;
+}
+
+int MONO2STEREO_NAME(real *bandPtr, mpg123_handle *fr)
+{
+	real out[NTOM_MAX*SBLIMIT];
+	SAMPLE_T *samples = (SAMPLE_T *) (fr->buffer.data + fr->buffer.fill);
+	unsigned long ntom;
+	int clip, i, count;
+
+	ntom = fr->ntom_val[1] = fr->ntom_val[0];
+	clip  = resample_synth(fr, bandPtr, 0);
+	count = resample_block(fr, 0, out, &ntom);
+	fr->ntom_val[0] = ntom;
+
+	for(i=0; i<count; ++i)
+	{
+		WRITE_SAMPLE(samples,out[i],clip);
+		samples[1] = samples[0];
+		samples += 2;
+	}
+	fr->buffer.fill += count*2*sizeof(SAMPLE_T);
+
+	return clip;
+}
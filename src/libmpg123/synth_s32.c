@@ -234,6 +234,62 @@ int synth_1to1_s32_stereo_avx(real *bandPtr_l, real *bandPtr_r, mpg123_handle *f
 }
 #endif
 
+#ifdef OPT_AVX512
+/* Assembler routines. */
+int synth_1to1_s32_s_avx512_asm(real *window, real *b0l, real *b0r, int32_t *samples, int bo1);
+void dct64_real_stereo_avx512(real *out0l, real *out1l, real *out0r, real *out1r, real *samples_l, real *samples_r);
+/* Hull for C mpg123 API */
+/* Only the stereo synth gains from the wide registers, a single channel uses the AVX code. */
+int synth_1to1_s32_avx512(real *bandPtr,int channel, mpg123_handle *fr, int final)
+{
+	return synth_1to1_s32_avx(bandPtr, channel, fr, final);
+}
+
+int synth_1to1_s32_stereo_avx512(real *bandPtr_l, real *bandPtr_r, mpg123_handle *fr)
+{
+	int32_t *samples = (int32_t *) (fr->buffer.data+fr->buffer.fill);
+
+	real *b0l, *b0r, **bufl, **bufr;
+	int bo1;
+	int clip;
+
+	if(fr->have_eq_settings)
+	{
+		do_equalizer(bandPtr_l,0,fr->equalizer);
+		do_equalizer(bandPtr_r,1,fr->equalizer);
+	}
+
+	fr->bo--;
+	fr->bo &= 0xf;
+	bufl = fr->real_buffs[0];
+	bufr = fr->real_buffs[1];
+
+	/* Both channels in one go, left in the lower and right in the upper half of the registers. */
+	if(fr->bo & 0x1)
+	{
+		b0l = bufl[0];
+		b0r = bufr[0];
+		bo1 = fr->bo;
+		dct64_real_stereo_avx512( bufl[1]+((fr->bo+1)&0xf), bufl[0]+fr->bo
+		,	bufr[1]+((fr->bo+1)&0xf), bufr[0]+fr->bo, bandPtr_l, bandPtr_r );
+	}
+	else
+	{
+		b0l = bufl[1];
+		b0r = bufr[1];
+		bo1 = fr->bo+1;
+		dct64_real_stereo_avx512( bufl[0]+fr->bo, bufl[1]+fr->bo+1
+		,	bufr[0]+fr->bo, bufr[1]+fr->bo+1, bandPtr_l, bandPtr_r );
+	}
+
+	clip = synth_1to1_s32_s_avx512_asm(fr->decwin, b0l, b0r, samples, bo1);
+
+	fr->buffer.fill += 256;
+
+	return clip;
+}
+#endif
+
 #if defined(OPT_SSE) || defined(OPT_SSE_VINTAGE)
 /* Assembler routines. */
 int synth_1to1_s32_sse_asm(real *window, real *b0, int32_t *samples, int bo1);
@@ -590,6 +646,19 @@ int synth_1to1_s32_stereo_neon64(real *bandPtr_l, real *bandPtr_r, mpg123_handle
 #undef MONO_NAME
 #undef MONO2STEREO_NAME
 
+#ifdef RESAMPLER
+/* Windowed-sinc resampling over the 1to1 real synth, see ntom.c . */
+#define SYNTH_NAME       synth_resample_s32
+#define STEREO_NAME      synth_resample_s32_stereo
+#define MONO_NAME        synth_resample_s32_mono
+#define MONO2STEREO_NAME synth_resample_s32_m2s
+#include "synth_resample.h"
+#undef SYNTH_NAME
+#undef STEREO_NAME
+#undef MONO_NAME
+#undef MONO2STEREO_NAME
+#endif
+
 #endif
 
 #undef SAMPLE_T
@@ -0,0 +1,270 @@
+/*
+	tabcache: decoder tables shared among handles
+
+	copyright 2016 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+
+	See tabcache.h for the idea. The cache is a plain list, there are only
+	a handful of distinct decoder/scale combinations in practice.
+	Handles may live on different threads, so the list needs a lock. Without
+	thread support there is none; each handle then gets its own tables as
+	before, the entries just are not put into the list.
+	Creating a table fills it via the usual init functions on the handle
+	that asks for it, with the handle's table pointers aimed at the new
+	memory. After that, nobody writes to it anymore.
+*/
+
+#include "mpg123lib_intern.h"
+#ifdef USE_THREADS
+#include <pthread.h>
+#endif
+#include "debug.h"
+
+enum tabcache_kind { tab_decwin, tab_layer };
+
+struct tabcache_entry
+{
+	struct tabcache_entry *next;
+	long refs;
+	/* The key. */
+	enum tabcache_kind kind;
+	enum optdec type;
+	void (*make_decode_tables)(mpg123_handle *fr);
+	double scale;
+	func_gainpow2 gainpow2;
+	func_layer12_table layer12;
+	int down_sample; /* The MMX tables depend on fr->p.down_sample. */
+	int sblimit;
+	/* The data. */
+	real *decwin;
+#ifdef OPT_MMXORSSE
+	float *decwin_mmx;
+	float *decwins;
+#endif
+	real *gainpow2_table;
+	real (*muls)[64];
+	int (*longLimit)[23];
+	int (*shortLimit)[14];
+	/* The memory for above tables follows the struct. */
+};
+
+static struct tabcache_entry *tabcache = NULL;
+#ifdef USE_THREADS
+static pthread_mutex_t tabcache_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define TABCACHE_LOCK   pthread_mutex_lock(&tabcache_mutex);
+#define TABCACHE_UNLOCK pthread_mutex_unlock(&tabcache_mutex);
+#else
+#define TABCACHE_LOCK
+#define TABCACHE_UNLOCK
+#endif
+
+/* Memory after the entry struct, aligned to 64 bytes (cache line, SSE/AVX). */
+static char *entry_space(struct tabcache_entry *e)
+{
+	uintptr_t base = (uintptr_t)(char*)(e+1);
+	uintptr_t aoff = base % 64;
+	return (char*)(e+1) + (aoff ? 64-aoff : 0);
+}
+
+static int same_key(struct tabcache_entry *a, struct tabcache_entry *b)
+{
+	if(a->kind != b->kind) return 0;
+	if(a->kind == tab_decwin)
+	return a->type == b->type
+	&&     a->make_decode_tables == b->make_decode_tables
+	&&     a->scale == b->scale;
+	else
+	return a->gainpow2 == b->gainpow2
+	&&     a->layer12 == b->layer12
+	&&     a->down_sample == b->down_sample
+	&&     a->sblimit == b->sblimit;
+}
+
+/* Needs the lock. The entry the handle already has (own) is checked first. */
+static struct tabcache_entry *tabcache_find(struct tabcache_entry *key, struct tabcache_entry *own)
+{
+	struct tabcache_entry *e;
+	if(own != NULL && same_key(own, key)) return own;
+#ifdef USE_THREADS
+	for(e=tabcache; e!=NULL; e=e->next)
+	if(same_key(e, key)) return e;
+#endif
+
+	return NULL;
+}
+
+/* Needs the lock. */
+static void tabcache_unref(struct tabcache_entry *e)
+{
+	struct tabcache_entry **ep;
+	if(e == NULL || --e->refs > 0) return;
+
+	for(ep=&tabcache; *ep!=NULL; ep=&(*ep)->next)
+	if(*ep == e)
+	{
+		*ep = e->next;
+		break;
+	}
+	debug1("freeing shared table %p", (void*)e);
+	free(e);
+}
+
+/* Needs the lock. */
+static struct tabcache_entry *tabcache_new(struct tabcache_entry *key, size_t size)
+{
+	struct tabcache_entry *e = malloc(sizeof(struct tabcache_entry)+size+63);
+	if(e == NULL) return NULL;
+
+	*e = *key;
+	e->refs = 0;
+#ifdef USE_THREADS
+	e->next = tabcache;
+	tabcache = e;
+#else
+	e->next = NULL;
+#endif
+	return e;
+}
+
+/* The synth window(s), of the same size as frame_buffers() used to allocate. */
+static size_t decwin_size(mpg123_handle *fr)
+{
+	size_t size = (512+32)*sizeof(real);
+#ifdef OPT_MMXORSSE
+#ifdef OPT_MULTI
+	if(fr->cpu_opts.class == mmxsse)
+	{
+#endif
+		/* decwin_mmx will share, decwins will be appended ... sizeof(float)==4 */
+		if(size < (512+32)*4) size = (512+32)*4;
+		/* The second window, (512+32)*4/32 == 68, so that retains alignment. */
+		size += (512+32)*4;
+#ifdef OPT_MULTI
+	}
+#endif
+#endif
+#if defined(OPT_ALTIVEC) || defined(OPT_ARM)
+	/* sizeof(real) >= 4 ... yes, it could be 8, for example.
+	   We got it intialized to at least (512+32)*sizeof(real).*/
+	size += 512*sizeof(real);
+#endif
+	return size;
+}
+
+static void use_decwin(mpg123_handle *fr, struct tabcache_entry *e)
+{
+	fr->decwin = e->decwin;
+#ifdef OPT_MMXORSSE
+	fr->decwin_mmx = e->decwin_mmx;
+	fr->decwins    = e->decwins;
+#endif
+}
+
+int tabcache_decwin(mpg123_handle *fr)
+{
+	struct tabcache_entry key, *e;
+
+	if(fr->make_decode_tables == NULL) return -1;
+	memset(&key, 0, sizeof(key));
+	key.kind  = tab_decwin;
+	key.type  = fr->cpu_opts.type;
+	key.make_decode_tables = fr->make_decode_tables;
+	key.scale = fr->lastscale < 0 ? fr->p.outscale : fr->lastscale;
+
+	TABCACHE_LOCK
+	e = tabcache_find(&key, fr->decwin_table);
+	if(e == NULL && (e = tabcache_new(&key, decwin_size(fr))) != NULL)
+	{
+		debug1("new shared decode table with scale %g", key.scale);
+		e->decwin = (real*)entry_space(e);
+#ifdef OPT_MMXORSSE
+		e->decwin_mmx = (float*)e->decwin;
+		e->decwins = e->decwin_mmx+512+32;
+#endif
+		use_decwin(fr, e);
+		fr->make_decode_tables(fr);
+	}
+	if(e != NULL)
+	{
+		++e->refs;
+		tabcache_unref(fr->decwin_table);
+		fr->decwin_table = e;
+	}
+	TABCACHE_UNLOCK
+
+	if(e == NULL) return -1;
+	use_decwin(fr, e);
+	return 0;
+}
+
+static void use_layer(mpg123_handle *fr, struct tabcache_entry *e)
+{
+	fr->gainpow2   = e->gainpow2_table;
+	fr->muls       = e->muls;
+	fr->longLimit  = e->longLimit;
+	fr->shortLimit = e->shortLimit;
+}
+
+int tabcache_layer(mpg123_handle *fr, func_gainpow2 gainpow2, func_layer12_table layer12)
+{
+	struct tabcache_entry key, *e;
+	size_t reals = 256+118+4 + 27*64;
+	size_t ints  = 9*23 + 9*14;
+
+	memset(&key, 0, sizeof(key));
+	key.kind = tab_layer;
+	key.gainpow2 = gainpow2;
+	key.layer12  = layer12;
+	key.down_sample = fr->p.down_sample;
+	key.sblimit  = fr->down_sample_sblimit;
+
+	TABCACHE_LOCK
+	e = tabcache_find(&key, fr->layer_table);
+	if(e == NULL && (e = tabcache_new(&key, reals*sizeof(real)+ints*sizeof(int))) != NULL)
+	{
+		real *space = (real*)entry_space(e);
+		debug1("new shared layer tables for sblimit %i", key.sblimit);
+		/* Unused parts (NO_LAYER3/NO_LAYER12) just stay in there. */
+		e->gainpow2_table = space;
+		e->muls = (real(*)[64])(space+256+118+4);
+		e->longLimit  = (int(*)[23])(space+reals);
+		e->shortLimit = (int(*)[14])((int*)e->longLimit+9*23);
+		use_layer(fr, e);
+#ifndef NO_LAYER3
+		if(gainpow2 != NULL) init_layer3_stuff(fr, gainpow2);
+#endif
+#ifndef NO_LAYER12
+		if(layer12 != NULL) init_layer12_stuff(fr, layer12);
+#endif
+	}
+	if(e != NULL)
+	{
+		++e->refs;
+		tabcache_unref(fr->layer_table);
+		fr->layer_table = e;
+	}
+	TABCACHE_UNLOCK
+
+	if(e == NULL) return -1;
+	use_layer(fr, e);
+	return 0;
+}
+
+void tabcache_release(mpg123_handle *fr)
+{
+	TABCACHE_LOCK
+	tabcache_unref(fr->decwin_table);
+	tabcache_unref(fr->layer_table);
+	TABCACHE_UNLOCK
+	fr->decwin_table = NULL;
+	fr->layer_table  = NULL;
+	fr->decwin = NULL;
+#ifdef OPT_MMXORSSE
+	fr->decwin_mmx = NULL;
+	fr->decwins    = NULL;
+#endif
+	fr->gainpow2   = NULL;
+	fr->muls       = NULL;
+	fr->longLimit  = NULL;
+	fr->shortLimit = NULL;
+}
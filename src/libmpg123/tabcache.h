@@ -0,0 +1,35 @@
+/*
+	tabcache: decoder tables shared among handles
+
+	copyright 2016 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+
+	The synth window and the layer dequantization tables only depend on the
+	chosen decoder and the output scale, not on the stream. Instead of each
+	handle computing and storing its own copy, handles get a reference to a
+	read-only table from a cache. Identical settings mean the same memory
+	(in builds with thread support, others have no lock for the cache and
+	keep one set of tables per handle). Tables are freed when the last
+	handle lets go of them.
+*/
+
+#ifndef MPG123_TABCACHE_H
+#define MPG123_TABCACHE_H
+
+#include "frame.h"
+
+typedef real (*func_gainpow2)(mpg123_handle *fr, int i);
+typedef real* (*func_layer12_table)(mpg123_handle *fr, real *table, int m);
+
+/* Point fr->decwin (and the MMX variants) to the table matching the current
+   decoder and scale (fr->lastscale or fr->p.outscale), creating it with
+   fr->make_decode_tables if needed. Returns 0 on success, -1 on failure,
+   in which case the old table stays in place. */
+int tabcache_decwin(mpg123_handle *fr);
+/* Same for fr->gainpow2, fr->longLimit, fr->shortLimit and fr->muls, created
+   with init_layer3_stuff(fr, gainpow2) and init_layer12_stuff(fr, layer12). */
+int tabcache_layer(mpg123_handle *fr, func_gainpow2 gainpow2, func_layer12_table layer12);
+/* Drop the references of the handle. */
+void tabcache_release(mpg123_handle *fr);
+
+#endif
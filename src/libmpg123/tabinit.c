@@ -9,8 +9,11 @@
 #include "mpg123lib_intern.h"
 #include "debug.h"
 
+/* The generated tables are aligned for altivec, too. */
+#if defined(PRECALC_TABLES) && !defined(REAL_IS_FIXED)
+#include "dct_float_tables.h"
 /* That altivec alignment part here should not hurt generic code, I hope */
-#ifdef OPT_ALTIVEC
+#elif defined(OPT_ALTIVEC)
 static ALIGNED(16) real cos64[16];
 static ALIGNED(16) real cos32[8];
 static ALIGNED(16) real cos16[4];
@@ -75,7 +78,7 @@ static long intwinbase[] = {
 
 void prepare_decode_tables()
 {
-#if !defined(REAL_IS_FIXED) || !defined(PRECALC_TABLES)
+#ifndef PRECALC_TABLES
   int i,k,kr,divv;
   real *costab;
 
@@ -249,7 +252,8 @@ void make_decode_tables(mpg123_handle *fr)
 	  || fr->cpu_opts.type == arm
 	  || fr->cpu_opts.type == neon
 	  || fr->cpu_opts.type == neon64
-	  || fr->cpu_opts.type == avx )
+	  || fr->cpu_opts.type == avx
+	  || fr->cpu_opts.type == avx512 )
 	{ /* for float SSE / AltiVec / ARM decoder */
 		for(i=512; i<512+32; i++)
 		{
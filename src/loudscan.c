@@ -0,0 +1,232 @@
+/*
+	loudscan: loudness measurement of a list of files (--loudness)
+
+	copyright 2016 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+
+	Each worker takes the next file from the list, decodes it with its own
+	handle to float and measures with MPG123_LOUDNESS. The results are
+	printed in the order of the list, as soon as the ones before are there.
+*/
+
+#include "loudscan.h"
+#include "playlist.h"
+#ifdef USE_THREADS
+#include <pthread.h>
+#endif
+#include <math.h>
+#include "debug.h"
+
+struct scan_result
+{
+	int done;
+	int err; /* MPG123_OK or error code */
+	struct mpg123_loudness lr;
+};
+
+struct scan
+{
+	mpg123_pars *mp;
+	char **files;
+	struct scan_result *results;
+	size_t count;
+	size_t next; /* file for the next free worker */
+#ifdef USE_THREADS
+	pthread_mutex_t lock;
+	pthread_cond_t  done;
+#endif
+};
+
+static mpg123_handle *scan_handle(mpg123_pars *mp, int *err)
+{
+	const long *rates;
+	size_t nrates, i;
+	mpg123_handle *mh = mpg123_parnew(mp, param.cpu, err);
+	if(mh == NULL) return NULL;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_LOUDNESS, 0.);
+	/* Float keeps what is above full scale, if the build has it. */
+	mpg123_rates(&rates, &nrates);
+	mpg123_format_none(mh);
+	for(i=0; i<nrates; ++i)
+	if(mpg123_format(mh, rates[i], MPG123_MONO|MPG123_STEREO, MPG123_ENC_FLOAT_32) != MPG123_OK)
+	{
+		mpg123_format_all(mh);
+		break;
+	}
+	return mh;
+}
+
+static void measure(mpg123_handle *mh, const char *path, struct scan_result *res)
+{
+	int ret;
+	if(mpg123_open(mh, path) != MPG123_OK)
+	{
+		res->err = mpg123_errcode(mh);
+		return;
+	}
+	do
+	{
+		off_t num;
+		unsigned char *audio;
+		size_t bytes;
+		ret = mpg123_decode_frame(mh, &num, &audio, &bytes);
+	} while(ret == MPG123_OK || ret == MPG123_NEW_FORMAT);
+	res->err = ret == MPG123_DONE ? MPG123_OK : mpg123_errcode(mh);
+	if(res->err == MPG123_OK && mpg123_loudness(mh, &res->lr) != MPG123_OK)
+	res->err = mpg123_errcode(mh);
+	mpg123_close(mh);
+}
+
+static void print_result(const char *path, struct scan_result *res)
+{
+	struct mpg123_loudness *lr = &res->lr;
+	if(res->err != MPG123_OK)
+	{
+		error2("cannot measure %s: %s", path, mpg123_plain_strerror(res->err));
+		return;
+	}
+	if(lr->integrated == -HUGE_VAL)
+	printf("-\t-\t");
+	else
+	printf("%.1f\t%.1f\t", lr->integrated, lr->range);
+	if(lr->true_peak > 0.)
+	printf("%.2f\t", 20.*log10(lr->true_peak));
+	else
+	printf("-\t");
+	printf("%+.2f\t%s\n", lr->gain, path);
+	fflush(stdout);
+}
+
+#ifdef USE_THREADS
+static void *scan_thread(void *arg)
+{
+	struct scan *sc = arg;
+	int err;
+	mpg123_handle *mh = scan_handle(sc->mp, &err);
+	size_t i;
+
+	pthread_mutex_lock(&sc->lock);
+	while(sc->next < sc->count)
+	{
+		i = sc->next++;
+		pthread_mutex_unlock(&sc->lock);
+		if(mh != NULL)
+		measure(mh, sc->files[i], &sc->results[i]);
+		else
+		sc->results[i].err = err;
+		pthread_mutex_lock(&sc->lock);
+		sc->results[i].done = 1;
+		pthread_cond_broadcast(&sc->done);
+	}
+	pthread_mutex_unlock(&sc->lock);
+	if(mh != NULL) mpg123_delete(mh);
+	return NULL;
+}
+#endif
+
+/* Without other threads (or none started), measure and print one after another. */
+static int scan_sequential(struct scan *sc)
+{
+	int err, bad = 0;
+	size_t i;
+	mpg123_handle *mh = scan_handle(sc->mp, &err);
+	if(mh == NULL)
+	{
+		error1("cannot get a decoder handle: %s", mpg123_plain_strerror(err));
+		return 1;
+	}
+	for(i=0; i<sc->count; ++i)
+	{
+		measure(mh, sc->files[i], &sc->results[i]);
+		print_result(sc->files[i], &sc->results[i]);
+		if(sc->results[i].err != MPG123_OK) bad = 1;
+	}
+	mpg123_delete(mh);
+	return bad;
+}
+
+int loudness_scan(mpg123_pars *mp)
+{
+	struct scan sc;
+	char *fname;
+	size_t size = 0;
+	long jobs = param.loudness_jobs;
+	int bad = 0;
+
+	sc.mp = mp;
+	sc.files = NULL;
+	sc.count = sc.next = 0;
+	while((fname = get_next_file()))
+	{
+		if(sc.count == size)
+		{
+			char **more = safe_realloc(sc.files, (size = 2*size+64)*sizeof(char*));
+			if(more == NULL)
+			{
+				error("out of memory for the file list");
+				free(sc.files);
+				return 1;
+			}
+			sc.files = more;
+		}
+		sc.files[sc.count++] = fname;
+	}
+	if(sc.count == 0)
+	{
+		free(sc.files);
+		return 0;
+	}
+	sc.results = calloc(sc.count, sizeof(struct scan_result));
+	if(sc.results == NULL)
+	{
+		error("out of memory for the results");
+		free(sc.files);
+		return 1;
+	}
+	if(!param.quiet)
+	printf("# integrated LUFS, range LU, true peak dBTP, gain to -18 LUFS dB, file\n");
+
+#if defined(HAVE_UNISTD_H) && defined(_SC_NPROCESSORS_ONLN)
+	if(jobs < 1) jobs = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	if(jobs < 1) jobs = 1;
+	if((size_t)jobs > sc.count) jobs = (long)sc.count;
+#ifdef USE_THREADS
+	if(jobs > 1)
+	{
+		pthread_t *threads = malloc(sizeof(pthread_t)*jobs);
+		long started = 0;
+		size_t i;
+		pthread_mutex_init(&sc.lock, NULL);
+		pthread_cond_init(&sc.done, NULL);
+		if(threads != NULL)
+		for(started=0; started<jobs; ++started)
+		if(pthread_create(&threads[started], NULL, scan_thread, &sc))
+		break;
+		if(started > 0)
+		{
+			/* Print in order, waiting for the next one to be finished. */
+			for(i=0; i<sc.count; ++i)
+			{
+				pthread_mutex_lock(&sc.lock);
+				while(!sc.results[i].done)
+				pthread_cond_wait(&sc.done, &sc.lock);
+				pthread_mutex_unlock(&sc.lock);
+				print_result(sc.files[i], &sc.results[i]);
+				if(sc.results[i].err != MPG123_OK) bad = 1;
+			}
+			while(started > 0)
+			pthread_join(threads[--started], NULL);
+			jobs = 0;
+		}
+		free(threads);
+		pthread_cond_destroy(&sc.done);
+		pthread_mutex_destroy(&sc.lock);
+	}
+	if(jobs > 0)
+#endif
+	bad = scan_sequential(&sc);
+	free(sc.results);
+	free(sc.files);
+	return bad;
+}
@@ -0,0 +1,18 @@
+/*
+	loudscan: loudness measurement of a list of files (--loudness)
+
+	copyright 2016 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+*/
+
+#ifndef LOUDSCAN_H
+#define LOUDSCAN_H
+
+#include "mpg123app.h"
+
+/* Decode all files of the prepared playlist without output and print their
+   loudness in order, param.loudness_jobs of them at once.
+   Return value is 0 when all could be measured, 1 otherwise. */
+int loudness_scan(mpg123_pars *mp);
+
+#endif
@@ -40,6 +40,7 @@
 #include "metaprint.h"
 #include "httpget.h"
 #include "streamdump.h"
+#include "loudscan.h"
 
 #include "debug.h"
 
@@ -114,6 +115,9 @@ struct parameter param = {
 	,-1 /* gain */
 	,NULL /* stream dump file */
 	,0 /* ICY interval */
+	,0 /* readahead */
+	,0 /* loudness */
+	,0 /* loudness_jobs */
 };
 
 mpg123_handle *mh = NULL;
@@ -498,6 +502,9 @@ topt opts[] = {
 	{0, "no-seekbuffer", GLO_INT, unset_frameflag, &frameflag, MPG123_SEEKBUFFER},
 	{'e', "encoding", GLO_ARG|GLO_CHAR, 0, &param.force_encoding, 0},
 	{0, "preframes", GLO_ARG|GLO_LONG, 0, &param.preframes, 0},
+	{0, "readahead", GLO_ARG|GLO_LONG, 0, &param.readahead, 0},
+	{0, "loudness", GLO_INT, 0, &param.loudness, 1},
+	{0, "loudness-jobs", GLO_ARG|GLO_LONG, 0, &param.loudness_jobs, 0},
 	{0, "skip-id3v2", GLO_INT, set_frameflag, &frameflag, MPG123_SKIP_ID3V2},
 	{0, "streamdump", GLO_ARG|GLO_CHAR, 0, &param.streamdump, 0},
 	{0, "icy-interval", GLO_ARG|GLO_LONG, 0, &param.icy_interval, 0},
@@ -909,13 +916,17 @@ int main(int sys_argc, char ** sys_argv)
 	/* Init audio as early as possible.
 	   If there is the buffer process to be spawned, it shouldn't carry the mpg123_handle with it. */
 	bufferblock = mpg123_safe_buffer(); /* Can call that before mpg123_init(), it's stateless. */
-	if(init_output(&ao) < 0)
+	/* Measuring the loudness does not need any output. */
+	if(!param.loudness)
 	{
-		error("Failed to initialize output, goodbye.");
-		mpg123_delete_pars(mp);
-		return 99; /* It's safe here... nothing nasty happened yet. */
+		if(init_output(&ao) < 0)
+		{
+			error("Failed to initialize output, goodbye.");
+			mpg123_delete_pars(mp);
+			return 99; /* It's safe here... nothing nasty happened yet. */
+		}
+		have_output = TRUE;
 	}
-	have_output = TRUE;
 
 	/* ========================================================================================================= */
 	/* Enterning the leaking zone... we start messing with stuff here that should be taken care of when leaving. */
@@ -963,6 +974,8 @@ int main(int sys_argc, char ** sys_argv)
 	    && MPG123_OK == (result = mpg123_par(mp, MPG123_OUTSCALE, param.outscale, 0))
 	    && ++libpar
 	    && MPG123_OK == (result = mpg123_par(mp, MPG123_PREFRAMES, param.preframes, 0))
+	    && ++libpar
+	    && MPG123_OK == (result = mpg123_par(mp, MPG123_READAHEAD, param.readahead*1024, 0))
 			))
 	{
 		error2("Cannot set library parameter %i: %s", libpar, mpg123_plain_strerror(result));
@@ -983,6 +996,18 @@ int main(int sys_argc, char ** sys_argv)
 		safe_exit(1);
 	}
 
+	if(param.loudness)
+	{
+		/* Just the files, each once, in the given order. */
+		param.shuffle = 0;
+		param.loop = 1;
+		prepare_playlist(argc, argv);
+		result = loudness_scan(mp);
+		free_playlist();
+		mpg123_delete_pars(mp);
+		safe_exit(result);
+	}
+
 	/* Now actually get an mpg123_handle. */
 	mh = mpg123_parnew(mp, param.cpu, &result);
 	if(mh == NULL)
@@ -1342,6 +1367,7 @@ static void long_usage(int err)
 	fprintf(o,"        --index-size <n>   change size of frame index\n");
 	fprintf(o,"        --preframes  <n>   number of frames to decode in advance after seeking (to keep layer 3 bit reservoir happy)\n");
 	fprintf(o,"        --resync-limit <n> Set number of bytes to search for valid MPEG data; <0 means search whole stream.\n");
+	fprintf(o,"        --readahead <n>    read <n> KiB of input ahead on a separate thread\n");
 	fprintf(o,"        --streamdump <f>   Dump a copy of input data (as read by libmpg123) to given file.\n");
 	fprintf(o,"        --icy-interval <n> Enforce ICY interval in bytes (for playing a stream dump.\n");
 	fprintf(o,"        --ignore-streamlength Ignore header info about length of MPEG streams.");
@@ -1402,6 +1428,8 @@ static void long_usage(int err)
 
 	fprintf(o,"\nmisc options\n\n");
 	fprintf(o," -t     --test             only decode, no output (benchmark)\n");
+	fprintf(o,"        --loudness         no playback, print the loudness of the files (EBU R 128, ReplayGain 2.0 gain)\n");
+	fprintf(o,"        --loudness-jobs <n> measure <n> files at once (default: number of processors)\n");
 	fprintf(o," -c     --check            count and display clipped samples\n");
 	fprintf(o," -v[*]  --verbose          increase verboselevel\n");
 	fprintf(o," -q     --quiet            quiet mode\n");
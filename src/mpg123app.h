@@ -111,6 +111,9 @@ struct parameter
 	long gain; /* audio output gain, for selected outputs */
 	char* streamdump;
 	long icy_interval;
+	long readahead; /* KiB of input to read ahead on a thread */
+	int loudness; /* only measure the loudness of the files */
+	long loudness_jobs; /* files measured at once, 0 for the number of processors */
 };
 
 enum mpg123app_flags
@@ -131,6 +131,9 @@ struct parameter param = {
 	,-1 /* gain */
 	,NULL /* stream dump file */
 	,0 /* ICY interval */
+	,0 /* readahead */
+	,0 /* loudness */
+	,0 /* loudness_jobs */
 };
 
 audio_output_t *ao = NULL;
@@ -0,0 +1,159 @@
+#include "compat.h"
+#include <mpg123.h>
+#include <time.h>
+#include "debug.h"
+
+/*
+	Walk a file with mpg123_analyze_next() and decode it with
+	mpg123_decode_frame(). The number of frames has to be the same, the
+	layer and channels have to match mpg123_info(), the frame offsets have
+	to increase and the statistics have to stay in the ranges of their bit
+	fields. Analyzing the first half and decoding the rest has to yield the
+	remaining frames. Prints the time of the analysis relative to decoding.
+	Usage: analyze file...
+*/
+
+static mpg123_handle *open_file(const char *path)
+{
+	mpg123_handle *mh = mpg123_new(NULL, NULL);
+	if(mh == NULL) return NULL;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0.);
+	mpg123_param(mh, MPG123_REMOVE_FLAGS, MPG123_GAPLESS, 0.);
+	if(mpg123_open(mh, path) != MPG123_OK)
+	{
+		error1("cannot open: %s", mpg123_strerror(mh));
+		mpg123_delete(mh);
+		return NULL;
+	}
+	return mh;
+}
+
+/* Decoded frames until the end, -1 on error. */
+static long decode_rest(mpg123_handle *mh)
+{
+	long frames = 0;
+	int ret;
+	off_t num;
+	unsigned char *audio;
+	size_t bytes;
+	while((ret = mpg123_decode_frame(mh, &num, &audio, &bytes)) == MPG123_OK || ret == MPG123_NEW_FORMAT)
+	if(ret == MPG123_OK) ++frames;
+	return ret == MPG123_DONE ? frames : -1;
+}
+
+static int check_stats(struct mpg123_frame_stats *st, struct mpg123_frameinfo *fi)
+{
+	int gr, ch;
+	if(st->layer != fi->layer || st->channels != (fi->mode == MPG123_M_MONO ? 1 : 2))
+	return -1;
+	for(ch=0; ch<st->channels; ++ch)
+	{
+		if(st->subbands[ch] < 0 || st->subbands[ch] > 32 || st->scale_index[ch] < 0 || st->scale_index[ch] > 63)
+		return -1;
+		for(gr=0; gr<st->granules; ++gr)
+		{
+			struct mpg123_granule_stats *gs = &st->gr[gr][ch];
+			if(  gs->part2_3_length < 0 || gs->part2_3_length > 4095 || gs->big_values < 0 || gs->big_values > 288
+			  || gs->global_gain < 0 || gs->global_gain > 255 || gs->block_type < 0 || gs->block_type > 3
+			  || gs->scalefac_compress < 0 || gs->scalefac_compress > 511 )
+			return -1;
+		}
+	}
+	if(st->granules > (st->layer == 3 ? 2 : 0) || st->main_data_begin < 0 || st->main_data_begin > 511)
+	return -1;
+	return 0;
+}
+
+int test_file(const char *path)
+{
+	int err = -1;
+	int ret;
+	mpg123_handle *mh = NULL;
+	long frames = 0, decoded, bad = 0, rest;
+	off_t pos = -1;
+	double gain = 0.;
+	clock_t analyze_time, decode_time;
+	struct mpg123_frame_stats st;
+	struct mpg123_frameinfo fi;
+
+	if((mh = open_file(path)) == NULL)
+	goto test_file_end;
+	analyze_time = clock();
+	while((ret = mpg123_analyze_next(mh, &st)) == MPG123_OK)
+	{
+		if(mpg123_info(mh, &fi) != MPG123_OK || check_stats(&st, &fi))
+		{
+			error1("frame %li: statistics do not fit the header", frames);
+			goto test_file_end;
+		}
+		if(mpg123_framepos(mh) <= pos)
+		{
+			error1("frame %li: offset does not increase", frames);
+			goto test_file_end;
+		}
+		pos = mpg123_framepos(mh);
+		if(st.bad) ++bad;
+		else if(st.layer == 3) gain += st.gr[0][0].global_gain;
+		++frames;
+	}
+	analyze_time = clock() - analyze_time;
+	if(ret != MPG123_DONE)
+	{
+		error1("analysis ended with %i", ret);
+		goto test_file_end;
+	}
+	mpg123_delete(mh);
+
+	if((mh = open_file(path)) == NULL)
+	goto test_file_end;
+	decode_time = clock();
+	decoded = decode_rest(mh);
+	decode_time = clock() - decode_time;
+	mpg123_delete(mh);
+	if(decoded != frames)
+	{
+		error2("analyzed %li frames, decoded %li", frames, decoded);
+		mh = NULL;
+		goto test_file_end;
+	}
+
+	if((mh = open_file(path)) == NULL)
+	goto test_file_end;
+	for(rest=0; rest<frames/2; ++rest)
+	if(mpg123_analyze_next(mh, &st) != MPG123_OK)
+	break;
+	if(rest != frames/2 || (rest = decode_rest(mh)) != frames - frames/2)
+	{
+		error2("decoded %li frames after the first %li", rest, frames/2);
+		goto test_file_end;
+	}
+	fprintf( stderr, "%li frames, %li bad, mean gain %g, analysis %g of decoding time: "
+	,	frames, bad, frames > bad ? gain/(frames-bad) : 0.
+	,	decode_time > 0 ? (double)analyze_time/decode_time : 0. );
+	err = 0;
+test_file_end:
+	if(mh) mpg123_delete(mh);
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	int err = 0, errsum = 0;
+	int i;
+	if(argc < 2)
+	{
+		printf("Gimme a MPEG file name...\n");
+		return 0;
+	}
+	mpg123_init();
+	for(i=1; i<argc; ++i)
+	{
+		fprintf(stderr, "%s: ", argv[i]);
+		err = test_file(argv[i]);
+		fprintf(stdout, "%s\n", err == 0 ? "PASS" : "FAIL");
+		errsum += err;
+	}
+	mpg123_exit();
+	printf("%s\n", errsum ? "FAIL" : "PASS");
+	return errsum;
+}
@@ -0,0 +1,167 @@
+#include "compat.h"
+#include <mpg123.h>
+#include "debug.h"
+
+/*
+	Decode a file with MPG123_BANDWIDTH. With all of the bandwidth, the output
+	has to be the same as without. At the limit of 4:1 downsampling it has to
+	be the same as that alone (where the quarter rate is supported). A preview
+	of an eighth of the sampling rate at the native rate has to keep the low
+	frequencies (compared after a moving average) and must not have much more
+	energy in the first differences than a sine at the cutoff: 4*sin(pi/8)^2,
+	0.59 of its energy. Noise up to the cutoff has 0.2, over all of the
+	bandwidth it has 2.
+	Usage: bandwidth file...
+*/
+
+#define AVERAGE 16
+#define LOW_ERROR 0.1
+#define HIGH_LIMIT 0.7
+
+/* Float output of the whole file, or NULL. */
+static float *decode(const char *path, long down_sample, long bandwidth, size_t *count, long *rate, int *channels)
+{
+	const long *rates;
+	size_t nrates, i, fill = 0, size = 0;
+	float *out = NULL;
+	int enc, ret = MPG123_ERR;
+	mpg123_handle *mh = mpg123_new(NULL, NULL);
+
+	if(mh == NULL) return NULL;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0.);
+	mpg123_param(mh, MPG123_DOWN_SAMPLE, down_sample, 0.);
+	mpg123_param(mh, MPG123_BANDWIDTH, bandwidth, 0.);
+	mpg123_rates(&rates, &nrates);
+	mpg123_format_none(mh);
+	for(i=0; i<nrates; ++i)
+	mpg123_format(mh, rates[i], MPG123_MONO|MPG123_STEREO, MPG123_ENC_FLOAT_32);
+	if(mpg123_open(mh, path) != MPG123_OK || mpg123_getformat(mh, rate, channels, &enc) != MPG123_OK)
+	goto decode_end;
+	do
+	{
+		size_t got = 0;
+		if(size-fill < mpg123_outblock(mh))
+		{
+			float *more = realloc(out, (size = 2*size + mpg123_outblock(mh))*sizeof(float));
+			if(more == NULL) break;
+			out = more;
+		}
+		ret = mpg123_read(mh, (unsigned char*)(out+fill), (size-fill)*sizeof(float), &got);
+		fill += got/sizeof(float);
+	} while(ret == MPG123_OK || ret == MPG123_NEW_FORMAT);
+	if(ret != MPG123_DONE)
+	{
+		free(out);
+		out = NULL;
+	}
+decode_end:
+	*count = fill;
+	mpg123_delete(mh);
+	return out;
+}
+
+/*
+	Energy of the moving average of a and of its difference to the one of b,
+	energy of b and of its first difference, per channel.
+*/
+static void energies(const float *a, const float *b, size_t count, int channels
+,	double *low, double *lowerr, double *all, double *high)
+{
+	size_t i;
+	int k;
+	*low = *lowerr = *all = *high = 0.;
+	for(i=AVERAGE*channels; i<count; ++i)
+	{
+		double sa = 0., sb = 0., d = b[i] - b[i-channels];
+		for(k=0; k<AVERAGE; ++k)
+		{
+			sa += a[i-k*channels];
+			sb += b[i-k*channels];
+		}
+		*low    += sa*sa;
+		*lowerr += (sb-sa)*(sb-sa);
+		*all    += b[i]*b[i];
+		*high   += d*d;
+	}
+}
+
+int test_file(const char *path)
+{
+	int err = -1;
+	float *full = NULL, *other = NULL;
+	size_t count, ocount;
+	long rate, orate;
+	int channels, ochannels;
+	double low, lowerr, all, high, fullall, fullhigh, dummy;
+
+	if((full = decode(path, 0, 0, &count, &rate, &channels)) == NULL)
+	{
+		error("cannot decode");
+		goto test_file_end;
+	}
+	if(  (other = decode(path, 0, rate, &ocount, &orate, &ochannels)) == NULL
+	  || ocount != count || memcmp(other, full, count*sizeof(float)) )
+	{
+		error("output with full bandwidth differs");
+		goto test_file_end;
+	}
+	free(other);
+	free(full);
+	other = NULL;
+	/* The quarter rate, so half of that is the eighth of the native one. */
+	if(  (full = decode(path, 2, 0, &count, &rate, &channels)) != NULL
+	  && (  (other = decode(path, 2, rate/2, &ocount, &orate, &ochannels)) == NULL
+	     || ocount != count || memcmp(other, full, count*sizeof(float)) ) )
+	{
+		error("output of 4:1 downsampling with its bandwidth differs");
+		goto test_file_end;
+	}
+	free(other);
+	free(full);
+	other = NULL;
+	if(  (full = decode(path, 0, 0, &count, &rate, &channels)) == NULL
+	  || (other = decode(path, 0, rate/8, &ocount, &orate, &ochannels)) == NULL
+	  || ocount != count || ochannels != channels )
+	{
+		error("preview decoding failed");
+		goto test_file_end;
+	}
+	energies(full, other, count, channels, &low, &lowerr, &all, &high);
+	energies(full, full, count, channels, &dummy, &dummy, &fullall, &fullhigh);
+	if(lowerr > LOW_ERROR*low || high > HIGH_LIMIT*all)
+	error2( "preview low frequency error %g, high frequency part %g"
+	,	lowerr/low, high/all );
+	else
+	{
+		fprintf( stderr, "low error %g, high part %g (full %g): "
+		,	low > 0 ? lowerr/low : 0., all > 0 ? high/all : 0.
+		,	fullall > 0 ? fullhigh/fullall : 0. );
+		err = 0;
+	}
+test_file_end:
+	free(other);
+	free(full);
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	int err = 0, errsum = 0;
+	int i;
+	if(argc < 2)
+	{
+		printf("Gimme a MPEG file name...\n");
+		return 0;
+	}
+	mpg123_init();
+	for(i=1; i<argc; ++i)
+	{
+		fprintf(stderr, "%s: ", argv[i]);
+		err = test_file(argv[i]);
+		fprintf(stdout, "%s\n", err == 0 ? "PASS" : "FAIL");
+		errsum += err;
+	}
+	mpg123_exit();
+	printf("%s\n", errsum ? "FAIL" : "PASS");
+	return errsum;
+}
@@ -0,0 +1,111 @@
+#include "compat.h"
+#include <mpg123.h>
+#include "debug.h"
+
+/*
+	Scan a file with a full plain index and with MPG123_COMPACT_INDEX: the
+	offsets from mpg123_index() have to be the same, as has to be the output
+	after seeking to frames. Also switch the compact index back to a
+	small plain one and check that it still covers the file.
+	Usage: compact_index file...
+*/
+
+static mpg123_handle *open_file(const char *path, int compact)
+{
+	mpg123_handle *mh = mpg123_new(NULL, NULL);
+	if(mh == NULL) return NULL;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0.);
+	if(compact)
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_COMPACT_INDEX, 0.);
+	else
+	mpg123_param(mh, MPG123_INDEX_SIZE, -1000, 0.);
+	if(mpg123_open(mh, path) != MPG123_OK || mpg123_scan(mh) != MPG123_OK)
+	{
+		error1("cannot open: %s", mpg123_strerror(mh));
+		mpg123_delete(mh);
+		return NULL;
+	}
+	return mh;
+}
+
+int test_index(const char *path)
+{
+	int err = -1;
+	mpg123_handle *plain, *compact = NULL;
+	off_t *offp, *offc;
+	off_t stepp, stepc, frames;
+	size_t fillp, fillc;
+	unsigned char outp[4608], outc[4608];
+	unsigned long rnd = 4711;
+	int i;
+
+	if((plain = open_file(path, 0)) == NULL) return -1;
+	if((compact = open_file(path, 1)) == NULL) goto test_index_end;
+	if(  mpg123_index(plain, &offp, &stepp, &fillp) != MPG123_OK
+	  || mpg123_index(compact, &offc, &stepc, &fillc) != MPG123_OK )
+	goto test_index_end;
+	if(stepc != 1 || stepp != stepc || fillp != fillc || memcmp(offp, offc, fillp*sizeof(off_t)))
+	{
+		error2("index differs: step %li/%li", (long)stepp, (long)stepc);
+		goto test_index_end;
+	}
+	frames = (off_t)fillc;
+	for(i=0; i<200 && frames > 0; ++i)
+	{
+		off_t frame;
+		size_t gotp = 0, gotc = 0;
+		rnd = rnd*1103515245UL + 12345UL;
+		frame = (off_t)((rnd>>8) % (unsigned long)frames);
+		if(  mpg123_seek_frame(plain, frame, SEEK_SET) != frame
+		  || mpg123_seek_frame(compact, frame, SEEK_SET) != frame
+		  || mpg123_read(plain, outp, sizeof(outp), &gotp) != mpg123_read(compact, outc, sizeof(outc), &gotc)
+		  || gotp != gotc || memcmp(outp, outc, gotp) )
+		{
+			error1("seek to frame %li differs", (long)frame);
+			goto test_index_end;
+		}
+	}
+	/* Back to a plain index of 100 entries, thinning out the compact one. */
+	mpg123_param(compact, MPG123_REMOVE_FLAGS, MPG123_COMPACT_INDEX, 0.);
+	if(  mpg123_param(compact, MPG123_INDEX_SIZE, 100, 0.) != MPG123_OK
+	  || mpg123_index(compact, &offc, &stepc, &fillc) != MPG123_OK
+	  || fillc > 100 || (off_t)(fillc+1)*stepc < frames )
+	{
+		error("index conversion failed");
+		goto test_index_end;
+	}
+	for(i=0; i<(int)fillc; ++i)
+	if(offc[i] != offp[i*stepc])
+	{
+		error1("converted index differs at %i", i);
+		goto test_index_end;
+	}
+	fprintf(stderr, "%lu entries: ", (unsigned long)fillp);
+	err = 0;
+test_index_end:
+	if(compact) mpg123_delete(compact);
+	mpg123_delete(plain);
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	int err = 0, errsum = 0;
+	int i;
+	if(argc < 2)
+	{
+		printf("Gimme a MPEG file name...\n");
+		return 0;
+	}
+	mpg123_init();
+	for(i=1; i<argc; ++i)
+	{
+		fprintf(stderr, "%s: ", argv[i]);
+		err = test_index(argv[i]);
+		fprintf(stdout, "%s\n", err == 0 ? "PASS" : "FAIL");
+		errsum += err;
+	}
+	mpg123_exit();
+	printf("%s\n", errsum ? "FAIL" : "PASS");
+	return errsum;
+}
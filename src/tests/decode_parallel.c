@@ -0,0 +1,327 @@
+#include "compat.h"
+#include <mpg123.h>
+#include "debug.h"
+
+static void silent_tap(void *handle, const struct mpg123_tap_data *data)
+{
+}
+
+/*
+	Decode the whole file sequentially and in parallel segments, compare.
+	With tap, the parallel decoding happens with a tap and MPG123_TAP_ONLY
+	set on the handle, which must not silence the segments.
+*/
+int test_parallel(const char* path, int segments, int encoding, int tap)
+{
+	int err = MPG123_OK;
+	int channels, enc;
+	long rate;
+	mpg123_handle* mh = NULL;
+	unsigned char *serial = NULL, *parallel = NULL;
+	size_t bytes, got = 0, done = 0;
+	off_t length;
+
+	mh = mpg123_new(NULL, &err);
+	if(mh == NULL) return -1;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0.);
+	mpg123_format_none(mh);
+	mpg123_format(mh, 44100, MPG123_MONO|MPG123_STEREO, encoding);
+	mpg123_format(mh, 22050, MPG123_MONO|MPG123_STEREO, encoding);
+	mpg123_format(mh, 48000, MPG123_MONO|MPG123_STEREO, encoding);
+	mpg123_format(mh, 32000, MPG123_MONO|MPG123_STEREO, encoding);
+
+	if(   mpg123_open(mh, path) != MPG123_OK
+	   || mpg123_getformat(mh, &rate, &channels, &enc) != MPG123_OK
+	   || mpg123_scan(mh) != MPG123_OK )
+	{
+		error1("cannot open: %s", mpg123_strerror(mh));
+		goto test_parallel_end;
+	}
+	length = mpg123_length(mh);
+	bytes = (size_t)length*channels*mpg123_encsize(enc);
+	serial   = malloc(bytes+mpg123_outblock(mh));
+	parallel = malloc(bytes);
+	if(serial == NULL || parallel == NULL) goto test_parallel_end;
+
+	do
+	{
+		size_t block = 0;
+		err = mpg123_read(mh, serial+got, mpg123_outblock(mh), &block);
+		got += block;
+	} while(err == MPG123_OK && got <= bytes);
+	if(err != MPG123_DONE)
+	{
+		error1("sequential decoding failed: %s", mpg123_strerror(mh));
+		goto test_parallel_end;
+	}
+	if(tap && (  mpg123_tap(mh, MPG123_TAP_SUBBANDS, silent_tap, NULL) != MPG123_OK
+	          || mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_TAP_ONLY, 0.) != MPG123_OK ))
+	{
+		error1("cannot set the tap: %s", mpg123_strerror(mh));
+		err = -1;
+		goto test_parallel_end;
+	}
+	err = mpg123_decode_parallel(mh, segments, parallel, bytes, &done);
+	if(err != MPG123_OK)
+	{
+		error1("parallel decoding failed: %s", mpg123_strerror(mh));
+		goto test_parallel_end;
+	}
+	fprintf(stderr, "%"SIZE_P" bytes sequential, %"SIZE_P" bytes parallel: "
+	,	(size_p)got, (size_p)done );
+	if(got == done && !memcmp(serial, parallel, done)) err = 0;
+	else err = -1;
+
+test_parallel_end:
+	if(serial)   free(serial);
+	if(parallel) free(parallel);
+	mpg123_delete(mh);
+	return err ? -1 : 0;
+}
+
+/* Layer III bitrates in kbit/s, MPEG 1 and 2/2.5. */
+static const int l3_kbps[2][15] =
+{
+	{ 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 }
+,	{ 0,  8, 16, 24, 32, 40, 48, 56,  64,  80,  96, 112, 128, 144, 160 }
+};
+
+/* 320 kbit/s at 32 kHz, with padding */
+#define MAXFRAME 1441
+
+struct l3frame
+{
+	unsigned long header;
+	unsigned char side[32];
+	size_t begin;  /* of the main data in the joined payloads */
+	size_t length; /* of the main data, without ancillary data after it */
+	size_t need;   /* reservoir this and the following frames need */
+};
+
+#define L3_LSF(h) (((h)>>19)&1 ? 0 : 1)
+#define L3_SSIZE(h) (L3_LSF(h) ? (((h)>>6)&3) == 3 ? 9 : 17 : (((h)>>6)&3) == 3 ? 17 : 32)
+
+/* Main data bytes in a frame with that header and bitrate index, 0 for a bad header. */
+static size_t l3_payload(unsigned long header, int bri)
+{
+	static const long freqs[4][3] =
+	{ { 11025, 12000, 8000 }, { 0, 0, 0 }, { 22050, 24000, 16000 }, { 44100, 48000, 32000 } };
+	int lsf = L3_LSF(header);
+	long freq = freqs[(header>>19)&3][(header>>10)&3];
+	if(freq == 0) return 0;
+	return (size_t)(l3_kbps[lsf][bri]*144000L/(freq<<lsf)) - 4 - L3_SSIZE(header);
+}
+
+/* Main data bytes from the part2_3_length of each granule and channel. */
+static size_t l3_length(unsigned long header, const unsigned char *side)
+{
+	int lsf = L3_LSF(header);
+	int channels = ((header>>6)&3) == 3 ? 1 : 2;
+	/* Behind main_data_begin, private bits and scfsi, 59 or 63 bits each. */
+	size_t pos = lsf ? 8+channels : 9+(channels == 1 ? 5 : 3)+4*channels;
+	size_t bits = 0;
+	int i, b;
+	for(i=0; i<(lsf ? 1 : 2)*channels; ++i, pos += lsf ? 63 : 59)
+	{
+		size_t part2_3 = 0;
+		for(b=0; b<12; ++b)
+		part2_3 = part2_3<<1 | (side[(pos+b)/8]>>(7-(pos+b)%8) & 1);
+		bits += part2_3;
+	}
+	return (bits+7)/8;
+}
+
+/*
+	Repack the Layer III frames of a file, each into the smallest frame that
+	keeps the bit reservoir full. That is a stream with variable bitrate and
+	main data reaching back as far as it can, decoding to the same samples.
+	The main data of all frames is joined first, then laid out again in the
+	new frames.
+	Returns 0 on success, 1 if the file is no plain Layer III stream.
+*/
+static int repack_vbr(const char *path, const char *vbrpath)
+{
+	int err = -1;
+	mpg123_handle *mh;
+	struct l3frame *frames = NULL;
+	size_t count = 0, size = 0;
+	unsigned char *data = NULL, *packed = NULL;
+	size_t fill = 0, datasize = 0, i;
+	size_t written = 0, pos = 0;
+	FILE *out = NULL;
+
+	if((mh = mpg123_new(NULL, NULL)) == NULL) return -1;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0.);
+	if(mpg123_open(mh, path) != MPG123_OK) goto repack_vbr_end;
+	while(1)
+	{
+		unsigned long header;
+		unsigned char *body;
+		size_t bytes, ssize, crc, mdb;
+		int ret = mpg123_framebyframe_next(mh);
+		if(ret == MPG123_DONE) break;
+		if(ret != MPG123_OK && ret != MPG123_NEW_FORMAT) goto repack_vbr_end;
+		if(mpg123_framedata(mh, &header, &body, &bytes) != MPG123_OK)
+		goto repack_vbr_end;
+		/* Layer III with a bitrate index, the others are not for this. */
+		if(((header>>17)&3) != 1 || ((header>>12)&0xf) == 0)
+		{
+			err = 1;
+			goto repack_vbr_end;
+		}
+		ssize = L3_SSIZE(header);
+		crc = (header>>16)&1 ? 0 : 2;
+		if(bytes < crc+ssize || l3_payload(header, 14) == 0) goto repack_vbr_end;
+		if(count == size)
+		{
+			struct l3frame *more = realloc(frames, (size = 2*size+256)*sizeof(*frames));
+			if(more == NULL) goto repack_vbr_end;
+			frames = more;
+		}
+		if(fill+bytes > datasize)
+		{
+			unsigned char *more = realloc(data, (datasize = 2*datasize+bytes));
+			if(more == NULL) goto repack_vbr_end;
+			data = more;
+		}
+		frames[count].header = header;
+		memcpy(frames[count].side, body+crc, ssize);
+		mdb = L3_LSF(header)
+		?	(size_t)body[crc]
+		:	(size_t)body[crc]<<1 | body[crc+1]>>7;
+		/* Main data from before the first frame is lost anyway. */
+		frames[count].begin = mdb > fill ? 0 : fill-mdb;
+		if(count && frames[count].begin < frames[count-1].begin)
+		frames[count].begin = frames[count-1].begin;
+		memcpy(data+fill, body+crc+ssize, bytes-crc-ssize);
+		fill += bytes-crc-ssize;
+		++count;
+	}
+	if(count == 0) goto repack_vbr_end;
+	for(i=0; i<count; ++i)
+	{
+		size_t end = i+1 < count ? frames[i+1].begin : fill;
+		frames[i].length = l3_length(frames[i].header, frames[i].side);
+		if(frames[i].length > end-frames[i].begin)
+		frames[i].length = end-frames[i].begin;
+	}
+	/* From the end: what the biggest frame cannot take has to be there before. */
+	for(i=count; i-- > 0;)
+	{
+		size_t later = i+1 < count ? frames[i+1].need : 0;
+		size_t max = l3_payload(frames[i].header, 14);
+		frames[i].need = frames[i].length+later > max
+		?	frames[i].length+later-max
+		:	0;
+		if(frames[i].need > (L3_LSF(frames[i].header) ? 255 : 511))
+		goto repack_vbr_end;
+	}
+	/* Up to the biggest frame each, the reservoir gap at the end included. */
+	if((packed = calloc(count+1, MAXFRAME)) == NULL) goto repack_vbr_end;
+	if((out = fopen(vbrpath, "wb")) == NULL) goto repack_vbr_end;
+	/* Main data written up to written, the payload of frame i begins at pos. */
+	for(i=0; i<count; ++i)
+	{
+		unsigned long header = frames[i].header;
+		size_t maxres = L3_LSF(header) ? 255 : 511;
+		size_t length = frames[i].length;
+		size_t later = i+1 < count ? frames[i+1].need : 0;
+		size_t mdb = pos-written;
+		size_t payload;
+		int bri;
+		/* The smallest frame that leaves the reservoir full, or else the
+		   biggest one, which still leaves what the next frames need. */
+		for(bri=1; bri<14; ++bri)
+		if(mdb+l3_payload(header, bri) >= length+maxres) break;
+		payload = l3_payload(header, bri);
+		if(mdb+payload < length+later) goto repack_vbr_end;
+		memcpy(packed+written, data+frames[i].begin, length);
+		written += length;
+		pos += payload;
+		if(pos-written > maxres) written = pos-maxres;
+		/* Same header with the new bitrate, without padding and CRC. */
+		frames[i].header = (header & ~(0xfUL<<12) & ~(1UL<<9)) | (unsigned long)bri<<12 | 1UL<<16;
+		if(L3_LSF(header)) frames[i].side[0] = (unsigned char)mdb;
+		else
+		{
+			frames[i].side[0] = (unsigned char)(mdb>>1);
+			frames[i].side[1] = (unsigned char)((frames[i].side[1]&0x7f) | (mdb&1)<<7);
+		}
+	}
+	/* Only now that the main data of later frames is in there, too. */
+	for(pos=0, i=0; i<count; ++i)
+	{
+		unsigned long header = frames[i].header;
+		size_t payload = l3_payload(header, (int)(header>>12)&0xf);
+		unsigned char head[4];
+		head[0] = (unsigned char)(header>>24);
+		head[1] = (unsigned char)(header>>16);
+		head[2] = (unsigned char)(header>>8);
+		head[3] = (unsigned char)header;
+		if(  fwrite(head, 4, 1, out) != 1
+		  || fwrite(frames[i].side, L3_SSIZE(header), 1, out) != 1
+		  || fwrite(packed+pos, payload, 1, out) != 1 )
+		goto repack_vbr_end;
+		pos += payload;
+	}
+	err = 0;
+repack_vbr_end:
+	if(out && fclose(out)) err = -1;
+	if(err == -1) error1("cannot repack to %s", vbrpath);
+	if(packed) free(packed);
+	if(data)   free(data);
+	if(frames) free(frames);
+	mpg123_delete(mh);
+	return err;
+}
+
+static int test_file(const char *path)
+{
+	int err = 0, errsum = 0;
+	int segments[] = { 1, 2, 7 };
+	int encodings[] = { MPG123_ENC_SIGNED_16, MPG123_ENC_FLOAT_32 };
+	size_t s, e;
+	for(e=0; e<sizeof(encodings)/sizeof(int); ++e)
+	for(s=0; s<sizeof(segments)/sizeof(int); ++s)
+	{
+		fprintf(stderr, "%s, encoding 0x%x, %i segments: ", path, encodings[e], segments[s]);
+		err = test_parallel(path, segments[s], encodings[e], 0);
+		fprintf(stdout, "%s\n", err == 0 ? "PASS" : "FAIL");
+		errsum += err;
+	}
+	fprintf(stderr, "%s, tap only, 2 segments: ", path);
+	err = test_parallel(path, 2, MPG123_ENC_SIGNED_16, 1);
+	fprintf(stdout, "%s\n", err == 0 ? "PASS" : "FAIL");
+	errsum += err;
+	return errsum;
+}
+
+/*
+	Usage: decode_parallel file [vbr file]
+	With a second name, the Layer III frames of the file are repacked to
+	variable bitrate into that file, which is tested, too.
+*/
+int main(int argc, char **argv)
+{
+	int errsum = 0;
+	if(argc < 2)
+	{
+		printf("Gimme a MPEG file name...\n");
+		return 0;
+	}
+	mpg123_init();
+	errsum += test_file(argv[1]);
+	if(argc > 2)
+	{
+		int err = repack_vbr(argv[1], argv[2]);
+		if(err == 1)
+		fprintf(stderr, "%s: no Layer III frames to repack\n", argv[1]);
+		else if(err)
+		errsum += err;
+		else
+		errsum += test_file(argv[2]);
+	}
+	mpg123_exit();
+	printf("%s\n", errsum ? "FAIL" : "PASS");
+	return errsum;
+}
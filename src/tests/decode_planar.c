@@ -0,0 +1,147 @@
+#include "compat.h"
+#include <mpg123.h>
+#include "debug.h"
+
+/*
+	Decode a file with interleaved and with planar output (MPG123_PLANAR),
+	frame by frame, and check that the planes hold the same samples.
+	Float output is compared with a little tolerance since a planar synth
+	may sum up in a different order for mono streams, relative to the sample
+	value as float can go far beyond full scale. mpg123_read() has to
+	refuse the planar output.
+*/
+
+static mpg123_handle *open_handle(const char *path, const char *decoder, int encoding, long flags)
+{
+	int err = MPG123_OK;
+	int channels, enc;
+	long rate;
+	mpg123_handle *mh = mpg123_new(decoder, &err);
+	if(mh == NULL) return NULL;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET|MPG123_GAPLESS|flags, 0.);
+	mpg123_format_none(mh);
+	mpg123_format(mh, 44100, MPG123_STEREO, encoding);
+	mpg123_format(mh, 22050, MPG123_STEREO, encoding);
+	mpg123_format(mh, 48000, MPG123_STEREO, encoding);
+	mpg123_format(mh, 32000, MPG123_STEREO, encoding);
+	if(   mpg123_open(mh, path) != MPG123_OK
+	   || mpg123_getformat(mh, &rate, &channels, &enc) != MPG123_OK )
+	{
+		error1("cannot open: %s", mpg123_strerror(mh));
+		mpg123_delete(mh);
+		return NULL;
+	}
+	return mh;
+}
+
+static int same_sample(const unsigned char *a, const unsigned char *b, int encoding)
+{
+	if(encoding == MPG123_ENC_FLOAT_32)
+	{
+		float fa, fb;
+		memcpy(&fa, a, sizeof(fa));
+		memcpy(&fb, b, sizeof(fb));
+		return fabs((double)fa-(double)fb) <= 1e-5*(1.+fabs((double)fa));
+	}
+	return !memcmp(a, b, mpg123_encsize(encoding));
+}
+
+int test_planar(const char *path, const char *decoder, int encoding)
+{
+	int err = -1, ierr, perr;
+	mpg123_handle *ih, *ph = NULL;
+	size_t size = mpg123_encsize(encoding);
+	long frames = 0;
+
+	ih = open_handle(path, decoder, encoding, 0);
+	if(ih == NULL) return -1;
+	ph = open_handle(path, decoder, encoding, MPG123_PLANAR);
+	if(ph == NULL) goto test_planar_end;
+
+	do
+	{
+		unsigned char *audio, *planes[2];
+		size_t ibytes = 0, pbytes = 0, i;
+		do ierr = mpg123_decode_frame(ih, NULL, &audio, &ibytes);
+		while(ierr == MPG123_NEW_FORMAT);
+		do perr = mpg123_decode_frame_planar(ph, NULL, planes, &pbytes);
+		while(perr == MPG123_NEW_FORMAT);
+		if(ierr != perr)
+		{
+			error2("return values differ: %i != %i", ierr, perr);
+			goto test_planar_end;
+		}
+		if(ierr != MPG123_OK) break;
+		if(ibytes != 2*pbytes)
+		{
+			error3("frame %li: %lu interleaved bytes, %lu per plane", frames
+			,	(unsigned long)ibytes, (unsigned long)pbytes);
+			goto test_planar_end;
+		}
+		for(i=0; i<pbytes/size; ++i)
+		{
+			if(   !same_sample(audio+2*i*size, planes[0]+i*size, encoding)
+			   || !same_sample(audio+(2*i+1)*size, planes[1]+i*size, encoding) )
+			{
+				error2("frame %li: mismatch at sample %lu", frames, (unsigned long)i);
+				goto test_planar_end;
+			}
+		}
+		++frames;
+	} while(1);
+	if(ierr == MPG123_DONE)
+	{
+		fprintf(stderr, "%li frames: ", frames);
+		err = 0;
+	}
+	else error1("decoding failed: %s", mpg123_strerror(ih));
+	if(err == 0)
+	{
+		unsigned char buf[1024];
+		size_t done;
+		mpg123_delete(ph);
+		if((ph = open_handle(path, decoder, encoding, MPG123_PLANAR)) == NULL)
+		err = -1;
+		else
+		{
+			do perr = mpg123_read(ph, buf, sizeof(buf), &done);
+			while(perr == MPG123_NEW_FORMAT);
+			if(perr != MPG123_ERR || mpg123_errcode(ph) != MPG123_PLANAR_OUTPUT)
+			{
+				error1("mpg123_read() with planar output returned %i", perr);
+				err = -1;
+			}
+		}
+	}
+
+test_planar_end:
+	mpg123_delete(ph);
+	mpg123_delete(ih);
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	int err = 0, errsum = 0;
+	int encodings[] = { MPG123_ENC_FLOAT_32, MPG123_ENC_SIGNED_16, MPG123_ENC_SIGNED_24 };
+	const char **decoders;
+	size_t d, e;
+	if(argc < 2)
+	{
+		printf("Gimme a MPEG file name...\n");
+		return 0;
+	}
+	mpg123_init();
+	decoders = mpg123_supported_decoders();
+	for(d=0; decoders[d] != NULL; ++d)
+	for(e=0; e<sizeof(encodings)/sizeof(int); ++e)
+	{
+		fprintf(stderr, "decoder %s, encoding 0x%x: ", decoders[d], encodings[e]);
+		err = test_planar(argv[1], decoders[d], encodings[e]);
+		fprintf(stdout, "%s\n", err == 0 ? "PASS" : "FAIL");
+		errsum += err;
+	}
+	mpg123_exit();
+	printf("%s\n", errsum ? "FAIL" : "PASS");
+	return errsum;
+}
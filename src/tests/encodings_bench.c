@@ -0,0 +1,98 @@
+#include "compat.h"
+#include <mpg123.h>
+#include <time.h>
+#include "debug.h"
+
+/*
+	Decoding time for each output encoding the library offers
+	(mpg123_encodings()), relative to signed 16 bit. The file is decoded
+	frame by frame at its native rate, best of several runs.
+	Usage: encodings_bench <file> [decoder] [runs]
+*/
+
+static double decode_time(const char *path, const char *decoder, int encoding, off_t *samples)
+{
+	int err = MPG123_OK;
+	int channels, enc;
+	long rate;
+	clock_t start;
+	double seconds = -1.;
+	unsigned char *audio;
+	size_t bytes;
+	mpg123_handle *mh = mpg123_new(decoder, &err);
+	if(mh == NULL) return -1.;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0.);
+	mpg123_format_none(mh);
+	mpg123_format(mh, 44100, MPG123_MONO|MPG123_STEREO, encoding);
+	mpg123_format(mh, 22050, MPG123_MONO|MPG123_STEREO, encoding);
+	mpg123_format(mh, 48000, MPG123_MONO|MPG123_STEREO, encoding);
+	mpg123_format(mh, 32000, MPG123_MONO|MPG123_STEREO, encoding);
+	if(   mpg123_open(mh, path) != MPG123_OK
+	   || mpg123_getformat(mh, &rate, &channels, &enc) != MPG123_OK )
+	{
+		error1("cannot open: %s", mpg123_strerror(mh));
+		goto decode_time_end;
+	}
+	*samples = 0;
+	start = clock();
+	while(  (err = mpg123_decode_frame(mh, NULL, &audio, &bytes)) == MPG123_OK
+	     || err == MPG123_NEW_FORMAT )
+	{
+		/* The channel count may change in the stream. */
+		if(err == MPG123_NEW_FORMAT)
+			mpg123_getformat(mh, &rate, &channels, &enc);
+		*samples += bytes/(channels*mpg123_encsize(enc));
+	}
+	if(err == MPG123_DONE)
+		seconds = (double)(clock()-start)/CLOCKS_PER_SEC;
+	else
+		error1("decoding failed: %s", mpg123_strerror(mh));
+
+decode_time_end:
+	mpg123_delete(mh);
+	return seconds;
+}
+
+int main(int argc, char **argv)
+{
+	const int *encodings;
+	size_t count, e;
+	const char *decoder = argc > 2 ? argv[2] : NULL;
+	int runs = argc > 3 ? atoi(argv[3]) : 5;
+	double base = 0.;
+	int errsum = 0;
+
+	if(argc < 2)
+	{
+		printf("Gimme a MPEG file name...\n");
+		return 0;
+	}
+	mpg123_init();
+	mpg123_encodings(&encodings, &count);
+	for(e=0; e<count; ++e)
+	{
+		double best = -1.;
+		off_t samples = 0;
+		int r;
+		for(r=0; r<runs; ++r)
+		{
+			double t = decode_time(argv[1], decoder, encodings[e], &samples);
+			if(t < 0.) break;
+			if(best < 0. || t < best) best = t;
+		}
+		if(best < 0.)
+		{
+			printf("encoding 0x%04x: FAIL\n", encodings[e]);
+			++errsum;
+			continue;
+		}
+		if(encodings[e] == MPG123_ENC_SIGNED_16) base = best;
+		printf( "encoding 0x%04x (%i bytes): %8.1f ms, %6.1f Msamples/s"
+		,	encodings[e], mpg123_encsize(encodings[e]), 1000.*best
+		,	best > 0. ? (double)samples/best/1e6 : 0. );
+		if(base > 0.) printf(", %.2f x s16", best/base);
+		printf("\n");
+	}
+	mpg123_exit();
+	return errsum;
+}
@@ -0,0 +1,176 @@
+#include "compat.h"
+#include <mpg123.h>
+#include "debug.h"
+
+/*
+	Decode a file fed in one go with mpg123_feed() and fed in pieces of random
+	size with mpg123_feed_borrowed() (every fourth one with mpg123_feed()).
+	The output has to be the same. Each borrowed piece has to be released
+	once, in order, and gets scribbled over then to catch later use.
+	Usage: feed_borrowed file...
+*/
+
+#define MAX_PIECE 65536
+
+struct piece
+{
+	long num;
+	size_t size;
+	unsigned char *data;
+};
+
+static long released, wrong_order;
+
+static void release_piece(void *handle)
+{
+	struct piece *p = handle;
+	if(p->num != released) ++wrong_order;
+	++released;
+	memset(p->data, 0xff, p->size);
+	free(p->data);
+	free(p);
+}
+
+static unsigned char *load_file(const char *path, size_t *size)
+{
+	unsigned char *data = NULL;
+	long len;
+	FILE *f = fopen(path, "rb");
+	if(f == NULL) return NULL;
+	if(  !fseek(f, 0, SEEK_END) && (len = ftell(f)) > 0 && !fseek(f, 0, SEEK_SET)
+	  && (data = malloc(len)) != NULL && fread(data, 1, len, f) != (size_t)len )
+	{
+		free(data);
+		data = NULL;
+	}
+	*size = data ? (size_t)len : 0;
+	fclose(f);
+	return data;
+}
+
+static mpg123_handle *new_handle(void)
+{
+	mpg123_handle *mh = mpg123_new(NULL, NULL);
+	if(mh == NULL) return NULL;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0.);
+	if(mpg123_open_feed(mh) != MPG123_OK)
+	{
+		mpg123_delete(mh);
+		return NULL;
+	}
+	return mh;
+}
+
+/* Decode what is there, return 0 on NEED_MORE or DONE. */
+static int drain(mpg123_handle *mh, unsigned char *out, size_t outsize, size_t *fill)
+{
+	int ret;
+	do
+	{
+		size_t got = 0;
+		ret = mpg123_read(mh, out+*fill, outsize-*fill, &got);
+		*fill += got;
+	} while((ret == MPG123_OK || ret == MPG123_NEW_FORMAT) && *fill < outsize);
+	return (ret == MPG123_NEED_MORE || ret == MPG123_DONE) ? 0 : -1;
+}
+
+int test_file(const char *path)
+{
+	int err = -1;
+	mpg123_handle *mh = NULL;
+	unsigned char *data, *ref = NULL, *out = NULL;
+	size_t size, pos, outsize, reffill = 0, fill = 0;
+	long pieces = 0;
+	unsigned long rnd = 4711;
+
+	if((data = load_file(path, &size)) == NULL)
+	{
+		error1("cannot load %s", path);
+		return -1;
+	}
+	/* Plenty for the decoded samples, even of Layer I at 8 kHz. */
+	outsize = size*2*4*6 + 1024*1024;
+	if(  (ref = malloc(outsize)) == NULL || (out = malloc(outsize)) == NULL
+	  || (mh = new_handle()) == NULL || mpg123_feed(mh, data, size) != MPG123_OK
+	  || drain(mh, ref, outsize, &reffill) )
+	{
+		error("reference decoding failed");
+		goto test_file_end;
+	}
+	mpg123_delete(mh);
+
+	released = wrong_order = 0;
+	if((mh = new_handle()) == NULL)
+	goto test_file_end;
+	for(pos = 0; pos < size; )
+	{
+		struct piece *p;
+		size_t part;
+		rnd = rnd*1103515245UL + 12345UL;
+		part = 1 + (rnd>>8) % MAX_PIECE;
+		if(part > size-pos) part = size-pos;
+		if(pieces % 4 == 3)
+		{
+			if(mpg123_feed(mh, data+pos, part) != MPG123_OK)
+			goto test_file_end;
+		}
+		else
+		{
+			if((p = malloc(sizeof(*p))) == NULL || (p->data = malloc(part)) == NULL)
+			goto test_file_end;
+			p->num  = pieces/4*3 + pieces%4;
+			p->size = part;
+			memcpy(p->data, data+pos, part);
+			if(mpg123_feed_borrowed(mh, p->data, part, release_piece, p) != MPG123_OK)
+			{
+				error1("feeding failed: %s", mpg123_strerror(mh));
+				goto test_file_end;
+			}
+		}
+		++pieces;
+		pos += part;
+		if(drain(mh, out, outsize, &fill))
+		{
+			error1("decoding failed: %s", mpg123_strerror(mh));
+			goto test_file_end;
+		}
+	}
+	mpg123_close(mh);
+	if(fill != reffill || memcmp(out, ref, fill))
+	error2("output differs (%lu vs. %lu bytes)", (unsigned long)fill, (unsigned long)reffill);
+	else if(released != pieces - pieces/4 || wrong_order)
+	error2("released %li of %li pieces, not all or not in order", released, pieces - pieces/4);
+	else
+	{
+		fprintf(stderr, "%li pieces: ", pieces);
+		err = 0;
+	}
+test_file_end:
+	if(mh) mpg123_delete(mh);
+	free(out);
+	free(ref);
+	free(data);
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	int err = 0, errsum = 0;
+	int i;
+	if(argc < 2)
+	{
+		printf("Gimme a MPEG file name...\n");
+		return 0;
+	}
+	mpg123_init();
+	for(i=1; i<argc; ++i)
+	{
+		fprintf(stderr, "%s: ", argv[i]);
+		err = test_file(argv[i]);
+		fprintf(stdout, "%s\n", err == 0 ? "PASS" : "FAIL");
+		errsum += err;
+	}
+	mpg123_exit();
+	printf("%s\n", errsum ? "FAIL" : "PASS");
+	return errsum;
+}
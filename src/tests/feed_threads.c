@@ -0,0 +1,219 @@
+#include "compat.h"
+#include <mpg123.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#include "debug.h"
+
+/*
+	Decode a file fed in one go and fed from another thread with
+	MPG123_CONCURRENT_FEED, in pieces of random size, copied and borrowed,
+	with little pauses. The decoding thread waits without limit and then
+	with a short timeout. The output has to be the same, all borrowed pieces
+	have to come back.
+	Usage: feed_threads file...
+*/
+
+#define MAX_PIECE 16384
+
+struct feeder
+{
+	mpg123_handle *mh;
+	const unsigned char *data;
+	size_t size;
+	int err;
+	long borrowed;
+};
+
+static long released;
+
+static void release_piece(void *handle)
+{
+	free(handle);
+	++released; /* Only the decoding thread calls that. */
+}
+
+static unsigned char *load_file(const char *path, size_t *size)
+{
+	unsigned char *data = NULL;
+	long len;
+	FILE *f = fopen(path, "rb");
+	if(f == NULL) return NULL;
+	if(  !fseek(f, 0, SEEK_END) && (len = ftell(f)) > 0 && !fseek(f, 0, SEEK_SET)
+	  && (data = malloc(len)) != NULL && fread(data, 1, len, f) != (size_t)len )
+	{
+		free(data);
+		data = NULL;
+	}
+	*size = data ? (size_t)len : 0;
+	fclose(f);
+	return data;
+}
+
+static mpg123_handle *new_handle(int concurrent, long wait)
+{
+	mpg123_handle *mh = mpg123_new(NULL, NULL);
+	if(mh == NULL) return NULL;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0.);
+	if(concurrent)
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_CONCURRENT_FEED, 0.);
+	mpg123_param(mh, MPG123_FEED_WAIT, wait, 0.);
+	if(mpg123_open_feed(mh) != MPG123_OK)
+	{
+		mpg123_delete(mh);
+		return NULL;
+	}
+	return mh;
+}
+
+#ifdef HAVE_PTHREAD_H
+static void *feed_thread(void *arg)
+{
+	struct feeder *fd = arg;
+	size_t pos = 0;
+	unsigned long rnd = 815;
+	while(pos < fd->size && !fd->err)
+	{
+		size_t part;
+		rnd = rnd*1103515245UL + 12345UL;
+		part = 1 + (rnd>>8) % MAX_PIECE;
+		if(part > fd->size-pos) part = fd->size-pos;
+		if(rnd & 0x10000)
+		{
+			unsigned char *piece = malloc(part);
+			if(piece == NULL)
+			{
+				fd->err = 1;
+				break;
+			}
+			memcpy(piece, fd->data+pos, part);
+			if(mpg123_feed_borrowed(fd->mh, piece, part, release_piece, piece) != MPG123_OK)
+			fd->err = 1;
+			++fd->borrowed;
+		}
+		else if(mpg123_feed(fd->mh, fd->data+pos, part) != MPG123_OK)
+		fd->err = 1;
+		pos += part;
+		if(!(rnd & 0x60000)) usleep(1000);
+	}
+	mpg123_feed_end(fd->mh);
+	return NULL;
+}
+
+/* Decode from the feeding thread until MPG123_DONE. */
+static int decode_fed(const unsigned char *data, size_t size, long wait, unsigned char *out, size_t outsize, size_t *fill)
+{
+	int ret = MPG123_OK;
+	pthread_t thread;
+	struct feeder fd;
+
+	released = 0;
+	fd.data = data;
+	fd.size = size;
+	fd.err = 0;
+	fd.borrowed = 0;
+	if((fd.mh = new_handle(1, wait)) == NULL) return -1;
+	if(pthread_create(&thread, NULL, feed_thread, &fd))
+	{
+		mpg123_delete(fd.mh);
+		return -1;
+	}
+	*fill = 0;
+	while(*fill < outsize)
+	{
+		size_t got = 0;
+		ret = mpg123_read(fd.mh, out+*fill, outsize-*fill, &got);
+		*fill += got;
+		if(ret == MPG123_NEED_MORE && wait < 0) break; /* Should not happen. */
+		if(ret != MPG123_OK && ret != MPG123_NEW_FORMAT && ret != MPG123_NEED_MORE) break;
+	}
+	pthread_join(thread, NULL);
+	mpg123_delete(fd.mh);
+	if(ret != MPG123_DONE || fd.err)
+	{
+		error1("decoding ended with %i", ret);
+		return -1;
+	}
+	if(released != fd.borrowed)
+	{
+		error2("released %li of %li borrowed pieces", released, fd.borrowed);
+		return -1;
+	}
+	fprintf(stderr, "%li borrowed: ", fd.borrowed);
+	return 0;
+}
+#endif
+
+int test_file(const char *path)
+{
+	int err = -1;
+	mpg123_handle *mh = NULL;
+	unsigned char *data, *ref = NULL, *out = NULL;
+	size_t size, outsize, reffill = 0, fill = 0;
+	long waits[2] = { -1, 1 };
+	int i;
+
+	if((data = load_file(path, &size)) == NULL)
+	{
+		error1("cannot load %s", path);
+		return -1;
+	}
+	/* Plenty for the decoded samples, even of Layer I at 8 kHz. */
+	outsize = size*2*4*6 + 1024*1024;
+	if(  (ref = malloc(outsize)) == NULL || (out = malloc(outsize)) == NULL
+	  || (mh = new_handle(0, 0)) == NULL || mpg123_feed(mh, data, size) != MPG123_OK )
+	goto test_file_end;
+	while(reffill < outsize)
+	{
+		size_t got = 0;
+		int ret = mpg123_read(mh, ref+reffill, outsize-reffill, &got);
+		reffill += got;
+		if(ret != MPG123_OK && ret != MPG123_NEW_FORMAT) break;
+	}
+#ifdef HAVE_PTHREAD_H
+	for(i=0; i<2; ++i)
+	{
+		if(decode_fed(data, size, waits[i], out, outsize, &fill))
+		goto test_file_end;
+		if(fill != reffill || memcmp(out, ref, fill))
+		{
+			error2("output differs (%lu vs. %lu bytes)", (unsigned long)fill, (unsigned long)reffill);
+			goto test_file_end;
+		}
+	}
+#endif
+	err = 0;
+test_file_end:
+	if(mh) mpg123_delete(mh);
+	free(out);
+	free(ref);
+	free(data);
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	int err = 0, errsum = 0;
+	int i;
+	if(argc < 2)
+	{
+		printf("Gimme a MPEG file name...\n");
+		return 0;
+	}
+	mpg123_init();
+	if(!mpg123_feature(MPG123_FEATURE_THREADS))
+	{
+		printf("No thread support, nothing to test.\n");
+		return 0;
+	}
+	for(i=1; i<argc; ++i)
+	{
+		fprintf(stderr, "%s: ", argv[i]);
+		err = test_file(argv[i]);
+		fprintf(stdout, "%s\n", err == 0 ? "PASS" : "FAIL");
+		errsum += err;
+	}
+	mpg123_exit();
+	printf("%s\n", errsum ? "FAIL" : "PASS");
+	return errsum;
+}
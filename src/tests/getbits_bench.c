@@ -0,0 +1,142 @@
+/*
+	getbits_bench: throughput of side info and scale factor parsing
+
+	Parses the field layout of MPEG 1 stereo Layer III side info plus long
+	block scale factors, and of Layer II scale factors, from a random buffer.
+	That is done once with the word reader from getbits.h and once with a
+	copy of the former byte-wise reader; both have to agree on the values.
+	Pass the number of passes over the buffer as argument for longer runs.
+*/
+
+#include "mpg123lib_intern.h"
+#include "getbits.h"
+#include <time.h>
+#include "debug.h"
+
+#define BUFSIZE 65536
+/* Enough for one round of fields from any position. */
+#define ROUND_BYTES 128
+
+/* The readers that getbits.h had before the 64 bit word loads. */
+static unsigned int old_getbits(mpg123_handle *fr, int number_of_bits)
+{
+	unsigned long rval;
+	rval = fr->wordpointer[0];
+	rval <<= 8;
+	rval |= fr->wordpointer[1];
+	rval <<= 8;
+	rval |= fr->wordpointer[2];
+	rval <<= fr->bitindex;
+	rval &= 0xffffff;
+	fr->bitindex += number_of_bits;
+	rval >>= (24-number_of_bits);
+	fr->wordpointer += (fr->bitindex>>3);
+	fr->bitindex &= 7;
+	return rval;
+}
+
+static unsigned int old_getbits_fast(mpg123_handle *fr, int number_of_bits)
+{
+	unsigned long rval;
+	rval = (unsigned char) (fr->wordpointer[0] << fr->bitindex);
+	rval |= ((unsigned long) fr->wordpointer[1]<<fr->bitindex)>>8;
+	rval <<= number_of_bits;
+	rval >>= 8;
+	fr->bitindex += number_of_bits;
+	fr->wordpointer += (fr->bitindex>>3);
+	fr->bitindex &= 7;
+	return rval;
+}
+
+/* One round: Layer III side info, 2x2 sets of scale factors, Layer II scale factors. */
+#define PARSE_ROUND(bits, bits_fast, fr, sum) \
+{ \
+	int gr, ch, i; \
+	sum += bits(fr, 9); \
+	sum += bits_fast(fr, 3); \
+	for(ch=0; ch<2; ++ch) \
+		sum += bits_fast(fr, 4); \
+	for(gr=0; gr<2; ++gr) \
+	for(ch=0; ch<2; ++ch) \
+	{ \
+		sum += bits(fr, 12); \
+		sum += bits(fr, 9); \
+		sum += bits_fast(fr, 8); \
+		sum += bits(fr, 4); \
+		sum += get1bit(fr); \
+		for(i=0; i<3; ++i) \
+			sum += bits_fast(fr, 5); \
+		sum += bits_fast(fr, 4); \
+		sum += bits_fast(fr, 3); \
+		sum += get1bit(fr); \
+		sum += get1bit(fr); \
+		sum += get1bit(fr); \
+	} \
+	for(gr=0; gr<2; ++gr) \
+	for(ch=0; ch<2; ++ch) \
+	{ \
+		for(i=0; i<11; ++i) \
+			sum += bits_fast(fr, 4); \
+		for(i=0; i<10; ++i) \
+			sum += bits_fast(fr, 3); \
+	} \
+	for(i=0; i<27; ++i) \
+	{ \
+		sum += bits_fast(fr, 2); \
+		sum += bits_fast(fr, 6); \
+		sum += bits_fast(fr, 6); \
+	} \
+}
+
+static unsigned char buf[BUFSIZE+BSBUF_PAD];
+static mpg123_handle handle;
+
+static double run(int old, long passes, unsigned long *sum, long *rounds)
+{
+	mpg123_handle *fr = &handle;
+	clock_t start = clock();
+	long p;
+	*sum = 0;
+	*rounds = 0;
+	for(p=0; p<passes; ++p)
+	{
+		fr->wordpointer = buf;
+		fr->bitindex = 0;
+		while(fr->wordpointer < buf+BUFSIZE-ROUND_BYTES)
+		{
+			if(old)
+				PARSE_ROUND(old_getbits, old_getbits_fast, fr, *sum)
+			else
+				PARSE_ROUND(getbits, getbits_fast, fr, *sum)
+			++*rounds;
+		}
+	}
+	return (double)(clock()-start)/CLOCKS_PER_SEC;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long seed = 2463534242UL;
+	unsigned long oldsum, newsum;
+	long oldrounds, newrounds;
+	long passes = argc > 1 ? atol(argv[1]) : 200;
+	double oldtime, newtime;
+	size_t i;
+
+	for(i=0; i<BUFSIZE; ++i)
+	{
+		seed = (seed*1103515245UL + 12345UL) & 0xffffffffUL;
+		buf[i] = (unsigned char)(seed>>16);
+	}
+	oldtime = run(1, passes, &oldsum, &oldrounds);
+	newtime = run(0, passes, &newsum, &newrounds);
+	printf("byte reader: %.1f MiB/s\n", (double)passes*BUFSIZE/(1024*1024)/oldtime);
+	printf("word reader: %.1f MiB/s\n", (double)passes*BUFSIZE/(1024*1024)/newtime);
+	if(oldsum != newsum || oldrounds != newrounds)
+	{
+		printf("FAIL: readers disagree\n");
+		return 1;
+	}
+	printf("PASS\n");
+	return 0;
+}
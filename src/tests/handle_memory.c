@@ -0,0 +1,126 @@
+/*
+	handle_memory: measure the memory a handle needs, fresh and while decoding
+
+	The struct size is taken from the internal header, the heap usage via
+	mallinfo(), where available. Handles are supposed to share the decoder
+	tables, so many handles decoding the same kind of stream should need
+	clearly less memory each than the first one alone. Builds without
+	thread support keep the tables per handle, there it is only reported.
+*/
+
+#include "mpg123lib_intern.h"
+#ifdef HAVE_MALLOC_H
+#include <malloc.h>
+#endif
+#include "debug.h"
+
+#define HANDLES 100
+/* Upper limit for a fresh handle, before it sees any stream. */
+#define FRESH_LIMIT 8192
+/* Minimum size of decoder tables shared among handles. */
+#define SHARED_MIN 8192
+
+#if defined(HAVE_MALLINFO2) || defined(HAVE_MALLINFO)
+#define HAVE_HEAPINFO
+static size_t heap_used(void)
+{
+#ifdef HAVE_MALLINFO2
+	struct mallinfo2 mi = mallinfo2();
+#else
+	struct mallinfo mi = mallinfo();
+#endif
+	return (size_t)mi.uordblks;
+}
+#endif
+
+/* Open and decode a bit of the file. */
+static int decode_some(mpg123_handle *mh, const char *path)
+{
+	unsigned char buf[4096];
+	size_t got = 0;
+	int ret;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0.);
+	if(mpg123_open(mh, path) != MPG123_OK) return -1;
+	do ret = mpg123_read(mh, buf, sizeof(buf), &got);
+	while(ret == MPG123_NEW_FORMAT);
+	return ret == MPG123_OK ? 0 : -1;
+}
+
+int main(int argc, char **argv)
+{
+	mpg123_handle *mh[HANDLES];
+	int i;
+	int err = 0;
+#ifdef HAVE_HEAPINFO
+	size_t start, fresh, first, decoding;
+#endif
+
+	fprintf(stderr, "handle struct: %"SIZE_P" bytes\n", (size_p)sizeof(mpg123_handle));
+	mpg123_init();
+#ifdef HAVE_HEAPINFO
+	start = heap_used();
+#endif
+	for(i=0; i<HANDLES; ++i)
+	{
+		mh[i] = mpg123_new(NULL, NULL);
+		if(mh[i] == NULL)
+		{
+			error("cannot create handle");
+			return -1;
+		}
+	}
+#ifdef HAVE_HEAPINFO
+	fresh = (heap_used()-start)/HANDLES;
+	fprintf(stderr, "fresh handle: %"SIZE_P" bytes\n", (size_p)fresh);
+	if(fresh > FRESH_LIMIT)
+	{
+		error2("fresh handle above %i bytes: %"SIZE_P, FRESH_LIMIT, (size_p)fresh);
+		err = -1;
+	}
+#else
+	fprintf(stderr, "no mallinfo(), cannot measure heap\n");
+#endif
+	if(argc > 1)
+	{
+#ifdef HAVE_HEAPINFO
+		size_t before = heap_used();
+#endif
+		/* The first one pays for the tables, the others should not. */
+		for(i=0; i<HANDLES; ++i)
+		{
+			if(decode_some(mh[i], argv[1]) != 0)
+			{
+				error1("cannot decode %s", argv[1]);
+				err = -1;
+				break;
+			}
+#ifdef HAVE_HEAPINFO
+			if(i == 0)
+			{
+				first = heap_used()-before;
+				before = heap_used();
+			}
+#endif
+		}
+#ifdef HAVE_HEAPINFO
+		if(i == HANDLES)
+		{
+			decoding = fresh+(heap_used()-before)/(HANDLES-1);
+			first += fresh;
+			fprintf( stderr, "first decoding handle: %"SIZE_P" bytes, others: %"SIZE_P" bytes\n"
+			,	(size_p)first, (size_p)decoding );
+			if(mpg123_feature(MPG123_FEATURE_THREADS) && decoding + SHARED_MIN > first)
+			{
+				error("decoding handles do not share tables");
+				err = -1;
+			}
+		}
+#endif
+	}
+	for(i=0; i<HANDLES; ++i)
+	mpg123_delete(mh[i]);
+	mpg123_exit();
+
+	printf("%s\n", err ? "FAIL" : "PASS");
+	return err;
+}
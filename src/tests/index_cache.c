@@ -0,0 +1,244 @@
+#include "compat.h"
+#include <mpg123.h>
+#include <time.h>
+#include "debug.h"
+
+/*
+	Scan a file with an index cache directory set, then open it again with
+	a fresh handle: length and frame index have to come out the same without
+	a scan. The explicit mpg123_index_save()/mpg123_index_load() are checked,
+	too, also with index files that have bogus track info (and a fitting
+	checksum): those have to be refused, the scan then has to find the same.
+	Usage: index_cache <cache directory> file...
+*/
+
+struct result
+{
+	off_t length;
+	off_t *offsets;
+	off_t step;
+	size_t fill;
+	double seconds;
+};
+
+static void result_free(struct result *res)
+{
+	if(res->offsets) free(res->offsets);
+	res->offsets = NULL;
+}
+
+/* Open with the cache directory and optional index file, record length and index. */
+static int info(const char *path, const char *dir, const char *load, const char *save, int scan, struct result *res)
+{
+	int err = -1;
+	off_t *offsets;
+	clock_t start;
+	mpg123_handle *mh = mpg123_new(NULL, NULL);
+	if(mh == NULL) return -1;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0.);
+	mpg123_param(mh, MPG123_INDEX_SIZE, -1000, 0.);
+	res->offsets = NULL;
+	start = clock();
+	if(   (dir != NULL && mpg123_index_cache(mh, dir) != MPG123_OK)
+	   || mpg123_open(mh, path) != MPG123_OK
+	   || (load != NULL && mpg123_index_load(mh, load) != MPG123_OK)
+	   || (scan && mpg123_scan(mh) != MPG123_OK)
+	   || (save != NULL && mpg123_index_save(mh, save) != MPG123_OK) )
+	{
+		error1("failure: %s", mpg123_strerror(mh));
+		goto info_end;
+	}
+	res->length = mpg123_length(mh);
+	res->seconds = (double)(clock()-start)/CLOCKS_PER_SEC;
+	if(mpg123_index(mh, &offsets, &res->step, &res->fill) != MPG123_OK)
+	goto info_end;
+	res->offsets = malloc(res->fill*sizeof(off_t)+1);
+	if(res->offsets == NULL) goto info_end;
+	memcpy(res->offsets, offsets, res->fill*sizeof(off_t));
+	err = 0;
+info_end:
+	mpg123_delete(mh);
+	return err;
+}
+
+static int same(const struct result *a, const struct result *b)
+{
+	if(a->length != b->length)
+	{
+		error2("length %"OFF_P"/%"OFF_P, (off_p)a->length, (off_p)b->length);
+		return 0;
+	}
+	if(a->step != b->step || a->fill != b->fill || memcmp(a->offsets, b->offsets, a->fill*sizeof(off_t)))
+	{
+		error("index differs");
+		return 0;
+	}
+	return 1;
+}
+
+/* Rewrite one 64 bit little endian field and the checksum at the end of the file. */
+static int patch_index(const char *idxfile, const char *bogus, int field, off_t val)
+{
+	unsigned char *buf = NULL;
+	size_t size = 0, fill = 0, n, i;
+	unsigned long hash = 2166136261UL;
+	int err = -1;
+	FILE *f = fopen(idxfile, "rb");
+	if(f == NULL) return -1;
+	do
+	{
+		if(fill == size)
+		{
+			unsigned char *more = realloc(buf, (size = 2*size+4096));
+			if(more == NULL) break;
+			buf = more;
+		}
+		n = fread(buf+fill, 1, size-fill, f);
+		fill += n;
+	} while(n > 0);
+	fclose(f);
+	if(fill < 8*(size_t)field+16) goto patch_index_end;
+	for(i=0; i<8; ++i, val >>= 8)
+	buf[8*field+i] = (unsigned char)(val & 0xff);
+	for(i=0; i<fill-8; ++i)
+	hash = ((hash ^ buf[i])*16777619UL) & 0xffffffffUL;
+	for(i=0; i<8; ++i, hash >>= 8)
+	buf[fill-8+i] = (unsigned char)(hash & 0xff);
+	if((f = fopen(bogus, "wb")) == NULL) goto patch_index_end;
+	if(fwrite(buf, 1, fill, f) == fill) err = 0;
+	if(fclose(f)) err = -1;
+patch_index_end:
+	free(buf);
+	return err;
+}
+
+static off_t get_field(const char *idxfile, int field)
+{
+	unsigned char b[8];
+	off_t val = 0;
+	int i;
+	FILE *f = fopen(idxfile, "rb");
+	if(f == NULL) return -1;
+	if(fseek(f, 8L*field, SEEK_SET) || fread(b, 1, 8, f) != 8)
+	memset(b, 0xff, 8);
+	fclose(f);
+	for(i=7; i>=0; --i)
+	val = val*256 + b[i];
+	return val;
+}
+
+/* Load an index file with one field changed, refused or not, then scan. */
+static int bogus_load(const char *path, const char *idxfile, const char *bogus, int field, off_t val, int refuse, const struct result *scanned)
+{
+	int err = -1, ret;
+	mpg123_handle *mh;
+	if(patch_index(idxfile, bogus, field, val) != 0)
+	{
+		error1("cannot write %s", bogus);
+		return -1;
+	}
+	if((mh = mpg123_new(NULL, NULL)) == NULL) return -1;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0.);
+	if(mpg123_open(mh, path) != MPG123_OK) goto bogus_load_end;
+	ret = mpg123_index_load(mh, bogus);
+	if(refuse ? (ret == MPG123_OK || mpg123_errcode(mh) != MPG123_BAD_INDEX_CACHE) : ret != MPG123_OK)
+	{
+		error3( "field %i set to %"OFF_P" %s", field, (off_p)val
+		,	refuse ? "was accepted" : "was refused" );
+		goto bogus_load_end;
+	}
+	if(mpg123_scan(mh) != MPG123_OK || mpg123_length(mh) != scanned->length)
+	{
+		error2("field %i set to %"OFF_P": wrong length after scan", field, (off_p)val);
+		goto bogus_load_end;
+	}
+	err = 0;
+bogus_load_end:
+	mpg123_delete(mh);
+	return err;
+}
+
+/* Field numbers in the cache file, see indexcache.c. */
+#define TRACK_FRAMES   6
+#define TRACK_SAMPLES  7
+#define GAPLESS_FRAMES 8
+#define BEGIN_S        9
+#define END_S         10
+#define INDEX_STEP    13
+#define INDEX_FILL    14
+
+static int test_bogus(const char *path, const char *idxfile, const struct result *scanned)
+{
+	int err = 0;
+	off_t frames  = get_field(idxfile, TRACK_FRAMES);
+	off_t samples = get_field(idxfile, TRACK_SAMPLES);
+	off_t end     = get_field(idxfile, END_S);
+	off_t step    = get_field(idxfile, INDEX_STEP);
+	off_t fill    = get_field(idxfile, INDEX_FILL);
+	char *bogus = malloc(strlen(idxfile)+7);
+	if(bogus == NULL) return -1;
+	sprintf(bogus, "%s.bogus", idxfile);
+	/* The unchanged values have to pass, or the patching is off. */
+	err += bogus_load(path, idxfile, bogus, TRACK_FRAMES, frames, 0, scanned);
+	err += bogus_load(path, idxfile, bogus, TRACK_FRAMES, -1, 1, scanned);
+	err += bogus_load(path, idxfile, bogus, TRACK_SAMPLES, -1, 1, scanned);
+	err += bogus_load(path, idxfile, bogus, GAPLESS_FRAMES, -2, 1, scanned);
+	err += bogus_load(path, idxfile, bogus, GAPLESS_FRAMES, frames+1, 1, scanned);
+	err += bogus_load(path, idxfile, bogus, BEGIN_S, -1, 1, scanned);
+	err += bogus_load(path, idxfile, bogus, BEGIN_S, end+1, 1, scanned);
+	err += bogus_load(path, idxfile, bogus, END_S, -1, 1, scanned);
+	err += bogus_load(path, idxfile, bogus, END_S, samples+100000, 1, scanned);
+	if(fill > 1)
+	err += bogus_load(path, idxfile, bogus, TRACK_FRAMES, (fill-1)*step, 1, scanned);
+	remove(bogus);
+	free(bogus);
+	return err ? -1 : 0;
+}
+
+int test_cache(const char *path, const char *dir)
+{
+	struct result scanned, cached, loaded;
+	char *idxfile;
+	int err = -1;
+	scanned.offsets = cached.offsets = loaded.offsets = NULL;
+	idxfile = malloc(strlen(dir)+12);
+	if(idxfile == NULL) return -1;
+	sprintf(idxfile, "%s/test.index", dir);
+	if(   !info(path, dir, NULL, idxfile, 1, &scanned)
+	   && !info(path, dir, NULL, NULL, 0, &cached)
+	   && !info(path, NULL, idxfile, NULL, 1, &loaded)
+	   && same(&scanned, &cached) && same(&scanned, &loaded)
+	   && !test_bogus(path, idxfile, &scanned) )
+	{
+		fprintf(stderr, "%"OFF_P" samples, scan %.3fs, cache %.3fs, index file %.3fs: "
+		,	(off_p)scanned.length, scanned.seconds, cached.seconds, loaded.seconds);
+		err = 0;
+	}
+	result_free(&scanned);
+	result_free(&cached);
+	result_free(&loaded);
+	free(idxfile);
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	int err = 0, errsum = 0;
+	int i;
+	if(argc < 3)
+	{
+		printf("Gimme a cache directory and MPEG file names...\n");
+		return 0;
+	}
+	mpg123_init();
+	for(i=2; i<argc; ++i)
+	{
+		fprintf(stderr, "%s: ", argv[i]);
+		err = test_cache(argv[i], argv[1]);
+		fprintf(stdout, "%s\n", err == 0 ? "PASS" : "FAIL");
+		errsum += err;
+	}
+	mpg123_exit();
+	printf("%s\n", errsum ? "FAIL" : "PASS");
+	return errsum;
+}
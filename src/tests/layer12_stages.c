@@ -0,0 +1,87 @@
+/*
+	layer12_stages: compare the SSE layer 1 and 2 dequantization with the C one
+
+	dequant12() and dequant12_x86_64() get the same random codes and factors,
+	for any number of rows and unaligned buffers, too. They do the very same
+	conversion and multiplication, so the results have to be identical.
+	This builds the layer 2 decoder code directly (with a dummy for the
+	outside function it needs), so it is for x86-64 only.
+*/
+
+#include "mpg123lib_intern.h"
+#include "debug.h"
+
+#define ROWS (3*SCALE_BLOCK)
+
+/* synth_blocks() is not called here. */
+void frame_tap(mpg123_handle *fr, struct mpg123_tap_data *td, const real *data, size_t count)
+{
+}
+
+static unsigned long seed = 2463534242UL;
+
+static unsigned long random_bits(void)
+{
+	seed ^= (seed << 13) & 0xffffffffUL;
+	seed ^= seed >> 17;
+	seed ^= (seed << 5) & 0xffffffffUL;
+	return seed;
+}
+
+/* Codes with the offset of the quantization applied, up to 16 bits. */
+static void random_codes(int *buf, size_t count)
+{
+	size_t i;
+	for(i=0; i<count; ++i)
+		buf[i] = (int)(random_bits() & 0x1ffff) - 0x10000;
+}
+
+/* Factors like the ones in fr->muls, 2 down to tiny. */
+static void random_factors(real *buf, size_t count)
+{
+	size_t i;
+	for(i=0; i<count; ++i)
+	{
+		unsigned long r = random_bits();
+		buf[i] = (real)((double)(r & 0xffff)/0x8000 / (double)(1UL << (r>>16)%20));
+	}
+}
+
+static size_t count_diff(const real *a, const real *b, size_t count)
+{
+	size_t i, n = 0;
+	for(i=0; i<count; ++i)
+		if(a[i] != b[i]) ++n;
+	return n;
+}
+
+static int test_dequant12(void)
+{
+	/* One extra value in front, for an unaligned start. */
+	int q[1+ROWS*SBLIMIT];
+	real cm[1+SBLIMIT], ref[1+ROWS*SBLIMIT], opt[1+ROWS*SBLIMIT];
+	size_t diff = 0;
+	int rows, off;
+	for(off=0; off<2; ++off)
+	for(rows=0; rows<=ROWS; ++rows)
+	{
+		random_codes(q, 1+ROWS*SBLIMIT);
+		random_factors(cm, 1+SBLIMIT);
+		/* What is beyond the rows has to stay as it is. */
+		random_factors(ref, 1+ROWS*SBLIMIT);
+		memcpy(opt, ref, sizeof(ref));
+		dequant12(ref+off, q+off, cm+off, rows);
+		dequant12_x86_64(opt+off, q+off, cm+off, rows);
+		diff += count_diff(ref, opt, 1+ROWS*SBLIMIT);
+	}
+	printf("%-12s %lu differing values\n", "dequant12", (unsigned long)diff);
+	return diff ? 1 : 0;
+}
+
+int main()
+{
+	int err = 0;
+	err += test_dequant12();
+	printf("%s\n", err ? "FAIL" : "PASS");
+	return err;
+}
@@ -0,0 +1,155 @@
+/*
+	layer3_stages: compare the SSE layer 3 stages with the generic C ones
+
+	Antialias, M/S stereo, dct12 and the hybrid tail get the same random
+	input in both versions, the results have to match up to float rounding.
+	This builds the layer 3 decoder code directly (with dummies for the
+	outside functions it needs), so it is for x86-64 only.
+*/
+
+#include "mpg123lib_intern.h"
+#include "debug.h"
+
+/* Tolerance relative to values around 1. */
+#define TOLERANCE 1e-5
+
+/* do_layer3() is not called here. */
+void set_pointer(mpg123_handle *fr, long backstep)
+{
+}
+
+void frame_tap(mpg123_handle *fr, struct mpg123_tap_data *td, const real *data, size_t count)
+{
+}
+
+static unsigned long seed = 2463534242UL;
+
+static real random_value(void)
+{
+	seed ^= (seed << 13) & 0xffffffffUL;
+	seed ^= seed >> 17;
+	seed ^= (seed << 5) & 0xffffffffUL;
+	return (real)((double)(seed & 0xffffff)/0x800000 - 1.);
+}
+
+static void randomize(real *buf, size_t count)
+{
+	size_t i;
+	for(i=0; i<count; ++i)
+		buf[i] = random_value();
+}
+
+static double max_diff(const real *a, const real *b, size_t count)
+{
+	double max = 0.;
+	size_t i;
+	for(i=0; i<count; ++i)
+	{
+		double d = fabs((double)a[i]-(double)b[i]);
+		if(d > max) max = d;
+	}
+	return max;
+}
+
+static int report(const char *name, double diff)
+{
+	int bad = !(diff <= TOLERANCE);
+	printf("%-12s max diff %g%s\n", name, diff, bad ? " (too large)" : "");
+	return bad;
+}
+
+static int test_antialias(void)
+{
+	real ref[SBLIMIT][SSLIMIT], opt[SBLIMIT][SSLIMIT];
+	double diff = 0., d;
+	int sblim;
+	for(sblim=0; sblim<SBLIMIT; ++sblim)
+	{
+		randomize(ref[0], SBLIMIT*SSLIMIT);
+		memcpy(opt, ref, sizeof(ref));
+		antialias(ref[1], sblim);
+		antialias_x86_64(opt[1], sblim);
+		d = max_diff(ref[0], opt[0], SBLIMIT*SSLIMIT);
+		if(d > diff) diff = d;
+	}
+	return report("antialias", diff);
+}
+
+static int test_stereo_ms(void)
+{
+	real ref[2][SBLIMIT*SSLIMIT], opt[2][SBLIMIT*SSLIMIT];
+	double diff = 0., d;
+	int count;
+	for(count=0; count<=SBLIMIT*SSLIMIT; ++count)
+	{
+		randomize(ref[0], 2*SBLIMIT*SSLIMIT);
+		memcpy(opt, ref, sizeof(ref));
+		stereo_ms(ref[0], ref[1], count);
+		stereo_ms_x86_64(opt[0], opt[1], count);
+		d = max_diff(ref[0], opt[0], 2*SBLIMIT*SSLIMIT);
+		if(d > diff) diff = d;
+	}
+	return report("stereo_ms", diff);
+}
+
+static int test_dct12(void)
+{
+	real in[SSLIMIT], wi[12];
+	real out1[SSLIMIT], ref2[SSLIMIT], opt2[SSLIMIT];
+	real refts[SSLIMIT*SBLIMIT], optts[SSLIMIT*SBLIMIT];
+	double diff = 0., d;
+	int i;
+	for(i=0; i<1000; ++i)
+	{
+		randomize(in, SSLIMIT);
+		randomize(wi, 12);
+		randomize(out1, SSLIMIT);
+		randomize(ref2, SSLIMIT);
+		memcpy(opt2, ref2, sizeof(ref2));
+		randomize(refts, SSLIMIT*SBLIMIT);
+		memcpy(optts, refts, sizeof(refts));
+		dct12(in, out1, ref2, wi, refts);
+		dct12_x86_64(in, out1, opt2, wi, optts);
+		d = max_diff(ref2, opt2, SSLIMIT);
+		if(d > diff) diff = d;
+		d = max_diff(refts, optts, SSLIMIT*SBLIMIT);
+		if(d > diff) diff = d;
+	}
+	return report("dct12", diff);
+}
+
+static int test_hybrid_tail(void)
+{
+	real out1[SBLIMIT*SSLIMIT], ref2[SBLIMIT*SSLIMIT], opt2[SBLIMIT*SSLIMIT];
+	real refts[SSLIMIT*SBLIMIT], optts[SSLIMIT*SBLIMIT];
+	double diff = 0., d;
+	int count;
+	for(count=0; count<=SBLIMIT; ++count)
+	{
+		int sb = SBLIMIT-count;
+		randomize(out1, SBLIMIT*SSLIMIT);
+		randomize(ref2, SBLIMIT*SSLIMIT);
+		memcpy(opt2, ref2, sizeof(ref2));
+		randomize(refts, SSLIMIT*SBLIMIT);
+		memcpy(optts, refts, sizeof(refts));
+		hybrid_tail(out1+sb*SSLIMIT, ref2+sb*SSLIMIT, refts+sb, count);
+		hybrid_tail_x86_64(out1+sb*SSLIMIT, opt2+sb*SSLIMIT, optts+sb, count);
+		d = max_diff(ref2, opt2, SBLIMIT*SSLIMIT);
+		if(d > diff) diff = d;
+		d = max_diff(refts, optts, SSLIMIT*SBLIMIT);
+		if(d > diff) diff = d;
+	}
+	return report("hybrid_tail", diff);
+}
+
+int main()
+{
+	int err = 0;
+	init_layer3();
+	err += test_antialias();
+	err += test_stereo_ms();
+	err += test_dct12();
+	err += test_hybrid_tail();
+	printf("%s\n", err ? "FAIL" : "PASS");
+	return err;
+}
@@ -0,0 +1,220 @@
+#include "compat.h"
+#include <mpg123.h>
+#include <math.h>
+#include "debug.h"
+
+/*
+	Decode a file with MPG123_LOUDNESS to float. The sample peak has to be
+	the one of the output, the true peak not below it, the integrated
+	loudness not above the momentary maximum and the gain has to go to
+	-18 LUFS. Half the volume and 16 bit output (if not clipped) have to
+	measure the same, as do the joined segments of mpg123_decode_parallel().
+	Storing the result as RVA has to set that gain. Without the flag, there
+	is no result.
+	Usage: loudness file...
+*/
+
+/* In LU, also for the relative peak difference (about 0.1 dB). */
+#define TOLERANCE 0.01
+#define TOLERANCE16 0.05
+
+static mpg123_handle *open_file(const char *path, int encoding, int flags, double volume)
+{
+	const long *rates;
+	size_t nrates, i;
+	mpg123_handle *mh = mpg123_new(NULL, NULL);
+	if(mh == NULL) return NULL;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET|flags, 0.);
+	mpg123_rates(&rates, &nrates);
+	mpg123_format_none(mh);
+	for(i=0; i<nrates; ++i)
+	mpg123_format(mh, rates[i], MPG123_MONO|MPG123_STEREO, encoding);
+	mpg123_volume(mh, volume);
+	if(mpg123_open(mh, path) != MPG123_OK)
+	{
+		mpg123_delete(mh);
+		return NULL;
+	}
+	return mh;
+}
+
+/* Decode with measurement and return the float peak of the output, -1 on error. */
+static double measure(const char *path, int encoding, double volume, struct mpg123_loudness *lr)
+{
+	double peak = 0.;
+	int ret;
+	mpg123_handle *mh = open_file(path, encoding, MPG123_LOUDNESS, volume);
+	if(mh == NULL) return -1.;
+	do
+	{
+		off_t num;
+		unsigned char *audio;
+		size_t bytes = 0, i;
+		ret = mpg123_decode_frame(mh, &num, &audio, &bytes);
+		if(encoding == MPG123_ENC_FLOAT_32)
+		for(i=0; i<bytes/sizeof(float); ++i)
+		{
+			float s = ((float*)audio)[i];
+			if(s > peak) peak = s;
+			if(-s > peak) peak = -s;
+		}
+	} while(ret == MPG123_OK || ret == MPG123_NEW_FORMAT);
+	if(ret != MPG123_DONE || mpg123_loudness(mh, lr) != MPG123_OK)
+	peak = -1.;
+	mpg123_delete(mh);
+	return peak;
+}
+
+static int differs(double a, double b, double tolerance)
+{
+	return a - b > tolerance || b - a > tolerance;
+}
+
+/* Same loudness, peaks relative to the ones of a. */
+static int same_loudness(struct mpg123_loudness *a, struct mpg123_loudness *b, double tolerance)
+{
+	return !(  differs(a->integrated, b->integrated, tolerance)
+	        || differs(a->momentary_max, b->momentary_max, tolerance)
+	        || differs(a->true_peak, b->true_peak, tolerance*a->true_peak) );
+}
+
+/* The parallel decoding measures the joined output. */
+static int measure_parallel(const char *path, struct mpg123_loudness *lr)
+{
+	int err = -1;
+	int channels, enc;
+	long rate;
+	off_t length;
+	size_t bytes, done = 0;
+	unsigned char *out = NULL;
+	mpg123_handle *mh = open_file(path, MPG123_ENC_FLOAT_32, MPG123_LOUDNESS, 1.);
+
+	if(  mh == NULL || mpg123_getformat(mh, &rate, &channels, &enc) != MPG123_OK
+	  || mpg123_scan(mh) != MPG123_OK || (length = mpg123_length(mh)) < 0 )
+	goto measure_parallel_end;
+	bytes = (size_t)length*channels*sizeof(float);
+	if(  (out = malloc(bytes)) != NULL
+	  && mpg123_decode_parallel(mh, 3, out, bytes, &done) == MPG123_OK
+	  && mpg123_loudness(mh, lr) == MPG123_OK )
+	err = 0;
+measure_parallel_end:
+	free(out);
+	if(mh) mpg123_delete(mh);
+	return err;
+}
+
+int test_file(const char *path)
+{
+	struct mpg123_loudness lr, other;
+	double peak, base, really, rva_db;
+	mpg123_handle *mh;
+
+	peak = measure(path, MPG123_ENC_FLOAT_32, 1., &lr);
+	if(peak < 0. || lr.seconds <= 0.)
+	{
+		error("cannot decode");
+		return -1;
+	}
+	if(  differs(lr.sample_peak, peak, 1e-6*peak)
+	  || lr.sample_peak - lr.true_peak > TOLERANCE*lr.sample_peak
+	  || lr.integrated - lr.momentary_max > TOLERANCE || lr.range < 0. )
+	{
+		error3("peaks %g (output %g), true %g or loudness out of order", lr.sample_peak, peak, lr.true_peak);
+		return -1;
+	}
+	if(differs(lr.gain, lr.integrated == -HUGE_VAL ? 0. : -18.-lr.integrated, 1e-9))
+	{
+		error2("gain %g for %g LUFS", lr.gain, lr.integrated);
+		return -1;
+	}
+	if(measure(path, MPG123_ENC_FLOAT_32, 0.5, &other) < 0.)
+	{
+		error("cannot decode at half volume");
+		return -1;
+	}
+	if(!same_loudness(&lr, &other, TOLERANCE))
+	{
+		error2("half volume measures %g instead of %g LUFS", other.integrated, lr.integrated);
+		return -1;
+	}
+	if(peak < 1.)
+	{
+		if(measure(path, MPG123_ENC_SIGNED_16, 1., &other) < 0.)
+		{
+			error("cannot decode to 16 bit");
+			return -1;
+		}
+		if(!same_loudness(&lr, &other, TOLERANCE16))
+		{
+			error2("16 bit output measures %g instead of %g LUFS", other.integrated, lr.integrated);
+			return -1;
+		}
+	}
+	if(measure_parallel(path, &other))
+	{
+		error("parallel decoding fails");
+		return -1;
+	}
+	if(!same_loudness(&lr, &other, TOLERANCE))
+	{
+		error2("parallel decoding measures %g instead of %g LUFS", other.integrated, lr.integrated);
+		return -1;
+	}
+
+	/* Only integer output to check that nothing happens without the flag. */
+	if((mh = open_file(path, MPG123_ENC_SIGNED_16, 0, 1.)) == NULL)
+	return -1;
+	if(mpg123_loudness(mh, &other) != MPG123_ERR || mpg123_errcode(mh) != MPG123_NO_LOUDNESS)
+	{
+		error("a result without MPG123_LOUDNESS");
+		mpg123_delete(mh);
+		return -1;
+	}
+	mpg123_delete(mh);
+	if(lr.integrated != -HUGE_VAL)
+	{
+		off_t num;
+		unsigned char *audio;
+		size_t bytes;
+		int ret;
+		if((mh = open_file(path, MPG123_ENC_FLOAT_32, MPG123_LOUDNESS, 1.)) == NULL)
+		return -1;
+		mpg123_param(mh, MPG123_RVA, MPG123_RVA_MIX, 0.);
+		while((ret = mpg123_decode_frame(mh, &num, &audio, &bytes)) == MPG123_OK || ret == MPG123_NEW_FORMAT)
+		;
+		ret = mpg123_loudness_rva(mh, MPG123_RVA_MIX);
+		if(  ret != MPG123_OK || mpg123_getvolume(mh, &base, &really, &rva_db) != MPG123_OK
+		  || differs(rva_db, lr.gain, 1e-3) )
+		{
+			error2("RVA gain %g instead of %g", rva_db, lr.gain);
+			mpg123_delete(mh);
+			return -1;
+		}
+		mpg123_delete(mh);
+	}
+	fprintf( stderr, "%g LUFS, %g LU, momentary %g, short-term %g, true peak %g, sample peak %g: "
+	,	lr.integrated, lr.range, lr.momentary_max, lr.short_term_max, lr.true_peak, lr.sample_peak );
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int err = 0, errsum = 0;
+	int i;
+	if(argc < 2)
+	{
+		printf("Gimme a MPEG file name...\n");
+		return 0;
+	}
+	mpg123_init();
+	for(i=1; i<argc; ++i)
+	{
+		fprintf(stderr, "%s: ", argv[i]);
+		err = test_file(argv[i]);
+		fprintf(stdout, "%s\n", err == 0 ? "PASS" : "FAIL");
+		errsum += err;
+	}
+	mpg123_exit();
+	printf("%s\n", errsum ? "FAIL" : "PASS");
+	return errsum;
+}
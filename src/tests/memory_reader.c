@@ -0,0 +1,155 @@
+#include "compat.h"
+#include <mpg123.h>
+#include "debug.h"
+
+/*
+	Decode a file read from disk, mapped with MPG123_MMAP and handed over
+	in memory with mpg123_open_memory(). Length, the full decoded output
+	and the output after seeking have to be the same for all of them.
+	Usage: memory_reader file...
+*/
+
+#define CHECK_BYTES 16384
+
+static unsigned char *load_file(const char *path, size_t *size)
+{
+	unsigned char *data = NULL;
+	long len;
+	FILE *f = fopen(path, "rb");
+	if(f == NULL) return NULL;
+	if(  !fseek(f, 0, SEEK_END) && (len = ftell(f)) > 0 && !fseek(f, 0, SEEK_SET)
+	  && (data = malloc(len)) != NULL && fread(data, 1, len, f) != (size_t)len )
+	{
+		free(data);
+		data = NULL;
+	}
+	*size = data ? (size_t)len : 0;
+	fclose(f);
+	return data;
+}
+
+/* 0: normal reader, 1: mapped file, 2: memory */
+static mpg123_handle *open_input(const char *path, int mode, const unsigned char *data, size_t size)
+{
+	int ret;
+	mpg123_handle *mh = mpg123_new(NULL, NULL);
+	if(mh == NULL) return NULL;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0.);
+	mpg123_param(mh, MPG123_INDEX_SIZE, -1000, 0.);
+	if(mode == 1)
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_MMAP, 0.);
+	ret = mode == 2 ? mpg123_open_memory(mh, data, size) : mpg123_open(mh, path);
+	if(ret != MPG123_OK || mpg123_scan(mh) != MPG123_OK)
+	{
+		error1("cannot open: %s", mpg123_strerror(mh));
+		mpg123_delete(mh);
+		return NULL;
+	}
+	return mh;
+}
+
+/* Decode up to size bytes, return the count. */
+static size_t decode(mpg123_handle *mh, unsigned char *out, size_t size)
+{
+	size_t fill = 0;
+	while(fill < size)
+	{
+		size_t got = 0;
+		int ret = mpg123_read(mh, out+fill, size-fill, &got);
+		fill += got;
+		if(ret != MPG123_OK && ret != MPG123_NEW_FORMAT) break;
+	}
+	return fill;
+}
+
+int test_file(const char *path)
+{
+	int err = -1;
+	int i, m;
+	mpg123_handle *mh[3] = { NULL, NULL, NULL };
+	unsigned char *data, *out[3] = { NULL, NULL, NULL };
+	size_t size, outsize, fill[3];
+	off_t length, frames, *offsets, step;
+	size_t entries;
+	unsigned long rnd = 815;
+
+	if((data = load_file(path, &size)) == NULL)
+	{
+		error1("cannot load %s", path);
+		return -1;
+	}
+	for(m=0; m<3; ++m)
+	if((mh[m] = open_input(path, m, data, size)) == NULL)
+	goto test_file_end;
+
+	length = mpg123_length(mh[0]);
+	if(mpg123_index(mh[0], &offsets, &step, &entries) != MPG123_OK) goto test_file_end;
+	frames = (off_t)entries*step;
+	outsize = (size_t)(length > 0 ? length : 0)*2*4 + mpg123_outblock(mh[0]);
+	for(m=0; m<3; ++m)
+	{
+		if(mpg123_length(mh[m]) != length || (out[m] = malloc(outsize)) == NULL)
+		{
+			error1("length differs for reader %i", m);
+			goto test_file_end;
+		}
+		fill[m] = decode(mh[m], out[m], outsize);
+		if(m && (fill[m] != fill[0] || memcmp(out[m], out[0], fill[0])))
+		{
+			error1("decoded output of reader %i differs", m);
+			goto test_file_end;
+		}
+	}
+	for(i=0; i<200 && frames > 0; ++i)
+	{
+		off_t frame;
+		rnd = rnd*1103515245UL + 12345UL;
+		frame = (off_t)((rnd>>8) % (unsigned long)frames);
+		for(m=0; m<3; ++m)
+		{
+			if(mpg123_seek_frame(mh[m], frame, SEEK_SET) != frame)
+			{
+				error2("seek to frame %li failed for reader %i", (long)frame, m);
+				goto test_file_end;
+			}
+			fill[m] = decode(mh[m], out[m], CHECK_BYTES);
+			if(m && (fill[m] != fill[0] || memcmp(out[m], out[0], fill[0])))
+			{
+				error2("output after seek to frame %li differs for reader %i", (long)frame, m);
+				goto test_file_end;
+			}
+		}
+	}
+	fprintf(stderr, "%li frames: ", (long)frames);
+	err = 0;
+test_file_end:
+	for(m=0; m<3; ++m)
+	{
+		if(mh[m])  mpg123_delete(mh[m]);
+		if(out[m]) free(out[m]);
+	}
+	free(data);
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	int err = 0, errsum = 0;
+	int i;
+	if(argc < 2)
+	{
+		printf("Gimme a MPEG file name...\n");
+		return 0;
+	}
+	mpg123_init();
+	for(i=1; i<argc; ++i)
+	{
+		fprintf(stderr, "%s: ", argv[i]);
+		err = test_file(argv[i]);
+		fprintf(stdout, "%s\n", err == 0 ? "PASS" : "FAIL");
+		errsum += err;
+	}
+	mpg123_exit();
+	printf("%s\n", errsum ? "FAIL" : "PASS");
+	return errsum;
+}
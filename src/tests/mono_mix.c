@@ -0,0 +1,127 @@
+#include "compat.h"
+#include <mpg123.h>
+#include "debug.h"
+
+/*
+	Decode a stereo file to float stereo and with MPG123_MONO_MIX to float
+	mono, frame by frame. The synthesis is linear, so for Layer I and II the
+	mono samples have to be the mean of left and right, up to rounding.
+	Layer III mixes before the hybrid filter bank, which uses the block type
+	of the left channel only, so block switching leaves some error there.
+	That has to stay small, also for M/S frames decoded from the mid channel
+	alone.
+	Usage: mono_mix file...
+*/
+
+#define TOLERANCE 1e-5
+/* Error to signal energy for Layer III. */
+#define TOLERANCE3 0.05
+
+static mpg123_handle *open_float(const char *path, int mix)
+{
+	const long *rates;
+	size_t count, i;
+	mpg123_handle *mh = mpg123_new(NULL, NULL);
+	if(mh == NULL) return NULL;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0.);
+	if(mix)
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_MONO_MIX, 0.);
+	mpg123_param(mh, MPG123_REMOVE_FLAGS, MPG123_GAPLESS, 0.);
+	mpg123_rates(&rates, &count);
+	mpg123_format_none(mh);
+	for(i=0; i<count; ++i)
+	mpg123_format(mh, rates[i], mix ? MPG123_MONO : MPG123_STEREO, MPG123_ENC_FLOAT_32);
+	if(mpg123_open(mh, path) != MPG123_OK)
+	{
+		error1("cannot open: %s", mpg123_strerror(mh));
+		mpg123_delete(mh);
+		return NULL;
+	}
+	return mh;
+}
+
+/* The next frame with output, 0 at the end. */
+static size_t next_frame(mpg123_handle *mh, float **out)
+{
+	int ret;
+	off_t num;
+	size_t bytes = 0;
+	do ret = mpg123_decode_frame(mh, &num, (unsigned char**)out, &bytes);
+	while(ret == MPG123_NEW_FORMAT || (ret == MPG123_OK && bytes == 0));
+	return ret == MPG123_OK ? bytes/sizeof(float) : 0;
+}
+
+int test_file(const char *path)
+{
+	int err = -1;
+	mpg123_handle *stereo = NULL, *mono = NULL;
+	long frames = 0, msframes = 0;
+	double maxdiff = 0., errsum = 0., sigsum = 0.;
+	int layer = 0;
+
+	if((stereo = open_float(path, 0)) == NULL || (mono = open_float(path, 1)) == NULL)
+	goto test_file_end;
+	while(1)
+	{
+		float *s, *m;
+		struct mpg123_frameinfo fi;
+		size_t ns = next_frame(stereo, &s);
+		size_t nm = next_frame(mono, &m);
+		size_t i;
+		if(ns != 2*nm)
+		{
+			error3("frame %li: %lu stereo and %lu mono samples", frames, (unsigned long)ns, (unsigned long)nm);
+			goto test_file_end;
+		}
+		if(nm == 0) break;
+		if(mpg123_info(mono, &fi) == MPG123_OK)
+		{
+			layer = fi.layer;
+			if(fi.mode == MPG123_M_JOINT && (fi.mode_ext & 0x2))
+			++msframes;
+		}
+		for(i=0; i<nm; ++i)
+		{
+			double mean = 0.5*(s[2*i]+s[2*i+1]);
+			double diff = m[i] - mean;
+			errsum += diff*diff;
+			sigsum += mean*mean;
+			if(diff < 0) diff = -diff;
+			if(diff > maxdiff) maxdiff = diff;
+		}
+		++frames;
+	}
+	if(  frames == 0 || (layer == 3 ? errsum > TOLERANCE3*sigsum : maxdiff > TOLERANCE) )
+	error3("%li frames, mono mix off by up to %g, error/signal %g", frames, maxdiff, sigsum > 0 ? errsum/sigsum : 0.);
+	else
+	{
+		fprintf(stderr, "%li frames, %li M/S, difference %g, error/signal %g: ", frames, msframes, maxdiff, sigsum > 0 ? errsum/sigsum : 0.);
+		err = 0;
+	}
+test_file_end:
+	if(mono) mpg123_delete(mono);
+	if(stereo) mpg123_delete(stereo);
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	int err = 0, errsum = 0;
+	int i;
+	if(argc < 2)
+	{
+		printf("Gimme a MPEG file name...\n");
+		return 0;
+	}
+	mpg123_init();
+	for(i=1; i<argc; ++i)
+	{
+		fprintf(stderr, "%s: ", argv[i]);
+		err = test_file(argv[i]);
+		fprintf(stdout, "%s\n", err == 0 ? "PASS" : "FAIL");
+		errsum += err;
+	}
+	mpg123_exit();
+	printf("%s\n", errsum ? "FAIL" : "PASS");
+	return errsum;
+}
@@ -0,0 +1,165 @@
+#include "compat.h"
+#include <mpg123.h>
+#include "debug.h"
+
+/*
+	Decode a file with and without MPG123_PIPELINE and require the same
+	output, for the whole track and after a number of seeks to random
+	positions, done on both handles alike. MPEG 2/2.5 Layer III streams
+	(and Layer I/II) are decoded serially in any case, they have to come
+	out the same just as well.
+	Usage: pipeline [-n seeks] file...
+*/
+
+#define CHECK_SAMPLES 4608
+
+static mpg123_handle *open_file(const char *path, int flags, int encoding)
+{
+	const long *rates;
+	size_t nrates, i;
+	mpg123_handle *mh = mpg123_new(NULL, NULL);
+	if(mh == NULL) return NULL;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET|flags, 0.);
+	mpg123_param(mh, MPG123_INDEX_SIZE, -1000, 0.);
+	mpg123_rates(&rates, &nrates);
+	mpg123_format_none(mh);
+	for(i=0; i<nrates; ++i)
+	mpg123_format(mh, rates[i], MPG123_MONO|MPG123_STEREO, encoding);
+	if(mpg123_open(mh, path) != MPG123_OK || mpg123_scan(mh) != MPG123_OK)
+	{
+		error1("cannot open: %s", mpg123_strerror(mh));
+		mpg123_delete(mh);
+		return NULL;
+	}
+	return mh;
+}
+
+/* Read up to size bytes, less only at the end of the track. */
+static size_t read_block(mpg123_handle *mh, unsigned char *out, size_t size, int *err)
+{
+	size_t fill = 0;
+	do
+	{
+		size_t got = 0;
+		*err = mpg123_read(mh, out+fill, size-fill, &got);
+		fill += got;
+	} while(fill < size && (*err == MPG123_OK || *err == MPG123_NEW_FORMAT));
+	return fill;
+}
+
+static int same_block(const char *what, unsigned char *a, size_t fa, unsigned char *b, size_t fb)
+{
+	if(fa != fb)
+	{
+		error3("%s: %"SIZE_P" bytes serial, %"SIZE_P" pipelined", what, (size_p)fa, (size_p)fb);
+		return 0;
+	}
+	if(memcmp(a, b, fa))
+	{
+		error1("%s: output differs", what);
+		return 0;
+	}
+	return 1;
+}
+
+int test_pipeline(const char *path, int encoding, long seeks)
+{
+	int err = -1, serr, perr;
+	mpg123_handle *serial = NULL, *piped = NULL;
+	unsigned char *sbuf = NULL, *pbuf = NULL;
+	size_t sfill, pfill, framebytes, size;
+	struct mpg123_frameinfo fi;
+	off_t length;
+	long rate, i;
+	int channels, enc;
+	unsigned long rnd = 54321;
+	char what[64];
+
+	if(  (serial = open_file(path, 0, encoding)) == NULL
+	  || (piped  = open_file(path, MPG123_PIPELINE, encoding)) == NULL
+	  || mpg123_getformat(serial, &rate, &channels, &enc) != MPG123_OK
+	  || mpg123_info(serial, &fi) != MPG123_OK )
+	goto test_pipeline_end;
+	length = mpg123_length(serial);
+	if(length <= 0 || mpg123_length(piped) != length)
+	{
+		error("lengths differ");
+		goto test_pipeline_end;
+	}
+	framebytes = channels*mpg123_encsize(enc);
+	size = (size_t)length*framebytes + mpg123_outblock(serial);
+	sbuf = malloc(size);
+	pbuf = malloc(size);
+	if(sbuf == NULL || pbuf == NULL) goto test_pipeline_end;
+
+	sfill = read_block(serial, sbuf, size, &serr);
+	pfill = read_block(piped,  pbuf, size, &perr);
+	if(serr != MPG123_DONE || perr != MPG123_DONE)
+	{
+		error2("decoding failed: %s / %s", mpg123_strerror(serial), mpg123_strerror(piped));
+		goto test_pipeline_end;
+	}
+	if(!same_block("whole track", sbuf, sfill, pbuf, pfill))
+	goto test_pipeline_end;
+	for(i=0; i<seeks; ++i)
+	{
+		off_t pos;
+		rnd = rnd*1103515245UL + 12345UL;
+		pos = (off_t)((rnd>>8) % (unsigned long)length);
+		if(  mpg123_seek(serial, pos, SEEK_SET) != pos
+		  || mpg123_seek(piped,  pos, SEEK_SET) != pos )
+		{
+			error1("seek to %"OFF_P" failed", (off_p)pos);
+			goto test_pipeline_end;
+		}
+		sfill = read_block(serial, sbuf, CHECK_SAMPLES*framebytes, &serr);
+		pfill = read_block(piped,  pbuf, CHECK_SAMPLES*framebytes, &perr);
+		sprintf(what, "after seek to %"OFF_P, (off_p)pos);
+		if(!same_block(what, sbuf, sfill, pbuf, pfill))
+		goto test_pipeline_end;
+	}
+	fprintf( stderr, "MPEG %s Layer %i, %"OFF_P" samples, %li seeks: "
+	,	fi.version == MPG123_1_0 ? "1" : fi.version == MPG123_2_0 ? "2" : "2.5"
+	,	fi.layer, (off_p)length, seeks );
+	err = 0;
+test_pipeline_end:
+	free(sbuf);
+	free(pbuf);
+	if(serial) mpg123_delete(serial);
+	if(piped)  mpg123_delete(piped);
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	int err = 0, errsum = 0;
+	int encodings[] = { MPG123_ENC_SIGNED_16, MPG123_ENC_FLOAT_32 };
+	long seeks = 50;
+	int i;
+	size_t e;
+	if(argc > 2 && !strcmp(argv[1], "-n"))
+	{
+		seeks = atol(argv[2]);
+		argc -= 2;
+		argv += 2;
+	}
+	if(argc < 2)
+	{
+		printf("Gimme a MPEG file name...\n");
+		return 0;
+	}
+	mpg123_init();
+	if(!mpg123_feature(MPG123_FEATURE_THREADS))
+	fprintf(stderr, "no thread support, MPG123_PIPELINE is ignored\n");
+	for(i=1; i<argc; ++i)
+	for(e=0; e<sizeof(encodings)/sizeof(int); ++e)
+	{
+		fprintf(stderr, "%s, encoding 0x%x: ", argv[i], encodings[e]);
+		err = test_pipeline(argv[i], encodings[e], seeks);
+		fprintf(stdout, "%s\n", err == 0 ? "PASS" : "FAIL");
+		errsum += err;
+	}
+	mpg123_exit();
+	printf("%s\n", errsum ? "FAIL" : "PASS");
+	return errsum;
+}
@@ -0,0 +1,180 @@
+#include "compat.h"
+#include <mpg123.h>
+#include "debug.h"
+
+/*
+	Decode a file with the Layer III Huffman lookup tables and with the plain
+	tree walk (MPG123_PLAIN_HUFFMAN) side by side and require the same output,
+	block for block, as well as the same return codes. Besides the file as it
+	is, copies with flipped bits and truncated copies are fed in, where the
+	decoders meet broken codes, overlong big_values and part2_3_length
+	running out in the middle of a code.
+	Usage: plain_huffman file...
+*/
+
+#define BLOCK 4608
+
+static unsigned long rnd_next(unsigned long *rnd)
+{
+	*rnd = *rnd*1103515245UL + 12345UL;
+	return (*rnd>>8) & 0xffffff;
+}
+
+static mpg123_handle *feed_handle(int flags)
+{
+	const long *rates;
+	size_t nrates, i;
+	mpg123_handle *mh = mpg123_new(NULL, NULL);
+	if(mh == NULL) return NULL;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET|flags, 0.);
+	/* Float shows any difference, where the build has it. */
+	mpg123_rates(&rates, &nrates);
+	mpg123_format_none(mh);
+	for(i=0; i<nrates; ++i)
+	if(mpg123_format(mh, rates[i], MPG123_MONO|MPG123_STEREO, MPG123_ENC_FLOAT_32) != MPG123_OK)
+	{
+		mpg123_format_all(mh);
+		break;
+	}
+	if(mpg123_open_feed(mh) != MPG123_OK)
+	{
+		mpg123_delete(mh);
+		return NULL;
+	}
+	return mh;
+}
+
+/* Decode both ways in lockstep, 0 if everything came out the same. */
+static int compare(const char *what, const unsigned char *data, size_t size)
+{
+	int err = -1;
+	mpg123_handle *tab, *plain = NULL;
+	unsigned char *tabout = NULL, *plainout = NULL;
+	size_t total = 0;
+	int tret, pret;
+
+	if(  (tab = feed_handle(0)) == NULL
+	  || (plain = feed_handle(MPG123_PLAIN_HUFFMAN)) == NULL
+	  || (tabout = malloc(BLOCK*8)) == NULL
+	  || (plainout = malloc(BLOCK*8)) == NULL )
+	{
+		error1("%s: cannot set up the decoders", what);
+		goto compare_end;
+	}
+	if(  mpg123_feed(tab, data, size) != MPG123_OK || mpg123_feed_end(tab) != MPG123_OK
+	  || mpg123_feed(plain, data, size) != MPG123_OK || mpg123_feed_end(plain) != MPG123_OK )
+	{
+		error1("%s: cannot feed", what);
+		goto compare_end;
+	}
+	do
+	{
+		size_t tgot = 0, pgot = 0;
+		tret = mpg123_read(tab, tabout, BLOCK*8, &tgot);
+		pret = mpg123_read(plain, plainout, BLOCK*8, &pgot);
+		if(tret != pret || tgot != pgot || memcmp(tabout, plainout, tgot))
+		{
+			error4( "%s: differs after %"SIZE_P" bytes (return codes %i/%i)"
+			,	what, (size_p)total, tret, pret );
+			goto compare_end;
+		}
+		total += tgot;
+	} while(tret == MPG123_OK || tret == MPG123_NEW_FORMAT);
+	if(tret != MPG123_DONE && mpg123_errcode(tab) != mpg123_errcode(plain))
+	{
+		error3( "%s: errors differ: %s / %s", what
+		,	mpg123_strerror(tab), mpg123_strerror(plain) );
+		goto compare_end;
+	}
+	err = 0;
+compare_end:
+	free(plainout);
+	free(tabout);
+	if(plain) mpg123_delete(plain);
+	if(tab)   mpg123_delete(tab);
+	return err;
+}
+
+int test_file(const char *path)
+{
+	int errsum = 0;
+	FILE *in;
+	unsigned char *data = NULL, *copy = NULL;
+	size_t size = 0, fill = 0, i, n;
+	unsigned long rnd = 4711;
+	char what[64];
+
+	if((in = fopen(path, "rb")) == NULL)
+	{
+		error1("cannot open %s", path);
+		return -1;
+	}
+	do
+	{
+		if(fill == size)
+		{
+			unsigned char *more = realloc(data, (size = 2*size+65536));
+			if(more == NULL) break;
+			data = more;
+		}
+		n = fread(data+fill, 1, size-fill, in);
+		fill += n;
+	} while(n > 0);
+	fclose(in);
+	if(fill == 0 || (copy = malloc(fill)) == NULL)
+	{
+		error("cannot read the file");
+		free(data);
+		return -1;
+	}
+
+	errsum += compare("intact", data, fill);
+	/* Flipped bits or random bytes, one in 100 or in 1000. */
+	for(n=0; n<4; ++n)
+	{
+		memcpy(copy, data, fill);
+		for(i=0; i<fill/(n < 2 ? 100 : 1000); ++i)
+		{
+			size_t pos = (size_t)(((double)rnd_next(&rnd)/0x1000000)*fill);
+			if(n % 2)
+			copy[pos] = (unsigned char)rnd_next(&rnd);
+			else
+			copy[pos] ^= (unsigned char)(1 << (rnd_next(&rnd) % 8));
+		}
+		sprintf(what, "damaged %i", (int)n);
+		errsum += compare(what, copy, fill);
+	}
+	/* Cut at some odd positions, also in the middle of a frame. */
+	for(n=1; n<4; ++n)
+	{
+		size_t cut = fill/4*n + n*137;
+		if(cut >= fill) break;
+		sprintf(what, "truncated to %"SIZE_P, (size_p)cut);
+		errsum += compare(what, data, cut);
+	}
+	free(copy);
+	free(data);
+	return errsum ? -1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+	int err = 0, errsum = 0;
+	int i;
+	if(argc < 2)
+	{
+		printf("Gimme a MPEG file name...\n");
+		return 0;
+	}
+	mpg123_init();
+	for(i=1; i<argc; ++i)
+	{
+		fprintf(stderr, "%s: ", argv[i]);
+		err = test_file(argv[i]);
+		fprintf(stdout, "%s\n", err == 0 ? "PASS" : "FAIL");
+		errsum += err;
+	}
+	mpg123_exit();
+	printf("%s\n", errsum ? "FAIL" : "PASS");
+	return errsum;
+}
@@ -0,0 +1,195 @@
+#include "compat.h"
+#include <mpg123.h>
+#include <sys/wait.h>
+#include "debug.h"
+
+/*
+	Decode a file with and without MPG123_READAHEAD: directly, after seeks
+	and through a pipe that a child process fills slowly. The output has to
+	be the same; reading from the slow pipe has to show stalls.
+	Usage: readahead file...
+*/
+
+#define CHECK_BYTES 9216
+#define READAHEAD   65536
+
+static mpg123_handle *new_handle(long readahead)
+{
+	mpg123_handle *mh = mpg123_new(NULL, NULL);
+	if(mh == NULL) return NULL;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0.);
+	mpg123_param(mh, MPG123_READAHEAD, readahead, 0.);
+	return mh;
+}
+
+/* Decode up to size bytes, return the count. */
+static size_t decode(mpg123_handle *mh, unsigned char *out, size_t size)
+{
+	size_t fill = 0;
+	while(fill < size)
+	{
+		size_t got = 0;
+		int ret = mpg123_read(mh, out+fill, size-fill, &got);
+		fill += got;
+		if(ret != MPG123_OK && ret != MPG123_NEW_FORMAT) break;
+	}
+	return fill;
+}
+
+/* Child writing the file to the pipe in small pieces with pauses. */
+static void slow_writer(const char *path, int fd)
+{
+	char buf[8192];
+	size_t got;
+	FILE *f = fopen(path, "rb");
+	if(f != NULL)
+	{
+		while((got = fread(buf, 1, sizeof(buf), f)) > 0)
+		{
+			if(write(fd, buf, got) != (ssize_t)got) break;
+			usleep(2000);
+		}
+		fclose(f);
+	}
+	close(fd);
+	_exit(0);
+}
+
+static int test_pipe(const char *path, const unsigned char *ref, size_t reffill, unsigned char *out)
+{
+	int err = -1;
+	int fds[2];
+	pid_t pid;
+	long stalls = 0;
+	mpg123_handle *mh;
+
+	if(pipe(fds)) return -1;
+	if((pid = fork()) < 0) return -1;
+	if(pid == 0)
+	{
+		close(fds[0]);
+		slow_writer(path, fds[1]);
+	}
+	close(fds[1]);
+	if(  (mh = new_handle(READAHEAD)) != NULL
+	  && mpg123_open_fd(mh, fds[0]) == MPG123_OK )
+	{
+		size_t fill = decode(mh, out, reffill+mpg123_outblock(mh));
+		mpg123_getstate(mh, MPG123_READAHEAD_STALLS, &stalls, NULL);
+		if(fill != reffill || memcmp(out, ref, fill))
+		error("output from pipe differs");
+		else if(stalls < 1)
+		error("no stalls from slow pipe");
+		else
+		{
+			fprintf(stderr, "%li stalls on pipe: ", stalls);
+			err = 0;
+		}
+	}
+	if(mh) mpg123_delete(mh);
+	close(fds[0]);
+	waitpid(pid, NULL, 0);
+	return err;
+}
+
+int test_file(const char *path)
+{
+	int err = -1;
+	int i, m;
+	mpg123_handle *mh[2];
+	unsigned char *out[2] = { NULL, NULL };
+	size_t outsize, fill[2];
+	off_t length;
+	long bufferfill = 0;
+	unsigned long rnd = 4711;
+
+	mh[0] = new_handle(0);
+	mh[1] = new_handle(READAHEAD);
+	for(m=0; m<2; ++m)
+	if(mh[m] == NULL || mpg123_open(mh[m], path) != MPG123_OK || mpg123_scan(mh[m]) != MPG123_OK)
+	{
+		error1("cannot open: %s", mh[m] ? mpg123_strerror(mh[m]) : "no handle");
+		goto test_file_end;
+	}
+	length = mpg123_length(mh[0]);
+	if(length <= 0 || mpg123_length(mh[1]) != length)
+	{
+		error("length differs");
+		goto test_file_end;
+	}
+	outsize = (size_t)length*2*4 + mpg123_outblock(mh[0]);
+	for(m=0; m<2; ++m)
+	{
+		if((out[m] = malloc(outsize)) == NULL) goto test_file_end;
+		fill[m] = decode(mh[m], out[m], outsize);
+	}
+	if(fill[1] != fill[0] || memcmp(out[1], out[0], fill[0]))
+	{
+		error("output with readahead differs");
+		goto test_file_end;
+	}
+	/* Seeks to anywhere, also just a bit back and forth. */
+	for(i=0; i<200; ++i)
+	{
+		off_t pos;
+		size_t part[2];
+		rnd = rnd*1103515245UL + 12345UL;
+		pos = (i % 3 == 2)
+		?	mpg123_tell(mh[0]) - (off_t)((rnd>>8) % 3000)
+		:	(off_t)((rnd>>8) % (unsigned long)length);
+		if(pos < 0) pos = 0;
+		for(m=0; m<2; ++m)
+		{
+			if(mpg123_seek(mh[m], pos, SEEK_SET) != pos)
+			{
+				error1("seek to %li failed", (long)pos);
+				goto test_file_end;
+			}
+			part[m] = decode(mh[m], out[m], CHECK_BYTES);
+		}
+		if(part[1] != part[0] || memcmp(out[1], out[0], part[0]))
+		{
+			error1("output after seek to %li differs", (long)pos);
+			goto test_file_end;
+		}
+	}
+	mpg123_getstate(mh[1], MPG123_READAHEAD_FILL, &bufferfill, NULL);
+	if(bufferfill < 0 || bufferfill > READAHEAD)
+	{
+		error1("bad readahead fill %li", bufferfill);
+		goto test_file_end;
+	}
+	/* Reference output for the pipe test, from the start again. */
+	if(mpg123_seek(mh[0], 0, SEEK_SET) != 0) goto test_file_end;
+	fill[0] = decode(mh[0], out[0], outsize);
+	err = test_pipe(path, out[0], fill[0], out[1]);
+test_file_end:
+	for(m=0; m<2; ++m)
+	{
+		if(mh[m])  mpg123_delete(mh[m]);
+		if(out[m]) free(out[m]);
+	}
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	int err = 0, errsum = 0;
+	int i;
+	if(argc < 2)
+	{
+		printf("Gimme a MPEG file name...\n");
+		return 0;
+	}
+	mpg123_init();
+	for(i=1; i<argc; ++i)
+	{
+		fprintf(stderr, "%s: ", argv[i]);
+		err = test_file(argv[i]);
+		fprintf(stdout, "%s\n", err == 0 ? "PASS" : "FAIL");
+		errsum += err;
+	}
+	mpg123_exit();
+	printf("%s\n", errsum ? "FAIL" : "PASS");
+	return errsum;
+}
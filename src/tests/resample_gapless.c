@@ -0,0 +1,104 @@
+#include "compat.h"
+#include <mpg123.h>
+#include "debug.h"
+
+/*
+	Decode a file in gapless mode at some forced output rates, with every
+	resampling quality, and require mpg123_length() to be the number of
+	samples that actually come out, as well as mpg123_tell() at the end.
+	The windowed-sinc filters delay the output, the gapless code has to
+	skip and flush just as much for this to hold. A file with gapless info
+	(a LAME/Info tag) is what tests the interesting part.
+	Usage: resample_gapless file...
+*/
+
+static const long test_rates[] = { 48000, 44100, 32000, 11000, 8000 };
+
+int test_resample(const char *path, int quality, long rate)
+{
+	int err = -1, ret;
+	mpg123_handle *mh;
+	unsigned char *buf = NULL;
+	size_t bufsize, got;
+	off_t length, samples = 0;
+	long outrate;
+	int channels, enc;
+
+	if((mh = mpg123_new(NULL, NULL)) == NULL) return -1;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET|MPG123_GAPLESS, 0.);
+	ret = mpg123_param(mh, MPG123_RESAMPLE, quality, 0.);
+	if(ret != MPG123_OK && mpg123_errcode(mh) == MPG123_MISSING_FEATURE)
+	{
+		/* No windowed-sinc filters in fixed point builds. */
+		fprintf(stderr, "not in this build, ");
+		err = 0;
+		goto test_resample_end;
+	}
+	if(ret != MPG123_OK || mpg123_param(mh, MPG123_FORCE_RATE, rate, 0.) != MPG123_OK)
+	{
+		error1("cannot set up resampling: %s", mpg123_strerror(mh));
+		goto test_resample_end;
+	}
+	if(  mpg123_open(mh, path) != MPG123_OK || mpg123_scan(mh) != MPG123_OK
+	  || mpg123_getformat(mh, &outrate, &channels, &enc) != MPG123_OK )
+	{
+		error1("cannot open: %s", mpg123_strerror(mh));
+		goto test_resample_end;
+	}
+	if(outrate != rate)
+	{
+		error2("output rate %li instead of %li", outrate, rate);
+		goto test_resample_end;
+	}
+	length = mpg123_length(mh);
+	bufsize = mpg123_outblock(mh);
+	if(length <= 0 || (buf = malloc(bufsize)) == NULL)
+		goto test_resample_end;
+	do
+	{
+		got = 0;
+		ret = mpg123_read(mh, buf, bufsize, &got);
+		samples += (off_t)(got/(channels*mpg123_encsize(enc)));
+	} while(ret == MPG123_OK || ret == MPG123_NEW_FORMAT);
+	if(ret != MPG123_DONE)
+	{
+		error1("decoding failed: %s", mpg123_strerror(mh));
+		goto test_resample_end;
+	}
+	if(samples != length || mpg123_tell(mh) != length)
+	{
+		error3( "length %"OFF_P", %"OFF_P" samples delivered, ending at %"OFF_P
+		,	(off_p)length, (off_p)samples, (off_p)mpg123_tell(mh) );
+		goto test_resample_end;
+	}
+	err = 0;
+test_resample_end:
+	free(buf);
+	mpg123_delete(mh);
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	int err = 0, errsum = 0;
+	int quality, i;
+	size_t r;
+	if(argc < 2)
+	{
+		printf("Gimme a MPEG file name...\n");
+		return 0;
+	}
+	mpg123_init();
+	for(i=1; i<argc; ++i)
+	for(quality=MPG123_RESAMPLE_NTOM; quality<=MPG123_RESAMPLE_MAX; ++quality)
+	for(r=0; r<sizeof(test_rates)/sizeof(*test_rates); ++r)
+	{
+		fprintf(stderr, "%s, quality %i, %li Hz: ", argv[i], quality, test_rates[r]);
+		err = test_resample(argv[i], quality, test_rates[r]);
+		fprintf(stdout, "%s\n", err == 0 ? "PASS" : "FAIL");
+		errsum += err;
+	}
+	mpg123_exit();
+	printf("%s\n", errsum ? "FAIL" : "PASS");
+	return errsum;
+}
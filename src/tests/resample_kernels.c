@@ -0,0 +1,133 @@
+/*
+	resample_kernels: compare the SSE and AVX resampler filter kernels with the C one
+
+	The coefficient tables are set up by resample_setup() for every quality
+	and some up- and downsampling ratios (the latter have longer filters).
+	Each phase row gets random input samples and a random fraction, the
+	kernels sum up in a different order, so the results have to match up
+	to float rounding, relative to the sum of the magnitudes of the terms.
+	This builds the resampler code directly (with dummies for the outside
+	functions it needs), so it is for x86-64 only. The AVX kernel is tested
+	where it is built (not with yasm) and the CPU has AVX.
+*/
+
+#include "mpg123lib_intern.h"
+#if defined(OPT_AVX) && defined(OPT_MULTI)
+#include "getcpuflags.h"
+#endif
+#include "debug.h"
+
+/* Relative to the sum of |x*coef|. */
+#define TOLERANCE 1e-5
+
+static long native_rate;
+
+long frame_freq(mpg123_handle *fr)
+{
+	return native_rate;
+}
+
+/* resample_flush() is not called here. */
+off_t decoder_synth_bytes(mpg123_handle *fr, off_t s)
+{
+	return 0;
+}
+
+static unsigned long seed = 2463534242UL;
+
+static real random_value(void)
+{
+	seed ^= (seed << 13) & 0xffffffffUL;
+	seed ^= seed >> 17;
+	seed ^= (seed << 5) & 0xffffffffUL;
+	return (real)((double)(seed & 0xffffff)/0x800000 - 1.);
+}
+
+typedef real (*fir_func)(const real *, const real *, int, real);
+
+/* Largest difference to the C kernel over all rows of the table, relative. */
+static double test_table(mpg123_handle *fr, fir_func fir)
+{
+	int taps = fr->rs_taps;
+	/* One more in front for unaligned input. */
+	real *x = malloc(sizeof(real)*(taps+1));
+	double diff = 0.;
+	int p, i, off;
+	if(x == NULL) return 1.;
+	for(off=0; off<2; ++off)
+	for(p=0; p<=fr->rs_phases; ++p)
+	{
+		const real *coef = fr->rs_coef + (size_t)p*2*taps;
+		real frac = (random_value()+1)/2;
+		double ref, opt, mag = 0.;
+		for(i=0; i<taps+1; ++i)
+			x[i] = random_value();
+		for(i=0; i<taps; ++i)
+		{
+			double t = (double)x[off+i]*(coef[i]+frac*coef[taps+i]);
+			mag += t < 0 ? -t : t;
+		}
+		ref = resample_fir(x+off, coef, taps, frac);
+		opt = fir(x+off, coef, taps, frac);
+		if(mag > 0. && (ref-opt)/mag > diff) diff = (ref-opt)/mag;
+		if(mag > 0. && (opt-ref)/mag > diff) diff = (opt-ref)/mag;
+	}
+	free(x);
+	return diff;
+}
+
+static int test_kernel(const char *name, fir_func fir)
+{
+	/* Native and output rates, up, a little down and far down. */
+	static const long rates[][2] =
+	{ { 44100, 48000 }, { 48000, 44100 }, { 44100, 16000 }, { 48000, 8000 }, { 48000, 4000 } };
+	mpg123_handle *fr = calloc(1, sizeof(mpg123_handle));
+	double diff = 0.;
+	int quality, bad;
+	size_t r;
+	if(fr == NULL) return 1;
+	fr->p.flags = MPG123_QUIET;
+	for(quality=MPG123_RESAMPLE_LOW; quality<=MPG123_RESAMPLE_MAX; ++quality)
+	for(r=0; r<sizeof(rates)/sizeof(*rates); ++r)
+	{
+		double d;
+		native_rate = rates[r][0];
+		fr->af.rate = rates[r][1];
+		fr->p.resample = quality;
+		if(resample_setup(fr) != 0 || fr->rs_taps <= 0)
+		{
+			error3("no filter for quality %i, %li to %li Hz", quality, rates[r][0], rates[r][1]);
+			diff = 1.;
+			continue;
+		}
+		d = test_table(fr, fir);
+		if(d > diff) diff = d;
+	}
+	if(fr->rs_buffer) free(fr->rs_buffer);
+	free(fr);
+	bad = !(diff <= TOLERANCE);
+	printf("%-12s max relative diff %g%s\n", name, diff, bad ? " (too large)" : "");
+	return bad;
+}
+
+int main()
+{
+	int err = 0;
+	err += test_kernel("x86_64", resample_fir_x86_64);
+#if defined(OPT_AVX) && !defined(USE_YASM_FOR_AVX)
+	{
+		int have_avx = 1;
+#ifdef OPT_MULTI
+		struct cpuflags cf;
+		getcpuflags(&cf);
+		have_avx = cpu_avx(cf);
+#endif
+		if(have_avx)
+		err += test_kernel("avx", resample_fir_avx);
+		else
+		printf("%-12s skipped, no AVX\n", "avx");
+	}
+#endif
+	printf("%s\n", err ? "FAIL" : "PASS");
+	return err;
+}
@@ -0,0 +1,125 @@
+#include "compat.h"
+#include <mpg123.h>
+#include <time.h>
+#include "debug.h"
+
+/*
+	Scan files with the full parser (MPG123_FULL_SCAN), with the header scan
+	and with the header scan on threads. Length and frame index have to be
+	identical, the processor times (summed over threads) are printed for
+	comparison.
+	Usage: scan_headers [-t threads] [-i index_size] file...
+*/
+
+struct result
+{
+	off_t length;
+	off_t *offsets;
+	off_t step;
+	size_t fill;
+	double seconds;
+};
+
+static int scan(const char *path, long flags, long threads, long index_size, struct result *res)
+{
+	int err = -1;
+	off_t *offsets;
+	clock_t start;
+	mpg123_handle *mh = mpg123_new(NULL, NULL);
+	if(mh == NULL) return -1;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET|flags, 0.);
+	mpg123_param(mh, MPG123_SCAN_THREADS, threads, 0.);
+	mpg123_param(mh, MPG123_INDEX_SIZE, index_size, 0.);
+	if(mpg123_open(mh, path) != MPG123_OK)
+	{
+		error1("cannot open: %s", mpg123_strerror(mh));
+		goto scan_end;
+	}
+	start = clock();
+	if(mpg123_scan(mh) != MPG123_OK)
+	{
+		error1("scan failed: %s", mpg123_strerror(mh));
+		goto scan_end;
+	}
+	res->seconds = (double)(clock()-start)/CLOCKS_PER_SEC;
+	res->length = mpg123_length(mh);
+	if(mpg123_index(mh, &offsets, &res->step, &res->fill) != MPG123_OK)
+	{
+		error1("no index: %s", mpg123_strerror(mh));
+		goto scan_end;
+	}
+	res->offsets = malloc(res->fill*sizeof(off_t));
+	if(res->offsets == NULL) goto scan_end;
+	memcpy(res->offsets, offsets, res->fill*sizeof(off_t));
+	err = 0;
+scan_end:
+	mpg123_delete(mh);
+	return err;
+}
+
+static int same(const struct result *a, const struct result *b)
+{
+	if(a->length != b->length)
+	{
+		error2("length %"OFF_P"/%"OFF_P, (off_p)a->length, (off_p)b->length);
+		return 0;
+	}
+	if(a->step != b->step || a->fill != b->fill)
+	{
+		error4( "index step %"OFF_P"/%"OFF_P", fill %lu/%lu"
+		,	(off_p)a->step, (off_p)b->step, (unsigned long)a->fill, (unsigned long)b->fill );
+		return 0;
+	}
+	if(memcmp(a->offsets, b->offsets, a->fill*sizeof(off_t)))
+	{
+		error("index offsets differ");
+		return 0;
+	}
+	return 1;
+}
+
+int test_scan(const char *path, long threads, long index_size)
+{
+	struct result full, fast, par;
+	int err = -1;
+	full.offsets = fast.offsets = par.offsets = NULL;
+	if(   !scan(path, MPG123_FULL_SCAN, 1, index_size, &full)
+	   && !scan(path, 0, 1, index_size, &fast)
+	   && !scan(path, 0, threads, index_size, &par)
+	   && same(&full, &fast) && same(&full, &par) )
+	{
+		fprintf(stderr, "%"OFF_P" samples, full %.3fs, headers %.3fs, %li threads %.3fs: "
+		,	(off_p)full.length, full.seconds, fast.seconds, threads, par.seconds);
+		err = 0;
+	}
+	if(full.offsets) free(full.offsets);
+	if(fast.offsets) free(fast.offsets);
+	if(par.offsets)  free(par.offsets);
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	int err = 0, errsum = 0;
+	long threads = 4;
+	long index_size = -1000; /* growing, to have all of the file */
+	int i = 1;
+	if(i+1 < argc && !strcmp(argv[i], "-t")){ threads = atol(argv[i+1]); i += 2; }
+	if(i+1 < argc && !strcmp(argv[i], "-i")){ index_size = atol(argv[i+1]); i += 2; }
+	if(i >= argc)
+	{
+		printf("Gimme a MPEG file name...\n");
+		return 0;
+	}
+	mpg123_init();
+	for(; i<argc; ++i)
+	{
+		fprintf(stderr, "%s: ", argv[i]);
+		err = test_scan(argv[i], threads, index_size);
+		fprintf(stdout, "%s\n", err == 0 ? "PASS" : "FAIL");
+		errsum += err;
+	}
+	mpg123_exit();
+	printf("%s\n", errsum ? "FAIL" : "PASS");
+	return errsum;
+}
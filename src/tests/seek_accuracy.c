@@ -0,0 +1,139 @@
+#include "compat.h"
+#include <mpg123.h>
+#include <time.h>
+#include "debug.h"
+
+/*
+	Decode a file in one go, then seek to a number of positions and compare
+	what comes after each seek with the continuous decode. Any difference is
+	a failure. The processor time per seek (including decoding the first
+	block after it) is printed as seek latency.
+	All supported decoders are tested, as their synths differ in how they
+	keep the state that seeking has to restore, unless one is given. The
+	dithering ones are left out, their noise does not repeat.
+	Usage: seek_accuracy [-n seeks] [-d decoder] file...
+*/
+
+#define CHECK_SAMPLES 4608
+
+static mpg123_handle *open_file(const char *path, const char *decoder)
+{
+	mpg123_handle *mh = mpg123_new(decoder, NULL);
+	if(mh == NULL) return NULL;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0.);
+	mpg123_param(mh, MPG123_INDEX_SIZE, -1000, 0.);
+	if(mpg123_open(mh, path) != MPG123_OK || mpg123_scan(mh) != MPG123_OK)
+	{
+		error1("cannot open: %s", mpg123_strerror(mh));
+		mpg123_delete(mh);
+		return NULL;
+	}
+	return mh;
+}
+
+int test_seeks(const char *path, const char *decoder, long seeks)
+{
+	int err = -1;
+	mpg123_handle *mh;
+	unsigned char *whole = NULL, *part = NULL;
+	size_t fill = 0, size, framebytes;
+	off_t length;
+	long rate, i, exact = 0;
+	int channels, encoding, spf;
+	unsigned long rnd = 12345;
+	clock_t ticks = 0;
+
+	if((mh = open_file(path, decoder)) == NULL) return -1;
+	if(mpg123_getformat(mh, &rate, &channels, &encoding) != MPG123_OK)
+	goto test_seeks_end;
+	length = mpg123_length(mh);
+	/* Samples per frame, for seeks to frame starts (of the output, without gapless trimming). */
+	if((spf = mpg123_spf(mh)) <= 0)
+	goto test_seeks_end;
+	framebytes = channels*mpg123_encsize(encoding);
+	size = (size_t)length*framebytes + mpg123_outblock(mh);
+	whole = malloc(size);
+	part  = malloc(CHECK_SAMPLES*framebytes);
+	if(whole == NULL || part == NULL || length <= 0) goto test_seeks_end;
+	while(fill < size)
+	{
+		size_t got = 0;
+		int ret = mpg123_read(mh, whole+fill, size-fill, &got);
+		fill += got;
+		if(ret == MPG123_DONE) break;
+		if(ret != MPG123_OK) goto test_seeks_end;
+	}
+	for(i=0; i<seeks; ++i)
+	{
+		off_t pos, want;
+		size_t got = 0;
+		clock_t start;
+		/* Some frame starts and some in between. */
+		rnd = rnd*1103515245UL + 12345UL;
+		pos = (off_t)((rnd>>8) % (unsigned long)length);
+		if(i % 4 == 0) pos -= pos % spf;
+		want = (off_t)fill/framebytes - pos;
+		if(want > CHECK_SAMPLES) want = CHECK_SAMPLES;
+		start = clock();
+		if(mpg123_seek(mh, pos, SEEK_SET) != pos)
+		{
+			error2("seek to %"OFF_P" failed: %s", (off_p)pos, mpg123_strerror(mh));
+			goto test_seeks_end;
+		}
+		while(got < (size_t)want*framebytes)
+		{
+			size_t block = 0;
+			int ret = mpg123_read(mh, part+got, (size_t)want*framebytes-got, &block);
+			got += block;
+			if(ret != MPG123_OK) break;
+		}
+		ticks += clock()-start;
+		if(got == (size_t)want*framebytes && !memcmp(part, whole+pos*framebytes, got))
+		++exact;
+		else
+		debug2("mismatch after seek to %"OFF_P" (%lu bytes)", (off_p)pos, (unsigned long)got);
+	}
+	fprintf(stderr, "%li/%li seeks exact, %.3f ms per seek: "
+	,	exact, seeks, 1000.*ticks/CLOCKS_PER_SEC/(seeks > 0 ? seeks : 1));
+	if(exact == seeks) err = 0;
+test_seeks_end:
+	if(whole) free(whole);
+	if(part)  free(part);
+	mpg123_delete(mh);
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	int err = 0, errsum = 0;
+	long seeks = 200;
+	const char *decoder = NULL;
+	const char **decoders;
+	int i = 1, d;
+	for(; i+1 < argc; i += 2)
+	{
+		if(!strcmp(argv[i], "-n")) seeks = atol(argv[i+1]);
+		else if(!strcmp(argv[i], "-d")) decoder = argv[i+1];
+		else break;
+	}
+	if(i >= argc)
+	{
+		printf("Gimme a MPEG file name...\n");
+		return 0;
+	}
+	mpg123_init();
+	decoders = mpg123_supported_decoders();
+	for(; i<argc; ++i)
+	for(d=0; decoder ? d == 0 : decoders[d] != NULL; ++d)
+	{
+		const char *dec = decoder ? decoder : decoders[d];
+		if(!decoder && strstr(dec, "dither")) continue;
+		fprintf(stderr, "%s (%s): ", argv[i], dec);
+		err = test_seeks(argv[i], dec, seeks);
+		fprintf(stdout, "%s\n", err == 0 ? "PASS" : "FAIL");
+		errsum += err;
+	}
+	mpg123_exit();
+	printf("%s\n", errsum ? "FAIL" : "PASS");
+	return errsum;
+}
@@ -0,0 +1,69 @@
+/*
+	startup: time the library setup and the first decoded block
+
+	This is where the decoder tables get computed, unless they are built in
+	as constants (PRECALC_TABLES). Build once with and once without
+	-DNO_PRECALC_TABLES in CPPFLAGS to see the difference. Only the first
+	run in a process is interesting, so there is no loop in here: repeat
+	the program itself for more samples.
+*/
+
+#include "mpg123lib_intern.h"
+#include <time.h>
+#include "debug.h"
+
+static double elapsed_us(clock_t start)
+{
+	return 1e6*(double)(clock()-start)/CLOCKS_PER_SEC;
+}
+
+int main(int argc, char **argv)
+{
+	mpg123_handle *mh;
+	unsigned char buf[4096];
+	size_t got = 0;
+	int ret;
+	clock_t start;
+
+#ifdef PRECALC_TABLES
+	fprintf(stderr, "tables: constant\n");
+#else
+	fprintf(stderr, "tables: computed at runtime\n");
+#endif
+	start = clock();
+	if(mpg123_init() != MPG123_OK)
+	{
+		error("cannot init library");
+		return -1;
+	}
+	printf("mpg123_init: %.0f us\n", elapsed_us(start));
+
+	start = clock();
+	mh = mpg123_new(NULL, NULL);
+	if(mh == NULL)
+	{
+		error("cannot create handle");
+		return -1;
+	}
+	printf("mpg123_new: %.0f us\n", elapsed_us(start));
+
+	if(argc > 1)
+	{
+		start = clock();
+		mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0.);
+		if(mpg123_open(mh, argv[1]) != MPG123_OK)
+		{
+			error1("cannot open %s", argv[1]);
+			mpg123_delete(mh);
+			return -1;
+		}
+		do ret = mpg123_read(mh, buf, sizeof(buf), &got);
+		while(ret == MPG123_NEW_FORMAT);
+		printf("first block: %.0f us\n", elapsed_us(start));
+		if(ret != MPG123_OK)
+			error1("decoding failed: %s", mpg123_strerror(mh));
+	}
+	mpg123_delete(mh);
+	mpg123_exit();
+	return 0;
+}
@@ -0,0 +1,154 @@
+#include "compat.h"
+#include <mpg123.h>
+#include <time.h>
+#include "debug.h"
+
+/*
+	Decode a file to float with a tap for subband samples and spectral lines.
+	The blocks have to come in the sizes of the layer, the energy of the
+	subband samples has to be about 1/32 of the one of the output (the
+	filter bank is nearly orthogonal, with that gain), unless that is
+	clipped. With MPG123_TAP_ONLY, the tap has to get the same data and the
+	output has to be silence of the same length. Prints the time of spectrum
+	only decoding relative to full decoding.
+	Usage: tap file...
+*/
+
+#define ENERGY_LOW  0.7
+#define ENERGY_HIGH 1.4
+
+struct tapped
+{
+	int bad;         /* block of unexpected size */
+	long blocks;
+	double subbands; /* energy */
+	double spectrum;
+	double sum;      /* of all values, weighted by position, to compare runs */
+};
+
+static void tap(void *handle, const struct mpg123_tap_data *td)
+{
+	struct tapped *t = handle;
+	size_t i;
+	double *energy = td->kind == MPG123_TAP_SPECTRUM ? &t->spectrum : &t->subbands;
+	if(  td->kind == MPG123_TAP_SUBBANDS
+	  ? (td->count % 32 || td->count > 36*32)
+	  : (td->count % 18 || td->count > 576 || td->block_type < 0 || td->block_type > 3) )
+	++t->bad;
+	if(td->channel < 0 || td->channel > 1 || td->granule < 0 || td->granule > 1)
+	++t->bad;
+	for(i=0; i<td->count; ++i)
+	{
+		*energy += (double)td->data[i]*td->data[i];
+		t->sum  += (double)td->data[i]*(double)(i+1);
+	}
+	++t->blocks;
+}
+
+/* Decode with the tap, return the number of samples (-1 on error), output energy and peak. */
+static long decode(const char *path, int kinds, int only, struct tapped *t, double *energy, double *peak)
+{
+	const long *rates;
+	size_t nrates, i;
+	long samples = 0;
+	int ret;
+	mpg123_handle *mh = mpg123_new(NULL, NULL);
+
+	memset(t, 0, sizeof(*t));
+	*energy = *peak = 0.;
+	if(mh == NULL) return -1;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0.);
+	if(only)
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_TAP_ONLY, 0.);
+	mpg123_rates(&rates, &nrates);
+	mpg123_format_none(mh);
+	for(i=0; i<nrates; ++i)
+	mpg123_format(mh, rates[i], MPG123_MONO|MPG123_STEREO, MPG123_ENC_FLOAT_32);
+	if(mpg123_tap(mh, kinds, tap, t) != MPG123_OK || mpg123_open(mh, path) != MPG123_OK)
+	{
+		mpg123_delete(mh);
+		return -1;
+	}
+	do
+	{
+		off_t num;
+		unsigned char *audio;
+		size_t bytes = 0;
+		float *s;
+		ret = mpg123_decode_frame(mh, &num, &audio, &bytes);
+		s = (float*)audio;
+		for(i=0; i<bytes/sizeof(float); ++i)
+		{
+			*energy += (double)s[i]*s[i];
+			if(s[i] > *peak) *peak = s[i];
+			if(-s[i] > *peak) *peak = -s[i];
+		}
+		samples += bytes/sizeof(float);
+	} while(ret == MPG123_OK || ret == MPG123_NEW_FORMAT);
+	mpg123_delete(mh);
+	return ret == MPG123_DONE ? samples : -1;
+}
+
+int test_file(const char *path)
+{
+	struct tapped full, only;
+	double energy, peak, dummy;
+	long samples, osamples;
+	clock_t full_time, only_time;
+
+	full_time = clock();
+	samples = decode(path, MPG123_TAP_SUBBANDS|MPG123_TAP_SPECTRUM, 0, &full, &energy, &peak);
+	full_time = clock() - full_time;
+	if(samples < 0 || full.blocks == 0 || full.bad)
+	{
+		error2("decoding failed or bad tap blocks (%li of %li)", (long)full.bad, full.blocks);
+		return -1;
+	}
+	if(peak < 1. && (32*full.subbands < ENERGY_LOW*energy || 32*full.subbands > ENERGY_HIGH*energy))
+	{
+		error2("subband energy %g, output energy %g", full.subbands, energy);
+		return -1;
+	}
+	osamples = decode(path, MPG123_TAP_SUBBANDS|MPG123_TAP_SPECTRUM, 1, &only, &dummy, &peak);
+	if(  osamples != samples || peak != 0. || only.blocks != full.blocks
+	  || only.sum != full.sum || only.subbands != full.subbands || only.spectrum != full.spectrum )
+	{
+		error2("tap only: %li samples instead of %li, or other data", osamples, samples);
+		return -1;
+	}
+	only_time = clock();
+	osamples = decode(path, MPG123_TAP_SPECTRUM, 1, &only, &dummy, &peak);
+	only_time = clock() - only_time;
+	if(osamples != samples || only.spectrum != full.spectrum)
+	{
+		error("spectrum only decoding differs");
+		return -1;
+	}
+	fprintf( stderr, "%li blocks, subband/output energy %g, spectrum/subbands %g, spectrum only %g of decoding time: "
+	,	full.blocks, energy > 0 ? 32*full.subbands/energy : 0.
+	,	full.subbands > 0 ? full.spectrum/full.subbands : 0.
+	,	full_time > 0 ? (double)only_time/full_time : 0. );
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int err = 0, errsum = 0;
+	int i;
+	if(argc < 2)
+	{
+		printf("Gimme a MPEG file name...\n");
+		return 0;
+	}
+	mpg123_init();
+	for(i=1; i<argc; ++i)
+	{
+		fprintf(stderr, "%s: ", argv[i]);
+		err = test_file(argv[i]);
+		fprintf(stdout, "%s\n", err == 0 ? "PASS" : "FAIL");
+		errsum += err;
+	}
+	mpg123_exit();
+	printf("%s\n", errsum ? "FAIL" : "PASS");
+	return errsum;
+}